@@ -0,0 +1,619 @@
+#include <Arduino.h>
+#include <SPI.h>
+#include <SD.h>
+#include <Wire.h>
+#include <LiquidCrystal.h>
+#include <avr/eeprom.h>
+
+#include "LptPinMap.h"
+#include "SimCore.h"
+#include "SimBoard.h"
+
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 64
+#endif
+
+// ============================================================================
+// Pins
+// ============================================================================
+
+namespace {
+
+struct PortRegisters {
+    volatile uint8_t* pin;
+    volatile uint8_t* port;
+    volatile uint8_t* ddr;
+};
+
+// Indexed by LptPinMap::Port
+const PortRegisters PORTS[LptPinMap::PORT_COUNT] = {
+    {nullptr, nullptr, nullptr},
+    {&PINA, &PORTA, &DDRA}, {&PINB, &PORTB, &DDRB}, {&PINC, &PORTC, &DDRC},
+    {&PIND, &PORTD, &DDRD}, {&PINE, &PORTE, &DDRE}, {&PINF, &PORTF, &DDRF},
+    {&PING, &PORTG, &DDRG}, {&PINH, &PORTH, &DDRH}, {&PINJ, &PORTJ, &DDRJ},
+    {&PINK, &PORTK, &DDRK}, {&PINL, &PORTL, &DDRL}
+};
+
+// Pins the host drives; pull-ups do not override them
+uint8_t drivenPins[LptPinMap::PORT_COUNT];
+
+const PortRegisters* portOfPin(uint8_t pin) {
+    uint8_t port = LptPinMap::portOf(pin);
+    return port == LptPinMap::PORT_NONE ? nullptr : &PORTS[port];
+}
+
+void setBit(volatile uint8_t* reg, uint8_t mask, bool level) {
+    if (level) {
+        *reg |= mask;
+    } else {
+        *reg &= (uint8_t)~mask;
+    }
+}
+
+} // namespace
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    Sim::advance(Sim::Cost::PIN_MODE);
+    const PortRegisters* regs = portOfPin(pin);
+    if (!regs) {
+        return;
+    }
+    uint8_t mask = LptPinMap::maskOf(pin);
+    setBit(regs->ddr, mask, mode == OUTPUT);
+    if (mode != OUTPUT) {
+        setBit(regs->port, mask, mode == INPUT_PULLUP);
+        if (!(drivenPins[LptPinMap::portOf(pin)] & mask)) {
+            setBit(regs->pin, mask, mode == INPUT_PULLUP);
+        }
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    Sim::advance(Sim::Cost::DIGITAL_WRITE);
+    const PortRegisters* regs = portOfPin(pin);
+    if (regs) {
+        setBit(regs->port, LptPinMap::maskOf(pin), value != LOW);
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    Sim::advance(Sim::Cost::DIGITAL_READ);
+    const PortRegisters* regs = portOfPin(pin);
+    if (!regs) {
+        return LOW;
+    }
+    uint8_t mask = LptPinMap::maskOf(pin);
+    volatile uint8_t* source = (*regs->ddr & mask) ? regs->port : regs->pin;
+    return (*source & mask) ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin) {
+    Sim::advance(Sim::Cost::ANALOG_READ);
+    return Sim::getAnalogLevel(pin >= A0 ? pin - A0 : pin);
+}
+
+void Sim::drivePin(uint8_t pin, bool level) {
+    const PortRegisters* regs = portOfPin(pin);
+    if (!regs) {
+        return;
+    }
+    uint8_t mask = LptPinMap::maskOf(pin);
+    drivenPins[LptPinMap::portOf(pin)] |= mask;
+    setBit(regs->pin, mask, level);
+
+    int number = digitalPinToInterrupt(pin);
+    if (number != NOT_AN_INTERRUPT) {
+        Sim::externalEdge((uint8_t)number, level);
+    }
+}
+
+bool Sim::readPinOutput(uint8_t pin) {
+    const PortRegisters* regs = portOfPin(pin);
+    return regs && (*regs->port & LptPinMap::maskOf(pin));
+}
+
+// ============================================================================
+// Time and interrupts
+// ============================================================================
+
+unsigned long millis() {
+    Sim::advance(Sim::Cost::MILLIS);
+    return (unsigned long)(Sim::now() / 1000000ULL);
+}
+
+unsigned long micros() {
+    Sim::advance(Sim::Cost::MICROS);
+    return (unsigned long)(Sim::now() / 1000ULL);
+}
+
+void delay(unsigned long ms) {
+    Sim::advance((uint64_t)ms * 1000000ULL);
+}
+
+void delayMicroseconds(unsigned int us) {
+    Sim::advance((uint64_t)us * 1000ULL);
+}
+
+void attachInterrupt(uint8_t interruptNumber, void (*handler)(void), int mode) {
+    Sim::attachExternal(interruptNumber, handler, mode);
+}
+
+void detachInterrupt(uint8_t interruptNumber) {
+    Sim::detachExternal(interruptNumber);
+}
+
+void noInterrupts() {
+    Sim::setInterruptsEnabled(false);
+}
+
+void interrupts() {
+    Sim::setInterruptsEnabled(true);
+}
+
+// ============================================================================
+// Print
+// ============================================================================
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size--) {
+        written += write(*buffer++);
+    }
+    return written;
+}
+
+size_t Print::printNumber(unsigned long value, int base) {
+    char digits[8 * sizeof(long) + 1];
+    char* p = &digits[sizeof(digits) - 1];
+    *p = '\0';
+    if (base < 2) {
+        base = 10;
+    }
+    do {
+        unsigned long digit = value % base;
+        value /= base;
+        *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    } while (value);
+    return write(p);
+}
+
+size_t Print::printSigned(long value, int base) {
+    if (base == DEC && value < 0) {
+        return print('-') + printNumber((unsigned long)-value, base);
+    }
+    return printNumber((unsigned long)value, base);
+}
+
+size_t Print::print(const __FlashStringHelper* text) {
+    return print(reinterpret_cast<const char*>(text));
+}
+
+size_t Print::print(const char* text) {
+    return write(text);
+}
+
+size_t Print::print(char value) {
+    return write((uint8_t)value);
+}
+
+size_t Print::print(unsigned char value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(int value, int base) {
+    return printSigned(value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(long value, int base) {
+    return printSigned(value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(double value, int digits) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+size_t Print::println() {
+    return write("\r\n");
+}
+
+size_t Print::println(const __FlashStringHelper* text) {
+    return print(text) + println();
+}
+
+size_t Print::println(const char* text) {
+    return print(text) + println();
+}
+
+size_t Print::println(char value) {
+    return print(value) + println();
+}
+
+size_t Print::println(unsigned char value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(int value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned int value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(double value, int digits) {
+    return print(value, digits) + println();
+}
+
+// ============================================================================
+// Serial
+// ============================================================================
+
+namespace {
+
+/**
+ * USART0 transmitter: one byte leaves the buffer per frame time, each
+ * through the data-register-empty interrupt
+ */
+class SerialTransmitter : public Sim::Device {
+public:
+    uint64_t byteNs = 86806;    // 115200 8N1
+    uint32_t queued = 0;
+    uint64_t nextDoneNs = Sim::NO_EVENT;
+    uint64_t totalBytes = 0;
+    uint64_t blockedNs = 0;
+    bool echo = false;
+    bool registered = false;
+
+    uint64_t nextEvent() const override {
+        return queued ? nextDoneNs : Sim::NO_EVENT;
+    }
+
+    void onEvent(uint64_t now) override {
+        while (queued && nextDoneNs <= now) {
+            queued--;
+            nextDoneNs += byteNs;
+            Sim::raise(Sim::VECTOR_USART0_UDRE);
+        }
+    }
+
+    void push(uint8_t value) {
+        uint64_t start = Sim::now();
+        while (queued >= SERIAL_TX_BUFFER_SIZE - 1) {
+            Sim::advance(nextDoneNs - Sim::now());
+        }
+        blockedNs += Sim::now() - start;
+
+        if (queued == 0) {
+            nextDoneNs = Sim::now() + byteNs;
+        }
+        queued++;
+        totalBytes++;
+        if (echo) {
+            putchar(value);
+        }
+    }
+};
+
+SerialTransmitter transmitter;
+
+} // namespace
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud, uint8_t config) {
+    (void)config;
+    if (baud == 0) {
+        baud = 9600;
+    }
+    transmitter.byteNs = 10000000000ULL / baud;
+    if (!transmitter.registered) {
+        Sim::addDevice(&transmitter);
+        transmitter.registered = true;
+    }
+}
+
+void HardwareSerial::end() {
+    flush();
+}
+
+int HardwareSerial::available() {
+    return 0;
+}
+
+int HardwareSerial::read() {
+    return -1;
+}
+
+int HardwareSerial::peek() {
+    return -1;
+}
+
+int HardwareSerial::availableForWrite() {
+    return (int)(SERIAL_TX_BUFFER_SIZE - 1 - transmitter.queued);
+}
+
+void HardwareSerial::flush() {
+    while (transmitter.queued) {
+        Sim::advance(transmitter.nextDoneNs - Sim::now());
+    }
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+    Sim::advance(Sim::Cost::SERIAL_WRITE);
+    transmitter.push(value);
+    return 1;
+}
+
+void Sim::setSerialEcho(bool enabled) {
+    transmitter.echo = enabled;
+}
+
+uint64_t Sim::getSerialBytes() {
+    return transmitter.totalBytes;
+}
+
+uint64_t Sim::getSerialBlockedNs() {
+    return transmitter.blockedNs;
+}
+
+// ============================================================================
+// SPI
+// ============================================================================
+
+namespace {
+
+Sim::SpiDevice* spiDevice = nullptr;
+uint64_t spiBitNs = 125;            // F_CPU/2
+uint64_t spiDoneNs = 0;
+uint8_t spiReceived = 0xFF;
+bool spiFlag = false;
+
+uint8_t exchangeByte(uint8_t mosi) {
+    return spiDevice ? spiDevice->exchange(mosi) : 0xFF;
+}
+
+} // namespace
+
+SPIClass SPI;
+SimSpiData SPDR;
+SimSpiStatus SPSR;
+
+void Sim::setSpiDevice(SpiDevice* device) {
+    spiDevice = device;
+}
+
+void SPIClass::begin() {
+    Sim::advance(Sim::Cost::PIN_MODE * 3);
+}
+
+void SPIClass::end() {
+}
+
+void SPIClass::beginTransaction(SPISettings settings) {
+    // The AVR divides F_CPU by 2..128; the fastest rate not above the request
+    uint32_t divider = 2;
+    while (divider < 128 && F_CPU / divider > settings.clock) {
+        divider *= 2;
+    }
+    spiBitNs = 1000000000ULL * divider / F_CPU;
+    Sim::advance(Sim::Cost::SREG_ACCESS * 8);
+}
+
+void SPIClass::endTransaction() {
+    if (spiDevice) {
+        spiDevice->endTransaction();
+    }
+    Sim::advance(Sim::Cost::SREG_ACCESS * 2);
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+    uint8_t received = exchangeByte(data);
+    Sim::advance(Sim::Cost::SPI_TRANSFER_CALL + 8 * spiBitNs);
+    return received;
+}
+
+void SPIClass::transfer(void* buffer, size_t count) {
+    uint8_t* bytes = static_cast<uint8_t*>(buffer);
+    for (size_t i = 0; i < count; i++) {
+        bytes[i] = transfer(bytes[i]);
+    }
+}
+
+void SPIClass::setClockDivider(uint8_t divider) {
+    (void)divider;
+}
+
+SimSpiData::operator uint8_t() const {
+    spiFlag = false;
+    return spiReceived;
+}
+
+SimSpiData& SimSpiData::operator=(uint8_t value) {
+    // Shifts out at once; SPIF sets 8 bit times later
+    spiReceived = exchangeByte(value);
+    spiFlag = false;
+    spiDoneNs = Sim::now() + 8 * spiBitNs;
+    Sim::advance(Sim::Cost::CYCLE);
+    return *this;
+}
+
+SimSpiStatus::operator uint8_t() const {
+    Sim::advance(Sim::Cost::SPI_STATUS_POLL);
+    if (Sim::now() >= spiDoneNs) {
+        spiFlag = true;
+    }
+    return spiFlag ? _BV(SPIF) : 0;
+}
+
+SimSpiStatus& SimSpiStatus::operator=(uint8_t value) {
+    (void)value;
+    return *this;
+}
+
+SimSpiStatus& SimSpiStatus::operator|=(uint8_t value) {
+    (void)value;
+    return *this;
+}
+
+SimSpiStatus& SimSpiStatus::operator&=(uint8_t value) {
+    (void)value;
+    return *this;
+}
+
+// ============================================================================
+// SD, I2C, LCD
+// ============================================================================
+
+SDClass SD;
+TwoWire Wire;
+
+void TwoWire::begin() {
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    (void)address;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    // START, address byte, NACK
+    Sim::advance(Sim::Cost::I2C_BYTE + 20000);
+    return 2;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity) {
+    (void)address;
+    (void)quantity;
+    Sim::advance(Sim::Cost::I2C_BYTE + 20000);
+    return 0;
+}
+
+size_t TwoWire::write(uint8_t value) {
+    (void)value;
+    return 1;
+}
+
+LiquidCrystal::LiquidCrystal(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7) {
+    (void)rs;
+    (void)enable;
+    (void)d4;
+    (void)d5;
+    (void)d6;
+    (void)d7;
+}
+
+void LiquidCrystal::begin(uint8_t cols, uint8_t rows) {
+    (void)cols;
+    (void)rows;
+    // Power-up wait and the 4-bit mode sequence
+    Sim::advance(60000000ULL);
+}
+
+void LiquidCrystal::clear() {
+    Sim::advance(Sim::Cost::LCD_CLEAR);
+}
+
+void LiquidCrystal::home() {
+    Sim::advance(Sim::Cost::LCD_CLEAR);
+}
+
+void LiquidCrystal::setCursor(uint8_t col, uint8_t row) {
+    (void)col;
+    (void)row;
+    Sim::advance(Sim::Cost::LCD_OP);
+}
+
+void LiquidCrystal::createChar(uint8_t location, uint8_t charmap[]) {
+    (void)location;
+    (void)charmap;
+    Sim::advance(9 * Sim::Cost::LCD_OP);
+}
+
+size_t LiquidCrystal::write(uint8_t value) {
+    (void)value;
+    Sim::advance(Sim::Cost::LCD_OP);
+    return 1;
+}
+
+void LiquidCrystal::noDisplay() {
+    Sim::advance(Sim::Cost::LCD_OP);
+}
+
+void LiquidCrystal::display() {
+    Sim::advance(Sim::Cost::LCD_OP);
+}
+
+// ============================================================================
+// Internal EEPROM
+// ============================================================================
+
+namespace {
+
+const size_t INTERNAL_EEPROM_SIZE = 4096;
+uint8_t internalEeprom[INTERNAL_EEPROM_SIZE];
+bool internalEepromErased = false;
+
+uint8_t* eepromCell(const void* address) {
+    if (!internalEepromErased) {
+        memset(internalEeprom, 0xFF, sizeof(internalEeprom));
+        internalEepromErased = true;
+    }
+    return &internalEeprom[reinterpret_cast<uintptr_t>(address) % INTERNAL_EEPROM_SIZE];
+}
+
+} // namespace
+
+uint8_t eeprom_read_byte(const uint8_t* address) {
+    Sim::advance(Sim::Cost::EEPROM_READ);
+    return *eepromCell(address);
+}
+
+void eeprom_update_byte(uint8_t* address, uint8_t value) {
+    uint8_t* cell = eepromCell(address);
+    if (*cell != value) {
+        *cell = value;
+        Sim::advance(Sim::Cost::EEPROM_WRITE);
+    } else {
+        Sim::advance(Sim::Cost::EEPROM_READ);
+    }
+}
+
+void eeprom_read_block(void* dst, const void* src, size_t size) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    for (size_t i = 0; i < size; i++) {
+        out[i] = eeprom_read_byte(reinterpret_cast<const uint8_t*>(src) + i);
+    }
+}
+
+void eeprom_update_block(const void* src, void* dst, size_t size) {
+    const uint8_t* in = static_cast<const uint8_t*>(src);
+    for (size_t i = 0; i < size; i++) {
+        eeprom_update_byte(reinterpret_cast<uint8_t*>(dst) + i, in[i]);
+    }
+}
+
+void eeprom_write_block(const void* src, void* dst, size_t size) {
+    const uint8_t* in = static_cast<const uint8_t*>(src);
+    for (size_t i = 0; i < size; i++) {
+        *eepromCell(reinterpret_cast<uint8_t*>(dst) + i) = in[i];
+        Sim::advance(Sim::Cost::EEPROM_WRITE);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef BENCH_SIMBOARD_H
+#define BENCH_SIMBOARD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * SimBoard - What the simulated peripherals see of the Mega's pins and
+ * buses (SimArduino.cpp)
+ */
+namespace Sim {
+
+/**
+ * Device on the SPI bus; it decides from its chip select whether a byte
+ * is meant for it
+ */
+class SpiDevice {
+public:
+    virtual ~SpiDevice() {}
+
+    /**
+     * Shift one byte in each direction
+     * @param mosi Byte from the master
+     * @return Byte to the master (0xFF when not selected)
+     */
+    virtual uint8_t exchange(uint8_t mosi) = 0;
+
+    /**
+     * SPI.endTransaction(): the command in progress ends if the chip select
+     * has been raised
+     */
+    virtual void endTransaction() = 0;
+};
+
+/**
+ * Attach the device the SPI bus talks to
+ * @param device Device or nullptr
+ */
+void setSpiDevice(SpiDevice* device);
+
+/**
+ * Drive an input pin from outside the board (the parallel port host)
+ * INT pins also raise their interrupt on the matching edge.
+ * @param pin Arduino pin number
+ * @param level New level
+ */
+void drivePin(uint8_t pin, bool level);
+
+/**
+ * Level the board drives on a pin (PORTx bit), e.g. BUSY or a chip select
+ * @param pin Arduino pin number
+ * @return true if high
+ */
+bool readPinOutput(uint8_t pin);
+
+/**
+ * Copy the firmware's serial output to stdout
+ * @param enabled true to echo
+ */
+void setSerialEcho(bool enabled);
+
+/**
+ * Total bytes the firmware has sent on Serial
+ */
+uint64_t getSerialBytes();
+
+/**
+ * Time the firmware spent blocked on a full serial transmit buffer
+ */
+uint64_t getSerialBlockedNs();
+
+} // namespace Sim
+
+#endif // BENCH_SIMBOARD_H
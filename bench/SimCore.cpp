@@ -0,0 +1,395 @@
+#include "SimCore.h"
+#include <Arduino.h>
+
+// Register file (avr/io.h)
+volatile uint8_t PINA, PINB, PINC, PIND, PINE, PINF, PING, PINH, PINJ, PINK, PINL;
+volatile uint8_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF, PORTG, PORTH, PORTJ, PORTK, PORTL;
+volatile uint8_t DDRA, DDRB, DDRC, DDRD, DDRE, DDRF, DDRG, DDRH, DDRJ, DDRK, DDRL;
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1;
+volatile uint8_t TCCR3A, TCCR3B, TCCR3C, TIMSK3;
+volatile uint16_t OCR1A, OCR1B, OCR3A, OCR3B;
+volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR0;
+volatile uint16_t ADC;
+volatile uint8_t XMCRA, XMCRB, SMCR, MCUSR, EIMSK, SPCR;
+
+SimStatusRegister SREG;
+SimTimerCounter TCNT1, TCNT3;
+SimFlagRegister TIFR3;
+
+// Vectors the firmware may define with ISR()
+extern "C" void ADC_vect(void) __attribute__((weak));
+extern "C" void TIMER3_COMPA_vect(void) __attribute__((weak));
+
+namespace Sim {
+
+namespace {
+
+constexpr uint64_t ADC_CONVERSION_NS = 104000;  // 13 ADC clocks at 125kHz
+constexpr uint8_t EXTERNAL_COUNT = 6;
+constexpr uint8_t MAX_DEVICES = 8;
+
+// AVR priority of the INT lines by attachInterrupt() number
+// (INT0-INT3 are on pins 21-18 = numbers 2-5, INT4/INT5 on pins 2/3)
+constexpr Vector INT_PRIORITY[EXTERNAL_COUNT] = {
+    VECTOR_INT2, VECTOR_INT3, VECTOR_INT4, VECTOR_INT5, VECTOR_INT0, VECTOR_INT1
+};
+
+uint64_t clockNs = 0;
+bool enabled = false;           // I bit is clear out of reset
+bool servicing = false;         // An interrupt handler is running
+bool frozen = false;            // Observer running: no time, no dispatch
+
+uint32_t pending = 0;
+uint64_t raisedAt[VECTOR_COUNT];
+VectorStats stats[VECTOR_COUNT];
+uint32_t dispatched = 0;
+uint64_t sleepNs = 0;
+
+Device* devices[MAX_DEVICES];
+uint8_t deviceCount = 0;
+void (*observer)(void) = nullptr;
+
+void (*externalHandlers[EXTERNAL_COUNT])(void);
+int externalModes[EXTERNAL_COUNT];
+bool externalLevels[EXTERNAL_COUNT] = {true, true, true, true, true, true};
+
+uint16_t analogLevels[16] = {
+    1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023
+};
+
+uint64_t nextTimer0Ns = TIMER0_PERIOD_NS;
+uint64_t adcDoneNs = NO_EVENT;
+uint64_t lastTimer3MatchTick = NO_EVENT;
+
+uint64_t timerTicks() {
+    return clockNs / TIMER_TICK_NS;
+}
+
+bool isAdcAutoTriggered() {
+    const uint8_t needed = _BV(ADEN) | _BV(ADATE) | _BV(ADIE);
+    return (ADCSRA & needed) == needed && (ADCSRB & 0x07) == _BV(ADTS2);
+}
+
+/**
+ * Next Timer3 compare A match (only while its interrupt is enabled)
+ */
+uint64_t nextTimer3Match() {
+    if (!(TIMSK3 & _BV(OCIE3A))) {
+        return NO_EVENT;
+    }
+    uint64_t ticks = timerTicks();
+    uint16_t counter = TCNT3;
+    uint32_t distance = (uint16_t)(OCR3A - counter);
+    if (distance == 0 && ticks != lastTimer3MatchTick) {
+        return clockNs;
+    }
+    if (distance == 0) {
+        distance = 0x10000;
+    }
+    return (ticks + distance) * TIMER_TICK_NS;
+}
+
+uint64_t nextEventNs() {
+    uint64_t next = nextTimer0Ns;
+    if (adcDoneNs < next) {
+        next = adcDoneNs;
+    }
+    uint64_t match = nextTimer3Match();
+    if (match < next) {
+        next = match;
+    }
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        uint64_t event = devices[i]->nextEvent();
+        if (event < next) {
+            next = event;
+        }
+    }
+    return next;
+}
+
+/**
+ * Run everything due at the current time
+ */
+void fireEvents() {
+    while (nextTimer0Ns <= clockNs) {
+        raise(VECTOR_TIMER0_OVF);
+        if (isAdcAutoTriggered() && adcDoneNs == NO_EVENT) {
+            adcDoneNs = nextTimer0Ns + ADC_CONVERSION_NS;
+        }
+        nextTimer0Ns += TIMER0_PERIOD_NS;
+    }
+    if (adcDoneNs <= clockNs) {
+        adcDoneNs = NO_EVENT;
+        uint8_t channel = (ADMUX & 0x07) | ((ADCSRB & _BV(MUX5)) ? 8 : 0);
+        ADC = analogLevels[channel];
+        if (isAdcAutoTriggered()) {
+            raise(VECTOR_ADC);
+        }
+    }
+    if (nextTimer3Match() <= clockNs) {
+        lastTimer3MatchTick = timerTicks();
+        raise(VECTOR_TIMER3_COMPA);
+    }
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (devices[i]->nextEvent() <= clockNs) {
+            devices[i]->onEvent(clockNs);
+        }
+    }
+}
+
+void notifyObserver() {
+    if (observer && !frozen) {
+        bool wasEnabled = enabled;
+        frozen = true;
+        observer();
+        frozen = false;
+        enabled = wasEnabled;
+    }
+}
+
+void runHandler(Vector vector) {
+    switch (vector) {
+        case VECTOR_INT0:
+        case VECTOR_INT1:
+        case VECTOR_INT2:
+        case VECTOR_INT3:
+        case VECTOR_INT4:
+        case VECTOR_INT5:
+            // Register saves before the handler, restores after it
+            advance(Cost::VECTOR_INT / 2);
+            if (externalHandlers[vector]) {
+                externalHandlers[vector]();
+            }
+            advance(Cost::VECTOR_INT - Cost::VECTOR_INT / 2);
+            break;
+        case VECTOR_TIMER0_OVF:
+            advance(Cost::VECTOR_TIMER0);
+            break;
+        case VECTOR_ADC:
+            advance(Cost::VECTOR_ADC);
+            if (ADC_vect) {
+                ADC_vect();
+            }
+            break;
+        case VECTOR_USART0_UDRE:
+            advance(Cost::VECTOR_UDRE);
+            break;
+        case VECTOR_TIMER3_COMPA:
+            advance(Cost::VECTOR_TIMER3);
+            if (TIMER3_COMPA_vect) {
+                TIMER3_COMPA_vect();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Highest priority pending vector
+ */
+int nextPending() {
+    for (uint8_t i = 0; i < EXTERNAL_COUNT; i++) {
+        if (pending & (1UL << INT_PRIORITY[i])) {
+            return INT_PRIORITY[i];
+        }
+    }
+    for (uint8_t v = VECTOR_TIMER0_OVF; v < VECTOR_COUNT; v++) {
+        if (pending & (1UL << v)) {
+            return v;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Take pending interrupts the way the AVR does between instructions
+ * @return Time the handlers took
+ */
+uint64_t dispatch() {
+    if (!enabled || servicing || frozen) {
+        return 0;
+    }
+
+    uint64_t start = clockNs;
+    int vector;
+    while (enabled && (vector = nextPending()) >= 0) {
+        pending &= ~(1UL << vector);
+        VectorStats& vectorStats = stats[vector];
+        uint64_t latency = clockNs - raisedAt[vector];
+        if (latency > vectorStats.maxLatencyNs) {
+            vectorStats.maxLatencyNs = latency;
+        }
+
+        uint64_t entry = clockNs;
+        servicing = true;
+        enabled = false;
+        runHandler((Vector)vector);
+        enabled = true;
+        servicing = false;
+
+        vectorStats.count++;
+        vectorStats.busyNs += clockNs - entry;
+        dispatched++;
+        notifyObserver();
+    }
+    return clockNs - start;
+}
+
+} // namespace
+
+uint64_t now() {
+    return clockNs;
+}
+
+void advance(uint64_t ns) {
+    if (frozen) {
+        return;
+    }
+
+    uint64_t target = clockNs + ns;
+    for (;;) {
+        // Handlers run on the main line's time
+        target += dispatch();
+        uint64_t next = nextEventNs();
+        if (next > target) {
+            break;
+        }
+        if (next > clockNs) {
+            clockNs = next;
+        }
+        fireEvents();
+    }
+    if (target > clockNs) {
+        clockNs = target;
+    }
+    notifyObserver();
+}
+
+void setInterruptsEnabled(bool value) {
+    enabled = value;
+    if (!frozen) {
+        advance(Cost::SREG_ACCESS);
+    }
+}
+
+bool interruptsEnabled() {
+    return enabled;
+}
+
+bool inInterrupt() {
+    return servicing;
+}
+
+void sleepUntilInterrupt() {
+    // With I clear only a reset would end the sleep
+    if (!enabled || servicing || frozen) {
+        return;
+    }
+
+    uint32_t before = dispatched;
+    uint64_t start = clockNs;
+    while (dispatched == before) {
+        if (pending) {
+            dispatch();
+            break;
+        }
+        uint64_t next = nextEventNs();
+        if (next > clockNs) {
+            clockNs = next;
+        }
+        fireEvents();
+    }
+    sleepNs += clockNs - start;
+}
+
+void raise(Vector vector) {
+    uint32_t bit = 1UL << vector;
+    if (pending & bit) {
+        stats[vector].merged++;
+        return;
+    }
+    pending |= bit;
+    raisedAt[vector] = clockNs;
+}
+
+void externalEdge(uint8_t number, bool level) {
+    if (number >= EXTERNAL_COUNT) {
+        return;
+    }
+    bool old = externalLevels[number];
+    externalLevels[number] = level;
+    if (!externalHandlers[number] || old == level) {
+        return;
+    }
+
+    int mode = externalModes[number];
+    if (mode == CHANGE || (mode == FALLING && !level) || (mode == RISING && level)) {
+        raise((Vector)number);
+    }
+}
+
+void attachExternal(uint8_t number, void (*handler)(void), int mode) {
+    if (number < EXTERNAL_COUNT) {
+        externalHandlers[number] = handler;
+        externalModes[number] = mode;
+    }
+}
+
+void detachExternal(uint8_t number) {
+    if (number < EXTERNAL_COUNT) {
+        externalHandlers[number] = nullptr;
+        pending &= ~(1UL << number);
+    }
+}
+
+void addDevice(Device* device) {
+    if (device && deviceCount < MAX_DEVICES) {
+        devices[deviceCount++] = device;
+    }
+}
+
+void setObserver(void (*hook)(void)) {
+    observer = hook;
+}
+
+void setAnalogLevel(uint8_t channel, uint16_t value) {
+    if (channel < 16) {
+        analogLevels[channel] = value;
+    }
+}
+
+uint16_t getAnalogLevel(uint8_t channel) {
+    return channel < 16 ? analogLevels[channel] : 0;
+}
+
+const VectorStats& getVectorStats(Vector vector) {
+    return stats[vector < VECTOR_COUNT ? vector : 0];
+}
+
+uint64_t getSleepNs() {
+    return sleepNs;
+}
+
+} // namespace Sim
+
+// Register proxies
+
+SimStatusRegister::operator uint8_t() const {
+    return Sim::interruptsEnabled() ? 0x80 : 0x00;
+}
+
+SimStatusRegister& SimStatusRegister::operator=(uint8_t value) {
+    Sim::setInterruptsEnabled((value & 0x80) != 0);
+    return *this;
+}
+
+SimTimerCounter::operator uint16_t() const {
+    return (uint16_t)(Sim::now() / Sim::TIMER_TICK_NS + offset);
+}
+
+SimTimerCounter& SimTimerCounter::operator=(uint16_t value) {
+    offset = (uint16_t)(value - (uint16_t)(Sim::now() / Sim::TIMER_TICK_NS));
+    return *this;
+}
@@ -0,0 +1,162 @@
+#ifndef BENCH_SIMCORE_H
+#define BENCH_SIMCORE_H
+
+#include <stdint.h>
+
+/**
+ * SimCore - Simulated ATmega2560 time base and interrupt controller
+ * The firmware runs unmodified on the host; time only moves when it calls
+ * into the mock Arduino core (micros(), digitalWrite(), SPI, LCD...) or
+ * when an interrupt runs. Each such call advances the nanosecond clock by
+ * its cost on a 16MHz Mega, and any interrupt that became due is
+ * dispatched at that point unless interrupts are disabled or one is
+ * already running, the way the AVR takes interrupts between instructions.
+ *
+ * Interrupt sources are Timer0 overflow (1.024ms, millis()), the ADC
+ * auto-triggered from it, Timer3 compare A, the USART0 transmitter and
+ * INT0-INT5. External devices (the trace replay host) plug in as Device.
+ */
+namespace Sim {
+
+// In AVR priority order (lowest vector number first)
+enum Vector : uint8_t {
+    VECTOR_INT0 = 0,            // Indexed by attachInterrupt() number:
+    VECTOR_INT1,                //   0-1 on pins 2-3, 2-5 on pins 21-18
+    VECTOR_INT2,
+    VECTOR_INT3,
+    VECTOR_INT4,
+    VECTOR_INT5,
+    VECTOR_TIMER0_OVF,
+    VECTOR_ADC,
+    VECTOR_USART0_UDRE,
+    VECTOR_TIMER3_COMPA,
+    VECTOR_COUNT
+};
+
+// Cost model (ns at 16MHz); figures are the usual measurements of the
+// Arduino AVR core, handler bodies are folded into the vector cost
+namespace Cost {
+constexpr uint32_t CYCLE = 63;                  // 62.5ns, rounded
+constexpr uint32_t MICROS = 3500;
+constexpr uint32_t MILLIS = 1500;
+constexpr uint32_t DIGITAL_WRITE = 3500;
+constexpr uint32_t DIGITAL_READ = 3000;
+constexpr uint32_t PIN_MODE = 4000;
+constexpr uint32_t ANALOG_READ = 112000;        // One 13-cycle conversion at 125kHz
+constexpr uint32_t SPI_TRANSFER_CALL = 500;     // SPI.transfer() around the 8 bit times
+constexpr uint32_t SPI_STATUS_POLL = 2 * CYCLE;
+constexpr uint32_t SREG_ACCESS = CYCLE;
+constexpr uint32_t SERIAL_WRITE = 5000;         // Print::write + ring insert
+constexpr uint32_t EEPROM_WRITE = 3400000;      // Per changed byte
+constexpr uint32_t EEPROM_READ = 500;
+constexpr uint32_t LCD_OP = 100000;             // Character or cursor move
+constexpr uint32_t LCD_CLEAR = 2000000;         // clear() and home()
+constexpr uint32_t I2C_BYTE = 90000;            // 9 bits at 100kHz
+constexpr uint32_t LOOP_PASS = 20000;           // Scheduler bookkeeping per loop()
+
+// Interrupt entry, handler and return
+constexpr uint32_t VECTOR_INT = 4000;           // attachInterrupt() trampoline + strobe ISR
+constexpr uint32_t VECTOR_TIMER0 = 1000;
+constexpr uint32_t VECTOR_ADC = 2000;
+constexpr uint32_t VECTOR_UDRE = 2500;
+constexpr uint32_t VECTOR_TIMER3 = 1500;
+} // namespace Cost
+
+constexpr uint64_t NO_EVENT = ~(uint64_t)0;
+constexpr uint64_t TIMER0_PERIOD_NS = 1024000;  // 64 prescaler, 256 counts
+constexpr uint64_t TIMER_TICK_NS = 500;         // Timer1/Timer3 at F_CPU/8
+
+/**
+ * Simulated peripheral or external device with its own timeline
+ */
+class Device {
+public:
+    virtual ~Device() {}
+
+    /**
+     * Time of the next thing this device does on its own
+     * @return Absolute time in ns, or NO_EVENT
+     */
+    virtual uint64_t nextEvent() const = 0;
+
+    /**
+     * Do everything due at or before now
+     * @param now Current time in ns
+     */
+    virtual void onEvent(uint64_t now) = 0;
+};
+
+struct VectorStats {
+    uint32_t count;             // Handler runs
+    uint32_t merged;            // Raised again while still pending (lost)
+    uint64_t busyNs;            // Time spent in the handler
+    uint64_t maxLatencyNs;      // Pending to handler entry
+};
+
+/**
+ * Current simulated time
+ * @return ns since reset
+ */
+uint64_t now();
+
+/**
+ * Let time pass on the main line (dispatches due interrupts)
+ * @param ns Duration; interrupts that run meanwhile extend it
+ */
+void advance(uint64_t ns);
+
+/**
+ * Global interrupt enable (SREG bit 7), from cli()/sei() and SREG writes
+ * @param enabled New state; enabling runs pending interrupts
+ */
+void setInterruptsEnabled(bool enabled);
+bool interruptsEnabled();
+bool inInterrupt();
+
+/**
+ * SLEEP_MODE_IDLE: wait for the next interrupt and run it
+ */
+void sleepUntilInterrupt();
+
+/**
+ * Flag an interrupt
+ * @param vector Vector
+ */
+void raise(Vector vector);
+
+/**
+ * External interrupt line changed level (INT pins)
+ * @param number attachInterrupt() number
+ * @param level New level
+ */
+void externalEdge(uint8_t number, bool level);
+void attachExternal(uint8_t number, void (*handler)(void), int mode);
+void detachExternal(uint8_t number);
+
+/**
+ * Register a device whose events are merged into the timeline
+ * @param device Device (must outlive the run)
+ */
+void addDevice(Device* device);
+
+/**
+ * Set a hook run after every dispatched interrupt and by advance(), with
+ * the clock frozen and interrupts masked (for metrics)
+ * @param hook Function or nullptr
+ */
+void setObserver(void (*hook)(void));
+
+/**
+ * Level on an analog pin as the ADC converts it
+ * @param channel 0-15
+ * @param value 0-1023
+ */
+void setAnalogLevel(uint8_t channel, uint16_t value);
+uint16_t getAnalogLevel(uint8_t channel);
+
+const VectorStats& getVectorStats(Vector vector);
+uint64_t getSleepNs();
+
+} // namespace Sim
+
+#endif // BENCH_SIMCORE_H
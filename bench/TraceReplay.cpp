@@ -0,0 +1,273 @@
+#include "TraceReplay.h"
+#include "SimBoard.h"
+#include "HardwareConfig.h"
+#include "LptPinMap.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+TraceReplay::TraceReplay()
+    : data(nullptr), times(nullptr), count(0), capacity(0), mode(HOST_ACK),
+      strobeWidthNs(1000), startNs(0), phase(PHASE_IDLE), position(0),
+      eventAt(Sim::NO_EVENT), waitStart(Sim::NO_EVENT), ackSeenLow(false),
+      ackDeadline(0), stats() {
+}
+
+TraceReplay::~TraceReplay() {
+    free(data);
+    free(times);
+}
+
+bool TraceReplay::append(uint64_t timeNs, uint8_t value) {
+    if (count == capacity) {
+        size_t grown = capacity ? capacity * 2 : 65536;
+        uint8_t* newData = static_cast<uint8_t*>(realloc(data, grown));
+        if (!newData) {
+            return false;
+        }
+        data = newData;
+        uint64_t* newTimes = static_cast<uint64_t*>(realloc(times, grown * sizeof(uint64_t)));
+        if (!newTimes) {
+            return false;
+        }
+        times = newTimes;
+        capacity = grown;
+    }
+    data[count] = value;
+    times[count] = timeNs;
+    count++;
+    return true;
+}
+
+bool TraceReplay::loadTrace(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    char line[256];
+    uint64_t firstUs = 0;
+    bool first = true;
+    while (fgets(line, sizeof(line), file)) {
+        char* comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        for (char* p = line; *p; p++) {
+            if (*p == ',') {
+                *p = ' ';
+            }
+        }
+
+        double timeUs;
+        unsigned int value;
+        if (sscanf(line, "%lf %x", &timeUs, &value) != 2) {
+            continue;
+        }
+        uint64_t us = timeUs > 0 ? (uint64_t)(timeUs * 1000.0) : 0;
+        if (first) {
+            firstUs = us;
+            first = false;
+        }
+        if (!append(us >= firstUs ? us - firstUs : 0, (uint8_t)value)) {
+            break;
+        }
+    }
+    fclose(file);
+    return count > 0;
+}
+
+bool TraceReplay::loadRaw(const char* path, uint32_t gapUs) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+
+    int value;
+    while ((value = fgetc(file)) != EOF) {
+        if (!append((uint64_t)count * gapUs * 1000, (uint8_t)value)) {
+            break;
+        }
+    }
+    fclose(file);
+    return count > 0;
+}
+
+void TraceReplay::generate(size_t size, uint32_t gapUs) {
+    const uint32_t width = 320;
+    const uint32_t height = 240;
+    const uint32_t pixelOffset = 14 + 40 + 256 * 4;
+    const uint32_t fileSize = pixelOffset + width * height;
+
+    uint8_t* image = static_cast<uint8_t*>(calloc(fileSize, 1));
+    if (!image) {
+        return;
+    }
+
+    // BITMAPFILEHEADER + BITMAPINFOHEADER, 8 bits per pixel, bottom-up
+    auto put16 = [&](uint32_t at, uint16_t v) { image[at] = v & 0xFF; image[at + 1] = v >> 8; };
+    auto put32 = [&](uint32_t at, uint32_t v) { put16(at, v & 0xFFFF); put16(at + 2, v >> 16); };
+    image[0] = 'B';
+    image[1] = 'M';
+    put32(2, fileSize);
+    put32(10, pixelOffset);
+    put32(14, 40);
+    put32(18, width);
+    put32(22, height);
+    put16(26, 1);
+    put16(28, 8);
+    put32(34, width * height);
+    put32(46, 256);
+
+    // Palette: background, graticule, channel 1
+    const uint32_t palette = 14 + 40;
+    put32(palette + 1 * 4, 0x808080);
+    put32(palette + 2 * 4, 0xFFFF00);
+
+    for (uint32_t y = 0; y < height; y++) {
+        uint8_t* row = image + pixelOffset + y * width;
+        for (uint32_t x = 0; x < width; x++) {
+            bool grid = (x % 32 == 0 && y % 2 == 0) || (y % 24 == 0 && x % 2 == 0);
+            row[x] = grid ? 1 : 0;
+        }
+    }
+    for (uint32_t x = 0; x < width; x++) {
+        int y = (int)(height / 2 + 80 * sin(2.0 * M_PI * x / 80.0));
+        for (int dy = -1; dy <= 1; dy++) {
+            if (y + dy >= 0 && y + dy < (int)height) {
+                image[pixelOffset + (y + dy) * width + x] = 2;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        if (!append((uint64_t)i * gapUs * 1000, image[i % fileSize])) {
+            break;
+        }
+    }
+    free(image);
+}
+
+void TraceReplay::start(HostMode hostMode, uint32_t strobeWidthUs) {
+    mode = hostMode;
+    strobeWidthNs = (uint64_t)(strobeWidthUs ? strobeWidthUs : 1) * 1000;
+    startNs = Sim::now();
+    position = 0;
+    stats = Stats();
+    waitStart = Sim::NO_EVENT;
+    phase = count ? PHASE_READY : PHASE_DONE;
+    eventAt = count ? startNs + times[0] : Sim::NO_EVENT;
+
+    // Idle bus: /Strobe high
+    Sim::drivePin(LPT_STROBE_PIN, true);
+    Sim::addDevice(this);
+}
+
+bool TraceReplay::isFinished() const {
+    return phase == PHASE_DONE;
+}
+
+const uint8_t* TraceReplay::getData() const {
+    return data;
+}
+
+size_t TraceReplay::getSize() const {
+    return count;
+}
+
+const TraceReplay::Stats& TraceReplay::getStats() const {
+    return stats;
+}
+
+uint64_t TraceReplay::nextEvent() const {
+    return phase == PHASE_DONE || phase == PHASE_IDLE ? Sim::NO_EVENT : eventAt;
+}
+
+void TraceReplay::endBusyWait(uint64_t now) {
+    if (waitStart == Sim::NO_EVENT) {
+        return;
+    }
+    uint64_t waited = now - waitStart;
+    stats.busyWaitNs += waited;
+    if (waited > stats.maxBusyWaitNs) {
+        stats.maxBusyWaitNs = waited;
+    }
+    waitStart = Sim::NO_EVENT;
+}
+
+void TraceReplay::presentByte(uint64_t now) {
+    uint8_t value = data[position];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        Sim::drivePin(LptPinMap::DATA_PINS[bit], (value >> bit) & 1);
+    }
+    Sim::drivePin(LPT_STROBE_PIN, false);
+
+    if (stats.strobed == 0) {
+        stats.firstStrobeNs = now;
+    }
+    stats.lastStrobeNs = now;
+    stats.strobed++;
+    position++;
+
+    phase = PHASE_STROBE;
+    eventAt = now + strobeWidthNs;
+}
+
+void TraceReplay::onEvent(uint64_t now) {
+    for (;;) {
+        switch (phase) {
+            case PHASE_READY: {
+                if (position >= count) {
+                    phase = PHASE_DONE;
+                    return;
+                }
+                uint64_t due = startNs + times[position];
+                if (now < due) {
+                    eventAt = due;
+                    return;
+                }
+                if (mode != HOST_BLIND && Sim::readPinOutput(LPT_BUSY_PIN)) {
+                    if (waitStart == Sim::NO_EVENT) {
+                        waitStart = now;
+                    }
+                    eventAt = now + POLL_NS;
+                    return;
+                }
+                endBusyWait(now);
+                presentByte(now);
+                return;
+            }
+            case PHASE_STROBE:
+                Sim::drivePin(LPT_STROBE_PIN, true);
+                if (mode == HOST_ACK) {
+                    phase = PHASE_ACK;
+                    ackSeenLow = false;
+                    ackDeadline = now + ACK_TIMEOUT_NS;
+                    eventAt = now + POLL_NS;
+                } else {
+                    phase = PHASE_READY;
+                    eventAt = now + (mode == HOST_BUSY ? HOST_BUSY_SETTLE_NS : 0);
+                }
+                return;
+            case PHASE_ACK: {
+                bool ackHigh = Sim::readPinOutput(LPT_ACKNOWLEDGE_PIN);
+                if (!ackHigh) {
+                    ackSeenLow = true;
+                } else if (ackSeenLow) {
+                    phase = PHASE_READY;
+                    continue;
+                }
+                if (now >= ackDeadline) {
+                    stats.ackTimeouts++;
+                    phase = PHASE_READY;
+                    continue;
+                }
+                eventAt = now + POLL_NS;
+                return;
+            }
+            default:
+                return;
+        }
+    }
+}
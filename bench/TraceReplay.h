@@ -0,0 +1,116 @@
+#ifndef BENCH_TRACEREPLAY_H
+#define BENCH_TRACEREPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SimCore.h"
+
+/**
+ * TraceReplay - The TDS2024 side of the parallel port
+ * Replays a strobe trace onto the simulated data, /Strobe, BUSY and /ACK
+ * lines. Each byte is strobed no earlier than its trace time, and, like a
+ * Centronics host, only when the handshake allows it:
+ *   HOST_ACK   wait for the /ACK pulse of the previous byte, then for BUSY
+ *              low (the compatibility-mode handshake the scope uses)
+ *   HOST_BUSY  wait for BUSY low only, sampled HOST_BUSY_SETTLE_NS after
+ *              /Strobe rises (exposes slow BUSY assertion)
+ *   HOST_BLIND ignore the handshake and follow the trace timing
+ *
+ * Trace files are text, one strobe per line: "<time_us> <byte>", byte in
+ * hex, '#' starts a comment. Times are relative and may be 0 throughout
+ * (send as fast as the handshake allows).
+ */
+class TraceReplay : public Sim::Device {
+public:
+    enum HostMode : uint8_t {
+        HOST_ACK = 0,
+        HOST_BUSY,
+        HOST_BLIND
+    };
+
+    static constexpr uint64_t POLL_NS = 500;            // Host status polling
+    static constexpr uint64_t HOST_BUSY_SETTLE_NS = 500;
+    static constexpr uint64_t ACK_TIMEOUT_NS = 10000000ULL;
+
+    struct Stats {
+        uint64_t strobed;
+        uint64_t firstStrobeNs;
+        uint64_t lastStrobeNs;
+        uint64_t busyWaitNs;        // Host held off by BUSY
+        uint64_t maxBusyWaitNs;
+        uint32_t ackTimeouts;
+    };
+
+private:
+    enum Phase : uint8_t {
+        PHASE_IDLE = 0,
+        PHASE_READY,            // Waiting for trace time and handshake
+        PHASE_STROBE,           // /Strobe low
+        PHASE_ACK,              // Waiting for the /ACK pulse
+        PHASE_DONE
+    };
+
+    uint8_t* data;
+    uint64_t* times;            // ns from the start of the replay
+    size_t count;
+    size_t capacity;
+
+    HostMode mode;
+    uint64_t strobeWidthNs;
+    uint64_t startNs;
+    Phase phase;
+    size_t position;
+    uint64_t eventAt;
+    uint64_t waitStart;         // BUSY wait start, NO_EVENT when not waiting
+    bool ackSeenLow;
+    uint64_t ackDeadline;
+    Stats stats;
+
+    bool append(uint64_t timeNs, uint8_t value);
+    void presentByte(uint64_t now);
+    void endBusyWait(uint64_t now);
+
+public:
+    TraceReplay();
+    ~TraceReplay() override;
+
+    /**
+     * Load a text trace
+     * @param path File name
+     * @return false if the file cannot be read or holds no strobes
+     */
+    bool loadTrace(const char* path);
+
+    /**
+     * Load raw bytes, one strobe every gapUs
+     * @param path File name
+     * @param gapUs Spacing between trace times
+     * @return false if the file cannot be read or is empty
+     */
+    bool loadRaw(const char* path, uint32_t gapUs);
+
+    /**
+     * Generate a TDS2024 style screenshot: a 320x240 8-bit BMP of the
+     * graticule and a sine trace (77878 bytes at full size)
+     * @param size Bytes (the image is cut or repeated to fit)
+     * @param gapUs Spacing between trace times
+     */
+    void generate(size_t size, uint32_t gapUs);
+
+    /**
+     * Start the replay
+     * @param hostMode Handshake the host follows
+     * @param strobeWidthUs /Strobe low time
+     */
+    void start(HostMode hostMode, uint32_t strobeWidthUs);
+
+    bool isFinished() const;
+    const uint8_t* getData() const;
+    size_t getSize() const;
+    const Stats& getStats() const;
+
+    uint64_t nextEvent() const override;
+    void onEvent(uint64_t now) override;
+};
+
+#endif // BENCH_TRACEREPLAY_H
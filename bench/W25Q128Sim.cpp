@@ -0,0 +1,238 @@
+#include "W25Q128Sim.h"
+#include "SimCore.h"
+#include <stdlib.h>
+#include <string.h>
+
+// W25Q128JV datasheet, section 9.6 (tPP, tSE, tBE1, tBE2, tCE)
+const W25Q128Sim::Timing W25Q128Sim::TYPICAL = {
+    700000ULL, 45000000ULL, 120000000ULL, 150000000ULL, 40000000000ULL
+};
+const W25Q128Sim::Timing W25Q128Sim::MAXIMUM = {
+    3000000ULL, 400000000ULL, 1600000000ULL, 2000000000ULL, 200000000000ULL
+};
+
+namespace {
+
+constexpr uint8_t CMD_WRITE_ENABLE = 0x06;
+constexpr uint8_t CMD_WRITE_DISABLE = 0x04;
+constexpr uint8_t CMD_READ_STATUS1 = 0x05;
+constexpr uint8_t CMD_READ_STATUS2 = 0x35;
+constexpr uint8_t CMD_READ_DATA = 0x03;
+constexpr uint8_t CMD_FAST_READ = 0x0B;
+constexpr uint8_t CMD_PAGE_PROGRAM = 0x02;
+constexpr uint8_t CMD_SECTOR_ERASE = 0x20;
+constexpr uint8_t CMD_BLOCK_ERASE_32K = 0x52;
+constexpr uint8_t CMD_BLOCK_ERASE_64K = 0xD8;
+constexpr uint8_t CMD_CHIP_ERASE = 0xC7;
+constexpr uint8_t CMD_CHIP_ERASE_ALT = 0x60;
+constexpr uint8_t CMD_JEDEC_ID = 0x9F;
+constexpr uint8_t CMD_RELEASE_POWER_DOWN = 0xAB;
+constexpr uint8_t CMD_POWER_DOWN = 0xB9;
+
+constexpr uint8_t STATUS_BUSY = 0x01;
+constexpr uint8_t STATUS_WEL = 0x02;
+
+constexpr uint8_t DEVICE_ID = 0x17;
+
+} // namespace
+
+W25Q128Sim::W25Q128Sim(uint8_t chipSelectPin)
+    : memory(static_cast<uint8_t*>(malloc(SIZE))), csPin(chipSelectPin), timing(TYPICAL),
+      stats(), active(false), opcode(0), index(0), address(0), writeEnabled(false),
+      poweredDown(false), busyUntil(0), pageBase(0), pageCount(0) {
+    // Shipped erased
+    memset(memory, 0xFF, SIZE);
+    memset(pageData, 0xFF, sizeof(pageData));
+}
+
+W25Q128Sim::~W25Q128Sim() {
+    free(memory);
+}
+
+bool W25Q128Sim::isSelected() const {
+    return !Sim::readPinOutput(csPin);
+}
+
+bool W25Q128Sim::isBusy() const {
+    return Sim::now() < busyUntil;
+}
+
+bool W25Q128Sim::isIdle() const {
+    return !isBusy();
+}
+
+uint8_t W25Q128Sim::readStatus() const {
+    return (isBusy() ? STATUS_BUSY : 0) | (writeEnabled ? STATUS_WEL : 0);
+}
+
+void W25Q128Sim::setWorstCase(bool worstCase) {
+    timing = worstCase ? MAXIMUM : TYPICAL;
+}
+
+const W25Q128Sim::Stats& W25Q128Sim::getStats() const {
+    return stats;
+}
+
+void W25Q128Sim::startBusy(uint64_t duration) {
+    busyUntil = Sim::now() + duration;
+    stats.busyNs += duration;
+    writeEnabled = false;
+}
+
+void W25Q128Sim::erase(uint32_t start, uint32_t length, uint64_t duration) {
+    if (!writeEnabled) {
+        stats.withoutWriteEnable++;
+        return;
+    }
+    memset(memory + (start & (SIZE - 1) & ~(length - 1)), 0xFF, length);
+    startBusy(duration);
+}
+
+void W25Q128Sim::finishCommand() {
+    if (!active) {
+        return;
+    }
+    active = false;
+
+    // Instructions that act on /CS rising
+    switch (opcode) {
+        case CMD_WRITE_ENABLE:
+            writeEnabled = true;
+            break;
+        case CMD_WRITE_DISABLE:
+            writeEnabled = false;
+            break;
+        case CMD_PAGE_PROGRAM:
+            if (index < 4 || pageCount == 0) {
+                break;
+            }
+            if (!writeEnabled) {
+                stats.withoutWriteEnable++;
+                break;
+            }
+            for (uint32_t i = 0; i < pageCount && i < PAGE_SIZE; i++) {
+                uint32_t offset = (address + i) % PAGE_SIZE;
+                uint8_t& cell = memory[pageBase + offset];
+                uint8_t value = pageData[offset];
+                if (value & ~cell) {
+                    stats.dirtyPrograms++;
+                }
+                cell &= value;
+            }
+            stats.pagePrograms++;
+            stats.bytesProgrammed += pageCount < PAGE_SIZE ? pageCount : PAGE_SIZE;
+            startBusy(timing.pageProgram);
+            break;
+        case CMD_SECTOR_ERASE:
+            if (index >= 4) {
+                stats.sectorErases++;
+                erase(address, 4096, timing.sectorErase);
+            }
+            break;
+        case CMD_BLOCK_ERASE_32K:
+            if (index >= 4) {
+                stats.blockErases++;
+                erase(address, 32768, timing.blockErase32);
+            }
+            break;
+        case CMD_BLOCK_ERASE_64K:
+            if (index >= 4) {
+                stats.blockErases++;
+                erase(address, 65536, timing.blockErase64);
+            }
+            break;
+        case CMD_CHIP_ERASE:
+        case CMD_CHIP_ERASE_ALT:
+            stats.chipErases++;
+            erase(0, SIZE, timing.chipErase);
+            break;
+        case CMD_POWER_DOWN:
+            poweredDown = true;
+            break;
+        case CMD_RELEASE_POWER_DOWN:
+            poweredDown = false;
+            break;
+        default:
+            break;
+    }
+}
+
+void W25Q128Sim::endTransaction() {
+    if (!isSelected()) {
+        finishCommand();
+    }
+}
+
+uint8_t W25Q128Sim::exchange(uint8_t mosi) {
+    if (!isSelected()) {
+        // /CS went high without an endTransaction() in between
+        finishCommand();
+        return 0xFF;
+    }
+
+    if (!active) {
+        active = true;
+        opcode = mosi;
+        index = 0;
+        address = 0;
+        pageCount = 0;
+
+        // Only status reads (and wake-up) are accepted while busy
+        if ((isBusy() && opcode != CMD_READ_STATUS1 && opcode != CMD_READ_STATUS2) ||
+            (poweredDown && opcode != CMD_RELEASE_POWER_DOWN)) {
+            if (isBusy()) {
+                stats.ignoredWhileBusy++;
+            }
+            opcode = 0;
+        }
+        return 0xFF;
+    }
+
+    index++;
+    switch (opcode) {
+        case CMD_READ_STATUS1:
+            return readStatus();
+        case CMD_READ_STATUS2:
+            return 0x00;
+        case CMD_JEDEC_ID:
+            return index <= 3 ? (uint8_t)(JEDEC_ID >> (8 * (3 - index))) : 0xFF;
+        case CMD_RELEASE_POWER_DOWN:
+            return index >= 4 ? DEVICE_ID : 0xFF;
+        case CMD_READ_DATA:
+        case CMD_FAST_READ: {
+            if (index <= 3) {
+                address = (address << 8) | mosi;
+                return 0xFF;
+            }
+            uint32_t first = opcode == CMD_FAST_READ ? 5 : 4;
+            if (index < first) {
+                return 0xFF;
+            }
+            stats.bytesRead++;
+            return memory[(address + (index - first)) & (SIZE - 1)];
+        }
+        case CMD_PAGE_PROGRAM:
+            if (index <= 3) {
+                address = (address << 8) | mosi;
+                if (index == 3) {
+                    address &= SIZE - 1;
+                    pageBase = address & ~(PAGE_SIZE - 1);
+                    memset(pageData, 0xFF, sizeof(pageData));
+                }
+                return 0xFF;
+            }
+            // Bytes past the page end wrap to its start
+            pageData[(address + pageCount) % PAGE_SIZE] &= mosi;
+            pageCount++;
+            return 0xFF;
+        case CMD_SECTOR_ERASE:
+        case CMD_BLOCK_ERASE_32K:
+        case CMD_BLOCK_ERASE_64K:
+            if (index <= 3) {
+                address = ((address << 8) | mosi) & (SIZE - 1);
+            }
+            return 0xFF;
+        default:
+            return 0xFF;
+    }
+}
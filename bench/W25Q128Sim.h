@@ -0,0 +1,96 @@
+#ifndef BENCH_W25Q128SIM_H
+#define BENCH_W25Q128SIM_H
+
+#include <stdint.h>
+#include "SimBoard.h"
+
+/**
+ * W25Q128Sim - Winbond W25Q128 (16MB SPI NOR flash) on the simulated bus
+ * Models the command set the EEPROM plugin uses (and a little more) with
+ * the datasheet program/erase times: BUSY stays set in status register 1
+ * for tPP after a page program and for tSE/tBE/tCE after an erase, and
+ * commands other than status reads are ignored while it is set, exactly
+ * as on the chip. Programming can only clear bits; programs over cells
+ * that were not erased are counted, as are commands sent while busy.
+ */
+class W25Q128Sim : public Sim::SpiDevice {
+public:
+    static constexpr uint32_t SIZE = 16UL * 1024 * 1024;
+    static constexpr uint32_t PAGE_SIZE = 256;
+    static constexpr uint32_t JEDEC_ID = 0xEF4018;
+
+    // Datasheet AC characteristics (ns), typical and maximum
+    struct Timing {
+        uint64_t pageProgram;
+        uint64_t sectorErase;       // 4KB
+        uint64_t blockErase32;
+        uint64_t blockErase64;
+        uint64_t chipErase;
+    };
+    static const Timing TYPICAL;
+    static const Timing MAXIMUM;
+
+    struct Stats {
+        uint32_t pagePrograms;
+        uint64_t bytesProgrammed;
+        uint32_t sectorErases;
+        uint32_t blockErases;
+        uint32_t chipErases;
+        uint64_t bytesRead;
+        uint64_t busyNs;            // Total program/erase time
+        uint32_t ignoredWhileBusy;  // Commands the chip dropped
+        uint32_t withoutWriteEnable;
+        uint32_t dirtyPrograms;     // Programs over cells not erased
+    };
+
+private:
+    uint8_t* memory;
+    uint8_t csPin;
+    Timing timing;
+    Stats stats;
+
+    bool active;                // Chip select low, opcode received
+    uint8_t opcode;
+    uint32_t index;             // Bytes after the opcode
+    uint32_t address;
+    bool writeEnabled;
+    bool poweredDown;
+    uint64_t busyUntil;
+
+    // Page program data, applied when chip select rises
+    uint8_t pageData[PAGE_SIZE];
+    uint32_t pageBase;
+    uint32_t pageCount;
+
+    bool isSelected() const;
+    bool isBusy() const;
+    uint8_t readStatus() const;
+    void startBusy(uint64_t duration);
+    void finishCommand();
+    void erase(uint32_t start, uint32_t length, uint64_t duration);
+
+public:
+    /**
+     * @param chipSelectPin Arduino pin of /CS
+     */
+    explicit W25Q128Sim(uint8_t chipSelectPin);
+    ~W25Q128Sim() override;
+
+    uint8_t exchange(uint8_t mosi) override;
+    void endTransaction() override;
+
+    /**
+     * Use typical or maximum program/erase times
+     * @param worstCase true for the datasheet maximums
+     */
+    void setWorstCase(bool worstCase);
+
+    /**
+     * Check if a program or erase is still running
+     */
+    bool isIdle() const;
+
+    const Stats& getStats() const;
+};
+
+#endif // BENCH_W25Q128SIM_H
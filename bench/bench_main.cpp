@@ -0,0 +1,374 @@
+/**
+ * Trace-replay throughput benchmark
+ * Boots the unmodified firmware (setup()/loop() from src/main.cpp) on the
+ * simulated Mega, replays a TDS2024 strobe trace into the parallel port and
+ * runs until the capture has been written to the simulated W25Q128 and the
+ * file closed. Reports sustained capture rate, overflows and drops, and the
+ * worst time a byte waited in the ring, as JSON for tools/bench_compare.py.
+ *
+ * Usage: bench [--trace FILE | --raw FILE | --synthetic BYTES] [--gap-us N]
+ *              [--host ack|busy|blind] [--strobe-us N] [--flash typical|max]
+ *              [--max-seconds N] [--label NAME] [--json FILE] [--verbose]
+ *              [--no-verify]
+ */
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HardwareConfig.h"
+#include "ServiceLocator.h"
+#include "ParallelPortManager.h"
+#include "FileSystemManager.h"
+#include "Scheduler.h"
+
+#include "SimCore.h"
+#include "SimBoard.h"
+#include "TraceReplay.h"
+#include "W25Q128Sim.h"
+
+// src/main.cpp
+void setup();
+void loop();
+bool isSystemQuiet();
+
+namespace {
+
+struct Options {
+    const char* tracePath = nullptr;
+    const char* rawPath = nullptr;
+    size_t syntheticBytes = 77878;
+    uint32_t gapUs = 0;
+    TraceReplay::HostMode host = TraceReplay::HOST_ACK;
+    uint32_t strobeUs = 1;
+    bool worstCaseFlash = false;
+    uint32_t maxSeconds = 300;
+    const char* label = "default";
+    const char* jsonPath = nullptr;
+    bool verbose = false;
+    bool verify = true;
+};
+
+// Ring residence: time each accepted byte entered, in acceptance order
+struct RingProbe {
+    uint64_t* entered = nullptr;
+    size_t capacity = 0;
+    uint64_t pushed = 0;
+    uint64_t popped = 0;
+    uint32_t lastReceived = 0;
+    uint64_t maxLatencyNs = 0;
+    uint64_t totalLatencyNs = 0;
+    size_t maxOccupancy = 0;
+};
+
+RingProbe probe;
+
+/**
+ * Sim observer: runs after every interrupt and every cost step
+ */
+void observeRing() {
+    ParallelPortManager* port = ServiceLocator::getParallelPortManager();
+    uint32_t received = port->getTotalBytesReceived();
+    size_t available = port->getAvailableBytes();
+    uint64_t now = Sim::now();
+
+    while (probe.lastReceived != received) {
+        probe.entered[probe.pushed % probe.capacity] = now;
+        probe.pushed++;
+        probe.lastReceived++;
+    }
+    if (available > probe.maxOccupancy) {
+        probe.maxOccupancy = available;
+    }
+
+    // Inside the strobe ISR (16-bit ring indices restore SREG) head can
+    // move before the byte is counted; the next observation catches up
+    if (available > probe.pushed) {
+        return;
+    }
+    uint64_t consumed = probe.pushed - available;
+    while (probe.popped < consumed) {
+        uint64_t latency = now - probe.entered[probe.popped % probe.capacity];
+        probe.totalLatencyNs += latency;
+        if (latency > probe.maxLatencyNs) {
+            probe.maxLatencyNs = latency;
+        }
+        probe.popped++;
+    }
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: bench [--trace FILE | --raw FILE | --synthetic BYTES] [--gap-us N]\n"
+            "             [--host ack|busy|blind] [--strobe-us N] [--flash typical|max]\n"
+            "             [--max-seconds N] [--label NAME] [--json FILE] [--verbose]\n"
+            "             [--no-verify]\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool takesValue = true;
+
+        if (strcmp(arg, "--trace") == 0 && value) {
+            options.tracePath = value;
+        } else if (strcmp(arg, "--raw") == 0 && value) {
+            options.rawPath = value;
+        } else if (strcmp(arg, "--synthetic") == 0 && value) {
+            options.syntheticBytes = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--gap-us") == 0 && value) {
+            options.gapUs = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--host") == 0 && value) {
+            if (strcmp(value, "ack") == 0) {
+                options.host = TraceReplay::HOST_ACK;
+            } else if (strcmp(value, "busy") == 0) {
+                options.host = TraceReplay::HOST_BUSY;
+            } else if (strcmp(value, "blind") == 0) {
+                options.host = TraceReplay::HOST_BLIND;
+            } else {
+                return false;
+            }
+        } else if (strcmp(arg, "--strobe-us") == 0 && value) {
+            options.strobeUs = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--flash") == 0 && value) {
+            options.worstCaseFlash = strcmp(value, "max") == 0;
+        } else if (strcmp(arg, "--max-seconds") == 0 && value) {
+            options.maxSeconds = strtoul(value, nullptr, 0);
+        } else if (strcmp(arg, "--label") == 0 && value) {
+            options.label = value;
+        } else if (strcmp(arg, "--json") == 0 && value) {
+            options.jsonPath = value;
+        } else if (strcmp(arg, "--verbose") == 0) {
+            options.verbose = true;
+            takesValue = false;
+        } else if (strcmp(arg, "--no-verify") == 0) {
+            options.verify = false;
+            takesValue = false;
+        } else {
+            return false;
+        }
+        if (takesValue) {
+            i++;
+        }
+    }
+    return true;
+}
+
+const char* hostName(TraceReplay::HostMode host) {
+    switch (host) {
+        case TraceReplay::HOST_BUSY:    return "busy";
+        case TraceReplay::HOST_BLIND:   return "blind";
+        default:                        return "ack";
+    }
+}
+
+/**
+ * Read every stored file back in directory order and compare the
+ * concatenation with what was strobed
+ * @return "match", "mismatch" or "no-files"
+ */
+const char* verifyCapture(const TraceReplay& trace, size_t& storedBytes, long& firstDifference) {
+    FileSystemManager* fileSystem = ServiceLocator::getFileSystemManager();
+    size_t capacity = trace.getSize() + 4096;
+    uint8_t* stored = static_cast<uint8_t*>(malloc(capacity));
+    storedBytes = 0;
+    firstDifference = -1;
+
+    char names[16][MAX_FILENAME_LENGTH];
+    size_t files = fileSystem->listFiles(names, 16, 0);
+    for (size_t i = 0; i < files && storedBytes < capacity; i++) {
+        storedBytes += fileSystem->readFile(names[i], stored + storedBytes, capacity - storedBytes);
+    }
+
+    const uint8_t* sent = trace.getData();
+    size_t common = storedBytes < trace.getSize() ? storedBytes : trace.getSize();
+    for (size_t i = 0; i < common; i++) {
+        if (stored[i] != sent[i]) {
+            firstDifference = (long)i;
+            break;
+        }
+    }
+    if (firstDifference < 0 && storedBytes != trace.getSize()) {
+        firstDifference = (long)common;
+    }
+    free(stored);
+
+    if (files == 0) {
+        return "no-files";
+    }
+    return firstDifference < 0 ? "match" : "mismatch";
+}
+
+double toMs(uint64_t ns) {
+    return ns / 1e6;
+}
+
+double toUs(uint64_t ns) {
+    return ns / 1e3;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    W25Q128Sim flash(EEPROM_CS_PIN);
+    flash.setWorstCase(options.worstCaseFlash);
+    Sim::setSpiDevice(&flash);
+    Sim::setSerialEcho(options.verbose);
+
+    TraceReplay trace;
+    const char* source = "synthetic";
+    bool loaded;
+    if (options.tracePath) {
+        source = options.tracePath;
+        loaded = trace.loadTrace(options.tracePath);
+    } else if (options.rawPath) {
+        source = options.rawPath;
+        loaded = trace.loadRaw(options.rawPath, options.gapUs);
+    } else {
+        trace.generate(options.syntheticBytes, options.gapUs);
+        loaded = trace.getSize() > 0;
+    }
+    if (!loaded) {
+        fprintf(stderr, "bench: no strobes in %s\n", source);
+        return 2;
+    }
+
+    probe.capacity = RING_BUFFER_SIZE + 64;
+    probe.entered = static_cast<uint64_t*>(calloc(probe.capacity, sizeof(uint64_t)));
+
+    // Boot as after power-up (the Arduino core enables interrupts in init())
+    Sim::setInterruptsEnabled(true);
+    setup();
+    uint64_t bootNs = Sim::now();
+
+    ParallelPortManager* port = ServiceLocator::getParallelPortManager();
+    FileSystemManager* fileSystem = ServiceLocator::getFileSystemManager();
+    probe.lastReceived = port->getTotalBytesReceived();
+    Sim::setObserver(observeRing);
+    trace.start(options.host, options.strobeUs);
+
+    uint64_t limitNs = Sim::now() + (uint64_t)options.maxSeconds * 1000000000ULL;
+    uint64_t loops = 0;
+    bool completed = false;
+    while (Sim::now() < limitNs) {
+        loop();
+        Sim::advance(Sim::Cost::LOOP_PASS);
+        loops++;
+
+        if (trace.isFinished() && port->getAvailableBytes() == 0 &&
+            !fileSystem->isWriteOpen() && flash.isIdle() && isSystemQuiet()) {
+            completed = true;
+            break;
+        }
+    }
+    uint64_t endNs = Sim::now();
+    Sim::setObserver(nullptr);
+
+    // Results before the read-back adds its own SPI traffic
+    const TraceReplay::Stats& host = trace.getStats();
+    const W25Q128Sim::Stats flashStats = flash.getStats();
+    const Sim::VectorStats& strobeIsr = Sim::getVectorStats((Sim::Vector)LPT_STROBE_INTERRUPT);
+    uint64_t window = host.lastStrobeNs - host.firstStrobeNs;
+    uint32_t captured = port->getTotalBytesReceived();
+    double rate = window ? captured * 1e9 / window : 0.0;
+    uint64_t runNs = endNs - bootNs;
+    double sleepPct = runNs ? 100.0 * Sim::getSleepNs() / runNs : 0.0;
+    double meanLatencyUs = probe.popped ? toUs(probe.totalLatencyNs) / probe.popped : 0.0;
+
+    const char* integrity = "skipped";
+    size_t storedBytes = 0;
+    long firstDifference = -1;
+    if (options.verify && completed) {
+        integrity = verifyCapture(trace, storedBytes, firstDifference);
+    }
+
+    FILE* out = stdout;
+    if (options.jsonPath) {
+        out = fopen(options.jsonPath, "w");
+        if (!out) {
+            fprintf(stderr, "bench: cannot write %s\n", options.jsonPath);
+            return 2;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"label\": \"%s\",\n", options.label);
+    fprintf(out, "  \"config\": {\n");
+    fprintf(out, "    \"RING_BUFFER_SIZE\": %ld,\n", (long)RING_BUFFER_SIZE);
+    fprintf(out, "    \"LPT_FLOW_CONTROL\": %d,\n", LPT_FLOW_CONTROL);
+    fprintf(out, "    \"LPT_FLOW_HIGH_WATERMARK\": %ld,\n", (long)LPT_FLOW_HIGH_WATERMARK);
+    fprintf(out, "    \"LPT_FLOW_LOW_WATERMARK\": %ld,\n", (long)LPT_FLOW_LOW_WATERMARK);
+    fprintf(out, "    \"LPT_TIMER_HANDSHAKE\": %d,\n", LPT_TIMER_HANDSHAKE);
+    fprintf(out, "    \"LPT_DIRECT_PORT_IO\": %d,\n", LPT_DIRECT_PORT_IO);
+    fprintf(out, "    \"SCHEDULER_DRAIN_THRESHOLD\": %ld,\n", (long)SCHEDULER_DRAIN_THRESHOLD);
+    fprintf(out, "    \"SCHEDULER_DISPLAY_MS\": %d,\n", SCHEDULER_DISPLAY_MS);
+    fprintf(out, "    \"SCHEDULER_LED_MS\": %d,\n", SCHEDULER_LED_MS);
+    fprintf(out, "    \"SCHEDULER_STORAGE_MS\": %d,\n", SCHEDULER_STORAGE_MS);
+    fprintf(out, "    \"SCHEDULER_IDLE_MS\": %d,\n", SCHEDULER_IDLE_MS);
+    fprintf(out, "    \"LCD_BUS_OPS_PER_UPDATE\": %d,\n", LCD_BUS_OPS_PER_UPDATE);
+    fprintf(out, "    \"IDLE_SLEEP\": %d,\n", IDLE_SLEEP);
+    fprintf(out, "    \"EEPROM_SPI_BURST\": %d,\n", EEPROM_SPI_BURST);
+    fprintf(out, "    \"CAPTURE_BLOCK_SIZE\": %ld,\n", (long)CAPTURE_BLOCK_SIZE);
+    fprintf(out, "    \"CAPTURE_COMPRESSION\": %d,\n", CAPTURE_COMPRESSION);
+    fprintf(out, "    \"CAPTURE_SPILL\": %d\n", CAPTURE_SPILL);
+    fprintf(out, "  },\n");
+    fprintf(out, "  \"trace\": {\n");
+    fprintf(out, "    \"source\": \"%s\",\n", source);
+    fprintf(out, "    \"bytes\": %zu,\n", trace.getSize());
+    fprintf(out, "    \"host\": \"%s\",\n", hostName(options.host));
+    fprintf(out, "    \"strobe_us\": %u,\n", options.strobeUs);
+    fprintf(out, "    \"flash_timing\": \"%s\"\n", options.worstCaseFlash ? "max" : "typical");
+    fprintf(out, "  },\n");
+    fprintf(out, "  \"results\": {\n");
+    fprintf(out, "    \"completed\": %s,\n", completed ? "true" : "false");
+    fprintf(out, "    \"bytes_strobed\": %llu,\n", (unsigned long long)host.strobed);
+    fprintf(out, "    \"bytes_captured\": %lu,\n", (unsigned long)captured);
+    fprintf(out, "    \"bytes_dropped\": %lu,\n", (unsigned long)port->getDroppedBytes());
+    fprintf(out, "    \"overflows\": %lu,\n", (unsigned long)port->getOverflowCount());
+    fprintf(out, "    \"lost_strobes\": %lu,\n", (unsigned long)strobeIsr.merged);
+    fprintf(out, "    \"capture_window_ms\": %.3f,\n", toMs(window));
+    fprintf(out, "    \"sustained_bytes_per_s\": %.1f,\n", rate);
+    fprintf(out, "    \"job_close_ms\": %.3f,\n", completed ? toMs(endNs - host.lastStrobeNs) : 0.0);
+    fprintf(out, "    \"drain_latency_max_us\": %.1f,\n", toUs(probe.maxLatencyNs));
+    fprintf(out, "    \"drain_latency_mean_us\": %.1f,\n", meanLatencyUs);
+    fprintf(out, "    \"ring_max_occupancy\": %zu,\n", probe.maxOccupancy);
+    fprintf(out, "    \"busy_stalls\": %lu,\n", (unsigned long)port->getStallCount());
+    fprintf(out, "    \"busy_stall_max_ms\": %lu,\n", (unsigned long)port->getMaxStallTime());
+    fprintf(out, "    \"host_busy_wait_ms\": %.3f,\n", toMs(host.busyWaitNs));
+    fprintf(out, "    \"host_busy_wait_max_us\": %.1f,\n", toUs(host.maxBusyWaitNs));
+    fprintf(out, "    \"host_ack_timeouts\": %lu,\n", (unsigned long)host.ackTimeouts);
+    fprintf(out, "    \"strobe_isr_latency_max_us\": %.2f,\n", toUs(strobeIsr.maxLatencyNs));
+    fprintf(out, "    \"scheduler_max_urgent_gap_us\": %u,\n", (unsigned)Scheduler::getMaxUrgentGap());
+    fprintf(out, "    \"loops\": %llu,\n", (unsigned long long)loops);
+    fprintf(out, "    \"cpu_sleep_pct\": %.1f,\n", sleepPct);
+    fprintf(out, "    \"serial_bytes\": %llu,\n", (unsigned long long)Sim::getSerialBytes());
+    fprintf(out, "    \"flash\": {\n");
+    fprintf(out, "      \"page_programs\": %lu,\n", (unsigned long)flashStats.pagePrograms);
+    fprintf(out, "      \"bytes_programmed\": %llu,\n", (unsigned long long)flashStats.bytesProgrammed);
+    fprintf(out, "      \"sector_erases\": %lu,\n", (unsigned long)flashStats.sectorErases);
+    fprintf(out, "      \"block_erases\": %lu,\n", (unsigned long)flashStats.blockErases);
+    fprintf(out, "      \"chip_erases\": %lu,\n", (unsigned long)flashStats.chipErases);
+    fprintf(out, "      \"busy_ms\": %.3f,\n", toMs(flashStats.busyNs));
+    fprintf(out, "      \"ignored_while_busy\": %lu,\n", (unsigned long)flashStats.ignoredWhileBusy);
+    fprintf(out, "      \"without_write_enable\": %lu,\n", (unsigned long)flashStats.withoutWriteEnable);
+    fprintf(out, "      \"dirty_programs\": %lu\n", (unsigned long)flashStats.dirtyPrograms);
+    fprintf(out, "    },\n");
+    fprintf(out, "    \"integrity\": \"%s\",\n", integrity);
+    fprintf(out, "    \"stored_bytes\": %zu,\n", storedBytes);
+    fprintf(out, "    \"first_difference\": %ld\n", firstDifference);
+    fprintf(out, "  }\n");
+    fprintf(out, "}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(probe.entered);
+    return completed ? 0 : 1;
+}
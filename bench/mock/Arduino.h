@@ -0,0 +1,151 @@
+#ifndef BENCH_ARDUINO_H
+#define BENCH_ARDUINO_H
+
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avr/io.h"
+#include "avr/interrupt.h"
+#include "avr/pgmspace.h"
+
+/**
+ * Arduino core for the host benchmark (SimArduino.cpp)
+ * Timing calls read and advance the simulated clock; pins are the port
+ * registers in avr/io.h, so digitalWrite() and LptPinMap.h agree.
+ */
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define CHANGE          1
+#define FALLING         2
+#define RISING          3
+
+#define DEC             10
+#define HEX             16
+#define OCT             8
+#define BIN             2
+
+#define SERIAL_8N1      0x06
+
+#define F_CPU           16000000L
+
+// Mega 2560 analog pins
+#define A0  54
+#define A1  55
+#define A2  56
+#define A3  57
+#define A4  58
+#define A5  59
+#define A6  60
+#define A7  61
+#define A8  62
+#define A9  63
+#define A10 64
+#define A11 65
+#define A12 66
+#define A13 67
+#define A14 68
+#define A15 69
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define bit(b) (1UL << (b))
+
+// Arduino interrupt numbers on the Mega: 0-1 on pins 2-3, 2-5 on pins 21-18
+#define NOT_AN_INTERRUPT    -1
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : (p) == 3 ? 1 : \
+                                  ((p) >= 18 && (p) <= 21) ? 23 - (p) : NOT_AN_INTERRUPT)
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+void attachInterrupt(uint8_t interruptNumber, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interruptNumber);
+void noInterrupts();
+void interrupts();
+
+class Print {
+private:
+    size_t printNumber(unsigned long value, int base);
+    size_t printSigned(long value, int base);
+
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* text) { return text ? write((const uint8_t*)text, strlen(text)) : 0; }
+    virtual int availableForWrite() { return 0; }
+
+    size_t print(const __FlashStringHelper* text);
+    size_t print(const char* text);
+    size_t print(char value);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    size_t println(const __FlashStringHelper* text);
+    size_t println(const char* text);
+    size_t println(char value);
+    size_t println(unsigned char value, int base = DEC);
+    size_t println(int value, int base = DEC);
+    size_t println(unsigned int value, int base = DEC);
+    size_t println(long value, int base = DEC);
+    size_t println(unsigned long value, int base = DEC);
+    size_t println(double value, int digits = 2);
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+/**
+ * UART0 with a transmit buffer that drains at the configured baud rate
+ * write() blocks (in simulated time) while the buffer is full, as the AVR
+ * core does; nothing is ever received.
+ */
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud, uint8_t config = SERIAL_8N1);
+    void end();
+    int available() override;
+    int read() override;
+    int peek() override;
+    int availableForWrite() override;
+    void flush();
+    size_t write(uint8_t value) override;
+    using Print::write;
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // BENCH_ARDUINO_H
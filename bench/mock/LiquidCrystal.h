@@ -0,0 +1,26 @@
+#ifndef BENCH_LIQUIDCRYSTAL_H
+#define BENCH_LIQUIDCRYSTAL_H
+
+#include <Arduino.h>
+
+/**
+ * HD44780 in 4-bit mode for the host benchmark
+ * Nothing is displayed; each call costs what the LiquidCrystal library
+ * spends on the bus (about 100us per character or cursor move, 2ms for
+ * clear and home).
+ */
+class LiquidCrystal : public Print {
+public:
+    LiquidCrystal(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7);
+    void begin(uint8_t cols, uint8_t rows);
+    void clear();
+    void home();
+    void setCursor(uint8_t col, uint8_t row);
+    void createChar(uint8_t location, uint8_t charmap[]);
+    size_t write(uint8_t value) override;
+    using Print::write;
+    void noDisplay();
+    void display();
+};
+
+#endif // BENCH_LIQUIDCRYSTAL_H
@@ -0,0 +1,50 @@
+#ifndef BENCH_SD_H
+#define BENCH_SD_H
+
+#include <Arduino.h>
+
+/**
+ * SD library for the host benchmark: there is never a card
+ * begin() fails and open() returns a closed File, so captures go to the
+ * simulated W25Q128.
+ */
+
+#define FILE_READ   0x01
+#define FILE_WRITE  0x13
+
+class File : public Stream {
+public:
+    File() {}
+    size_t write(uint8_t value) override { (void)value; return 0; }
+    size_t write(const uint8_t* buffer, size_t size) override { (void)buffer; (void)size; return 0; }
+    using Print::write;
+    int read() override { return -1; }
+    int read(void* buffer, uint16_t size) { (void)buffer; (void)size; return -1; }
+    int peek() override { return -1; }
+    int available() override { return 0; }
+    void flush() {}
+    bool seek(uint32_t position) { (void)position; return false; }
+    uint32_t position() { return 0; }
+    uint32_t size() { return 0; }
+    void close() {}
+    operator bool() { return false; }
+    char* name() { return nullptr; }
+    bool isDirectory() { return false; }
+    File openNextFile(uint8_t mode = FILE_READ) { (void)mode; return File(); }
+    void rewindDirectory() {}
+};
+
+class SDClass {
+public:
+    bool begin(uint8_t csPin = 10) { (void)csPin; return false; }
+    void end() {}
+    File open(const char* path, uint8_t mode = FILE_READ) { (void)path; (void)mode; return File(); }
+    bool exists(const char* path) { (void)path; return false; }
+    bool mkdir(const char* path) { (void)path; return false; }
+    bool remove(const char* path) { (void)path; return false; }
+    bool rmdir(const char* path) { (void)path; return false; }
+};
+
+extern SDClass SD;
+
+#endif // BENCH_SD_H
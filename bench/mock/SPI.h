@@ -0,0 +1,53 @@
+#ifndef BENCH_SPI_H
+#define BENCH_SPI_H
+
+#include <Arduino.h>
+
+/**
+ * SPI master for the host benchmark
+ * Bytes go to the simulated W25Q128 while its chip select is low; every
+ * byte costs 8 bit times at the clock of the current transaction.
+ */
+
+#define SPI_MODE0       0x00
+#define SPI_MODE1       0x04
+#define SPI_MODE2       0x08
+#define SPI_MODE3       0x0C
+#define MSBFIRST        1
+#define LSBFIRST        0
+
+#define SPI_CLOCK_DIV2      0x04
+#define SPI_CLOCK_DIV4      0x00
+#define SPI_CLOCK_DIV8      0x05
+#define SPI_CLOCK_DIV16     0x01
+#define SPI_CLOCK_DIV32     0x06
+#define SPI_CLOCK_DIV64     0x02
+#define SPI_CLOCK_DIV128    0x03
+
+class SPISettings {
+public:
+    uint32_t clock;
+
+    SPISettings() : clock(4000000) {}
+    SPISettings(uint32_t clockHz, uint8_t bitOrder, uint8_t dataMode) : clock(clockHz) {
+        (void)bitOrder;
+        (void)dataMode;
+    }
+};
+
+class SPIClass {
+public:
+    static void begin();
+    static void end();
+    static void beginTransaction(SPISettings settings);
+    static void endTransaction();
+    static uint8_t transfer(uint8_t data);
+    static void transfer(void* buffer, size_t count);
+    static void setClockDivider(uint8_t divider);
+    static void setDataMode(uint8_t mode) { (void)mode; }
+    static void setBitOrder(uint8_t order) { (void)order; }
+};
+
+extern SPIClass SPI;
+
+#endif // BENCH_SPI_H
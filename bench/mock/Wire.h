@@ -0,0 +1,26 @@
+#ifndef BENCH_WIRE_H
+#define BENCH_WIRE_H
+
+#include <Arduino.h>
+
+/**
+ * I2C master for the host benchmark: no device answers (no RTC), and each
+ * transaction costs its bytes at 100kHz
+ */
+class TwoWire : public Stream {
+public:
+    void begin();
+    void setClock(uint32_t clockHz) { (void)clockHz; }
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    size_t write(uint8_t value) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
+
+extern TwoWire Wire;
+
+#endif // BENCH_WIRE_H
@@ -0,0 +1,15 @@
+#ifndef BENCH_AVR_EEPROM_H
+#define BENCH_AVR_EEPROM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 4KB internal EEPROM, erased at start; writes take 3.4ms per changed byte
+void eeprom_read_block(void* dst, const void* src, size_t size);
+void eeprom_update_block(const void* src, void* dst, size_t size);
+void eeprom_write_block(const void* src, void* dst, size_t size);
+uint8_t eeprom_read_byte(const uint8_t* address);
+void eeprom_update_byte(uint8_t* address, uint8_t value);
+#define EEMEM
+
+#endif // BENCH_AVR_EEPROM_H
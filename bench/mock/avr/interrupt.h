@@ -0,0 +1,18 @@
+#ifndef BENCH_AVR_INTERRUPT_H
+#define BENCH_AVR_INTERRUPT_H
+
+#include "avr/io.h"
+
+namespace Sim {
+void setInterruptsEnabled(bool enabled);
+}
+
+#define cli()   Sim::setInterruptsEnabled(false)
+#define sei()   Sim::setInterruptsEnabled(true)
+
+// Vectors are plain C functions the simulator calls by name
+#define ISR(vector, ...) extern "C" void vector(void); extern "C" void vector(void)
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+
+#endif // BENCH_AVR_INTERRUPT_H
@@ -0,0 +1,152 @@
+#ifndef BENCH_AVR_IO_H
+#define BENCH_AVR_IO_H
+
+#include <stdint.h>
+
+/**
+ * ATmega2560 registers for the host benchmark
+ * GPIO and configuration registers are plain bytes the firmware and the
+ * simulator share. Registers whose value depends on time or that start a
+ * transfer when written (SREG, the Timer1/Timer3 counters, interrupt flag
+ * registers, SPDR/SPSR) are small classes backed by SimCore.cpp.
+ */
+
+#define _BV(b) (1u << (b))
+
+// General purpose I/O
+extern volatile uint8_t PINA, PINB, PINC, PIND, PINE, PINF, PING, PINH, PINJ, PINK, PINL;
+extern volatile uint8_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF, PORTG, PORTH, PORTJ, PORTK, PORTL;
+extern volatile uint8_t DDRA, DDRB, DDRC, DDRD, DDRE, DDRF, DDRG, DDRH, DDRJ, DDRK, DDRL;
+
+// Plain configuration registers
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1;
+extern volatile uint8_t TCCR3A, TCCR3B, TCCR3C, TIMSK3;
+extern volatile uint16_t OCR1A, OCR1B, OCR3A, OCR3B;
+extern volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR0;
+extern volatile uint16_t ADC;
+extern volatile uint8_t XMCRA, XMCRB, SMCR, MCUSR, EIMSK, SPCR;
+
+/**
+ * Status register: bit 7 is the global interrupt enable
+ * Setting it runs any interrupt that became due while it was clear.
+ */
+class SimStatusRegister {
+public:
+    operator uint8_t() const;
+    SimStatusRegister& operator=(uint8_t value);
+};
+
+/**
+ * 16-bit timer counter running at F_CPU/8 from the simulated clock
+ */
+class SimTimerCounter {
+private:
+    uint16_t offset;
+
+public:
+    SimTimerCounter() : offset(0) {}
+    operator uint16_t() const;
+    SimTimerCounter& operator=(uint16_t value);
+};
+
+/**
+ * Interrupt flag register: flags are set by the simulator, and writing a
+ * one clears the flag as on the AVR
+ */
+class SimFlagRegister {
+private:
+    uint8_t flags;
+
+public:
+    SimFlagRegister() : flags(0) {}
+    operator uint8_t() const { return flags; }
+    SimFlagRegister& operator=(uint8_t value) {
+        flags &= (uint8_t)~value;
+        return *this;
+    }
+    void raise(uint8_t mask) { flags |= mask; }
+};
+
+/**
+ * SPI data register: a write clocks one byte out to the selected device
+ */
+class SimSpiData {
+public:
+    operator uint8_t() const;
+    SimSpiData& operator=(uint8_t value);
+};
+
+/**
+ * SPI status register: SPIF reads set once the byte in flight has shifted
+ */
+class SimSpiStatus {
+public:
+    operator uint8_t() const;
+    SimSpiStatus& operator=(uint8_t value);
+    SimSpiStatus& operator|=(uint8_t value);
+    SimSpiStatus& operator&=(uint8_t value);
+};
+
+extern SimStatusRegister SREG;
+extern SimTimerCounter TCNT1, TCNT3;
+extern SimFlagRegister TIFR3;
+extern SimSpiData SPDR;
+extern SimSpiStatus SPSR;
+
+// Timers
+#define CS10    0
+#define CS11    1
+#define CS12    2
+#define CS30    0
+#define CS31    1
+#define CS32    2
+#define WGM12   3
+#define TOIE1   0
+#define OCIE1A  1
+#define OCIE1B  2
+#define TOV1    0
+#define OCF1A   1
+#define OCF1B   2
+#define OCIE3A  1
+#define OCIE3B  2
+#define OCF3A   1
+#define OCF3B   2
+
+// SPI
+#define SPIF    7
+#define WCOL    6
+#define SPI2X   0
+
+// ADC
+#define ADEN    7
+#define ADSC    6
+#define ADATE   5
+#define ADIF    4
+#define ADIE    3
+#define ADPS2   2
+#define ADPS1   1
+#define ADPS0   0
+#define ADTS2   2
+#define ADTS1   1
+#define ADTS0   0
+#define MUX5    3
+#define REFS1   7
+#define REFS0   6
+#define ADLAR   5
+#define ADC0D   0
+
+// External memory interface
+#define SRE     7
+#define SRL0    4
+#define SRW11   3
+#define SRW10   2
+#define SRW01   1
+#define SRW00   0
+#define XMBK    7
+#define XMM0    0
+
+#define RAMSTART    0x200
+#define RAMEND      0x21FF
+#define XRAMEND     0xFFFF
+
+#endif // BENCH_AVR_IO_H
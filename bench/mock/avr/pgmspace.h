@@ -0,0 +1,22 @@
+#ifndef BENCH_AVR_PGMSPACE_H
+#define BENCH_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+// One address space on the host: flash reads are plain reads
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define pgm_read_byte(p)    (*(const uint8_t*)(p))
+#define pgm_read_word(p)    (*(const uint16_t*)(p))
+#define pgm_read_dword(p)   (*(const uint32_t*)(p))
+#define pgm_read_ptr(p)     (*(void* const*)(p))
+#define memcpy_P    memcpy
+#define strlen_P    strlen
+#define strcmp_P    strcmp
+#define strncmp_P   strncmp
+#define strcpy_P    strcpy
+#define strncpy_P   strncpy
+
+#endif // BENCH_AVR_PGMSPACE_H
@@ -0,0 +1,15 @@
+#ifndef BENCH_AVR_SLEEP_H
+#define BENCH_AVR_SLEEP_H
+
+namespace Sim {
+void sleepUntilInterrupt();
+}
+
+#define SLEEP_MODE_IDLE     0
+#define set_sleep_mode(m)   ((void)(m))
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()         Sim::sleepUntilInterrupt()
+#define sleep_mode()        Sim::sleepUntilInterrupt()
+
+#endif // BENCH_AVR_SLEEP_H
@@ -0,0 +1,139 @@
+#ifndef BENCHMARKSTAT_H
+#define BENCHMARKSTAT_H
+
+#ifdef UNIT_TEST
+#include <stdint.h>
+#include <stddef.h>
+#else
+#include <Arduino.h>
+#endif
+
+#include "TimingHistogram.h"
+
+/**
+ * Latency statistics of one benchmark: sample count, min/max/total and a
+ * log2 histogram of the samples
+ * Samples are Timer1 ticks. The histogram counts (ticks >> shift), so a
+ * shift of 10 spreads sector erases (tens of ms) over the same 16 buckets
+ * that hold page programs at shift 0.
+ */
+class BenchmarkStat {
+private:
+    TimingHistogram histogram;
+    uint8_t shift;
+    uint16_t count;
+    uint32_t minTicks;
+    uint32_t maxTicks;
+    uint32_t totalTicks;
+
+public:
+    /**
+     * Constructor - initializes empty statistics
+     * @param histogramShift Right shift applied before binning
+     */
+    explicit BenchmarkStat(uint8_t histogramShift = 0)
+        : histogram(), shift(histogramShift), count(0), minTicks(0xFFFFFFFFUL),
+          maxTicks(0), totalTicks(0) {}
+
+    /**
+     * Record one sample
+     * @param ticks Measured time in Timer1 ticks
+     */
+    void record(uint32_t ticks) {
+        uint32_t scaled = ticks >> shift;
+        if (scaled > 0xFFFF) {
+            histogram.recordOverflow();
+        } else {
+            histogram.record((uint16_t)scaled);
+        }
+
+        if (count != 0xFFFF) {
+            count++;
+        }
+        if (ticks < minTicks) {
+            minTicks = ticks;
+        }
+        if (ticks > maxTicks) {
+            maxTicks = ticks;
+        }
+        totalTicks += ticks;
+    }
+
+    /**
+     * Get number of samples (saturates at 65535)
+     * @return Sample count
+     */
+    uint16_t getCount() const {
+        return count;
+    }
+
+    /**
+     * Get shortest sample
+     * @return Ticks, 0 if empty
+     */
+    uint32_t getMin() const {
+        return count ? minTicks : 0;
+    }
+
+    /**
+     * Get longest sample
+     * @return Ticks
+     */
+    uint32_t getMax() const {
+        return maxTicks;
+    }
+
+    /**
+     * Get sum of all samples
+     * @return Ticks
+     */
+    uint32_t getTotal() const {
+        return totalTicks;
+    }
+
+    /**
+     * Get mean sample
+     * @return Ticks, 0 if empty
+     */
+    uint32_t getAverage() const {
+        return count ? totalTicks / count : 0;
+    }
+
+    /**
+     * Get an upper bound for a percentile from the histogram
+     * @param percent Percentile (1-100)
+     * @return End of the bucket holding it in ticks, at most getMax()
+     */
+    uint32_t getPercentileBound(uint8_t percent) const {
+        uint32_t total = histogram.getTotal();
+        uint32_t wanted = (total * percent + 99) / 100;
+        uint32_t seen = 0;
+
+        for (uint8_t i = 0; i < TIMING_HISTOGRAM_OVERFLOW; i++) {
+            seen += histogram.getCount(i);
+            if (seen >= wanted && seen > 0) {
+                uint32_t bound = (2UL << i) << shift;
+                return bound < maxTicks ? bound : maxTicks;
+            }
+        }
+        return maxTicks;
+    }
+
+    /**
+     * Get the histogram of (ticks >> getShift())
+     * @return Histogram
+     */
+    const TimingHistogram& getHistogram() const {
+        return histogram;
+    }
+
+    /**
+     * Get the histogram scale
+     * @return Right shift applied before binning
+     */
+    uint8_t getShift() const {
+        return shift;
+    }
+};
+
+#endif // BENCHMARKSTAT_H
@@ -0,0 +1,181 @@
+#ifndef CAPTUREBLOCKPIPELINE_H
+#define CAPTUREBLOCKPIPELINE_H
+
+#include <Arduino.h>
+#include "HardwareConfig.h"
+#include "PackBits.h"
+
+/**
+ * CaptureBlockPipeline - Double-buffered block stage in front of storage
+ * Capture data is collected into one CAPTURE_BLOCK_SIZE block while the
+ * other, already full, block is handed to FileSystemManager as a single
+ * append. Storage that defers write completion (SPI flash page program)
+ * is polled through isWriteBusy(), so programming one block overlaps with
+ * filling the next. If both blocks are full the writer has fallen behind
+ * and fill() stops accepting data, leaving it in the capture ring where
+ * BUSY flow control holds the host off.
+ * With compression started, data passes through a PackBitsEncoder on its
+ * way into the fill block and the file begins with the PackBits header.
+ */
+class CaptureBlockPipeline {
+    static_assert(CAPTURE_BLOCK_SIZE > 0 && CAPTURE_BLOCK_SIZE <= 4096,
+                  "CAPTURE_BLOCK_SIZE must be 1..4096 bytes");
+#if CAPTURE_COMPRESSION
+    static_assert(CAPTURE_BLOCK_SIZE >= PACKBITS_MAX_EMIT,
+                  "CAPTURE_BLOCK_SIZE must hold one PackBits packet");
+#endif
+
+private:
+    // Block storage
+    uint8_t blocks[2][CAPTURE_BLOCK_SIZE];
+    uint8_t fillIndex;              // Block currently being filled
+    uint16_t fillLevel;             // Bytes in the fill block
+    bool blockPending;              // Other block is full, awaiting write
+    bool writerBehind;              // Fill block full while other still pending
+    uint32_t blockStartTime;        // micros() when fill block got its first byte
+    uint32_t bytesCommitted;        // Bytes accepted by storage this session
+    uint32_t bytesCaptured;         // Capture bytes taken by fill() this session
+
+#if CAPTURE_COMPRESSION
+    PackBitsEncoder encoder;
+    bool compressing;
+
+    // Encoder output goes straight into the fill block
+    struct BlockSink {
+        CaptureBlockPipeline& pipeline;
+        void put(uint8_t value) { pipeline.putByte(value); }
+    };
+
+    /**
+     * Append one byte of encoder output to the fill block
+     * Callers guarantee room (see getFreeSpace())
+     * @param value Byte to append
+     */
+    void putByte(uint8_t value);
+
+    /**
+     * Get bytes the fill block can still take, counting the other block
+     * when it is free to rotate into
+     * @return Free bytes
+     */
+    size_t getFreeSpace() const;
+#endif
+
+    // Statistics
+    uint32_t blocksWritten;
+    uint32_t writerStalls;
+    uint32_t lastFillLatency;       // μs from first to last byte of a block
+    uint32_t maxFillLatency;
+    uint32_t fillLatencyTotal;      // Sum over the completed blocks (μs)
+    uint32_t fillLatencySamples;    // Number of completed blocks
+
+    /**
+     * Hand the full fill block to the writer if the other block is free
+     * @return true if the fill block was rotated out
+     */
+    bool rotate();
+
+    /**
+     * Append a block to the open file
+     * @param data Block data
+     * @param size Bytes in block
+     * @return STATUS_OK or STATUS_ERROR on short write
+     */
+    int writeBlock(const uint8_t* data, size_t size);
+
+public:
+    CaptureBlockPipeline();
+
+    /**
+     * Discard buffered data and start a new session
+     */
+    void reset();
+
+    /**
+     * Copy capture data into the fill block
+     * @param data Source data
+     * @param size Number of bytes offered
+     * @return Number of bytes accepted (less than size when writer is behind)
+     */
+    size_t fill(const uint8_t* data, size_t size);
+
+    /**
+     * Compress the rest of the session (call once the file is open)
+     * Data already buffered is re-encoded; if that no longer fits in one
+     * block the session stays uncompressed
+     * @return true if the session is being compressed
+     */
+    bool startCompression();
+
+    /**
+     * Check if the session is being compressed
+     * @return true if data passes through the PackBits encoder
+     */
+    bool isCompressing() const;
+
+    /**
+     * Write the pending block if storage is ready (non-blocking when busy)
+     * @return STATUS_OK, STATUS_BUSY if storage is still programming,
+     *         STATUS_ERROR on write failure
+     */
+    int service();
+
+    /**
+     * Write all buffered data, including a partial fill block (blocking)
+     * @return STATUS_OK or STATUS_ERROR
+     */
+    int flush();
+
+    /**
+     * Get bytes buffered but not yet written
+     * @return Byte count
+     */
+    size_t getBufferedBytes() const;
+
+    /**
+     * Get bytes accepted by storage since reset()
+     * @return Byte count (compressed size when compressing)
+     */
+    uint32_t getBytesCommitted() const;
+
+    /**
+     * Get capture bytes taken by fill() since reset()
+     * @return Byte count before compression
+     */
+    uint32_t getBytesCaptured() const;
+
+    /**
+     * Get number of blocks handed to storage
+     * @return Block count
+     */
+    uint32_t getBlocksWritten() const;
+
+    /**
+     * Get how often the writer fell behind (both blocks full)
+     * @return Stall count
+     */
+    uint32_t getWriterStalls() const;
+
+    /**
+     * Get block-fill latency statistics
+     * @param lastUs Latency of the last completed block (μs)
+     * @param maxUs Maximum latency (μs)
+     * @param avgUs Average latency (μs)
+     */
+    void getFillLatency(uint32_t& lastUs, uint32_t& maxUs, uint32_t& avgUs) const;
+
+    /**
+     * Reset statistics
+     */
+    void resetStatistics();
+
+    /**
+     * Get block size
+     * @return Bytes per block
+     */
+    static constexpr size_t getBlockSize() {
+        return CAPTURE_BLOCK_SIZE;
+    }
+};
+
+#endif // CAPTUREBLOCKPIPELINE_H
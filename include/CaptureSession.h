@@ -0,0 +1,244 @@
+#ifndef CAPTURESESSION_H
+#define CAPTURESESSION_H
+
+#include <Arduino.h>
+#include "HardwareConfig.h"
+#include "CaptureBlockPipeline.h"
+#include "FormatDetector.h"
+
+class EEPROMStoragePlugin;
+
+/**
+ * CaptureSession - Frames parallel port data into print jobs
+ * A job starts on the first byte received and streams everything into
+ * one file until the host goes idle for the configured gap or pulses
+ * /INIT, regardless of how the main loop happened to slice the incoming
+ * data. The file is opened once a FormatDetector has classified the
+ * leading bytes, so it gets the matching extension; until then data waits
+ * in the CaptureBlockPipeline, which feeds storage in whole blocks.
+ * With CAPTURE_SPILL, a stalled pipeline diverts the capture buffer into
+ * the flash spill region until storage catches up, and the spilled bytes
+ * re-enter the job ahead of anything newer.
+ */
+class CaptureSession {
+private:
+    // Session state
+    bool active;
+    bool fileOpen;
+    char filename[MAX_FILENAME_LENGTH];
+    uint32_t sessionBytes;
+    CaptureBlockPipeline pipeline;
+    FormatDetector detector;
+    uint32_t lastDataTime;
+    uint32_t idleTimeoutMs;
+    bool compressionEnabled;
+    bool passThrough;
+    bool debugEnabled;
+    Print* output;                  // Status and job report text
+
+    // Statistics
+    uint32_t jobCount;
+    uint32_t writeErrors;
+    uint32_t passThroughBytes;
+
+#if CAPTURE_SPILL
+    // Flash holding the spilled bytes, nullptr while not spilling
+    EEPROMStoragePlugin* spill;
+    uint32_t spilledBytes;
+    uint32_t spillEvents;
+
+    /**
+     * Start diverting the capture buffer into flash, if a spill region
+     * is ready
+     */
+    void startSpill();
+
+    /**
+     * Spill newly captured bytes behind the pending ones and feed the
+     * oldest back into the block pipeline; ends the spill once it is empty
+     * @return Number of bytes moved (spilled plus fed back)
+     */
+    size_t drainSpill();
+
+    /**
+     * Abandon the spill, dropping bytes not yet fed back
+     */
+    void dropSpill();
+#endif
+
+    /**
+     * Start a new job (file is opened later by openFile())
+     */
+    void startSession();
+
+    /**
+     * Open the capture file, named after the detected format
+     * Drops the job's buffered data if no file can be opened
+     * @return true if file opened
+     */
+    bool openFile();
+
+    /**
+     * Move buffered capture data into the block pipeline
+     * @return Number of bytes drained from the capture buffer
+     */
+    size_t drain();
+
+    /**
+     * Forward buffered capture data to the serial transmitter
+     * Moves only what the TX ring can take; the rest stays in the capture
+     * buffer, whose watermarks then hold BUSY
+     * @return Number of bytes forwarded
+     */
+    size_t forward();
+
+    /**
+     * Refresh sessionBytes from the pipeline
+     */
+    void updateSessionBytes();
+
+    /**
+     * Report a finished job on serial and display
+     * @param committed true if the file was committed
+     */
+    void reportSession(bool committed);
+
+public:
+    CaptureSession();
+
+    /**
+     * Service the capture session (call from main loop)
+     * Drains the capture buffer and closes the job on idle or /INIT
+     */
+    void update();
+
+    /**
+     * Close the current job, committing the file
+     * @return true if a file was committed
+     */
+    bool closeSession();
+
+    /**
+     * Check if a job is currently open
+     * @return true while capturing into a file
+     */
+    bool isActive() const;
+
+    /**
+     * Get the current (or last) capture filename
+     * @return Filename, empty if no job has been started
+     */
+    const char* getFilename() const;
+
+    /**
+     * Get bytes captured in the current (or last) job
+     * @return Byte count as sent by the host (before compression)
+     */
+    uint32_t getSessionBytes() const;
+
+    /**
+     * Get format detection for the current (or last) job
+     * Downstream stages use it to choose a strategy, e.g. skip compressing
+     * already-compressed formats or pre-size from the declared BMP size
+     * @return Detector reference
+     */
+    const FormatDetector& getDetector() const;
+
+    /**
+     * Get number of completed jobs
+     * @return Job count
+     */
+    uint32_t getJobCount() const;
+
+    /**
+     * Get number of failed writes (data dropped)
+     * @return Error count
+     */
+    uint32_t getWriteErrors() const;
+
+    /**
+     * Get the block pipeline (for statistics)
+     * @return Pipeline reference
+     */
+    const CaptureBlockPipeline& getPipeline() const;
+
+    /**
+     * Check if captured bytes are currently going to flash
+     * @return true while spilling (always false without CAPTURE_SPILL)
+     */
+    bool isSpilling() const;
+
+#if CAPTURE_SPILL
+    /**
+     * Get bytes that went through the spill region
+     * @return Byte count since boot
+     */
+    uint32_t getSpilledBytes() const;
+
+    /**
+     * Get number of times the pipeline stalled into a spill
+     * @return Spill count since boot
+     */
+    uint32_t getSpillEvents() const;
+#endif
+
+    /**
+     * Set idle gap that ends a job
+     * @param timeoutMs Idle time in milliseconds
+     */
+    void setIdleTimeout(uint32_t timeoutMs);
+
+    /**
+     * Get idle gap that ends a job
+     * @return Idle time in milliseconds
+     */
+    uint32_t getIdleTimeout() const;
+
+    /**
+     * Enable/disable pass-through mode
+     * Captured bytes go unframed to the serial port and no files are
+     * written; enabling closes the job in progress
+     * @param enabled Pass-through state
+     */
+    void setPassThrough(bool enabled);
+
+    /**
+     * Check if pass-through mode is enabled
+     * @return true if captured bytes are forwarded to serial
+     */
+    bool isPassThrough() const;
+
+    /**
+     * Get bytes forwarded in pass-through mode
+     * @return Byte count
+     */
+    uint32_t getPassThroughBytes() const;
+
+    /**
+     * Enable/disable PackBits compression of new jobs
+     * Jobs whose format is already compressed are always stored as is
+     * @param enabled Compression state
+     */
+    void setCompressionEnabled(bool enabled);
+
+    /**
+     * Check if new jobs are compressed
+     * @return true if compression is enabled
+     */
+    bool isCompressionEnabled() const;
+
+    /**
+     * Enable/disable debug output
+     * @param enabled Debug state
+     */
+    void setDebugEnabled(bool enabled);
+
+    /**
+     * Set where status and job reports are printed (Serial by default)
+     * A SerialOutput holds them back during serial file transfers
+     * @param text Text destination
+     */
+    void setOutput(Print& text);
+};
+
+#endif // CAPTURESESSION_H
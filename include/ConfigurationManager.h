@@ -5,57 +5,168 @@
 #include "IComponent.h"
 #include "HardwareConfig.h"
 
+class CaptureSession;
+
+/**
+ * Runtime configuration record as stored in the internal EEPROM
+ * Field order and sizes are the on-chip format; changing them needs a new
+ * CONFIG_VERSION (older records are then ignored and defaults used).
+ */
+struct RuntimeConfig {
+    uint16_t magic;                 // CONFIG_MAGIC
+    uint8_t version;                // CONFIG_VERSION
+    uint8_t size;                   // sizeof(RuntimeConfig)
+    uint32_t baudRate;              // Serial rate at boot
+    uint16_t flowHighWatermark;     // Ring fill that asserts BUSY
+    uint16_t flowLowWatermark;      // Ring fill that releases it
+    uint16_t ackDelayUs;            // BUSY to ACK delay
+    uint16_t ackPulseUs;            // ACK pulse width
+    uint16_t idleTimeoutMs;         // Idle gap that ends a print job
+    uint8_t flags;                  // CONFIG_FLAG_*
+    uint32_t crc;                   // CRC-32 of the bytes before it
+} __attribute__((packed));
+
+#define CONFIG_FLAG_COMPRESSION     0x01
+#define CONFIG_FLAG_FLOW_CONTROL    0x02
+
 /**
- * ConfigurationManager - Serial command interface (placeholder)
- * Will implement 30+ debug/control commands for system management
+ * ConfigurationManager - Persisted runtime tunables
+ * Loads the RuntimeConfig record from the internal EEPROM once at boot
+ * (before the serial port opens, so the stored link speed applies) and
+ * falls back to the HardwareConfig.h defaults when it is missing, from an
+ * older version or corrupt. Values are edited by key over serial, pushed
+ * to the port and capture session with apply(), and written back only on
+ * save().
  */
-class ConfigurationManager : public IComponent {
+class ConfigurationManager final : public IComponent {
+public:
+    // Editable values
+    enum Key : uint8_t {
+        KEY_BAUD = 0,
+        KEY_FLOW_HIGH,
+        KEY_FLOW_LOW,
+        KEY_FLOW_CONTROL,
+        KEY_ACK_DELAY,
+        KEY_ACK_PULSE,
+        KEY_IDLE_TIMEOUT,
+        KEY_COMPRESSION,
+        KEY_COUNT
+    };
+
+    // Where the active values came from
+    enum Source : uint8_t {
+        SOURCE_DEFAULTS = 0,        // No valid record stored
+        SOURCE_STORED,              // Record loaded from EEPROM
+        SOURCE_SKIPPED              // SELECT held at boot
+    };
+
 private:
     bool initialized;
     bool debugEnabled;
-    
+    bool booted;                    // First initialize() done (ADC now sampled)
+    Source source;
+    RuntimeConfig config;
+
+    /**
+     * Fill the record with the compile-time defaults
+     * @param record Record to fill
+     */
+    static void loadDefaults(RuntimeConfig& record);
+
+    /**
+     * Check every field of a record
+     * @param record Record to check (CRC not included)
+     * @return true if all values are in range and consistent
+     */
+    static bool isValid(const RuntimeConfig& record);
+
+    /**
+     * Compute the checksum of a record
+     * @param record Record
+     * @return CRC-32 of everything before the crc field
+     */
+    static uint32_t computeCrc(const RuntimeConfig& record);
+
+    /**
+     * Read the stored record
+     * @return true if a valid record of this version was loaded
+     */
+    bool load();
+
 public:
-    ConfigurationManager() : initialized(false), debugEnabled(false) {}
+    ConfigurationManager();
     ~ConfigurationManager() override = default;
-    
+
     // IComponent interface implementation
-    int initialize() override { 
-        initialized = true; 
-        return STATUS_OK; 
-    }
-    
-    int update() override { 
-        return STATUS_OK; 
-    }
-    
-    int getStatus() const override { 
-        return initialized ? STATUS_OK : STATUS_NOT_INITIALIZED; 
-    }
-    
-    const __FlashStringHelper* getName() const override {
-        return F("ConfigurationManager");
-    }
-    
-    bool validate() const override { 
-        return initialized; 
-    }
-    
-    int reset() override { 
-        initialized = false; 
-        return initialize(); 
-    }
-    
-    size_t getMemoryUsage() const override { 
-        return sizeof(*this); 
-    }
-    
-    void setDebugEnabled(bool enabled) override { 
-        debugEnabled = enabled; 
-    }
-    
-    bool isDebugEnabled() const override { 
-        return debugEnabled; 
-    }
+    int initialize() override;
+    int update() override;
+    int getStatus() const override;
+    const __FlashStringHelper* getName() const override;
+    bool validate() const override;
+    int reset() override;
+    size_t getMemoryUsage() const override;
+    void setDebugEnabled(bool enabled) override;
+    bool isDebugEnabled() const override;
+
+    /**
+     * Get the active configuration
+     * @return Record (valid after initialize())
+     */
+    const RuntimeConfig& getConfig() const;
+
+    /**
+     * Get where the active configuration came from
+     * @return Source
+     */
+    Source getSource() const;
+
+    /**
+     * Look a key up by name
+     * @param name Key name (case-insensitive)
+     * @param length Length of name
+     * @return Key, or KEY_COUNT if unknown
+     */
+    static Key findKey(const char* name, size_t length);
+
+    /**
+     * Get a key's name
+     * @param key Key
+     * @return PROGMEM name
+     */
+    static const __FlashStringHelper* getKeyName(Key key);
+
+    /**
+     * Get a value
+     * @param key Key
+     * @return Current value
+     */
+    uint32_t getValue(Key key) const;
+
+    /**
+     * Change a value (in RAM; apply() and save() make it take effect/persist)
+     * @param key Key
+     * @param value New value
+     * @return false if out of range or inconsistent with the other values
+     */
+    bool setValue(Key key, uint32_t value);
+
+    /**
+     * Return every value to its compile-time default (in RAM)
+     */
+    void restoreDefaults();
+
+    /**
+     * Push the values to the parallel port and capture session
+     * The baud rate only applies at the next boot.
+     * @param session Capture session (nullptr for the port only)
+     */
+    void apply(CaptureSession* session) const;
+
+    /**
+     * Write the record to the internal EEPROM (unchanged bytes are not rewritten)
+     * @return STATUS_OK, or STATUS_ERROR if the readback does not match
+     */
+    int save();
 };
 
-#endif // CONFIGURATIONMANAGER_H
\ No newline at end of file
+#endif // CONFIGURATIONMANAGER_H
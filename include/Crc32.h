@@ -0,0 +1,82 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#ifdef UNIT_TEST
+#include <stdint.h>
+#include <stddef.h>
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#define CRC32_READ_TABLE(p) (*(p))
+#else
+#include <Arduino.h>
+#define CRC32_READ_TABLE(p) pgm_read_dword(p)
+#endif
+
+/**
+ * Crc32 - Incremental CRC-32 (IEEE 802.3, as used by zip and PNG)
+ * Nibble-table variant: 64 bytes of PROGMEM and two lookups per byte, so
+ * the checksum can follow data as it streams into storage without a
+ * second pass. Crc32::compute("123456789", 9) == 0xCBF43926.
+ */
+class Crc32 {
+private:
+    uint32_t value;
+
+    static uint32_t entry(uint8_t index) {
+        static const uint32_t table[16] PROGMEM = {
+            0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+            0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+            0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+            0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+        };
+        return CRC32_READ_TABLE(&table[index]);
+    }
+
+public:
+    Crc32() : value(0xFFFFFFFF) {}
+
+    /**
+     * Start a new checksum
+     */
+    void reset() {
+        value = 0xFFFFFFFF;
+    }
+
+    /**
+     * Add bytes to the checksum
+     * @param data Bytes in stream order
+     * @param size Number of bytes
+     */
+    void update(const uint8_t* data, size_t size) {
+        uint32_t crc = value;
+        for (size_t i = 0; i < size; i++) {
+            crc ^= data[i];
+            crc = (crc >> 4) ^ entry(crc & 0x0F);
+            crc = (crc >> 4) ^ entry(crc & 0x0F);
+        }
+        value = crc;
+    }
+
+    /**
+     * Get the checksum of the bytes added so far
+     * @return CRC-32
+     */
+    uint32_t get() const {
+        return ~value;
+    }
+
+    /**
+     * Checksum a buffer in one call
+     * @param data Bytes
+     * @param size Number of bytes
+     * @return CRC-32
+     */
+    static uint32_t compute(const uint8_t* data, size_t size) {
+        Crc32 crc;
+        crc.update(data, size);
+        return crc.get();
+    }
+};
+
+#endif // CRC32_H
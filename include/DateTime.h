@@ -0,0 +1,205 @@
+#ifndef DATETIME_H
+#define DATETIME_H
+
+#ifdef UNIT_TEST
+#include <stdint.h>
+#include <stddef.h>
+#else
+#include <Arduino.h>
+#endif
+
+#define DATETIME_EPOCH_YEAR     2000
+#define DATETIME_LAST_YEAR      2099    // DS1307 stores two year digits
+#define DATETIME_STAMP_LENGTH   8       // "DDHHMMSS"
+#define DATETIME_TEXT_LENGTH    19      // "YYYY-MM-DD HH:MM:SS"
+
+/**
+ * DateTime - Calendar time in the DS1307 range (2000-2099)
+ * Converts to and from seconds since 2000-01-01 00:00:00, so TimeManager
+ * can keep a single counter and add elapsed millis() to it. Formatting
+ * writes the digits directly instead of going through printf.
+ */
+struct DateTime {
+    uint16_t year;
+    uint8_t month;              // 1-12
+    uint8_t day;                // 1-31
+    uint8_t hour;               // 0-23
+    uint8_t minute;
+    uint8_t second;
+
+    /**
+     * Constructor - all fields zero (not a valid date until set)
+     */
+    DateTime() : year(0), month(0), day(0), hour(0), minute(0), second(0) {}
+
+    /**
+     * Check for a leap year (every fourth year is one within 2000-2099)
+     * @param year Full year
+     * @return true if February has 29 days
+     */
+    static bool isLeapYear(uint16_t year) {
+        return year % 4 == 0;
+    }
+
+    /**
+     * Get the length of a month
+     * @param year Full year
+     * @param month Month 1-12
+     * @return Number of days
+     */
+    static uint8_t daysInMonth(uint16_t year, uint8_t month) {
+        if (month == 2) {
+            return isLeapYear(year) ? 29 : 28;
+        }
+        // 31 for Jan, Mar, May, Jul, Aug, Oct, Dec
+        return 30 + ((month + (month >> 3)) & 1);
+    }
+
+    /**
+     * Check that every field is in range
+     * @return true if the date exists and lies in 2000-2099
+     */
+    bool isValid() const {
+        return year >= DATETIME_EPOCH_YEAR && year <= DATETIME_LAST_YEAR &&
+               month >= 1 && month <= 12 &&
+               day >= 1 && day <= daysInMonth(year, month) &&
+               hour < 24 && minute < 60 && second < 60;
+    }
+
+    /**
+     * Convert to seconds since 2000-01-01 00:00:00
+     * @return Seconds (the date must be valid)
+     */
+    uint32_t toSeconds() const {
+        uint16_t years = year - DATETIME_EPOCH_YEAR;
+        uint32_t days = (uint32_t)years * 365 + (years + 3) / 4;
+        for (uint8_t m = 1; m < month; m++) {
+            days += daysInMonth(year, m);
+        }
+        days += day - 1;
+        return ((days * 24 + hour) * 60 + minute) * 60 + second;
+    }
+
+    /**
+     * Convert seconds since 2000-01-01 00:00:00 to a calendar time
+     * @param seconds Seconds since the epoch
+     * @return Calendar time
+     */
+    static DateTime fromSeconds(uint32_t seconds) {
+        DateTime time;
+        time.second = seconds % 60;
+        seconds /= 60;
+        time.minute = seconds % 60;
+        seconds /= 60;
+        time.hour = seconds % 24;
+        uint32_t days = seconds / 24;
+
+        time.year = DATETIME_EPOCH_YEAR;
+        while (days >= (isLeapYear(time.year) ? 366u : 365u)) {
+            days -= isLeapYear(time.year) ? 366 : 365;
+            time.year++;
+        }
+        time.month = 1;
+        while (days >= daysInMonth(time.year, time.month)) {
+            days -= daysInMonth(time.year, time.month);
+            time.month++;
+        }
+        time.day = (uint8_t)(days + 1);
+        return time;
+    }
+
+    /**
+     * Write the filename stamp "DDHHMMSS" (unique to the second within a
+     * month, and fits an 8.3 base name)
+     * @param dest Buffer of at least DATETIME_STAMP_LENGTH + 1 bytes
+     */
+    void formatStamp(char* dest) const {
+        dest = putDigits(dest, day);
+        dest = putDigits(dest, hour);
+        dest = putDigits(dest, minute);
+        dest = putDigits(dest, second);
+        *dest = '\0';
+    }
+
+    /**
+     * Write "YYYY-MM-DD HH:MM:SS"
+     * @param dest Buffer of at least DATETIME_TEXT_LENGTH + 1 bytes
+     */
+    void format(char* dest) const {
+        dest = putDigits(dest, (uint8_t)(year / 100));
+        dest = putDigits(dest, (uint8_t)(year % 100));
+        *dest++ = '-';
+        dest = putDigits(dest, month);
+        *dest++ = '-';
+        dest = putDigits(dest, day);
+        *dest++ = ' ';
+        dest = putDigits(dest, hour);
+        *dest++ = ':';
+        dest = putDigits(dest, minute);
+        *dest++ = ':';
+        dest = putDigits(dest, second);
+        *dest = '\0';
+    }
+
+    /**
+     * Parse "YYYY-MM-DD HH:MM:SS"
+     * @param text Text to parse (trailing characters are rejected)
+     * @param time Receives the parsed time
+     * @return true if the text is a valid time in 2000-2099
+     */
+    static bool parse(const char* text, DateTime& time) {
+        if (!text) {
+            return false;
+        }
+        for (size_t i = 0; i < DATETIME_TEXT_LENGTH; i++) {
+            char separator = (i == 4 || i == 7) ? '-' : i == 10 ? ' ' :
+                             (i == 13 || i == 16) ? ':' : '\0';
+            bool digit = text[i] >= '0' && text[i] <= '9';
+            if (separator ? text[i] != separator : !digit) {
+                return false;
+            }
+        }
+        if (text[DATETIME_TEXT_LENGTH] != '\0') {
+            return false;
+        }
+
+        time.year = (uint16_t)(readDigits(text) * 100 + readDigits(text + 2));
+        time.month = readDigits(text + 5);
+        time.day = readDigits(text + 8);
+        time.hour = readDigits(text + 11);
+        time.minute = readDigits(text + 14);
+        time.second = readDigits(text + 17);
+        return time.isValid();
+    }
+
+    /**
+     * Decode a DS1307 BCD register value
+     * @param value BCD byte
+     * @return Binary value
+     */
+    static uint8_t fromBcd(uint8_t value) {
+        return (uint8_t)((value >> 4) * 10 + (value & 0x0F));
+    }
+
+    /**
+     * Encode a value 0-99 as BCD
+     * @param value Binary value
+     * @return BCD byte
+     */
+    static uint8_t toBcd(uint8_t value) {
+        return (uint8_t)(((value / 10) << 4) | (value % 10));
+    }
+
+private:
+    static char* putDigits(char* dest, uint8_t value) {
+        *dest++ = (char)('0' + value / 10);
+        *dest++ = (char)('0' + value % 10);
+        return dest;
+    }
+
+    static uint8_t readDigits(const char* text) {
+        return (uint8_t)((text[0] - '0') * 10 + (text[1] - '0'));
+    }
+};
+
+#endif // DATETIME_H
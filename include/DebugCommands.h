@@ -1,12 +1,15 @@
 #ifndef DEBUGCOMMANDS_H
 #define DEBUGCOMMANDS_H
 
+class CaptureSession;
+
 namespace DebugCommands {
 
 /**
  * Initialize debug command system
+ * @param session Capture session the capture commands act on
  */
-void initialize();
+void initialize(CaptureSession* session);
 
 /**
  * Update debug command processing
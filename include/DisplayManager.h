@@ -5,13 +5,20 @@
 #include <LiquidCrystal.h>
 #include "IComponent.h"
 #include "HardwareConfig.h"
+#include "LcdFrameBuffer.h"
 
 /**
  * DisplayManager - 16x2 LCD with button navigation
  * Manages OSEPP LCD Keypad Shield with analog button interface
  * Provides message display, menu navigation, and real-time status updates
+ *
+ * Nothing here writes the LCD directly: text goes into a shadow frame and
+ * update() sends at most LCD_BUS_OPS_PER_UPDATE changed cells per tick, so
+ * the display never holds up the capture drain. Menus, the button test
+ * and the error blink are state machines advanced by update(); button
+ * presses are latched for takeButtonPress().
  */
-class DisplayManager : public IComponent {
+class DisplayManager final : public IComponent {
 public:
     enum ButtonType {
         BUTTON_NONE = 0,
@@ -27,11 +34,13 @@ public:
         STATE_MENU,
         STATE_MESSAGE,
         STATE_STATUS,
-        STATE_SCROLLING
+        STATE_SCROLLING,
+        STATE_BUTTON_TEST
     };
     
 private:
     LiquidCrystal lcd;
+    LcdFrameBuffer<16, 2> frame;    // What the LCD should show
     
     // State management
     bool initialized;
@@ -44,52 +53,87 @@ private:
     uint32_t buttonPressTime;
     uint32_t buttonReleaseTime;
     bool buttonHeld;
+    ButtonType pendingPress;         // Latched for takeButtonPress()
     
-    // Display content - EMERGENCY MEMORY REDUCTION
-    char line1Buffer[6];        // EMERGENCY: 5 chars + null
-    char line2Buffer[6];
-    char messageBuffer[6];      // EMERGENCY: 5 chars only
-    uint32_t displayUpdateTime;
+    // Message timeout
     uint32_t messageTimeout;
     bool messageTimedOut;
     
-    // Menu system - reduced size
+    // Menu system: item strings are the caller's (no copies)
+    const char* const* menuItems;
     size_t currentMenuItem;
     size_t totalMenuItems;
-    char menuItems[1][6];       // EMERGENCY: 1 menu item, 5 chars
+    uint32_t menuActivityTime;      // Last press, for the menu timeout
+    uint32_t menuTimeout;
+    int8_t menuSelection;           // Result once closed, -1 if cancelled
+    bool menuClosed;                // Result not yet collected by pollMenu()
     
-    // Scrolling text
+    // Scrolling text: the caller's string, not copied
+    const char* scrollText;
     size_t scrollPosition;
     uint32_t scrollUpdateTime;
+    uint16_t scrollInterval;
+    uint8_t scrollLine;
     bool scrollEnabled;
     
+    // Error marker blink and button test progress
+    uint8_t errorBlinks;            // Marker toggles left
+    uint32_t errorBlinkTime;
+    uint8_t buttonTestStep;         // Index of the button expected next
+    uint32_t buttonTestTime;
+    
     // Status display
     uint32_t statusUpdateTime;
+    uint32_t statusUpdateInterval;
     bool autoStatusUpdate;
     
     // Backlight control
     bool backlightEnabled;
     
     /**
-     * Read analog button value and determine pressed button
-     * @return Button type pressed
+     * Update button state with debouncing
      */
-    ButtonType readButton();
+    void updateButtonState();
     
     /**
-     * Update button state with debouncing
+     * Start the Timer0-triggered button conversions (BUTTON_ADC_INTERRUPT)
      */
-    void updateButtonState();
+    void startButtonSampling();
     
     /**
-     * Clear display and buffers
+     * Blank the frame (the LCD follows on the next ticks)
      */
     void clearDisplay();
     
     /**
-     * Update display content based on current state
+     * Write full-width text from PROGMEM into one row of the frame
+     * @param row Row
+     * @param text PROGMEM text (nullptr blanks the row)
+     */
+    void putLinePGM(uint8_t row, const __FlashStringHelper* text);
+    
+    /**
+     * Draw the current menu item into the frame
+     */
+    void renderMenu();
+    
+    /**
+     * Close the menu and keep its result for pollMenu()
+     * @param selection Item index, or -1 if cancelled
      */
-    void updateDisplay();
+    void closeMenu(int8_t selection);
+    
+    /**
+     * Show the prompt for the current button test step
+     */
+    void renderButtonTest();
+    
+    /**
+     * Advance timed state: message timeout, menu timeout, error blink,
+     * button test timeout
+     * @param currentTime millis()
+     */
+    void updateTimers(uint32_t currentTime);
     
     /**
      * Handle button press for current state
@@ -102,14 +146,6 @@ private:
      */
     void updateScrolling();
     
-    /**
-     * Format status line for display
-     * @param statusText Status text to format
-     * @param buffer Buffer to store formatted text
-     * @param bufferSize Size of buffer
-     */
-    void formatStatusLine(const char* statusText, char* buffer, size_t bufferSize);
-    
     /**
      * Center text in display line
      * @param text Text to center
@@ -118,14 +154,6 @@ private:
      */
     void centerText(const char* text, char* buffer, size_t bufferSize);
     
-    /**
-     * Truncate text to fit display width
-     * @param text Text to truncate
-     * @param buffer Buffer to store truncated text
-     * @param bufferSize Size of buffer
-     */
-    void truncateText(const char* text, char* buffer, size_t bufferSize);
-    
 public:
     /**
      * Constructor
@@ -168,6 +196,7 @@ public:
     
     /**
      * Display scrolling message (for text longer than 16 chars)
+     * The text is not copied and must stay valid while it scrolls.
      * @param message Long message to scroll
      * @param line Line number (0 or 1)
      * @param scrollSpeed Scroll speed in milliseconds per character
@@ -195,16 +224,32 @@ public:
     
     /**
      * Set up menu system
+     * The array and strings are not copied and must outlive the menu.
      * @param items Array of menu item strings
      * @param itemCount Number of menu items
      */
-    void setupMenu(const char* items[], size_t itemCount);
+    void setupMenu(const char* const items[], size_t itemCount);
+    
+    /**
+     * Show the menu; UP/DOWN move, SELECT picks, LEFT or the timeout cancel
+     * Returns at once; collect the result with pollMenu()
+     * @param timeoutMs Inactivity timeout in milliseconds
+     * @return false if no menu is set up
+     */
+    bool openMenu(uint32_t timeoutMs = 10000);
+    
+    /**
+     * Check if the menu is on screen
+     * @return true while open
+     */
+    bool isMenuOpen() const;
     
     /**
-     * Show menu and handle navigation
-     * @return Selected menu item index or -1 if cancelled
+     * Collect the menu result once it closes
+     * @param selection Receives the item index, or -1 if cancelled
+     * @return true once per closed menu
      */
-    int showMenu();
+    bool pollMenu(int& selection);
     
     /**
      * Get current button state
@@ -213,11 +258,24 @@ public:
     ButtonType getCurrentButton() const;
     
     /**
-     * Wait for button press with timeout
-     * @param timeoutMs Timeout in milliseconds
-     * @return Button pressed or BUTTON_NONE if timeout
+     * Read the buttons now, without waiting for update()
+     * With BUTTON_ADC_INTERRUPT this is the ISR's debounced sample
+     * @return Button type pressed
+     */
+    ButtonType readButton() const;
+    
+    /**
+     * Get the raw button divider reading
+     * @return Latest ADC value (0-1023)
      */
-    ButtonType waitForButton(uint32_t timeoutMs = 5000);
+    int getButtonAdcValue() const;
+    
+    /**
+     * Take the last button press not yet collected
+     * Presses consumed by a menu or the button test are not reported
+     * @return Button, or BUTTON_NONE if none since the last call
+     */
+    ButtonType takeButtonPress();
     
     /**
      * Check if button is currently held down
@@ -288,10 +346,17 @@ public:
     const __FlashStringHelper* getButtonName(ButtonType button) const;
     
     /**
-     * Test all buttons and display status
-     * @return true if all buttons respond correctly
+     * Start the interactive button test
+     * Prompts for each button in turn (5 s each) and shows PASSED or the
+     * failing button; runs from update()
+     */
+    void startButtonTest();
+    
+    /**
+     * Check if the button test is running
+     * @return true until it passes or fails
      */
-    bool testButtons();
+    bool isButtonTestRunning() const;
     
     /**
      * Get current display state
@@ -300,9 +365,21 @@ public:
     DisplayState getCurrentState() const;
     
     /**
-     * Force display update (refresh content)
+     * Send every pending cell now (blocks for the whole transfer)
+     * For boot, self-test and fatal error paths only
      */
     void forceUpdate();
+    
+    /**
+     * Mark every cell for resending, so the next update redraws the frame
+     */
+    void redraw();
+    
+    /**
+     * Get cells still waiting to be sent
+     * @return Dirty cell count
+     */
+    uint8_t getPendingCells() const;
 };
 
 #endif // DISPLAYMANAGER_H
\ No newline at end of file
@@ -5,28 +5,124 @@
 #include <SPI.h>
 #include "IStoragePlugin.h"
 #include "HardwareConfig.h"
+#include "Crc32.h"
+
+class BenchmarkStat;
 
 /**
  * EEPROM Storage Plugin for W25Q128FVSG (16MB SPI Flash)
- * Implements minimal filesystem with wear leveling support
- * Uses complement-based size encoding and sector management
+ * Files are contiguous sector runs. The directory lives in RAM (names stay
+ * on flash behind a hash) and every change is appended as a checksummed
+ * record to a journal ring in the last JOURNAL_SECTORS sectors; when a
+ * journal sector fills, a snapshot of the directory and wear counters
+ * opens the next one. Each 64KB block keeps an erase counter, journaled
+ * alongside the entries, and allocation moves off the sequential cursor
+ * to the least-worn free block once the gap passes WEAR_LEVEL_THRESHOLD.
+ * While idle, a pool of PRE_ERASE_SECTORS ahead of the next write is
+ * erased in the background, and fragmented free space is compacted by
+ * relocating files one sector at a time. The pre-journal table in sector
+ * 0 is imported once.
  */
 class EEPROMStoragePlugin : public IStoragePlugin {
 private:
+    /**
+     * Resident directory entry
+     * The name stays on flash in the entry's latest journal record and is
+     * paged in on demand; the hash lets lookups skip all other names.
+     */
     struct FileEntry {
-        char filename[MAX_FILENAME_LENGTH];
         uint32_t startSector;      // Starting sector number
         uint32_t sizeBytes;        // File size in bytes
-        uint32_t sizeComplement;   // Complement of size for validation
+        uint16_t record;           // Journal record holding the name
+        uint8_t nameHash;          // hashName() of the filename
         uint8_t status;            // File status (active, deleted, etc.)
-        uint8_t reserved[3];       // Reserved for alignment
+    };
+    
+    // Directory table layout before the journal, imported once
+    struct LegacyEntry {
+        char filename[MAX_FILENAME_LENGTH];
+        uint32_t startSector;
+        uint32_t sizeBytes;
+        uint32_t sizeComplement;
+        uint8_t status;
+        uint8_t reserved[3];
+    };
+    
+    // Wear tracking granularity: one erase counter per 64KB block
+    static constexpr uint32_t SECTORS_PER_WEAR_BLOCK = 16;
+    static constexpr size_t WEAR_COUNTERS_PER_RECORD = 14;
+    
+    struct EntryPayload {
+        char filename[MAX_FILENAME_LENGTH];
+        uint8_t reserved[3];       // Pad to 28 bytes
+        uint32_t startSector;
+        uint32_t sizeBytes;
+        union {
+            uint32_t sizeComplement;   // RECORD_ENTRY
+            uint32_t crc;              // RECORD_FILE: CRC-32 of the file data
+        };
+    };
+    
+    /**
+     * On-flash directory journal record
+     * A RECORD_ENTRY or RECORD_FILE sets directory[slot] (the latter also
+     * carries the data checksum), a RECORD_WEAR sets the erase
+     * counters of wear group slot, and a RECORD_HEADER opens a journal
+     * sector.
+     */
+    struct JournalRecord {
+        uint8_t type;              // Record type, 0xFF = erased
+        uint8_t slot;              // Directory index or wear group
+        uint8_t status;            // File status of the entry
+        uint8_t checksum;          // Complement of the byte sum of the rest
+        union {
+            EntryPayload entry;                      // RECORD_ENTRY, RECORD_FILE
+            uint16_t wear[WEAR_COUNTERS_PER_RECORD]; // RECORD_WEAR
+            uint32_t generation;                     // RECORD_HEADER
+        };
     };
     
     static constexpr size_t FILE_ENTRY_SIZE = sizeof(FileEntry);
-    static constexpr size_t MAX_FILES = 32;  // Reduced from 64 to save memory
-    static constexpr uint32_t DIRECTORY_SECTOR = 0; // First sector for directory
+    static constexpr size_t MAX_FILES = 64;  // Names live on flash, 12 bytes each in RAM
+    static constexpr uint32_t LEGACY_DIRECTORY_SECTOR = 0; // Pre-journal directory table
+    static constexpr size_t LEGACY_MAX_FILES = 32;   // Entries in the legacy table
     static constexpr uint32_t DATA_START_SECTOR = 1; // First data sector
     static constexpr uint32_t TOTAL_SECTORS = EEPROM_SIZE / EEPROM_SECTOR_SIZE;
+    static constexpr uint32_t JOURNAL_SECTORS = 4;   // Directory journal ring
+    static constexpr uint32_t JOURNAL_START_SECTOR = TOTAL_SECTORS - JOURNAL_SECTORS;
+    static constexpr uint32_t SPILL_SECTORS = CAPTURE_SPILL ? CAPTURE_SPILL_SECTORS : 0;
+    static constexpr uint32_t SPILL_START_SECTOR = JOURNAL_START_SECTOR - SPILL_SECTORS;
+    static constexpr uint32_t SPILL_SIZE = SPILL_SECTORS * EEPROM_SECTOR_SIZE;
+    static constexpr uint32_t DATA_END_SECTOR = SPILL_START_SECTOR; // One past last data sector
+    static constexpr size_t JOURNAL_RECORD_SIZE = sizeof(JournalRecord);
+    static constexpr uint16_t RECORDS_PER_SECTOR = EEPROM_SECTOR_SIZE / JOURNAL_RECORD_SIZE;
+    static constexpr uint16_t LEGACY_RECORD = 0x8000; // FileEntry::record flag: name in legacy table
+    static constexpr size_t WEAR_BLOCKS = TOTAL_SECTORS / SECTORS_PER_WEAR_BLOCK;
+    static constexpr size_t WEAR_RECORDS =
+        (WEAR_BLOCKS + WEAR_COUNTERS_PER_RECORD - 1) / WEAR_COUNTERS_PER_RECORD;
+    
+    // Allocation policy: stay on the sequential write cursor unless its
+    // block has seen this many more erases than the least-worn free block
+    static constexpr uint16_t WEAR_LEVEL_THRESHOLD = SECTORS_PER_WEAR_BLOCK * 4;
+    
+    // Runway reserved for writes of unknown size (one wear block)
+    static constexpr uint32_t MIN_ALLOCATION_SECTORS = SECTORS_PER_WEAR_BLOCK;
+    
+    // Sectors kept erased ahead of the next write while idle, so a capture
+    // of up to 64KB only page-programs (a sector erase takes 45-400ms)
+    static constexpr uint32_t PRE_ERASE_SECTORS = MIN_ALLOCATION_SECTORS;
+    
+    // Compaction starts once the largest free run drops below this (256KB)
+    // while the free space is split across several holes
+    static constexpr uint32_t COMPACT_RUNWAY_SECTORS = SECTORS_PER_WEAR_BLOCK * 4;
+    
+    static_assert(EEPROM_PAGE_SIZE % sizeof(JournalRecord) == 0,
+                  "Journal records must not straddle flash pages");
+    static_assert((1 + MAX_FILES + WEAR_RECORDS) * JOURNAL_RECORD_SIZE < EEPROM_SECTOR_SIZE,
+                  "Directory snapshot must fit one journal sector");
+    static_assert(WEAR_RECORDS <= 32, "Wear dirty mask is 32 bits");
+    static_assert(MAX_FILES <= 127, "Directory index must fit relocateSlot");
+    static_assert(SPILL_SECTORS <= 32, "Spill sector masks are 32 bits");
     
     enum FileStatus {
         STATUS_EMPTY = 0xFF,
@@ -34,8 +130,17 @@ private:
         STATUS_DELETED = 0x55
     };
     
+    enum RecordType {
+        RECORD_ERASED = 0xFF,
+        RECORD_HEADER = 0xA5,
+        RECORD_ENTRY = 0x5A,       // Entry without checksum (written before CRCs)
+        RECORD_FILE = 0x5B,        // Entry with the CRC-32 of its data
+        RECORD_WEAR = 0x3C
+    };
+    
     // W25Q128 Commands
     static constexpr uint8_t CMD_READ_DATA = 0x03;
+    static constexpr uint8_t CMD_FAST_READ = 0x0B;
     static constexpr uint8_t CMD_PAGE_PROGRAM = 0x02;
     static constexpr uint8_t CMD_SECTOR_ERASE = 0x20;
     static constexpr uint8_t CMD_WRITE_ENABLE = 0x06;
@@ -48,37 +153,148 @@ private:
     
     // Filesystem state
     FileEntry directory[MAX_FILES];
-    uint32_t nextFreeSector;
+    uint32_t nextFreeSector;       // Sequential write cursor (end of last file)
     uint32_t totalFiles;
     uint32_t deletedFiles;
     
     // Operation buffers
-    uint8_t sectorBuffer[EEPROM_SECTOR_SIZE];
-    uint8_t pageBuffer[EEPROM_PAGE_SIZE];
+#if XMEM_CAPTURE_BUFFER && XMEM_EEPROM_PAGE_BUFFER
+    static uint8_t (&pageBuffer)[EEPROM_PAGE_SIZE];   // Relocation copy (external SRAM)
+#else
+    uint8_t pageBuffer[EEPROM_PAGE_SIZE];   // Relocation copy
+#endif
+    
+    // Directory journal position
+    uint8_t journalSector;         // Active ring sector (0..JOURNAL_SECTORS-1)
+    uint16_t journalOffset;        // Next free record in that sector
+    uint32_t journalGeneration;    // Generation of the active sector
+    
+    // Sector erases per 64KB block (saturating), persisted in the journal
+    uint16_t blockWear[WEAR_BLOCKS];
+    uint32_t wearDirty;            // Wear groups changed since last logged
+    
+    // Streaming write state (one open file at a time)
+    bool writeOpen;
+    FileEntry* writeEntry;         // Reserved directory slot
+    char writeName[MAX_FILENAME_LENGTH]; // Its name until the commit record
+    uint32_t writeStartSector;     // First sector of the open file
+    uint32_t writeLimitSector;     // End of the free region it was given
+    uint32_t writeSize;            // Bytes written so far
+    FileEntry* replacedEntry;      // Entry this write replaces, logged at close
+    Crc32 writeCrc;                // Checksum of the data appended so far
+    
+    // Streaming read state (one open file at a time)
+    bool readOpen;
+    uint32_t readStart;            // First byte of the file being read
+    uint32_t readAddress;          // Next byte to read
+    uint32_t readRemaining;        // Bytes left in the file
+    bool verifyReads;              // Check streamed reads against the stored CRC
+    bool readVerifying;            // The open file has a CRC to check
+    uint32_t readExpectedCrc;
+    Crc32 readCrc;
+    
+    // Pre-erased pool: [poolStart, poolEnd) is known erased, and grows up
+    // to poolLimit while idle, one background erase at a time
+    uint32_t poolStart;
+    uint32_t poolEnd;
+    uint32_t poolLimit;
+    bool poolStale;                // Next write location may have moved
+    bool journalSpareErased;       // Next journal ring sector is ready
+    
+    enum BackgroundErase : uint8_t {
+        ERASE_NONE,
+        ERASE_POOL,                // Erasing poolEnd
+        ERASE_JOURNAL,             // Erasing the next journal ring sector
+        ERASE_RELOCATE,            // Erasing the next relocation target
+        ERASE_SPILL                // Erasing spillEraseSector
+    };
+    BackgroundErase backgroundErase;
+    
+    // Incremental compaction: one file is relocated at a time, one sector
+    // per update(), and switched over by a single journal record
+    int8_t relocateSlot;           // Directory index being moved, -1 if none
+    uint32_t relocateTarget;       // First destination sector
+    uint32_t relocateDone;         // Sectors copied so far
+    bool relocateErased;           // Next destination sector is erased
+    bool compactCheck;             // Layout changed, re-run the trigger
+    bool compactRequested;         // Allocation failed: compact fully
+    
+#if CAPTURE_SPILL
+    // Capture spill region [SPILL_START_SECTOR, JOURNAL_START_SECTOR):
+    // bytes [spillTail, spillHead) are pending, written from offset 0 up
+    uint32_t spillHead;
+    uint32_t spillTail;
+    uint32_t spillErased;          // Sectors known erased (bit per sector)
+    uint32_t spillChecked;         // Sectors blank-checked since boot
+    uint8_t spillEraseSector;      // Target of an ERASE_SPILL
+#endif
+    
+    // Page program or erase issued but not yet confirmed complete
+    mutable bool programPending;
     
     /**
      * Initialize SPI communication
      */
     void initSPI();
     
+    /**
+     * Claim the SPI bus and assert chip select
+     */
+    static void select();
+    
+    /**
+     * Release chip select and the SPI bus
+     */
+    static void deselect();
+    
+    /**
+     * Clock a buffer out to the selected device
+     * @param data Bytes to send
+     * @param size Number of bytes
+     */
+    static void transmitBurst(const uint8_t* data, size_t size);
+    
+    /**
+     * Clock a buffer in from the selected device
+     * @param data Buffer to store received bytes
+     * @param size Number of bytes
+     */
+    static void receiveBurst(uint8_t* data, size_t size);
+    
     /**
      * Send command to EEPROM
      * @param cmd Command byte
      */
-    void sendCommand(uint8_t cmd);
+    void sendCommand(uint8_t cmd) const;
     
     /**
      * Send address (24-bit) to EEPROM
      * @param address 24-bit address
      */
-    void sendAddress(uint32_t address);
+    void sendAddress(uint32_t address) const;
     
     /**
      * Wait for write operation to complete
      * @param timeoutMs Timeout in milliseconds
      * @return true if operation completed
      */
-    bool waitForWriteComplete(uint32_t timeoutMs = 1000);
+    bool waitForWriteComplete(uint32_t timeoutMs = 1000) const;
+    
+    /**
+     * Wait for a deferred program or erase to finish before the next command
+     * @return true if device is idle
+     */
+    bool waitForIdle() const;
+    
+#if HARDWARE_BENCHMARK
+    /**
+     * Poll status register 1 without pausing until the device is idle
+     * The register is read continuously under one chip select
+     * @param timeoutMs Timeout in milliseconds
+     * @return true if the device finished
+     */
+    bool pollReady(uint32_t timeoutMs) const;
+#endif
     
     /**
      * Enable write operations
@@ -92,11 +308,11 @@ private:
      * @param size Number of bytes to read
      * @return true if read successful
      */
-    bool readData(uint32_t address, uint8_t* data, size_t size);
+    bool readData(uint32_t address, uint8_t* data, size_t size) const;
     
     /**
      * Write page to EEPROM (256 bytes max)
-     * @param address Start address (must be page-aligned)
+     * @param address Start address (rejected if data would cross a page boundary)
      * @param data Data to write
      * @param size Number of bytes to write (max 256)
      * @return true if write successful
@@ -110,18 +326,180 @@ private:
      */
     bool eraseSector(uint32_t sectorNum);
     
+    /**
+     * Issue a sector erase without waiting for it (completion is checked
+     * like a deferred page program)
+     * @param sectorNum Sector number to erase
+     * @return true if the erase was started
+     */
+    bool startErase(uint32_t sectorNum);
+    
+    /**
+     * Account for a background erase once the device has finished it
+     */
+    void completeBackgroundErase();
+    
+    /**
+     * Move the pre-erased pool to where the next write will be placed
+     * Erased sectors already at that spot are kept
+     */
+    void placePool();
+    
+#if CAPTURE_SPILL
+    /**
+     * Check that no active file reaches into the spill region
+     * @return true if the region is free
+     */
+    bool spillRegionFree() const;
+    
+    /**
+     * Ready the next spill sector: blank-check it once after boot, erase
+     * it if it holds data
+     * @return true if an erase was started or a sector checked
+     */
+    bool prepareSpill();
+#endif
+    
     /**
      * Load directory from EEPROM
+     * Replays the directory journal, importing a legacy table once if no
+     * journal exists yet
      * @return true if directory loaded successfully
      */
     bool loadDirectory();
     
     /**
-     * Save directory to EEPROM
+     * Rebuild the directory from the newest journal sector
+     * @return true if a valid journal sector was found
+     */
+    bool replayJournal();
+    
+    /**
+     * Save full directory snapshot into the next journal sector (compaction)
+     * The new sector only becomes current once its header is written, so
+     * an interrupted snapshot leaves the previous one intact.
      * @return true if directory saved successfully
      */
     bool saveDirectory();
     
+    /**
+     * Append one directory entry change to the journal
+     * Costs one 32-byte program; compacts only when the sector is full
+     * @param entry Changed entry (must point into directory)
+     * @return true if the change is durable
+     */
+    bool logEntry(const FileEntry* entry);
+    
+    /**
+     * Log the erase counters of every wear group changed since last time
+     * @return true if the counters are durable
+     */
+    bool logWear();
+    
+    /**
+     * Append one record to the active journal sector
+     * Compacts instead when the sector is full (the snapshot then carries
+     * the change)
+     * @param record Record to append
+     * @return true if write successful
+     */
+    bool appendRecord(JournalRecord& record);
+    
+    /**
+     * Program one record into erased journal space
+     * @param address Flash address of the record
+     * @param record Record to write (checksum is filled in)
+     * @return true if write successful
+     */
+    bool writeRecord(uint32_t address, JournalRecord& record);
+    
+    /**
+     * Fill in a journal record for a directory entry
+     * @param slot Directory index
+     * @param record Record to fill
+     * @return true if the entry's name could be read
+     */
+    bool buildEntryRecord(size_t slot, JournalRecord& record) const;
+    
+    /**
+     * Set a resident directory entry from its on-flash form
+     * An active entry that fails validation is loaded as deleted
+     * @param slot Directory index
+     * @param type RECORD_ENTRY or RECORD_FILE
+     * @param status File status
+     * @param payload Entry fields
+     * @param record Location of the name (journal record index)
+     */
+    void applyEntry(size_t slot, uint8_t type, uint8_t status, const EntryPayload& payload,
+                    uint16_t record);
+    
+    /**
+     * Read the journal record an entry was last logged in
+     * @param slot Directory index (must not be a legacy entry)
+     * @param record Record to fill
+     * @return true if read successful
+     */
+    bool readEntryRecord(size_t slot, JournalRecord& record) const;
+    
+    /**
+     * Get the data checksum of a directory entry
+     * @param slot Directory index
+     * @param crc Receives the CRC-32
+     * @return true if the entry has one (files from before CRCs have none)
+     */
+    bool getStoredCrc(size_t slot, uint32_t& crc) const;
+    
+    /**
+     * Re-read a file's data and compare it with its stored checksum
+     * @param slot Directory index of an active entry
+     * @return true if the data matches or the entry has no checksum
+     */
+    bool verifyFileData(size_t slot);
+    
+    /**
+     * Page in the name of a directory entry
+     * @param slot Directory index
+     * @param name Buffer of MAX_FILENAME_LENGTH bytes
+     * @return true if read successful
+     */
+    bool readName(size_t slot, char* name) const;
+    
+    /**
+     * Hash a filename for the directory index (case-insensitive)
+     * @param name File name
+     * @return 8-bit hash
+     */
+    static uint8_t hashName(const char* name);
+    
+    /**
+     * Get the journal record index for a record position
+     * @param ringIndex Journal ring sector
+     * @param offset Byte offset of the record in that sector
+     * @return Record index
+     */
+    static uint16_t recordIndex(uint8_t ringIndex, uint16_t offset);
+    
+    /**
+     * Fill in a journal record for a group of erase counters
+     * @param group Wear group index (0..WEAR_RECORDS-1)
+     * @param record Record to fill
+     */
+    void buildWearRecord(size_t group, JournalRecord& record) const;
+    
+    /**
+     * Compute the checksum byte for a journal record
+     * @param record Record with all other fields filled in
+     * @return Checksum byte
+     */
+    static uint8_t recordChecksum(const JournalRecord& record);
+    
+    /**
+     * Get flash address of a journal ring sector
+     * @param ringIndex Ring index (0..JOURNAL_SECTORS-1)
+     * @return Byte address
+     */
+    static uint32_t journalAddress(uint8_t ringIndex);
+    
     /**
      * Find file entry by name
      * @param filename File name to find
@@ -138,17 +516,37 @@ private:
     
     /**
      * Allocate sectors for file
-     * @param sizeBytes File size in bytes
+     * Continues at the write cursor while its block is not markedly more
+     * worn than the least-worn free block, otherwise moves there.
+     * @param sizeBytes Expected file size in bytes, 0 if unknown
+     * @param regionEnd Receives the end of the free region allocated from
      * @return Starting sector number or 0 if allocation failed
      */
-    uint32_t allocateSectors(uint32_t sizeBytes);
+    uint32_t allocateSectors(uint32_t sizeBytes, uint32_t& regionEnd);
+    
+    /**
+     * Find the free sector run at or after a sector
+     * @param from First sector to consider
+     * @param runEnd Receives one past the last free sector of the run
+     * @return First free sector (DATA_END_SECTOR if none)
+     */
+    uint32_t nextFreeRun(uint32_t from, uint32_t& runEnd) const;
     
     /**
-     * Free sectors used by file
-     * @param startSector Starting sector number
-     * @param sizeBytes File size in bytes
+     * Find the least-worn start position with enough free runway
+     * Candidates are each free run's start and every wear block boundary
+     * inside it.
+     * @param sectorsNeeded Required runway in sectors
+     * @param regionEnd Receives the end of the chosen run
+     * @return Starting sector or 0 if nothing fits
      */
-    void freeSectors(uint32_t startSector, uint32_t sizeBytes);
+    uint32_t findLeastWornRegion(uint32_t sectorsNeeded, uint32_t& regionEnd) const;
+    
+    /**
+     * Get sectors held by active files
+     * @return Sector count
+     */
+    uint32_t getUsedSectors() const;
     
     /**
      * Get number of sectors needed for size
@@ -158,18 +556,59 @@ private:
     uint32_t getSectorCount(uint32_t sizeBytes) const;
     
     /**
-     * Validate file entry integrity
-     * @param entry File entry to validate
+     * Validate on-flash entry fields
+     * @param type RECORD_ENTRY (checks the size complement) or RECORD_FILE
+     * @param payload Entry fields
      * @return true if entry is valid
      */
-    bool validateFileEntry(const FileEntry* entry) const;
+    bool validateEntry(uint8_t type, const EntryPayload& payload) const;
     
     /**
-     * Defragment filesystem (compact deleted files)
-     * @return true if defragmentation successful
+     * Re-read an active entry's journal record and check it against RAM
+     * @param slot Directory index
+     * @return true if entry is valid
+     */
+    bool validateFileEntry(size_t slot) const;
+    
+    /**
+     * Drop the open streaming write without committing it
+     */
+    void discardWrite();
+    
+    /**
+     * Schedule full compaction after an allocation failure
+     * Files are moved by update() so no write waits on a reorganisation
+     * @return false (space is freed incrementally, not by this call)
      */
     bool defragment();
     
+    /**
+     * Measure free space in the data area
+     * @param freeSectors Receives the total number of free sectors
+     * @return Length of the largest free run in sectors
+     */
+    uint32_t getLargestFreeRun(uint32_t& freeSectors) const;
+    
+    /**
+     * Choose the next file to move into the lowest hole that holds it
+     * Prefers the file right above the hole, else the highest that fits;
+     * source and destination never overlap, so a crash mid-copy loses
+     * nothing
+     * @return true if a relocation was started
+     */
+    bool selectRelocation();
+    
+    /**
+     * Run one compaction step: start the next destination erase, or copy
+     * one sector, or commit the finished move
+     */
+    void stepRelocation();
+    
+    /**
+     * Abandon the relocation in progress (the source stays authoritative)
+     */
+    void cancelRelocation();
+    
 public:
     /**
      * Constructor
@@ -184,16 +623,27 @@ public:
     // IStoragePlugin interface implementation
     int initialize() override;
     bool isReady() const override;
+    int update() override;
     StorageType getType() const override;
     const __FlashStringHelper* getName() const override;
     uint32_t getAvailableSpace() const override;
     uint32_t getTotalSpace() const override;
     size_t writeFile(const char* filename, const uint8_t* data, size_t size) override;
+    bool openWrite(const char* filename, uint32_t sizeHint) override;
+    size_t append(const uint8_t* data, size_t size) override;
+    bool closeWrite() override;
+    bool isWriteOpen() const override;
+    bool isBusy() const override;
     size_t readFile(const char* filename, uint8_t* data, size_t maxSize) override;
+    bool openRead(const char* filename) override;
+    size_t readChunk(uint8_t* data, size_t maxSize) override;
+    bool seekRead(uint32_t offset) override;
+    void closeRead() override;
     bool deleteFile(const char* filename) override;
     bool fileExists(const char* filename) const override;
     uint32_t getFileSize(const char* filename) const override;
-    size_t listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles) const override;
+    size_t listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles,
+                     size_t first) const override;
     bool format() override;
     bool getStatus(char* statusBuffer, size_t bufferSize) const override;
     bool validate() const override;
@@ -209,7 +659,7 @@ public:
      * Get filesystem statistics
      * @param totalFiles_ Total number of files
      * @param deletedFiles_ Number of deleted files
-     * @param fragmentation Fragmentation percentage (0-100)
+     * @param fragmentation Free space outside the largest free run (0-100%)
      */
     void getFilesystemStats(uint32_t& totalFiles_, uint32_t& deletedFiles_, uint8_t& fragmentation) const;
     
@@ -221,10 +671,27 @@ public:
     
     /**
      * Perform filesystem check and repair
+     * Invalid entries are dropped; files whose data no longer matches their
+     * CRC are reported but kept
      * @return true if filesystem is healthy or repaired
      */
     bool fsck();
     
+    /**
+     * Enable/disable CRC checking of streamed reads
+     * When enabled, readChunk() returns 0 instead of the last chunk of a
+     * file whose data does not match its stored CRC. Off by default so
+     * bulk offload pays nothing.
+     * @param enabled true to verify
+     */
+    void setVerifyReads(bool enabled);
+    
+    /**
+     * Check if streamed reads are verified
+     * @return true if enabled
+     */
+    bool isVerifyReads() const;
+    
     /**
      * Get wear leveling statistics
      * @param minEraseCount Minimum erase count
@@ -232,6 +699,84 @@ public:
      * @param avgEraseCount Average erase count
      */
     void getWearStats(uint32_t& minEraseCount, uint32_t& maxEraseCount, uint32_t& avgEraseCount) const;
+    
+    /**
+     * Get depth of the pre-erased pool
+     * @return Sectors ready for the next write without an erase
+     */
+    uint32_t getPreErasedSectors() const;
+    
+    /**
+     * Check if compaction is moving a file
+     * @return true while a relocation is in progress
+     */
+    bool isCompacting() const;
+    
+#if HARDWARE_BENCHMARK
+    /**
+     * Time raw flash operations on free sectors ("bench" command)
+     * Each sector at the top of the first free run that holds them all is
+     * erased, programmed page by page with a pattern, read back and
+     * checked, then erased again; files, the journal and the spill region
+     * are not touched. Completion is polled without the 1ms delay of
+     * normal waits, so the times are the device's own.
+     * @param sectors Sectors to cycle
+     * @param erase Receives sector erase times
+     * @param program Receives page program times (transfer included)
+     * @param read Receives page read times
+     * @return STATUS_OK, STATUS_BUSY while a file, compaction or spill is
+     *         open, STATUS_TIMEOUT, or STATUS_ERROR if no free run fits or
+     *         the read-back differs
+     */
+    int benchmark(uint8_t sectors, BenchmarkStat& erase, BenchmarkStat& program,
+                  BenchmarkStat& read);
+#endif
+    
+#if CAPTURE_SPILL
+    /**
+     * Check if the spill region can take a burst
+     * Files written before the region was reserved may still occupy it;
+     * spilling waits until they are deleted or moved
+     * @return true if no file overlaps the region and its first sector is erased
+     */
+    bool spillAvailable() const;
+    
+    /**
+     * Program spilled bytes without waiting (no directory update)
+     * Writes at most up to the next page boundary, and only into sectors
+     * already erased; the program completes in the background
+     * @param data Bytes to spill
+     * @param size Number of bytes
+     * @return Number of bytes taken (0 while the device is busy or full)
+     */
+    size_t spillWrite(const uint8_t* data, size_t size);
+    
+    /**
+     * Read the oldest spilled bytes without releasing them
+     * @param data Buffer to fill
+     * @param maxSize Maximum bytes to read
+     * @return Number of bytes read
+     */
+    size_t spillPeek(uint8_t* data, size_t maxSize) const;
+    
+    /**
+     * Release bytes obtained through spillPeek()
+     * @param size Number of bytes handed on
+     */
+    void spillConsume(size_t size);
+    
+    /**
+     * Get spilled bytes not yet handed back
+     * @return Byte count
+     */
+    uint32_t getSpillPending() const;
+    
+    /**
+     * Drop the spill (pending bytes are lost) and queue the used sectors
+     * for a background erase
+     */
+    void endSpill();
+#endif
 };
 
 #endif // EEPROMSTORAGEPLUGIN_H
\ No newline at end of file
@@ -5,6 +5,9 @@
 #include "IComponent.h"
 #include "IStoragePlugin.h"
 #include "HardwareConfig.h"
+#include "PackBits.h"
+#include "Crc32.h"
+#include "SerialRetrieval.h"
 
 // Forward declarations for storage plugins
 class SDCardStoragePlugin;
@@ -16,7 +19,7 @@ class SerialStoragePlugin;
  * Implements plugin architecture for SD Card, EEPROM, and Serial transfer
  * Provides unified interface for file operations across storage types
  */
-class FileSystemManager : public IComponent {
+class FileSystemManager final : public IComponent {
 private:
     // Storage plugins
     SDCardStoragePlugin* sdCardPlugin;
@@ -27,13 +30,54 @@ private:
     IStoragePlugin* currentStorage;
     IStoragePlugin::StorageType currentStorageType;
     
+    // Storage holding the open streaming write (survives storage switches)
+    IStoragePlugin* writeStorage;
+    
+    // Storage holding the open streaming read
+    IStoragePlugin* readStorage;
+    
     // State management
     bool initialized;
     bool debugEnabled;
     
     // File operation buffers
     uint8_t transferBuffer[TRANSFER_BUFFER_SIZE];
-    char filenameBuffer[MAX_FILENAME_LENGTH];
+    char transferTarget[MAX_FILENAME_LENGTH];   // Destination name of a transfer
+    uint16_t nameCounter;           // Next CAP_nnnn number, 0 until seeded
+    
+    // Chunked copy engine: one transfer at a time, stepped by update()
+    enum TransferPhase : uint8_t {
+        TRANSFER_IDLE,
+        TRANSFER_COPY,              // Source -> destination
+        TRANSFER_VERIFY             // Reading the destination copy back
+    };
+    TransferPhase transferPhase;
+    IStoragePlugin* transferSource;
+    IStoragePlugin* transferDest;
+    bool transferIsMigration;       // Delete the source once verified
+    char transferName[MAX_FILENAME_LENGTH];
+    uint32_t transferSize;          // Source file size
+    uint32_t transferOffset;        // Source bytes read (copy) / copy bytes read back (verify)
+    uint32_t transferWritten;       // Bytes appended to the destination
+    bool transferDecode;            // Unpacking a packed file on the way
+    PackBitsDecoder decoder;
+    uint8_t packedBuffer[TRANSFER_PACKED_SIZE];
+    uint8_t packedPos;
+    uint8_t packedLength;
+    Crc32 sourceSum;                // CRC-32 of the bytes written
+    Crc32 verifySum;                // CRC-32 of the destination copy
+    uint8_t transferShown;          // Last progress percentage displayed
+    
+    // Tiered write-back (flash -> migration target)
+    bool tieredEnabled;
+    IStoragePlugin::StorageType migrationTarget;
+    uint32_t migrationFailedAt;     // millis() of the last failure, 0 if none
+    uint32_t filesMigrated;
+    uint32_t migrationFailures;
+    
+    // Windowed download over serial ("get"), reading through the
+    // streaming read handle
+    SerialRetrieval retrieval;
     
     // Statistics
     uint32_t totalFilesWritten;
@@ -72,6 +116,115 @@ private:
     bool generateUniqueFilename(const char* prefix, const char* extension, 
                                char* dest, size_t destSize);
     
+    /**
+     * Generate the next free prefix_nnnn name
+     * The counter starts past the highest number already stored, so names
+     * are not reused after a reboot without a valid clock
+     * @param prefix Filename prefix
+     * @param extension File extension (including dot)
+     * @param dest Buffer to store generated filename
+     * @param destSize Size of destination buffer
+     * @return true if a free name was found
+     */
+    bool generateCounterFilename(const char* prefix, const char* extension,
+                                 char* dest, size_t destSize);
+    
+    /**
+     * Check if a name is in use where a new file can land: the capture
+     * storage, the current storage and, when tiered, the migration target
+     * @param filename Name to check
+     * @return true if any of them holds the name
+     */
+    bool isNameTaken(const char* filename);
+    
+    /**
+     * Find the highest prefix_nnnn number on a storage
+     * @param storage Storage to scan
+     * @param prefix Filename prefix
+     * @return Highest number, 0 if none
+     */
+    static uint16_t findHighestCounter(const IStoragePlugin* storage, const char* prefix);
+    
+    /**
+     * Read a packed file from current storage, expanding it
+     * @param filename File name to read
+     * @param data Buffer for the unpacked data
+     * @param maxSize Maximum bytes to return
+     * @return Number of unpacked bytes, or 0 on error
+     */
+    size_t readPacked(const char* filename, uint8_t* data, size_t maxSize);
+    
+    /**
+     * Get the storage new files are written to
+     * @return Flash in tiered mode (if ready), else the current storage
+     */
+    IStoragePlugin* getCaptureStorage() const;
+    
+    /**
+     * Open both ends of a transfer
+     * @param filename File to move
+     * @param source Plugin holding the file
+     * @param dest Plugin receiving the copy
+     * @param migration true to delete the source once the copy verified
+     * @param target Name of the copy on dest
+     * @return true if the transfer was started
+     */
+    bool startTransfer(const char* filename, IStoragePlugin* source,
+                       IStoragePlugin* dest, bool migration, const char* target);
+    
+    /**
+     * Move chunks of the transfer in progress for up to TRANSFER_STEP_US,
+     * starting a migration when idle (called from update())
+     */
+    void stepTransfer();
+    
+    /**
+     * Check if the current transfer phase has moved all its data
+     * @return true when the copy or read-back is complete
+     */
+    bool isPhaseComplete() const;
+    
+    /**
+     * Move one chunk of the current phase (unpacking if required)
+     * @return false on a short read or write
+     */
+    bool moveChunk();
+    
+    /**
+     * Close the copy, start the read-back, or complete a verified transfer
+     */
+    void finishTransfer();
+    
+    /**
+     * Abandon the transfer in progress (the source is kept)
+     * @param failed true to report it (migration also backs off)
+     */
+    void abortTransfer(bool failed);
+    
+    /**
+     * Abandon the transfer if it holds a handle on a plugin
+     * Called before a foreground operation needs that plugin's handles
+     * @param plugin Plugin about to be used
+     */
+    void releaseTransfer(const IStoragePlugin* plugin);
+    
+    /**
+     * Get transfer progress (copy and read-back each count for half)
+     * @return Percentage 0-100
+     */
+    uint8_t transferPercent() const;
+    
+    /**
+     * Update the progress bar of a foreground copy
+     */
+    void showTransferProgress();
+    
+    /**
+     * Pick the next flash file and start migrating it
+     * @return true if a migration was started
+     */
+    bool startMigration();
+    
 public:
     /**
      * Constructor
@@ -152,8 +305,56 @@ public:
                         const uint8_t* data, size_t size,
                         char* generatedName = nullptr, size_t nameBufferSize = 0);
     
+    /**
+     * Open file on current storage for streaming write
+     * @param filename File name (will be validated)
+     * @param sizeHint Expected file size in bytes, 0 if unknown
+     * @return true if file opened
+     */
+    bool openWrite(const char* filename, uint32_t sizeHint = 0);
+    
+    /**
+     * Open file with auto-generated filename for streaming write
+     * @param prefix Filename prefix
+     * @param extension File extension
+     * @param generatedName Buffer to store generated filename (optional)
+     * @param nameBufferSize Size of filename buffer
+     * @param sizeHint Expected file size in bytes, 0 if unknown
+     * @return true if file opened
+     */
+    bool openWriteAuto(const char* prefix, const char* extension,
+                       char* generatedName = nullptr, size_t nameBufferSize = 0,
+                       uint32_t sizeHint = 0);
+    
+    /**
+     * Append data to the open streaming write
+     * @param data Data buffer to append
+     * @param size Number of bytes to append
+     * @return Number of bytes written, or 0 on error
+     */
+    size_t append(const uint8_t* data, size_t size);
+    
+    /**
+     * Close the open streaming write and commit the file
+     * @return true if file committed
+     */
+    bool closeWrite();
+    
+    /**
+     * Check if a streaming write is open
+     * @return true if a file is open for writing
+     */
+    bool isWriteOpen() const;
+    
+    /**
+     * Check if the storage holding the open write is still programming
+     * @return true if a new append would have to wait for the device
+     */
+    bool isWriteBusy() const;
+    
     /**
      * Read file from current storage
+     * Packed captures (PackBits header) are returned unpacked
      * @param filename File name to read
      * @param data Buffer to store read data
      * @param maxSize Maximum bytes to read
@@ -162,15 +363,157 @@ public:
     size_t readFile(const char* filename, uint8_t* data, size_t maxSize);
     
     /**
-     * Copy file between storage types
+     * Open file on current storage for streaming read
+     * @param filename File name (will be validated)
+     * @return true if file opened
+     */
+    bool openRead(const char* filename);
+    
+    /**
+     * Read the next chunk of the open streaming read
+     * Data is returned as stored (packed captures stay packed)
+     * @param data Buffer to store read data
+     * @param maxSize Maximum bytes to read
+     * @return Number of bytes read, 0 at end of file or on error
+     */
+    size_t readChunk(uint8_t* data, size_t maxSize);
+    
+    /**
+     * Move the position of the open streaming read
+     * @param offset Byte offset from the start of the file
+     * @return true if the next readChunk() starts at offset
+     */
+    bool seekRead(uint32_t offset);
+    
+    /**
+     * Close the open streaming read
+     */
+    void closeRead();
+    
+    /**
+     * Check if a streaming read is open
+     * @return true if a file is open for reading
+     */
+    bool isReadOpen() const;
+    
+    /**
+     * Start copying a file between storage types
+     * The copy runs in chunks from update(), shows progress on the display
+     * and is read back where the destination allows; the result is reported
+     * on serial and display
      * @param filename File name to copy
      * @param sourceType Source storage type
      * @param destType Destination storage type
-     * @return true if copy successful
+     * @return true if the copy was started
      */
     bool copyFile(const char* filename, IStoragePlugin::StorageType sourceType,
                   IStoragePlugin::StorageType destType);
     
+    /**
+     * Cancel the copy started by copyFile() (the partial copy is removed)
+     */
+    void cancelCopy();
+    
+    /**
+     * Check if a copy started by copyFile() is running
+     * @return true while copying
+     */
+    bool isCopying() const;
+    
+    /**
+     * Get progress of the running copy
+     * @return Percentage 0-100
+     */
+    uint8_t getCopyProgress() const;
+    
+    /**
+     * Enable/disable tiered write-back
+     * When enabled, new files are written to flash and migrated to the
+     * migration target in the background
+     * @param enabled Tiered mode state
+     */
+    void setTieredStorage(bool enabled);
+    
+    /**
+     * Check if tiered write-back is enabled
+     * @return true if new files are written to flash first
+     */
+    bool isTieredStorage() const;
+    
+    /**
+     * Set where tiered write-back migrates files to
+     * @param type STORAGE_SD_CARD or STORAGE_SERIAL
+     * @return true if the target was accepted
+     */
+    bool setMigrationTarget(IStoragePlugin::StorageType type);
+    
+    /**
+     * Get where tiered write-back migrates files to
+     * @return Migration target storage type
+     */
+    IStoragePlugin::StorageType getMigrationTarget() const;
+    
+    /**
+     * Check if a file is being migrated
+     * @return true while a migration is in progress
+     */
+    bool isMigrating() const;
+    
+    /**
+     * Get migration statistics
+     * @param migrated Files moved off flash
+     * @param failures Migrations that failed (and will be retried)
+     */
+    void getMigrationStatistics(uint32_t& migrated, uint32_t& failures) const;
+    
+    /**
+     * Select the serial transfer encoding
+     * @param enabled true for COBS-framed binary packets, false for hex lines
+     * @return false if no serial plugin or a serial transfer is running
+     */
+    bool setSerialBinary(bool enabled);
+    
+    /**
+     * Check the serial transfer encoding
+     * @return true if serial transfers use binary packets
+     */
+    bool isSerialBinary() const;
+    
+    /**
+     * Check if a file is being streamed over serial
+     * @return true while the serial plugin has a transfer open or a
+     *         retrieval is running
+     */
+    bool isSerialTransferring() const;
+    
+    /**
+     * Start a windowed download of a file on current storage
+     * @param filename File to send
+     * @param offset First byte to send (resume point)
+     * @return false if the file cannot be read or the link is in use
+     */
+    bool startRetrieval(const char* filename, uint32_t offset);
+    
+    /**
+     * Acknowledge retrieval packets up to and including sequence
+     * @param sequence Last packet the host received in order
+     * @return true if the packet was in flight
+     */
+    bool acknowledgeRetrieval(uint16_t sequence);
+    
+    /**
+     * Resend retrieval packets from sequence on
+     * @param sequence First packet the host is missing
+     * @return true if the packet was in flight
+     */
+    bool resendRetrieval(uint16_t sequence);
+    
+    /**
+     * Get the retrieval engine (state and statistics)
+     * @return Retrieval engine
+     */
+    const SerialRetrieval& getRetrieval() const;
+    
     /**
      * Delete file from current storage
      * @param filename File name to delete
@@ -196,9 +539,10 @@ public:
      * List files in current storage
      * @param filenames Array to store filenames
      * @param maxFiles Maximum number of files to list
+     * @param first Files to skip before the first one listed (paging)
      * @return Number of files found
      */
-    size_t listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles) const;
+    size_t listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles, size_t first) const;
     
     /**
      * Get storage space information
@@ -252,6 +596,15 @@ public:
      * @return Pointer to plugin or nullptr
      */
     IStoragePlugin* getPlugin(IStoragePlugin::StorageType type);
+    
+#if CAPTURE_SPILL
+    /**
+     * Get the flash a stalled capture can spill into
+     * @return EEPROM plugin, or nullptr if it is missing, is itself
+     *         receiving the capture, or its spill region is not ready
+     */
+    EEPROMStoragePlugin* getSpillStorage();
+#endif
 };
 
 #endif // FILESYSTEMMANAGER_H
\ No newline at end of file
@@ -0,0 +1,218 @@
+#ifndef FORMATDETECTOR_H
+#define FORMATDETECTOR_H
+
+#ifdef UNIT_TEST
+#include <stdint.h>
+#include <stddef.h>
+#else
+#include <Arduino.h>
+#endif
+
+// Bytes needed to classify every supported format (BMP compression field
+// ends at offset 34)
+#define FORMAT_DETECT_WINDOW    34
+
+/**
+ * FormatDetector - Incremental classifier for captured print data
+ * Looks only at the first FORMAT_DETECT_WINDOW bytes of a capture session
+ * as they stream past and recognises the TDS2024 output formats: BMP, RLE
+ * (BMP with RLE4/RLE8 compression), PCX, TIFF, EPS and Epson ESC/P or HP
+ * PCL escape streams. Once decided, further feed() calls cost one compare.
+ */
+class FormatDetector {
+public:
+    enum Format : uint8_t {
+        FORMAT_PENDING = 0,             // Not enough bytes seen yet
+        FORMAT_UNKNOWN,                 // Raw binary
+        FORMAT_BMP,                     // Windows bitmap, uncompressed
+        FORMAT_RLE,                     // Windows bitmap, RLE4/RLE8
+        FORMAT_PCX,                     // ZSoft PCX (RLE encoded)
+        FORMAT_TIFF,                    // TIFF, either byte order
+        FORMAT_EPS,                     // Encapsulated PostScript
+        FORMAT_ESCP,                    // Epson ESC/P printer stream
+        FORMAT_PCL                      // HP PCL / PJL printer stream
+    };
+
+private:
+    uint8_t header[FORMAT_DETECT_WINDOW];
+    uint8_t headerLength;
+    Format format;
+    uint32_t declaredSize;
+
+    static uint32_t readLE32(const uint8_t* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+               ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    /**
+     * Classify the bytes collected so far
+     * @param final true if no more bytes will arrive
+     * @return Detected format, or FORMAT_PENDING if more bytes are needed
+     */
+    Format classify(bool final) {
+        const uint8_t n = headerLength;
+        if (n < 2) {
+            return final ? FORMAT_UNKNOWN : FORMAT_PENDING;
+        }
+
+        const uint8_t b0 = header[0];
+        const uint8_t b1 = header[1];
+
+        // BMP/RLE: "BM", file size at 2, compression at 30
+        if (b0 == 'B' && b1 == 'M') {
+            if (n >= 6) {
+                declaredSize = readLE32(&header[2]);
+            }
+            if (n < 34) {
+                return final ? FORMAT_BMP : FORMAT_PENDING;
+            }
+            uint32_t compression = readLE32(&header[30]);
+            return (compression == 1 || compression == 2) ? FORMAT_RLE : FORMAT_BMP;
+        }
+
+        // Printer escape streams
+        if (b0 == 0x1B) {
+            if (b1 == '@') {
+                return FORMAT_ESCP;                  // ESC @ (printer init)
+            }
+            if (b1 == 'E' || b1 == '%' || b1 == '&' || b1 == '*' ||
+                b1 == '(' || b1 == ')') {
+                return FORMAT_PCL;                   // ESC E reset, UEL, parameterized
+            }
+            return FORMAT_UNKNOWN;
+        }
+
+        if (n < 4) {
+            return final ? FORMAT_UNKNOWN : FORMAT_PENDING;
+        }
+
+        const uint8_t b2 = header[2];
+        const uint8_t b3 = header[3];
+
+        // PCX: manufacturer 0x0A, version, encoding 1, bits per pixel
+        if (b0 == 0x0A && (b1 <= 5 && b1 != 1) && b2 == 1 &&
+            (b3 == 1 || b3 == 2 || b3 == 4 || b3 == 8)) {
+            return FORMAT_PCX;
+        }
+
+        // TIFF: "II*\0" or "MM\0*"
+        if ((b0 == 'I' && b1 == 'I' && b2 == 0x2A && b3 == 0x00) ||
+            (b0 == 'M' && b1 == 'M' && b2 == 0x00 && b3 == 0x2A)) {
+            return FORMAT_TIFF;
+        }
+
+        // EPS: "%!PS" text or DOS EPS binary header C5 D0 D3 C6
+        if ((b0 == '%' && b1 == '!' && b2 == 'P' && b3 == 'S') ||
+            (b0 == 0xC5 && b1 == 0xD0 && b2 == 0xD3 && b3 == 0xC6)) {
+            return FORMAT_EPS;
+        }
+
+        return FORMAT_UNKNOWN;
+    }
+
+public:
+    /**
+     * Constructor - starts a new detection
+     */
+    FormatDetector() : header(), headerLength(0), format(FORMAT_PENDING), declaredSize(0) {}
+
+    /**
+     * Start detection for a new capture session
+     */
+    void reset() {
+        headerLength = 0;
+        format = FORMAT_PENDING;
+        declaredSize = 0;
+    }
+
+    /**
+     * Inspect the next bytes of the session
+     * @param data Session data in arrival order
+     * @param size Number of bytes
+     * @return Current verdict (FORMAT_PENDING until decided)
+     */
+    Format feed(const uint8_t* data, size_t size) {
+        if (format != FORMAT_PENDING || !data) {
+            return format;
+        }
+
+        while (size > 0 && headerLength < FORMAT_DETECT_WINDOW) {
+            header[headerLength++] = *data++;
+            size--;
+        }
+
+        format = classify(headerLength >= FORMAT_DETECT_WINDOW);
+        return format;
+    }
+
+    /**
+     * Decide with whatever was seen (session ended early)
+     * @return Final format, never FORMAT_PENDING
+     */
+    Format finish() {
+        if (format == FORMAT_PENDING) {
+            format = classify(true);
+        }
+        return format;
+    }
+
+    /**
+     * Check whether the verdict is in
+     * @return true once the format is known
+     */
+    bool isDecided() const {
+        return format != FORMAT_PENDING;
+    }
+
+    /**
+     * Get detected format
+     * @return Format (FORMAT_PENDING until decided)
+     */
+    Format getFormat() const {
+        return format;
+    }
+
+    /**
+     * Get file size declared in the header (BMP/RLE only)
+     * @return Declared size in bytes, 0 if unknown
+     */
+    uint32_t getDeclaredSize() const {
+        return declaredSize;
+    }
+
+    /**
+     * Check if the payload is already compressed (not worth compressing)
+     * @return true for RLE and PCX
+     */
+    bool isCompressed() const {
+        return format == FORMAT_RLE || format == FORMAT_PCX;
+    }
+
+    /**
+     * Get file extension for a format
+     * @param f Format
+     * @return Extension including the dot (".BIN" when unknown)
+     */
+    static const char* extensionFor(Format f) {
+        switch (f) {
+            case FORMAT_BMP:  return ".BMP";
+            case FORMAT_RLE:  return ".RLE";
+            case FORMAT_PCX:  return ".PCX";
+            case FORMAT_TIFF: return ".TIF";
+            case FORMAT_EPS:  return ".EPS";
+            case FORMAT_ESCP: return ".PRN";
+            case FORMAT_PCL:  return ".PCL";
+            default:          return ".BIN";
+        }
+    }
+
+    /**
+     * Get file extension for the detected format
+     * @return Extension including the dot
+     */
+    const char* getExtension() const {
+        return extensionFor(format);
+    }
+};
+
+#endif // FORMATDETECTOR_H
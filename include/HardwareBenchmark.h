@@ -0,0 +1,42 @@
+#ifndef HARDWAREBENCHMARK_H
+#define HARDWAREBENCHMARK_H
+
+#include "HardwareConfig.h"
+#include "TaskProfiler.h"
+
+namespace HardwareBenchmark {
+
+enum Test : uint8_t {
+    TEST_ALL = 0,       // Everything below, the loop window last
+    TEST_FLASH,         // W25Q128 sector erase, page program, page read
+    TEST_SD,            // Sequential SD writes of BENCH_CHUNK_SIZE appends
+    TEST_SERIAL,        // Serial TX raw, as hex lines and as binary packets
+    TEST_LCD,           // Full-frame LCD redraws
+    TEST_LOOP           // Main loop pass times over BENCH_LOOP_MS
+};
+
+/**
+ * Run a benchmark and print its rows
+ * The blocking tests take a few seconds in all; data strobed meanwhile
+ * waits behind BUSY. The loop test only opens a sampling window, and its
+ * table prints from the loop once the window closes.
+ * @param test Benchmark to run
+ * @return false if storage or capture is in use, or a test could not run
+ */
+bool run(Test test);
+
+/**
+ * Check if the main loop is being sampled
+ * @return true while a loop window is open
+ */
+bool isTimingLoop();
+
+/**
+ * Record one main loop pass (call after the pass while isTimingLoop())
+ * @param start Mark taken before the pass
+ */
+void recordLoopPass(const TaskProfiler::Mark& start);
+
+} // namespace HardwareBenchmark
+
+#endif // HARDWAREBENCHMARK_H
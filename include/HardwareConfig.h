@@ -3,6 +3,20 @@
 
 #include <Arduino.h>
 
+// External SRAM on the ATmega2560 XMEM interface
+// 1 = the capture ring (and optionally the EEPROM page buffer) lives in
+//     external SRAM. The interface takes over PORTA (AD0-AD7), PORTC
+//     (A8-A15) and PG0-PG2 (/WR, /RD, ALE), so the LPT data bus moves to
+//     PORTK and the control, LED and SD lines on those ports move to the
+//     XMEM pin map below (checked in LptPinMap.h)
+// 0 = everything in internal SRAM, default wiring
+#ifndef XMEM_CAPTURE_BUFFER
+#define XMEM_CAPTURE_BUFFER     0
+#endif
+#if XMEM_CAPTURE_BUFFER && !defined(LPT_DATA_ON_PORTK)
+#define LPT_DATA_ON_PORTK
+#endif
+
 // Hardware Pin Assignments
 // LCD Shield Interface
 #define LCD_RESET_PIN           8
@@ -16,49 +30,222 @@
 // Storage & Memory Interface
 #define SD_CS_PIN               10
 #define EEPROM_CS_PIN           3
+#if XMEM_CAPTURE_BUFFER
+#define SD_DETECT_PIN           38  // Active LOW (PD7)
+#define SD_WRITE_PROTECT_PIN    19  // Active HIGH (PD2)
+#else
 #define SD_DETECT_PIN           36  // Active LOW
 #define SD_WRITE_PROTECT_PIN    34  // Active HIGH
+#endif
 
 // SPI Bus Configuration
 // ICSP pins are used for SPI (automatically handled by SPI library)
-#define SPI_CLOCK_SPEED         4000000  // 4MHz for W25Q128 compatibility
+#define SPI_CLOCK_SPEED         8000000  // F_CPU/2, the AVR maximum (W25Q128 is rated far higher)
+
+// SPI flash transport
+// 1 = SPDR register burst loop for page programs and reads
+// 0 = portable SPI.transfer() per byte
+#ifndef EEPROM_SPI_BURST
+#define EEPROM_SPI_BURST        1
+#endif
 
 // Real-Time Clock Interface (I2C)
 // SDA and SCL pins are automatically handled by Wire library
 
 // Status LEDs
 #define HEARTBEAT_LED_PIN       13
+#if XMEM_CAPTURE_BUFFER
+#define LPT_ACTIVITY_LED_PIN    55  // A1 (PF1)
+#define WRITE_ACTIVITY_LED_PIN  56  // A2 (PF2)
+#else
 #define LPT_ACTIVITY_LED_PIN    30
 #define WRITE_ACTIVITY_LED_PIN  32
+#endif
 
 // IEEE-1284 Parallel Port Interface
 #define LPT_STROBE_PIN          18  // /Strobe - Interrupt pin
-#define LPT_DATA0_PIN           25  // D0
-#define LPT_DATA1_PIN           27  // D1
-#define LPT_DATA2_PIN           29  // D2
-#define LPT_DATA3_PIN           31  // D3
-#define LPT_DATA4_PIN           33  // D4
-#define LPT_DATA5_PIN           35  // D5
-#define LPT_DATA6_PIN           37  // D6
-#define LPT_DATA7_PIN           39  // D7
-#define LPT_ACKNOWLEDGE_PIN     41  // /Acknowledge - Output
+#ifdef LPT_DATA_ON_PORTK
+// Alternative wiring: DB25 pins 2-9 to A8-A15 (PK0-PK7), byte is one PINK read
+#define LPT_DATA0_PIN           62  // D0 (A8)
+#define LPT_DATA1_PIN           63  // D1 (A9)
+#define LPT_DATA2_PIN           64  // D2 (A10)
+#define LPT_DATA3_PIN           65  // D3 (A11)
+#define LPT_DATA4_PIN           66  // D4 (A12)
+#define LPT_DATA5_PIN           67  // D5 (A13)
+#define LPT_DATA6_PIN           68  // D6 (A14)
+#define LPT_DATA7_PIN           69  // D7 (A15)
+#else
+// Default wiring: spans PORTA/PORTC/PORTG, byte is three reads plus bit gather
+#define LPT_DATA0_PIN           25  // D0 (PA3)
+#define LPT_DATA1_PIN           27  // D1 (PA5)
+#define LPT_DATA2_PIN           29  // D2 (PA7)
+#define LPT_DATA3_PIN           31  // D3 (PC6)
+#define LPT_DATA4_PIN           33  // D4 (PC4)
+#define LPT_DATA5_PIN           35  // D5 (PC2)
+#define LPT_DATA6_PIN           37  // D6 (PC0)
+#define LPT_DATA7_PIN           39  // D7 (PG2)
+#endif
 #define LPT_BUSY_PIN            43  // Busy - Output
 #define LPT_PAPER_OUT_PIN       45  // Paper Out - Output (forced low)
 #define LPT_SELECT_PIN          47  // Select - Output (forced high)
+#if XMEM_CAPTURE_BUFFER
+// XMEM wiring: the lines on PORTA/PG0 move to free PORTL pins
+#define LPT_ACKNOWLEDGE_PIN     42  // /Acknowledge - Output (PL7)
+#define LPT_AUTO_FEED_PIN       44  // /Auto Feed - Input (PL5)
+#define LPT_ERROR_PIN           46  // /Error - Output (PL3)
+#define LPT_INITIALIZE_PIN      48  // /Initialize - Input (PL1)
+#define LPT_SELECT_IN_PIN       49  // /Select In - Input (PL0)
+#else
+#define LPT_ACKNOWLEDGE_PIN     41  // /Acknowledge - Output
 #define LPT_AUTO_FEED_PIN       22  // /Auto Feed - Input
 #define LPT_ERROR_PIN           24  // /Error - Output
 #define LPT_INITIALIZE_PIN      26  // /Initialize - Input
 #define LPT_SELECT_IN_PIN       28  // /Select In - Input
+#endif
 
 // Interrupt Configuration
 #define LPT_STROBE_INTERRUPT    5   // Pin 18 = INT5 on Mega 2560
 
+// LPT capture I/O mode
+// 1 = direct PINx/PORTx register access via LptPinMap.h (fast ISR)
+// 0 = portable digitalRead()/digitalWrite() path
+#ifndef LPT_DIRECT_PORT_IO
+#define LPT_DIRECT_PORT_IO      1
+#endif
+
 // System Constants - EMERGENCY MEMORY REDUCTION
+#if XMEM_CAPTURE_BUFFER
+// External capture ring: a whole screenshot fits, storage never throttles
+// the port. 0x8000-0xFFFF is the upper 32 KB, decoded by a 62256 selected
+// with A15 as well as by 56 KB boards
+#define RING_BUFFER_SIZE        32768   // Largest RingBuffer (16-bit indices)
+#define XMEM_RING_ADDRESS       0x8000
+#define XMEM_WAIT_STATES        0       // SRW11:SRW10, 0 suits 55ns SRAM at 16MHz
+// 1 = EEPROM page buffer right below the ring (needs SRAM decoded there)
+#ifndef XMEM_EEPROM_PAGE_BUFFER
+#define XMEM_EEPROM_PAGE_BUFFER 0
+#endif
+#define XMEM_PAGE_BUFFER_ADDRESS (XMEM_RING_ADDRESS - EEPROM_PAGE_SIZE)
+#else
+#ifndef RING_BUFFER_SIZE
 #define RING_BUFFER_SIZE        16   // EMERGENCY: Absolute minimum
-#define COMMAND_BUFFER_SIZE     2    // EMERGENCY: 2 bytes only
+#endif
+#endif
+#define COMMAND_BUFFER_SIZE     32   // Debug command line
 #define EEPROM_BUFFER_SIZE      1    // EMERGENCY: 1 byte only
-#define TRANSFER_BUFFER_SIZE    2    // EMERGENCY: 2 bytes only
-#define MAX_FILENAME_LENGTH     2    // EMERGENCY: 2 chars only
+#define TRANSFER_BUFFER_SIZE    64   // Copy engine chunk (one serial hex line)
+#define TRANSFER_STEP_US        2000 // Copy engine time budget per update()
+#define TRANSFER_PACKED_SIZE    16   // Packed bytes staged per unpack step
+#define MAX_FILENAME_LENGTH     13   // 8.3 name + terminator (CAP_0001.BIN)
+
+// Scheduler (Scheduler.h): task periods in ms, 0 = every pass. The capture
+// drain also runs between any two tasks once the ring holds this many bytes
+#define SCHEDULER_MAX_TASKS         12
+#ifndef SCHEDULER_DRAIN_THRESHOLD
+#define SCHEDULER_DRAIN_THRESHOLD   LPT_FLOW_LOW_WATERMARK
+#endif
+#ifndef SCHEDULER_DISPLAY_MS
+#define SCHEDULER_DISPLAY_MS        20      // Button sampling and LCD
+#endif
+#define SCHEDULER_LED_MS            50
+#ifndef SCHEDULER_STORAGE_MS
+#define SCHEDULER_STORAGE_MS        0       // Copies, erases and retrieval step every pass
+#endif
+#define SCHEDULER_IDLE_MS           1000    // Components with nothing periodic to do
+
+// LCD refresh: changed cells are sent from a shadow frame, at most this many
+// bus operations (a character or a cursor move, ~100us each with
+// LiquidCrystal) per display tick
+#ifndef LCD_BUS_OPS_PER_UPDATE
+#define LCD_BUS_OPS_PER_UPDATE      4
+#endif
+
+// Idle sleep: with no job, transfer or command in flight, the loop sleeps
+// in SLEEP_MODE_IDLE after each pass until the next interrupt (/Strobe,
+// UART, or the 1ms Timer0 tick); timers and the port handshake keep running
+// 1 = sleep between passes while quiet (default)
+// 0 = spin
+#ifndef IDLE_SLEEP
+#define IDLE_SLEEP                  1
+#endif
+
+// DS1307 real-time clock: read once at boot and then once a minute (never
+// while the port is busy), with millis() filling the time in between
+#define RTC_I2C_ADDRESS         0x68
+#define RTC_SYNC_INTERVAL_MS    60000
+#define RTC_SYNC_QUIET_MS       1000    // Port idle time before an I2C read
+
+// Runtime configuration (ConfigurationManager.h): a versioned record in the
+// AVR's internal EEPROM overrides the defaults below at boot. "config"
+// edits it over serial; holding SELECT during reset ignores it
+#define CONFIG_EEPROM_ADDRESS   0       // Offset in the 4KB internal EEPROM
+#define CONFIG_MAGIC            0x4346  // "CF"
+#define CONFIG_VERSION          1
+
+// Capture Session Configuration
+#define CAPTURE_IDLE_TIMEOUT    2000    // ms without data that ends a print job
+#define CAPTURE_FILE_PREFIX     "CAP"   // Capture file name prefix
+#define CAPTURE_FILE_EXTENSION  ".BIN"  // Capture file extension
+
+// Pass-through: forward captured bytes straight to the serial port instead
+// of storing them (toggled at runtime with "passthru on|off")
+#ifndef CAPTURE_PASS_THROUGH
+#define CAPTURE_PASS_THROUGH    0
+#endif
+
+// Capture block size: storage is fed whole blocks of this many bytes
+// (EEPROM_PAGE_SIZE for SPI flash, 512 for SD). Two blocks are allocated
+// so one fills while the other is being programmed.
+#ifndef CAPTURE_BLOCK_SIZE
+#define CAPTURE_BLOCK_SIZE      EEPROM_PAGE_SIZE
+#endif
+
+// Capture compression: captures whose format is not already compressed are
+// PackBits-encoded on their way into the block pipeline (see PackBits.h)
+#ifndef CAPTURE_COMPRESSION
+#define CAPTURE_COMPRESSION     1
+#endif
+
+// Capture spill: when the block pipeline stalls and the ring passes
+// CAPTURE_SPILL_WATERMARK, the bytes go straight into a reserved, pre-erased
+// region of the SPI flash (below the directory journal, no directory
+// records) and are fed back into the job in order once storage catches up.
+// 1 = reserve the region and spill (SD captures only)
+// 0 = bytes wait in the ring under BUSY flow control (default)
+#ifndef CAPTURE_SPILL
+#define CAPTURE_SPILL           0
+#endif
+#define CAPTURE_SPILL_SECTORS   16      // 64KB reserved (at most 32)
+#ifndef CAPTURE_SPILL_WATERMARK
+#define CAPTURE_SPILL_WATERMARK (RING_BUFFER_SIZE / 2)
+#endif
+#define CAPTURE_SPILL_CHUNK     64      // Bytes fed back per read
+
+// SD card writer
+#define SD_BLOCK_SIZE           512
+#define SD_CARD_POLL_INTERVAL   250     // ms between card detect/write protect reads
+// Card bring-up runs from update(): wait for card detect, settle, then probe
+// with CMD0 until the card answers; only then is SD.begin() called
+#define SD_INIT_SETTLE_MS       250     // Insertion debounce / power-up time
+#define SD_PROBE_INTERVAL       50      // ms between CMD0 probes
+#define SD_PROBE_CLOCK          250000  // SPI clock for the probe (card not yet in SPI mode)
+#ifndef SD_INIT_TIMEOUT
+#define SD_INIT_TIMEOUT         2000    // ms from insertion before bring-up gives up
+#endif
+// An open capture file commits its FAT and directory entry every this many
+// blocks (and at close) instead of on every write
+#ifndef SD_SYNC_INTERVAL_BLOCKS
+#define SD_SYNC_INTERVAL_BLOCKS 64      // 32KB
+#endif
+
+// Tiered write-back: captures land on the W25Q128 (pre-erased, lowest
+// latency) and FileSystemManager's copy engine migrates finished files to the
+// migration target while no capture is open, deleting the flash copy once
+// the target holds a verified copy
+#ifndef STORAGE_TIERED
+#define STORAGE_TIERED          1
+#endif
+#define MIGRATE_RETRY_MS        5000    // Back-off after a failed migration
 
 // Timing Constants (microseconds)
 #define ACK_PULSE_WIDTH         20
@@ -67,6 +254,73 @@
 #define MODERATE_FLOW_DELAY     25
 #define CRITICAL_FLOW_DELAY     50
 
+// LPT handshake generation
+// 1 = Timer3 output-compare ISR produces the ACK pulse and releases BUSY,
+//     the strobe ISR only latches data and arms the timer
+// 0 = legacy delayMicroseconds() handshake inside the strobe ISR
+#ifndef LPT_TIMER_HANDSHAKE
+#define LPT_TIMER_HANDSHAKE     1
+#endif
+#define LPT_TIMER_TICKS_PER_US  2       // Timer3 at F_CPU/8 = 0.5μs per tick
+#define LPT_MAX_HANDSHAKE_US    30000   // Upper bound for configurable delays
+#define LPT_MIN_ARM_TICKS       4       // Minimum compare lead time (2μs)
+
+// LPT flow control (BUSY back-pressure)
+// 1 = ISR holds BUSY high once the ring passes the high watermark; the main
+//     loop releases it after draining below the low watermark
+// 0 = bytes arriving at a full ring are dropped
+#ifndef LPT_FLOW_CONTROL
+#define LPT_FLOW_CONTROL        1
+#endif
+#ifndef LPT_FLOW_HIGH_WATERMARK
+#define LPT_FLOW_HIGH_WATERMARK ((RING_BUFFER_SIZE * 3) / 4)
+#endif
+#ifndef LPT_FLOW_LOW_WATERMARK
+#define LPT_FLOW_LOW_WATERMARK  (RING_BUFFER_SIZE / 4)
+#endif
+
+// LPT timing histograms (ISR execution time, inter-strobe gap)
+// 1 = Timer1 runs free at F_CPU/8 and the strobe ISR records log2 buckets
+// 0 = compiled out: no Timer1, no ISR cost, no RAM
+#ifndef LPT_ISR_HISTOGRAM
+#define LPT_ISR_HISTOGRAM       0
+#endif
+#define LPT_HIST_TICKS_PER_US   2       // Timer1 at F_CPU/8 = 0.5μs per tick
+#define LPT_HIST_WRAP_MS        30      // Gaps past this overflow Timer1 (32.8ms)
+
+// Task and component profiler ("prof" command)
+// 1 = Timer1 runs free at F_CPU/8 and every scheduled task, updateAll()
+//     component and initialize() call records calls/total/max/last time
+// 0 = compiled out: no timing reads, no RAM
+#ifndef TASK_PROFILER
+#define TASK_PROFILER           0
+#endif
+
+// On-device benchmarks ("bench" command)
+// 1 = W25Q128 read/program/erase, SD write, serial encodings, LCD redraw
+//     and main loop pass times against Timer1; the loop window keeps one
+//     histogram (about 50 bytes of RAM); pio run -e megaatmega2560_bench
+// 0 = compiled out
+#ifndef HARDWARE_BENCHMARK
+#define HARDWARE_BENCHMARK      0
+#endif
+#define BENCH_FLASH_SECTORS     4       // Free sectors cycled: erase, program, read, erase
+#define BENCH_TRANSFER_BYTES    4096    // Bytes per SD and serial run
+#define BENCH_CHUNK_SIZE        64      // Bytes per append (stack buffer)
+#define BENCH_LCD_REDRAWS       8       // Full-frame LCD redraws timed
+#define BENCH_LOOP_MS           5000    // Main loop sampling window
+
+// IEEE-1284 negotiation (ECP forward channel)
+// 1 = main loop answers 1284 negotiation on /SelectIn + /AutoFeed and, when
+//     the host requests ECP, switches to the ECP forward handshake (BUSY
+//     follows /Strobe, no ACK pulse); other mode requests are declined
+// 0 = compatibility (SPP) mode only
+#ifndef LPT_IEEE1284_NEGOTIATION
+#define LPT_IEEE1284_NEGOTIATION 0
+#endif
+#define LPT_1284_REQUEST_ECP    0x10    // Extensibility byte: ECP mode
+#define LPT_1284_TIMEOUT_MS     35      // Host gives up on a negotiation step
+
 // Memory Limits
 #define TOTAL_RAM_SIZE          8192
 #define AVAILABLE_RAM_SIZE      6144    // After stack/heap
@@ -81,6 +335,23 @@
 #define SERIAL_BAUD_RATE        115200
 #define SERIAL_DATA_BITS        8
 #define SERIAL_STOP_BITS        1
+#define SERIAL_MAX_BAUD_RATE    1000000 // U2X at 16MHz: 250k, 500k and 1M are exact
+#define SERIAL_BAUD_MAX_ERROR   2       // Percent; rates further off are refused
+#define SERIAL_BAUD_CONFIRM_MS  2000    // Host must confirm a new rate in time
+#define SERIAL_TEXT_QUEUE_SIZE  192     // Queued status text (a status line and a warning)
+
+// Serial transfers: hex lines (readable in a terminal) or COBS-framed binary
+// packets with a sequence number and CRC-32 each (tools/serial_receive.py)
+#ifndef SERIAL_TRANSFER_BINARY
+#define SERIAL_TRANSFER_BINARY  0
+#endif
+#define SERIAL_FRAME_PAYLOAD    64      // Data bytes per binary packet
+
+// Bulk retrieval ("get"): packets in flight before the host must ack, and
+// how long the oldest may go unacknowledged before it is sent again
+#define SERIAL_RETRIEVE_WINDOW      16      // 1KB in flight at 64-byte packets
+#define SERIAL_RETRIEVE_TIMEOUT_MS  1000
+#define SERIAL_RETRIEVE_RETRIES     8       // Timeouts in a row before giving up
 
 // Debug Configuration
 #define DEBUG_ENABLED           1
@@ -95,6 +366,18 @@
 #define BUTTON_NONE_VALUE       1023
 #define BUTTON_TOLERANCE        30
 
+// Button sampling: the ADC converts A0 on every Timer0 overflow (~976Hz,
+// no extra timer) and its ISR keeps every 20th result (~50Hz), committing
+// a button after 2 equal readings in a row. readButton() is then a plain
+// read; nothing else may call analogRead() while sampling runs
+// 1 = ADC-complete interrupt (default)
+// 0 = analogRead() from the display task
+#ifndef BUTTON_ADC_INTERRUPT
+#define BUTTON_ADC_INTERRUPT        1
+#endif
+#define BUTTON_SAMPLE_DIVIDER       20
+#define BUTTON_DEBOUNCE_SAMPLES     2
+
 // Component Status Codes
 #define STATUS_OK               0
 #define STATUS_ERROR            1
@@ -4,101 +4,104 @@
 #include <Arduino.h>
 #include "IComponent.h"
 #include "HardwareConfig.h"
+#include "LedPattern.h"
 
 /**
- * HeartbeatLEDManager - Visual system status (placeholder)
- * Will implement heartbeat LED with SOS error patterns
+ * HeartbeatLEDManager - Status LED pattern sequencer
+ * Drives the heartbeat, LPT activity and write activity LEDs from PROGMEM
+ * patterns advanced by update(), never with delay(). Patterns are layered:
+ * each LED shows the highest priority layer bound to it that is playing
+ * (layers are listed in priority order), and is off when none is.
+ * Capture, overflow and writing layers follow the parallel port and file
+ * system on their own; SOS is started by triggerSOSPattern().
  */
-class HeartbeatLEDManager : public IComponent {
+class HeartbeatLEDManager final : public IComponent {
+public:
+    enum Layer : uint8_t {
+        LAYER_SOS = 0,          // Heartbeat LED: ...---... once
+        LAYER_HEARTBEAT,        // Heartbeat LED: slow blink
+        LAYER_OVERFLOW,         // LPT LED: fast flicker after ring overflow
+        LAYER_CAPTURE,          // LPT LED: solid while the ring holds data
+        LAYER_WRITING,          // Write LED: blink while a file is open
+        LAYER_COUNT
+    };
+    
 private:
     bool initialized;
     bool debugEnabled;
-    bool sosMode;
-    uint32_t lastBlinkTime;
-    bool ledState;
     
-public:
-    HeartbeatLEDManager() : initialized(false), debugEnabled(false), 
-                           sosMode(false), lastBlinkTime(0), ledState(false) {}
-    ~HeartbeatLEDManager() override = default;
+    LedPatternPlayer layers[LAYER_COUNT];
+    uint8_t ledLevels;              // Bit per LED as last written
+    bool ledLevelsValid;            // false forces the next write
+    uint32_t lastOverflowCount;     // Overflows already shown
     
-    // IComponent interface implementation
-    int initialize() override { 
-        pinMode(HEARTBEAT_LED_PIN, OUTPUT);
-        digitalWrite(HEARTBEAT_LED_PIN, LOW);
-        initialized = true; 
-        return STATUS_OK; 
-    }
+    /**
+     * Start or stop a layer to follow a condition (no restart while held)
+     * @param layer Layer
+     * @param active Condition
+     * @param now Current millis()
+     */
+    void holdLayer(Layer layer, bool active, uint32_t now);
     
-    int update() override { 
-        if (!initialized) return STATUS_NOT_INITIALIZED;
-        
-        uint32_t currentTime = millis();
-        if (currentTime - lastBlinkTime >= HEARTBEAT_INTERVAL) {
-            ledState = !ledState;
-            digitalWrite(HEARTBEAT_LED_PIN, ledState ? HIGH : LOW);
-            lastBlinkTime = currentTime;
-        }
-        
-        return STATUS_OK; 
-    }
+    /**
+     * Get the PROGMEM pattern of a layer
+     * @param layer Layer
+     * @return Pattern steps
+     */
+    static const uint8_t* getLayerPattern(Layer layer);
     
-    int getStatus() const override { 
-        return initialized ? STATUS_OK : STATUS_NOT_INITIALIZED; 
-    }
+    /**
+     * Get the LED a layer is bound to
+     * @param layer Layer
+     * @return LED index (0 heartbeat, 1 LPT, 2 write)
+     */
+    static uint8_t getLayerLed(Layer layer);
     
-    const __FlashStringHelper* getName() const override {
-        return F("HeartbeatLEDManager");
-    }
+    /**
+     * Check if a layer repeats until stopped
+     * @param layer Layer
+     * @return true for looping layers
+     */
+    static bool isLayerLooping(Layer layer);
     
-    bool validate() const override { 
-        return initialized; 
-    }
+public:
+    HeartbeatLEDManager();
+    ~HeartbeatLEDManager() override = default;
     
-    int reset() override { 
-        sosMode = false;
-        ledState = false;
-        digitalWrite(HEARTBEAT_LED_PIN, LOW);
-        initialized = false; 
-        return initialize(); 
-    }
+    // IComponent interface implementation
+    int initialize() override;
+    int update() override;
+    int getStatus() const override;
+    const __FlashStringHelper* getName() const override;
+    bool validate() const override;
+    int reset() override;
+    size_t getMemoryUsage() const override;
+    void setDebugEnabled(bool enabled) override;
+    bool isDebugEnabled() const override;
     
-    size_t getMemoryUsage() const override { 
-        return sizeof(*this); 
-    }
+    /**
+     * Play a layer's pattern from the start
+     * @param layer Layer
+     */
+    void startPattern(Layer layer);
     
-    void setDebugEnabled(bool enabled) override { 
-        debugEnabled = enabled; 
-    }
+    /**
+     * Stop a layer
+     * @param layer Layer
+     */
+    void stopPattern(Layer layer);
     
-    bool isDebugEnabled() const override { 
-        return debugEnabled; 
-    }
+    /**
+     * Check if a layer is playing
+     * @param layer Layer
+     * @return true if active
+     */
+    bool isPatternActive(Layer layer) const;
     
-    void triggerSOSPattern() {
-        sosMode = true;
-        // Simple SOS indication for now
-        for (int i = 0; i < 3; i++) {
-            digitalWrite(HEARTBEAT_LED_PIN, HIGH);
-            delay(100);
-            digitalWrite(HEARTBEAT_LED_PIN, LOW);
-            delay(100);
-        }
-        delay(300);
-        for (int i = 0; i < 3; i++) {
-            digitalWrite(HEARTBEAT_LED_PIN, HIGH);
-            delay(300);
-            digitalWrite(HEARTBEAT_LED_PIN, LOW);
-            delay(100);
-        }
-        delay(300);
-        for (int i = 0; i < 3; i++) {
-            digitalWrite(HEARTBEAT_LED_PIN, HIGH);
-            delay(100);
-            digitalWrite(HEARTBEAT_LED_PIN, LOW);
-            delay(100);
-        }
-    }
+    /**
+     * Show SOS on the heartbeat LED (returns at once; update() plays it)
+     */
+    void triggerSOSPattern();
 };
 
-#endif // HEARTBEATLEDMANAGER_H
\ No newline at end of file
+#endif // HEARTBEATLEDMANAGER_H
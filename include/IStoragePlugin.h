@@ -31,6 +31,14 @@ public:
      */
     virtual bool isReady() const = 0;
     
+    /**
+     * Run background maintenance (call from main loop)
+     * Must return quickly: long device operations are started here and
+     * polled on later calls, never waited on
+     * @return STATUS_OK on success, error code on failure
+     */
+    virtual int update() = 0;
+    
     /**
      * Get storage type
      * @return Storage type identifier
@@ -64,6 +72,43 @@ public:
      */
     virtual size_t writeFile(const char* filename, const uint8_t* data, size_t size) = 0;
     
+    /**
+     * Open file for streaming write (one open write per plugin)
+     * An existing file with the same name is replaced on success.
+     * @param filename File name
+     * @param sizeHint Expected file size in bytes, 0 if unknown
+     * @return true if file opened for writing
+     */
+    virtual bool openWrite(const char* filename, uint32_t sizeHint) = 0;
+    
+    /**
+     * Append data to the file opened with openWrite()
+     * @param data Data buffer to append
+     * @param size Number of bytes to append
+     * @return Number of bytes written, or 0 on error
+     */
+    virtual size_t append(const uint8_t* data, size_t size) = 0;
+    
+    /**
+     * Finish streaming write and commit the file
+     * @return true if file committed successfully
+     */
+    virtual bool closeWrite() = 0;
+    
+    /**
+     * Check if a streaming write is open
+     * @return true if openWrite() succeeded and closeWrite() not yet called
+     */
+    virtual bool isWriteOpen() const = 0;
+    
+    /**
+     * Check if the device is still completing a previous write
+     * Writers may poll this to overlap device program time with other work;
+     * write calls made while busy simply wait for the device first
+     * @return true if a write is in progress on the device
+     */
+    virtual bool isBusy() const = 0;
+    
     /**
      * Read file from storage
      * @param filename File name to read
@@ -73,6 +118,33 @@ public:
      */
     virtual size_t readFile(const char* filename, uint8_t* data, size_t maxSize) = 0;
     
+    /**
+     * Open file for streaming read (one open read per plugin)
+     * @param filename File name to read
+     * @return true if file opened for reading
+     */
+    virtual bool openRead(const char* filename) = 0;
+    
+    /**
+     * Read the next chunk of the file opened with openRead()
+     * @param data Buffer to store read data
+     * @param maxSize Maximum bytes to read
+     * @return Number of bytes read, 0 at end of file or on error
+     */
+    virtual size_t readChunk(uint8_t* data, size_t maxSize) = 0;
+    
+    /**
+     * Move the read position of the file opened with openRead()
+     * @param offset Byte offset from the start of the file
+     * @return true if the next readChunk() starts at offset
+     */
+    virtual bool seekRead(uint32_t offset) = 0;
+    
+    /**
+     * Finish streaming read
+     */
+    virtual void closeRead() = 0;
+    
     /**
      * Delete file from storage
      * @param filename File name to delete
@@ -98,9 +170,11 @@ public:
      * List files in storage
      * @param filenames Array to store filenames (each MAX_FILENAME_LENGTH)
      * @param maxFiles Maximum number of files to list
+     * @param first Files to skip before the first one listed (paging)
      * @return Number of files found
      */
-    virtual size_t listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles) const = 0;
+    virtual size_t listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles,
+                             size_t first) const = 0;
     
     /**
      * Format/initialize storage
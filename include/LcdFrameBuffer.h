@@ -0,0 +1,170 @@
+#ifndef LCDFRAMEBUFFER_H
+#define LCDFRAMEBUFFER_H
+
+#ifdef UNIT_TEST
+#include <stdint.h>
+#include <stddef.h>
+#else
+#include <Arduino.h>
+#endif
+
+/**
+ * Shadow copy of a character LCD with one dirty bit per cell
+ * Text is written here at RAM speed; flush() then sends only the cells
+ * that differ from what the LCD shows, at most a given number of bus
+ * operations per call, so a full repaint spreads over several display
+ * ticks instead of blocking on the 4-bit bus. Cell values 0-7 are the
+ * custom characters. flush() skips the cursor command when the next dirty
+ * cell follows the last one written (the LCD advances on its own within
+ * a row).
+ */
+template <uint8_t Cols, uint8_t Rows>
+class LcdFrameBuffer {
+    static_assert(Cols * Rows <= 32, "LcdFrameBuffer tracks at most 32 cells");
+
+public:
+    static const uint8_t CELLS = Cols * Rows;
+
+private:
+    static const uint8_t NO_CURSOR = 0xFF;
+
+    char cells[CELLS];
+    uint32_t dirty;             // Bit i: cell i differs from the LCD
+    uint8_t cursor;             // Cell the LCD writes next, NO_CURSOR if unknown
+
+public:
+    /**
+     * Constructor - blank frame, matching a cleared LCD
+     */
+    LcdFrameBuffer() : dirty(0), cursor(NO_CURSOR) {
+        for (uint8_t i = 0; i < CELLS; i++) {
+            cells[i] = ' ';
+        }
+    }
+
+    /**
+     * Set one cell
+     * @param row Row
+     * @param col Column (ignored if off screen)
+     * @param value Character or custom character 0-7
+     */
+    void put(uint8_t row, uint8_t col, char value) {
+        if (row >= Rows || col >= Cols) {
+            return;
+        }
+        uint8_t index = row * Cols + col;
+        if (cells[index] != value) {
+            cells[index] = value;
+            dirty |= (uint32_t)1 << index;
+        }
+    }
+
+    /**
+     * Write text padded with spaces to a field width
+     * @param row Row
+     * @param col First column
+     * @param text Text (nullptr writes only spaces)
+     * @param width Field width (clipped at the row end)
+     * @return Characters of text written
+     */
+    uint8_t putText(uint8_t row, uint8_t col, const char* text, uint8_t width = Cols) {
+        uint8_t written = 0;
+        for (uint8_t i = 0; i < width && col + i < Cols; i++) {
+            char value = ' ';
+            if (text && text[written] != '\0') {
+                value = text[written++];
+            }
+            put(row, col + i, value);
+        }
+        return written;
+    }
+
+    /**
+     * Blank every cell
+     */
+    void clear() {
+        for (uint8_t row = 0; row < Rows; row++) {
+            putText(row, 0, nullptr);
+        }
+    }
+
+    /**
+     * Get a cell
+     * @param row Row
+     * @param col Column
+     * @return Cell value
+     */
+    char get(uint8_t row, uint8_t col) const {
+        return (row < Rows && col < Cols) ? cells[row * Cols + col] : ' ';
+    }
+
+    /**
+     * Check for cells not yet sent
+     * @return true if flush() has work
+     */
+    bool isDirty() const {
+        return dirty != 0;
+    }
+
+    /**
+     * Count cells not yet sent
+     * @return Dirty cell count
+     */
+    uint8_t getDirtyCount() const {
+        uint8_t count = 0;
+        for (uint32_t bits = dirty; bits; bits &= bits - 1) {
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * Mark every cell for resending (after lcd.clear() or a glitch)
+     * Also forgets the cursor, as after createChar()
+     */
+    void invalidate() {
+        dirty = CELLS == 32 ? 0xFFFFFFFFUL : (((uint32_t)1 << CELLS) - 1);
+        cursor = NO_CURSOR;
+    }
+
+    /**
+     * Forget the LCD cursor position (it moved without this class)
+     */
+    void invalidateCursor() {
+        cursor = NO_CURSOR;
+    }
+
+    /**
+     * Send dirty cells to the LCD
+     * @param lcd Anything with setCursor(col, row) and write(uint8_t)
+     * @param budget Maximum bus operations (cursor moves and characters)
+     * @return Bus operations used
+     */
+    template <typename Display>
+    uint8_t flush(Display& lcd, uint8_t budget) {
+        uint8_t used = 0;
+        for (uint8_t index = 0; index < CELLS && dirty != 0; index++) {
+            uint32_t bit = (uint32_t)1 << index;
+            if (!(dirty & bit)) {
+                continue;
+            }
+
+            uint8_t cost = cursor == index ? 1 : 2;
+            if (used + cost > budget) {
+                break;
+            }
+            if (cursor != index) {
+                lcd.setCursor(index % Cols, index / Cols);
+            }
+            lcd.write((uint8_t)cells[index]);
+            used += cost;
+            dirty &= ~bit;
+
+            // The address runs on past the row end into hidden DDRAM
+            cursor = (index % Cols == Cols - 1) ? NO_CURSOR : index + 1;
+        }
+        return used;
+    }
+};
+
+#endif // LCDFRAMEBUFFER_H
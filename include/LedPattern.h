@@ -0,0 +1,116 @@
+#ifndef LEDPATTERN_H
+#define LEDPATTERN_H
+
+#ifdef UNIT_TEST
+#include <stdint.h>
+#include <stddef.h>
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#define LED_PATTERN_READ(p) (*(p))
+#else
+#include <Arduino.h>
+#define LED_PATTERN_READ(p) pgm_read_byte(p)
+#endif
+
+// Pattern step: LED level in bit 7, duration in units in bits 0-6; a zero
+// byte ends the pattern
+#define LED_ON      0x80
+#define LED_OFF     0x00
+
+/**
+ * LedPatternPlayer - Plays one PROGMEM blink pattern without blocking
+ * Each step holds the LED on or off for 1-127 units of UNIT_MS; update()
+ * moves on when a step is due, so the pattern advances from a periodic
+ * task instead of delay(). Steps stay in phase while update() runs within
+ * a unit of schedule; after a longer stall the pattern resynchronises to
+ * the current time rather than replaying the missed steps.
+ */
+class LedPatternPlayer {
+public:
+    static const uint8_t UNIT_MS = 50;    // One LED task period
+
+private:
+    const uint8_t* steps;       // Current pattern, nullptr when stopped
+    uint8_t index;              // Step being shown
+    bool repeat;                // Restart at the end instead of stopping
+    uint32_t stepStart;         // millis() the step began
+
+    uint8_t stepAt(uint8_t i) const {
+        return LED_PATTERN_READ(steps + i);
+    }
+
+public:
+    /**
+     * Constructor - stopped
+     */
+    LedPatternPlayer() : steps(nullptr), index(0), repeat(false), stepStart(0) {}
+
+    /**
+     * Play a pattern from its first step
+     * @param pattern PROGMEM steps ending in 0 (nullptr stops)
+     * @param loop true to repeat until stop()
+     * @param now Current millis()
+     */
+    void start(const uint8_t* pattern, bool loop, uint32_t now) {
+        steps = (pattern && LED_PATTERN_READ(pattern) != 0) ? pattern : nullptr;
+        index = 0;
+        repeat = loop;
+        stepStart = now;
+    }
+
+    /**
+     * Stop playing (the LED is released to lower layers)
+     */
+    void stop() {
+        steps = nullptr;
+    }
+
+    /**
+     * Check if a pattern is playing
+     * @return true until a one-shot pattern ends or stop() is called
+     */
+    bool isActive() const {
+        return steps != nullptr;
+    }
+
+    /**
+     * Get the level of the current step
+     * @return true for LED on (false when stopped)
+     */
+    bool isOn() const {
+        return steps && (stepAt(index) & LED_ON);
+    }
+
+    /**
+     * Advance past a step that has run its time
+     * @param now Current millis()
+     * @return Level to show now
+     */
+    bool update(uint32_t now) {
+        if (!steps) {
+            return false;
+        }
+
+        uint32_t elapsed = now - stepStart;
+        uint32_t length = (uint32_t)(stepAt(index) & 0x7F) * UNIT_MS;
+        if (elapsed < length) {
+            return isOn();
+        }
+
+        // On schedule: keep the phase; late by a unit or more: resync
+        stepStart = (elapsed - length < UNIT_MS) ? stepStart + length : now;
+
+        index++;
+        if (stepAt(index) == 0) {
+            if (!repeat) {
+                steps = nullptr;
+                return false;
+            }
+            index = 0;
+        }
+        return isOn();
+    }
+};
+
+#endif // LEDPATTERN_H
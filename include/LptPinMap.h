@@ -0,0 +1,250 @@
+#ifndef LPTPINMAP_H
+#define LPTPINMAP_H
+
+#include <Arduino.h>
+#include "HardwareConfig.h"
+
+/**
+ * LptPinMap - Compile-time Arduino Mega 2560 pin to AVR port map
+ * Resolves the LPT pin assignments in HardwareConfig.h to PINx/PORTx
+ * registers and bit masks at compile time, so the strobe ISR samples the
+ * data bus with one read per AVR port and drives BUSY/ACK with single
+ * bit operations instead of digitalRead()/digitalWrite() table lookups.
+ *
+ * With the default wiring D0-D7 span PORTA, PORTC and PORTG (three reads
+ * plus a bit gather). Building with LPT_DATA_ON_PORTK moves D0-D7 onto
+ * A8-A15 (PK0-PK7) and the whole byte becomes a single PINK read.
+ *
+ * NOTE: PORTH/J/K/L live in extended I/O space, so a read-modify-write on
+ * them is not atomic. Call setHigh()/setLow() for those ports from ISR
+ * context or inside ATOMIC_BLOCK only.
+ */
+namespace LptPinMap {
+
+// AVR ports present on the ATmega2560 (there is no PORTI)
+enum Port : uint8_t {
+    PORT_NONE = 0,
+    PORT_ID_A, PORT_ID_B, PORT_ID_C, PORT_ID_D, PORT_ID_E, PORT_ID_F,
+    PORT_ID_G, PORT_ID_H, PORT_ID_J, PORT_ID_K, PORT_ID_L,
+    PORT_COUNT
+};
+
+struct PinInfo {
+    uint8_t port;
+    uint8_t bit;
+};
+
+#define LPT_PIN_COUNT 70
+
+// Arduino Mega 2560 digital pin number -> AVR port/bit (pins_arduino.h)
+constexpr PinInfo MEGA_PINS[LPT_PIN_COUNT] = {
+    {PORT_ID_E, 0}, {PORT_ID_E, 1}, {PORT_ID_E, 4}, {PORT_ID_E, 5}, // 0-3
+    {PORT_ID_G, 5}, {PORT_ID_E, 3}, {PORT_ID_H, 3}, {PORT_ID_H, 4}, // 4-7
+    {PORT_ID_H, 5}, {PORT_ID_H, 6}, {PORT_ID_B, 4}, {PORT_ID_B, 5}, // 8-11
+    {PORT_ID_B, 6}, {PORT_ID_B, 7}, {PORT_ID_J, 1}, {PORT_ID_J, 0}, // 12-15
+    {PORT_ID_H, 1}, {PORT_ID_H, 0}, {PORT_ID_D, 3}, {PORT_ID_D, 2}, // 16-19
+    {PORT_ID_D, 1}, {PORT_ID_D, 0}, {PORT_ID_A, 0}, {PORT_ID_A, 1}, // 20-23
+    {PORT_ID_A, 2}, {PORT_ID_A, 3}, {PORT_ID_A, 4}, {PORT_ID_A, 5}, // 24-27
+    {PORT_ID_A, 6}, {PORT_ID_A, 7}, {PORT_ID_C, 7}, {PORT_ID_C, 6}, // 28-31
+    {PORT_ID_C, 5}, {PORT_ID_C, 4}, {PORT_ID_C, 3}, {PORT_ID_C, 2}, // 32-35
+    {PORT_ID_C, 1}, {PORT_ID_C, 0}, {PORT_ID_D, 7}, {PORT_ID_G, 2}, // 36-39
+    {PORT_ID_G, 1}, {PORT_ID_G, 0}, {PORT_ID_L, 7}, {PORT_ID_L, 6}, // 40-43
+    {PORT_ID_L, 5}, {PORT_ID_L, 4}, {PORT_ID_L, 3}, {PORT_ID_L, 2}, // 44-47
+    {PORT_ID_L, 1}, {PORT_ID_L, 0}, {PORT_ID_B, 3}, {PORT_ID_B, 2}, // 48-51
+    {PORT_ID_B, 1}, {PORT_ID_B, 0}, {PORT_ID_F, 0}, {PORT_ID_F, 1}, // 52-55 (A0-A1)
+    {PORT_ID_F, 2}, {PORT_ID_F, 3}, {PORT_ID_F, 4}, {PORT_ID_F, 5}, // 56-59 (A2-A5)
+    {PORT_ID_F, 6}, {PORT_ID_F, 7}, {PORT_ID_K, 0}, {PORT_ID_K, 1}, // 60-63 (A6-A9)
+    {PORT_ID_K, 2}, {PORT_ID_K, 3}, {PORT_ID_K, 4}, {PORT_ID_K, 5}, // 64-67 (A10-A13)
+    {PORT_ID_K, 6}, {PORT_ID_K, 7}                                  // 68-69 (A14-A15)
+};
+
+constexpr uint8_t portOf(uint8_t pin) {
+    return pin < LPT_PIN_COUNT ? MEGA_PINS[pin].port : (uint8_t)PORT_NONE;
+}
+
+constexpr uint8_t bitOf(uint8_t pin) {
+    return pin < LPT_PIN_COUNT ? MEGA_PINS[pin].bit : 0;
+}
+
+constexpr uint8_t maskOf(uint8_t pin) {
+    return (uint8_t)(1u << bitOf(pin));
+}
+
+// Data bus wiring, D0 first
+constexpr uint8_t DATA_PINS[8] = {
+    LPT_DATA0_PIN, LPT_DATA1_PIN, LPT_DATA2_PIN, LPT_DATA3_PIN,
+    LPT_DATA4_PIN, LPT_DATA5_PIN, LPT_DATA6_PIN, LPT_DATA7_PIN
+};
+
+/**
+ * Check whether any data line is wired to an AVR port
+ * @param port Port identifier
+ * @return true if at least one of D0-D7 is on that port
+ */
+constexpr bool dataUsesPort(uint8_t port) {
+    for (uint8_t i = 0; i < 8; i++) {
+        if (portOf(DATA_PINS[i]) == port) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Number of distinct AVR ports read per byte
+ */
+constexpr uint8_t dataPortCount() {
+    uint8_t count = 0;
+    for (uint8_t port = PORT_ID_A; port < PORT_COUNT; port++) {
+        if (dataUsesPort(port)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * True when D0-D7 sit on bits 0-7 of one port, i.e. one PINx read is the byte
+ */
+constexpr bool dataIsSinglePort() {
+    for (uint8_t i = 0; i < 8; i++) {
+        if (portOf(DATA_PINS[i]) != portOf(DATA_PINS[0]) || bitOf(DATA_PINS[i]) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool dataPinsMapped() {
+    for (uint8_t i = 0; i < 8; i++) {
+        if (portOf(DATA_PINS[i]) == PORT_NONE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(dataPinsMapped(), "LPT data pin is not a valid Mega 2560 pin");
+static_assert(portOf(LPT_BUSY_PIN) != PORT_NONE, "LPT_BUSY_PIN is not a valid Mega 2560 pin");
+static_assert(portOf(LPT_ACKNOWLEDGE_PIN) != PORT_NONE, "LPT_ACKNOWLEDGE_PIN is not a valid Mega 2560 pin");
+
+#if XMEM_CAPTURE_BUFFER
+// Every pin the firmware drives or reads
+constexpr uint8_t USED_PINS[] = {
+    LPT_DATA0_PIN, LPT_DATA1_PIN, LPT_DATA2_PIN, LPT_DATA3_PIN,
+    LPT_DATA4_PIN, LPT_DATA5_PIN, LPT_DATA6_PIN, LPT_DATA7_PIN,
+    LPT_STROBE_PIN, LPT_ACKNOWLEDGE_PIN, LPT_BUSY_PIN, LPT_PAPER_OUT_PIN,
+    LPT_SELECT_PIN, LPT_AUTO_FEED_PIN, LPT_ERROR_PIN, LPT_INITIALIZE_PIN,
+    LPT_SELECT_IN_PIN, HEARTBEAT_LED_PIN, LPT_ACTIVITY_LED_PIN, WRITE_ACTIVITY_LED_PIN,
+    SD_CS_PIN, SD_DETECT_PIN, SD_WRITE_PROTECT_PIN, EEPROM_CS_PIN,
+    LCD_RESET_PIN, LCD_ENABLE_PIN, LCD_DATA4_PIN, LCD_DATA5_PIN,
+    LCD_DATA6_PIN, LCD_DATA7_PIN
+};
+
+/**
+ * True when no used pin is on the external memory bus
+ * (PORTA = AD0-AD7, PORTC = A8-A15, PG0-PG2 = /WR, /RD, ALE)
+ */
+constexpr bool pinsClearOfXmem() {
+    for (uint8_t pin : USED_PINS) {
+        uint8_t port = portOf(pin);
+        if (port == PORT_ID_A || port == PORT_ID_C ||
+            (port == PORT_ID_G && bitOf(pin) <= 2)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(pinsClearOfXmem(), "A pin in HardwareConfig.h is on the XMEM bus (PORTA, PORTC, PG0-PG2)");
+#endif
+
+// Register access per port, resolved at compile time
+template <uint8_t P> struct Gpio;
+
+#define LPT_DEFINE_GPIO(L) \
+    template <> struct Gpio<PORT_ID_##L> { \
+        static inline volatile uint8_t& pin() { return PIN##L; } \
+        static inline volatile uint8_t& port() { return PORT##L; } \
+        static inline volatile uint8_t& ddr() { return DDR##L; } \
+    };
+
+LPT_DEFINE_GPIO(A) LPT_DEFINE_GPIO(B) LPT_DEFINE_GPIO(C) LPT_DEFINE_GPIO(D)
+LPT_DEFINE_GPIO(E) LPT_DEFINE_GPIO(F) LPT_DEFINE_GPIO(G) LPT_DEFINE_GPIO(H)
+LPT_DEFINE_GPIO(J) LPT_DEFINE_GPIO(K) LPT_DEFINE_GPIO(L)
+
+#undef LPT_DEFINE_GPIO
+
+/**
+ * Read a port only if the data bus uses it (otherwise no register access)
+ */
+template <uint8_t P>
+static inline __attribute__((always_inline)) uint8_t samplePort() {
+    if constexpr (dataUsesPort(P)) {
+        return Gpio<P>::pin();
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * Move data line I from its port snapshot into bit I of the result
+ */
+template <uint8_t I>
+static inline __attribute__((always_inline)) uint8_t dataBit(const uint8_t (&snap)[PORT_COUNT]) {
+    constexpr uint8_t pin = DATA_PINS[I];
+    return (snap[portOf(pin)] & maskOf(pin)) ? (uint8_t)(1u << I) : 0;
+}
+
+/**
+ * Sample D0-D7
+ * Each used port is read exactly once, back to back, so all lines are
+ * captured within a few cycles of each other.
+ * @return Data byte as presented on the bus
+ */
+static inline __attribute__((always_inline)) uint8_t readDataBus() {
+    if constexpr (dataIsSinglePort()) {
+        return Gpio<portOf(LPT_DATA0_PIN)>::pin();
+    } else {
+        const uint8_t snap[PORT_COUNT] = {
+            0,
+            samplePort<PORT_ID_A>(), samplePort<PORT_ID_B>(), samplePort<PORT_ID_C>(),
+            samplePort<PORT_ID_D>(), samplePort<PORT_ID_E>(), samplePort<PORT_ID_F>(),
+            samplePort<PORT_ID_G>(), samplePort<PORT_ID_H>(), samplePort<PORT_ID_J>(),
+            samplePort<PORT_ID_K>(), samplePort<PORT_ID_L>()
+        };
+        return dataBit<0>(snap) | dataBit<1>(snap) | dataBit<2>(snap) | dataBit<3>(snap) |
+               dataBit<4>(snap) | dataBit<5>(snap) | dataBit<6>(snap) | dataBit<7>(snap);
+    }
+}
+
+/**
+ * Drive an output pin HIGH with a single bit operation
+ */
+template <uint8_t Pin>
+static inline __attribute__((always_inline)) void setHigh() {
+    static_assert(portOf(Pin) != PORT_NONE, "Pin is not a valid Mega 2560 pin");
+    Gpio<portOf(Pin)>::port() |= maskOf(Pin);
+}
+
+/**
+ * Drive an output pin LOW with a single bit operation
+ */
+template <uint8_t Pin>
+static inline __attribute__((always_inline)) void setLow() {
+    static_assert(portOf(Pin) != PORT_NONE, "Pin is not a valid Mega 2560 pin");
+    Gpio<portOf(Pin)>::port() &= (uint8_t)~maskOf(Pin);
+}
+
+/**
+ * Read a pin level directly from its PINx register
+ */
+template <uint8_t Pin>
+static inline __attribute__((always_inline)) bool read() {
+    static_assert(portOf(Pin) != PORT_NONE, "Pin is not a valid Mega 2560 pin");
+    return (Gpio<portOf(Pin)>::pin() & maskOf(Pin)) != 0;
+}
+
+} // namespace LptPinMap
+
+#endif // LPTPINMAP_H
@@ -131,6 +131,28 @@ void clearBuffer(void* buffer, size_t size);
  */
 int getAvailableRAM();
 
+/**
+ * Get the smallest stack/heap gap seen since boot
+ * RAM above the heap is painted with a canary before constructors run;
+ * this counts the canary bytes the stack has never overwritten.
+ * @return Bytes of RAM never used by the stack
+ */
+size_t getUnusedStack();
+
+/**
+ * Get the deepest stack use seen since boot
+ * @return Bytes from the top of RAM to the lowest stack byte ever written
+ */
+size_t getStackHighWaterMark();
+
+/**
+ * Get the statically allocated RAM (from the linker symbols)
+ * @param dataBytes Set to the size of .data (initialized globals)
+ * @param bssBytes Set to the size of .bss (zeroed globals)
+ * @return dataBytes + bssBytes
+ */
+size_t getStaticRAM(size_t& dataBytes, size_t& bssBytes);
+
 /**
  * Memory validation for debugging
  * @param ptr Pointer to validate
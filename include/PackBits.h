@@ -0,0 +1,251 @@
+#ifndef PACKBITS_H
+#define PACKBITS_H
+
+#ifdef UNIT_TEST
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#else
+#include <Arduino.h>
+#endif
+
+// Packed files start with this header; it is the per-file flag readers use
+// to decide between decompressing and passing the data through
+#define PACKBITS_HEADER_SIZE    4
+#define PACKBITS_MAX_LITERAL    128     // Longest literal packet
+#define PACKBITS_MAX_RUN        128     // Longest run packet
+#define PACKBITS_MIN_RUN        3       // Shorter repeats stay literal
+#define PACKBITS_MAX_EMIT       (PACKBITS_MAX_LITERAL + 1)  // Largest single emit
+
+/**
+ * PackBits - Header and signature of packed capture files
+ * Screenshots are mostly flat background, which the Apple/TIFF PackBits
+ * scheme collapses into two-byte runs while costing at most one byte per
+ * 128 on data that does not repeat. A packed file is PACKBITS_HEADER_SIZE
+ * signature bytes followed by packets:
+ *   n = 0..127     n + 1 literal bytes follow
+ *   n = -1..-127   the next byte repeats 1 - n times
+ *   n = -128       no-op
+ */
+namespace PackBits {
+    static const uint8_t HEADER[PACKBITS_HEADER_SIZE] = {0x89, 'P', 'K', 0x01};
+
+    /**
+     * Check whether file data starts with the packed-file header
+     * @param data First bytes of the file
+     * @param size Number of bytes available
+     * @return true if the file is packed
+     */
+    inline bool isPacked(const uint8_t* data, size_t size) {
+        return data && size >= PACKBITS_HEADER_SIZE &&
+               memcmp(data, HEADER, PACKBITS_HEADER_SIZE) == 0;
+    }
+}
+
+/**
+ * PackBitsEncoder - Streaming PackBits compressor
+ * Holds at most one literal packet (PACKBITS_MAX_LITERAL bytes) plus the
+ * current run. Output is handed to a sink with a put(uint8_t) member; one
+ * feed() emits at most PACKBITS_MAX_EMIT bytes, so a caller that checks for
+ * that much room before each byte never has to buffer encoder output.
+ */
+class PackBitsEncoder {
+private:
+    uint8_t literal[PACKBITS_MAX_LITERAL];
+    uint8_t literalLength;
+    uint8_t repeatLength;           // Trailing identical bytes in literal[]
+    uint8_t runByte;
+    uint8_t runLength;              // 0 while collecting a literal
+
+    template <typename Sink>
+    void emitLiteral(uint8_t length, Sink& sink) {
+        if (length == 0) {
+            return;
+        }
+        sink.put((uint8_t)(length - 1));
+        for (uint8_t i = 0; i < length; i++) {
+            sink.put(literal[i]);
+        }
+    }
+
+    template <typename Sink>
+    void emitRun(Sink& sink) {
+        sink.put((uint8_t)(1 - (int16_t)runLength));
+        sink.put(runByte);
+        runLength = 0;
+    }
+
+public:
+    PackBitsEncoder() : literal(), literalLength(0), repeatLength(0), runByte(0), runLength(0) {}
+
+    /**
+     * Start a new stream (pending output is discarded)
+     */
+    void reset() {
+        literalLength = 0;
+        repeatLength = 0;
+        runLength = 0;
+    }
+
+    /**
+     * Compress one byte
+     * @param value Next input byte
+     * @param sink Receives up to PACKBITS_MAX_EMIT output bytes
+     */
+    template <typename Sink>
+    void feed(uint8_t value, Sink& sink) {
+        if (runLength > 0) {
+            if (value == runByte && runLength < PACKBITS_MAX_RUN) {
+                runLength++;
+                return;
+            }
+            emitRun(sink);
+        }
+
+        if (literalLength > 0 && value == literal[literalLength - 1]) {
+            repeatLength++;
+        } else {
+            repeatLength = 1;
+        }
+        literal[literalLength++] = value;
+
+        if (repeatLength == PACKBITS_MIN_RUN) {
+            // The repeat turns into a run; what came before goes out as is
+            emitLiteral(literalLength - PACKBITS_MIN_RUN, sink);
+            runByte = value;
+            runLength = PACKBITS_MIN_RUN;
+            literalLength = 0;
+            repeatLength = 0;
+        } else if (literalLength == PACKBITS_MAX_LITERAL) {
+            emitLiteral(literalLength, sink);
+            literalLength = 0;
+            repeatLength = 0;
+        }
+    }
+
+    /**
+     * Compress a buffer
+     * @param data Input bytes
+     * @param size Number of bytes
+     * @param sink Receives the output
+     */
+    template <typename Sink>
+    void feed(const uint8_t* data, size_t size, Sink& sink) {
+        for (size_t i = 0; i < size; i++) {
+            feed(data[i], sink);
+        }
+    }
+
+    /**
+     * Emit the pending packet (end of stream)
+     * @param sink Receives up to PACKBITS_MAX_EMIT output bytes
+     */
+    template <typename Sink>
+    void finish(Sink& sink) {
+        if (runLength > 0) {
+            emitRun(sink);
+        }
+        emitLiteral(literalLength, sink);
+        literalLength = 0;
+        repeatLength = 0;
+    }
+};
+
+/**
+ * PackBitsDecoder - Streaming PackBits decompressor
+ * Three bytes of state; input and output can be split anywhere, including
+ * between a run header and its byte.
+ */
+class PackBitsDecoder {
+private:
+    enum Mode : uint8_t {
+        MODE_HEADER,                // Next input byte is a packet header
+        MODE_LITERAL,               // Copying literal bytes
+        MODE_RUN_BYTE,              // Next input byte is the repeated byte
+        MODE_RUN                    // Repeating runByte
+    };
+
+    Mode mode;
+    uint8_t count;                  // Bytes left in the packet
+    uint8_t runByte;
+
+public:
+    PackBitsDecoder() : mode(MODE_HEADER), count(0), runByte(0) {}
+
+    /**
+     * Start a new stream
+     */
+    void reset() {
+        mode = MODE_HEADER;
+        count = 0;
+    }
+
+    /**
+     * Decompress as much as fits
+     * @param in Packed input (header already stripped)
+     * @param inSize Input bytes available
+     * @param consumed Set to the input bytes used
+     * @param out Output buffer
+     * @param outSize Output capacity
+     * @return Bytes written to out
+     */
+    size_t decode(const uint8_t* in, size_t inSize, size_t& consumed,
+                  uint8_t* out, size_t outSize) {
+        size_t produced = 0;
+        consumed = 0;
+
+        while (produced < outSize) {
+            if (mode == MODE_RUN) {
+                out[produced++] = runByte;
+                if (--count == 0) {
+                    mode = MODE_HEADER;
+                }
+                continue;
+            }
+
+            if (consumed == inSize) {
+                break;
+            }
+            uint8_t value = in[consumed++];
+
+            switch (mode) {
+                case MODE_HEADER:
+                    if (value < 0x80) {
+                        count = value + 1;
+                        mode = MODE_LITERAL;
+                    } else if (value != 0x80) {
+                        count = (uint8_t)(257 - value);
+                        mode = MODE_RUN_BYTE;
+                    }
+                    break;
+
+                case MODE_LITERAL:
+                    out[produced++] = value;
+                    if (--count == 0) {
+                        mode = MODE_HEADER;
+                    }
+                    break;
+
+                case MODE_RUN_BYTE:
+                    runByte = value;
+                    mode = MODE_RUN;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        return produced;
+    }
+
+    /**
+     * Check whether output is still owed without more input
+     * @return true while a run is being expanded
+     */
+    bool hasPendingOutput() const {
+        return mode == MODE_RUN;
+    }
+};
+
+#endif // PACKBITS_H
@@ -5,30 +5,106 @@
 #include "IComponent.h"
 #include "RingBuffer.h"
 #include "HardwareConfig.h"
+#if LPT_ISR_HISTOGRAM
+#include "TimingHistogram.h"
+#endif
 
 /**
  * ParallelPortManager - IEEE-1284 Standard Parallel Port Manager
  * Handles real-time data capture from Tektronix TDS2024 oscilloscope
  * Implements hardware flow control with ≤2μs ISR constraints
+ *
+ * With LPT_TIMER_HANDSHAKE the strobe ISR only raises BUSY, latches the
+ * data byte and arms Timer3 compare channel A. The compare ISR then
+ * drives the ACK low pulse and releases BUSY, so interrupts are never
+ * masked for the length of the pulse.
  */
-class ParallelPortManager : public IComponent {
+class ParallelPortManager final : public IComponent {
+public:
+    // IEEE-1284 forward transfer mode
+    enum TransferMode : uint8_t {
+        MODE_COMPATIBILITY = 0,         // SPP: BUSY/ACK handshake per byte
+        MODE_NEGOTIATING,               // 1284 negotiation/termination in progress
+        MODE_ECP_FORWARD                // ECP: BUSY (PeriphAck) follows /Strobe
+    };
+    
 private:
-    RingBuffer ringBuffer;              // 512-byte ring buffer for data
+#if XMEM_CAPTURE_BUFFER
+    // Lock-free SPSC capture buffer, data in external SRAM
+    RingBuffer<RING_BUFFER_SIZE, RingBufferAt<RING_BUFFER_SIZE, XMEM_RING_ADDRESS>> ringBuffer;
+#else
+    RingBuffer<RING_BUFFER_SIZE> ringBuffer; // Lock-free SPSC capture buffer
+#endif
     volatile bool initialized;          // Initialization state
     volatile bool captureEnabled;       // Data capture enabled flag
     volatile uint32_t bytesReceived;    // Total bytes received counter
     volatile uint32_t overflowCount;    // Overflow events counter
-    volatile uint32_t lastInterruptTime; // Last interrupt timestamp (μs)
+    volatile uint32_t lastInterruptTime; // Last interrupt timestamp (ms)
+    volatile uint16_t lastStrobeStamp;  // Entry of the last strobe ISR (Timer3 ticks or μs)
     bool debugEnabled;                  // Debug output enabled
     
     // Hardware control state
-    volatile bool busyAsserted;         // Busy signal state
+    volatile bool busyAsserted;         // Busy signal held by flow control
     volatile bool errorState;           // Error condition detected
+    bool flowControlEnabled;            // Watermark back-pressure enabled
+    uint16_t flowHighWatermark;         // Fill level that asserts BUSY
+    uint16_t flowLowWatermark;          // Fill level that releases it
+    
+    // Flow control statistics
+    volatile uint32_t droppedBytes;     // Bytes lost to a full buffer
+    volatile uint32_t stallCount;       // Times BUSY was held at high watermark
+    volatile uint32_t stallStartTime;   // Start of current stall (ms)
+    uint32_t stallTimeTotal;            // Accumulated completed stall time (ms)
+    uint32_t maxStallTime;              // Longest single stall (ms)
     
     // Statistics
     volatile uint32_t totalInterrupts;  // Total interrupt count
     volatile uint16_t maxISRTime;       // Maximum ISR execution time (μs)
-    volatile uint16_t avgISRTime;       // Average ISR execution time (μs)
+    volatile uint32_t isrTimeTotal;     // Sum of timed ISR executions (μs)
+    volatile uint32_t isrTimeSamples;   // Number of timed ISR executions
+    
+#if LPT_ISR_HISTOGRAM
+    // Timing histograms (Timer1 ticks, reset per job)
+    TimingHistogram isrHistogram;       // ISR execution time
+    TimingHistogram strobeHistogram;    // Gap between consecutive strobes
+    uint16_t lastStrobeTick;            // Timer1 count at previous strobe
+    bool strobeHistogramPrimed;         // lastStrobeTick is valid
+#endif
+    
+    // Handshake timing (configurable, defaults match TDS2024 requirements)
+    uint16_t ackDelayUs;                // BUSY asserted -> ACK low (μs)
+    uint16_t ackPulseUs;                // ACK low pulse width (μs)
+    uint16_t ackDelayTicks;             // ackDelayUs in Timer3 ticks
+    uint16_t ackPulseTicks;             // ackPulseUs in Timer3 ticks
+    volatile uint8_t handshakePhase;    // Timer-driven handshake state
+    
+#if LPT_IEEE1284_NEGOTIATION
+    // IEEE-1284 negotiation state (main loop polled, ISR latches data)
+    volatile uint8_t transferMode;      // TransferMode seen by the strobe ISR
+    uint8_t negotiationState;           // NegotiationState
+    volatile uint8_t extensibilityByte; // Mode requested by the host
+    volatile bool extensibilityLatched; // Host strobed the request (event 3)
+    bool lastSelectIn;                  // Previous 1284Active level (edge detect)
+    uint32_t negotiationStartTime;      // Start of current step (ms)
+    uint32_t negotiationCount;          // Negotiations attempted by the host
+    uint32_t ecpSessions;               // Negotiations that entered ECP
+    
+    enum NegotiationState : uint8_t {
+        NEG_IDLE = 0,                   // Compatibility mode
+        NEG_AWAIT_REQUEST,              // Event 2 answered, waiting for events 3/4
+        NEG_ECP_SETUP,                  // ECP accepted, waiting for event 30
+        NEG_ECP_ACTIVE,                 // ECP forward transfer
+        NEG_DECLINED,                   // Mode refused, waiting for host to terminate
+        NEG_TERMINATE                   // Event 24 answered, waiting for event 25
+    };
+#endif
+    
+    // Timer-driven handshake phases
+    enum HandshakePhase : uint8_t {
+        HANDSHAKE_IDLE = 0,             // No handshake in progress
+        HANDSHAKE_ACK_ASSERT,           // Next compare drives ACK low
+        HANDSHAKE_ACK_RELEASE           // Next compare releases ACK and BUSY
+    };
     
     /**
      * Configure parallel port pins
@@ -36,21 +112,64 @@ private:
     void configurePins();
     
     /**
-     * Assert hardware flow control signals
+     * Assert hardware flow control signals (ISR context)
+     * Holds BUSY high past the end of the current handshake
      */
     void assertFlowControl();
     
     /**
-     * Release hardware flow control signals
+     * Release hardware flow control signals (main loop context)
+     * Drops BUSY unless a handshake is still in progress
      */
     void releaseFlowControl();
     
+    /**
+     * Release BUSY if held and the buffer drained below the low watermark
+     */
+    void checkFlowControlRelease();
+    
     /**
      * Update timing statistics
      * @param executionTime ISR execution time in microseconds
      */
     void updateTimingStats(uint16_t executionTime);
     
+#if LPT_ISR_HISTOGRAM
+    /**
+     * Record ISR time and inter-strobe gap (ISR context)
+     * @param startTick Timer1 count at ISR entry
+     * @param nowMs millis() for this strobe
+     */
+    void recordTimingHistograms(uint16_t startTick, uint32_t nowMs);
+#endif
+    
+    /**
+     * Configure Timer3 as free-running 0.5μs time base for the handshake
+     */
+    void configureHandshakeTimer();
+    
+#if LPT_IEEE1284_NEGOTIATION
+    /**
+     * Advance the IEEE-1284 negotiation state machine (main loop context)
+     */
+    void updateNegotiation();
+    
+    /**
+     * Answer a host termination request (event 22) with nAck low
+     */
+    void beginTermination();
+    
+    /**
+     * Drive status lines back to compatibility-mode idle levels
+     */
+    void restoreCompatibilitySignals();
+    
+    /**
+     * Strobe handling while negotiating or in ECP mode (ISR context)
+     */
+    void handleNegotiatedStrobe();
+#endif
+    
 public:
     /**
      * Constructor
@@ -99,6 +218,20 @@ public:
      */
     size_t readData(uint8_t* dest, size_t maxBytes);
     
+    /**
+     * Expose captured data in place without copying (zero-copy read)
+     * @param ptr Set to the first readable byte in the capture buffer
+     * @return Number of contiguous bytes at ptr (0 if none)
+     */
+    size_t peekContiguous(const uint8_t*& ptr) const;
+    
+    /**
+     * Release bytes obtained through peekContiguous()
+     * @param numBytes Number of bytes processed by the consumer
+     * @return Number of bytes actually released
+     */
+    size_t consume(size_t numBytes);
+    
     /**
      * Peek at next byte without removing it
      * @param data Reference to store peeked byte
@@ -140,6 +273,95 @@ public:
      */
     uint32_t getOverflowCount() const;
     
+    /**
+     * Get number of bytes dropped because the buffer was full
+     * @return Dropped byte count
+     */
+    uint32_t getDroppedBytes() const;
+    
+    /**
+     * Get number of flow control stalls (BUSY held at high watermark)
+     * @return Stall count
+     */
+    uint32_t getStallCount() const;
+    
+    /**
+     * Get total time BUSY was held by flow control, including a stall in progress
+     * @return Stall time in milliseconds
+     */
+    uint32_t getStallTime() const;
+    
+    /**
+     * Get time since the last strobe ISR started (wraps after 32ms)
+     * @return Microseconds
+     */
+    uint16_t getStrobeAge() const;
+    
+    /**
+     * Get when the last strobe arrived
+     * @return millis() timestamp
+     */
+    uint32_t getLastStrobeTime() const;
+    
+    /**
+     * Get longest single flow control stall
+     * @return Stall time in milliseconds
+     */
+    uint32_t getMaxStallTime() const;
+    
+    /**
+     * Enable/disable watermark BUSY back-pressure
+     * @param enabled true to hold BUSY instead of dropping data
+     */
+    void setFlowControlEnabled(bool enabled);
+    
+    /**
+     * Check if watermark back-pressure is enabled
+     * @return true if enabled
+     */
+    bool isFlowControlEnabled() const;
+    
+    /**
+     * Set the flow control watermarks
+     * @param high Fill level that asserts BUSY
+     * @param low Fill level that releases it
+     * @return true if accepted (0 < low < high <= RING_BUFFER_SIZE)
+     */
+    bool setFlowWatermarks(uint16_t high, uint16_t low);
+    
+    /**
+     * Get the flow control watermarks
+     * @param high Receives the assert level
+     * @param low Receives the release level
+     */
+    void getFlowWatermarks(uint16_t& high, uint16_t& low) const;
+    
+    /**
+     * Check if BUSY is currently held by flow control
+     * @return true while stalled
+     */
+    bool isFlowControlAsserted() const;
+    
+    /**
+     * Check if the host is asserting /INIT (printer reset)
+     * Polled: pin 26 has no pin-change interrupt
+     * @return true while /INIT is held low
+     */
+    bool isInitAsserted() const;
+    
+    /**
+     * Get current IEEE-1284 forward transfer mode
+     * @return MODE_COMPATIBILITY unless a host negotiated ECP
+     */
+    TransferMode getTransferMode() const;
+    
+    /**
+     * Get IEEE-1284 negotiation statistics
+     * @param attempts Negotiations started by the host
+     * @param ecp Negotiations that entered ECP mode
+     */
+    void getNegotiationStats(uint32_t& attempts, uint32_t& ecp) const;
+    
     /**
      * Get interrupt statistics
      * @param totalInts Total interrupt count
@@ -148,6 +370,20 @@ public:
      */
     void getInterruptStats(uint32_t& totalInts, uint16_t& maxTime, uint16_t& avgTime) const;
     
+    /**
+     * Reset ISR timing statistics and histograms (e.g. at start of a job)
+     */
+    void resetTimingStats();
+    
+#if LPT_ISR_HISTOGRAM
+    /**
+     * Get consistent snapshot of the timing histograms
+     * @param isrTime ISR execution time histogram (Timer1 ticks)
+     * @param strobeGap Inter-strobe gap histogram (Timer1 ticks)
+     */
+    void getTimingHistograms(TimingHistogram& isrTime, TimingHistogram& strobeGap) const;
+#endif
+    
     /**
      * Test interrupt for specified duration
      * @param durationMs Test duration in milliseconds
@@ -175,6 +411,27 @@ public:
      */
     void handleInterrupt();
     
+    /**
+     * Timer3 compare ISR body (called by TIMER3_COMPA_vect)
+     * Generates the ACK pulse and releases BUSY after a strobe
+     */
+    void handleHandshakeTimer();
+    
+    /**
+     * Configure handshake timing
+     * @param delayUs Delay from BUSY assert to ACK low in microseconds
+     * @param pulseUs ACK low pulse width in microseconds
+     * @return true if values accepted (1..LPT_MAX_HANDSHAKE_US)
+     */
+    bool setHandshakeTiming(uint16_t delayUs, uint16_t pulseUs);
+    
+    /**
+     * Get handshake timing
+     * @param delayUs BUSY assert to ACK low delay (μs)
+     * @param pulseUs ACK low pulse width (μs)
+     */
+    void getHandshakeTiming(uint16_t& delayUs, uint16_t& pulseUs) const;
+    
     /**
      * Force error state (for testing)
      * @param error true to set error state
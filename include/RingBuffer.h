@@ -1,116 +1,331 @@
 #ifndef RINGBUFFER_H
 #define RINGBUFFER_H
 
+#ifdef UNIT_TEST
+#include <stdint.h>
+#include <stddef.h>
+#else
 #include <Arduino.h>
-#include "HardwareConfig.h"
+#endif
 
 /**
- * High-performance ring buffer for parallel port data capture
+ * Index type selection for RingBuffer<N>
+ * Head/tail are free-running counters, so the index type must hold 0..N
+ * distinct fill levels: 8-bit for N <= 128, 16-bit above that.
+ */
+template <bool Small> struct RingBufferIndex { typedef uint16_t type; };
+template <> struct RingBufferIndex<true> { typedef uint8_t type; };
+
+/**
+ * Storage for RingBuffer<N>: an array inside the buffer object
+ */
+template <size_t N>
+class RingBufferArray {
+    uint8_t storage[N];
+
+protected:
+    RingBufferArray() : storage() {}
+
+    uint8_t* bytes() { return storage; }
+    const uint8_t* bytes() const { return storage; }
+};
+
+/**
+ * Storage for RingBuffer<N>: N bytes at a fixed address, e.g. external SRAM
+ * on the XMEM interface. Takes no space in the buffer object and is not
+ * cleared (the interface must be enabled before the buffer is used).
+ */
+template <size_t N, uintptr_t Address>
+class RingBufferAt {
+protected:
+    static uint8_t* bytes() { return reinterpret_cast<uint8_t*>(Address); }
+};
+
+/**
+ * High-performance lock-free ring buffer for parallel port data capture
  * Designed for interrupt service routine usage with ≤2μs constraints
- * Thread-safe for single producer, single consumer scenario
+ *
+ * Single producer (strobe ISR) / single consumer (main loop). There is no
+ * shared element count: the producer only writes head, the consumer only
+ * writes tail, and the fill level is head - tail. N must be a power of two
+ * so wrap-around is a bitmask. With 8-bit indices every index update is a
+ * single atomic store; 16-bit indices are loaded/stored with interrupts
+ * briefly masked. The data bytes are not volatile, so every index load and
+ * store is also a compiler barrier that orders them against the index.
+ * Storage selects where the N data bytes live.
  */
-class RingBuffer {
+template <size_t N, typename Storage = RingBufferArray<N>>
+class RingBuffer : private Storage {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "RingBuffer size must be a power of two");
+    static_assert(N <= 32768, "RingBuffer size exceeds 16-bit index range");
+
+public:
+    typedef typename RingBufferIndex<(N <= 128)>::type index_t;
+
 private:
-    uint8_t buffer[RING_BUFFER_SIZE];
-    volatile size_t head;           // Write position (producer)
-    volatile size_t tail;           // Read position (consumer)
-    volatile size_t count;          // Current number of elements
+    static constexpr index_t MASK = (index_t)(N - 1);
+
+    using Storage::bytes;
+
+    volatile index_t head;          // Free-running write counter (producer only)
+    volatile index_t tail;          // Free-running read counter (consumer only)
     volatile bool overflowFlag;     // Overflow detection
-    
+
+    /**
+     * Read an index written by the other side
+     * The compiler barrier keeps data accesses from moving above the load:
+     * bytes are only touched once the index that covers them is seen.
+     */
+    static inline index_t load(const volatile index_t& index) {
+        index_t value;
+#ifndef UNIT_TEST
+        if (sizeof(index_t) > 1) {
+            uint8_t oldSREG = SREG;
+            cli();
+            value = index;
+            SREG = oldSREG;
+        } else
+#endif
+        {
+            value = index;
+        }
+        asm volatile("" ::: "memory");
+        return value;
+    }
+
+    /**
+     * Publish an index read by the other side
+     * The compiler barrier keeps data accesses from moving below the
+     * store: the other side never sees an index ahead of the bytes.
+     */
+    static inline void store(volatile index_t& index, index_t value) {
+        asm volatile("" ::: "memory");
+#ifndef UNIT_TEST
+        if (sizeof(index_t) > 1) {
+            uint8_t oldSREG = SREG;
+            cli();
+            index = value;
+            SREG = oldSREG;
+            return;
+        }
+#endif
+        index = value;
+    }
+
 public:
     /**
      * Constructor - initializes empty buffer
      */
-    RingBuffer();
-    
+    RingBuffer() : Storage(), head(0), tail(0), overflowFlag(false) {}
+
     /**
-     * Write single byte to buffer (ISR-safe)
+     * Write single byte to buffer (producer side, ISR-safe)
      * @param data Byte to write
      * @return true if write successful, false if buffer full
      */
-    bool write(uint8_t data);
-    
+    bool write(uint8_t data) {
+        index_t h = head;
+        if ((index_t)(h - load(tail)) >= N) {
+            overflowFlag = true;
+            return false;
+        }
+
+        bytes()[h & MASK] = data;
+        store(head, (index_t)(h + 1));
+        return true;
+    }
+
     /**
-     * Read single byte from buffer
+     * Read single byte from buffer (consumer side)
      * @param data Reference to store read byte
      * @return true if read successful, false if buffer empty
      */
-    bool read(uint8_t& data);
-    
+    bool read(uint8_t& data) {
+        index_t t = tail;
+        if (load(head) == t) {
+            return false;
+        }
+
+        data = bytes()[t & MASK];
+        store(tail, (index_t)(t + 1));
+        return true;
+    }
+
     /**
      * Peek at next byte without removing it
      * @param data Reference to store peeked byte
      * @return true if peek successful, false if buffer empty
      */
-    bool peek(uint8_t& data) const;
-    
+    bool peek(uint8_t& data) const {
+        index_t t = tail;
+        if (load(head) == t) {
+            return false;
+        }
+
+        data = bytes()[t & MASK];
+        return true;
+    }
+
     /**
      * Get number of bytes available for reading
      * @return Number of bytes in buffer
      */
-    size_t available() const;
-    
+    size_t available() const {
+        return (index_t)(load(head) - load(tail));
+    }
+
     /**
      * Get number of free bytes in buffer
      * @return Number of free bytes
      */
-    size_t free() const;
-    
+    size_t free() const {
+        return N - available();
+    }
+
     /**
      * Check if buffer is empty
      * @return true if buffer is empty
      */
-    bool isEmpty() const;
-    
+    bool isEmpty() const {
+        return available() == 0;
+    }
+
     /**
      * Check if buffer is full
      * @return true if buffer is full
      */
-    bool isFull() const;
-    
+    bool isFull() const {
+        return available() >= N;
+    }
+
     /**
-     * Clear buffer (reset to empty state)
+     * Clear buffer (consumer side: discards everything written so far)
      */
-    void clear();
-    
+    void clear() {
+        store(tail, load(head));
+        overflowFlag = false;
+    }
+
     /**
      * Check if overflow occurred
      * @return true if overflow detected
      */
-    bool hasOverflow() const;
-    
+    bool hasOverflow() const {
+        return overflowFlag;
+    }
+
     /**
      * Clear overflow flag
      */
-    void clearOverflow();
-    
+    void clearOverflow() {
+        overflowFlag = false;
+    }
+
     /**
      * Get buffer capacity
      * @return Total buffer size
      */
-    size_t capacity() const;
-    
+    static constexpr size_t capacity() {
+        return N;
+    }
+
     /**
-     * Read multiple bytes from buffer
+     * Read multiple bytes from buffer (consumer side)
      * @param dest Destination buffer
      * @param maxBytes Maximum bytes to read
      * @return Number of bytes actually read
      */
-    size_t readBytes(uint8_t* dest, size_t maxBytes);
-    
+    size_t readBytes(uint8_t* dest, size_t maxBytes) {
+        if (!dest || maxBytes == 0) {
+            return 0;
+        }
+
+        index_t t = tail;
+        size_t count = (index_t)(load(head) - t);
+        if (count > maxBytes) {
+            count = maxBytes;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            dest[i] = bytes()[(index_t)(t + i) & MASK];
+        }
+
+        store(tail, (index_t)(t + count));
+        return count;
+    }
+
     /**
-     * Write multiple bytes to buffer
+     * Expose the largest contiguous readable region in place (consumer side)
+     * The region stays valid until consume() is called; the producer never
+     * writes into it. Data that wraps past the end of storage is returned
+     * by the next call after consume().
+     * @param ptr Set to the first readable byte (unchanged if empty)
+     * @return Number of contiguous bytes at ptr (0 if buffer empty)
+     */
+    size_t peekContiguous(const uint8_t*& ptr) const {
+        index_t t = tail;
+        size_t count = (index_t)(load(head) - t);
+        if (count == 0) {
+            return 0;
+        }
+
+        size_t toEnd = N - (t & MASK);
+        ptr = &bytes()[t & MASK];
+        return count < toEnd ? count : toEnd;
+    }
+
+    /**
+     * Release bytes previously exposed by peekContiguous() (consumer side)
+     * @param numBytes Number of bytes to release
+     * @return Number of bytes actually released (clamped to available)
+     */
+    size_t consume(size_t numBytes) {
+        index_t t = tail;
+        size_t count = (index_t)(load(head) - t);
+        if (numBytes > count) {
+            numBytes = count;
+        }
+
+        store(tail, (index_t)(t + numBytes));
+        return numBytes;
+    }
+
+    /**
+     * Write multiple bytes to buffer (producer side)
      * @param src Source buffer
      * @param numBytes Number of bytes to write
      * @return Number of bytes actually written
      */
-    size_t writeBytes(const uint8_t* src, size_t numBytes);
-    
+    size_t writeBytes(const uint8_t* src, size_t numBytes) {
+        if (!src || numBytes == 0) {
+            return 0;
+        }
+
+        index_t h = head;
+        size_t space = N - (index_t)(h - load(tail));
+        size_t count = numBytes < space ? numBytes : space;
+
+        for (size_t i = 0; i < count; i++) {
+            bytes()[(index_t)(h + i) & MASK] = src[i];
+        }
+
+        store(head, (index_t)(h + count));
+
+        // Set overflow flag if we couldn't write all bytes
+        if (count < numBytes) {
+            overflowFlag = true;
+        }
+
+        return count;
+    }
+
     /**
      * Get buffer utilization percentage
      * @return Utilization (0-100)
      */
-    uint8_t getUtilization() const;
+    uint8_t getUtilization() const {
+        return (uint8_t)(((uint32_t)available() * 100) / N);
+    }
 };
 
-#endif // RINGBUFFER_H
\ No newline at end of file
+#endif // RINGBUFFER_H
@@ -13,27 +13,68 @@
  */
 class SDCardStoragePlugin : public IStoragePlugin {
 private:
+    // Card bring-up, stepped by update() so boot and capture never wait
+    enum InitState : uint8_t {
+        INIT_WAIT_CARD,         // No card detected
+        INIT_SETTLE,            // Card inserted, letting it power up
+        INIT_PROBE,             // Sending CMD0 until the card answers
+        INIT_MOUNTED,           // SD.begin() succeeded
+        INIT_FAILED             // Gave up; retried after the card is reinserted
+    };
+    
     bool initialized;
-    bool cardPresent;
+    bool cardPresent;           // Card detected and mounted
     bool writeProtected;
     bool debugEnabled;
     
     // Card information
     uint32_t cardSize;          // Total card size in bytes
-    uint32_t freeSpace;         // Available space in bytes
+    mutable uint32_t freeSpace; // Available space in bytes (cached)
+    mutable bool freeSpaceValid; // freeSpace is current
+    uint32_t lastCardPoll;      // millis() of the last card status read or probe
+    InitState initState;
+    uint32_t initStart;         // millis() when the card was detected
     
     // File operation buffer
     char pathBuffer[MAX_FILENAME_LENGTH + 8]; // Extra space for path
     
+    // Streaming write state (file stays open for the whole session)
+    File writeHandle;
+    bool writeOpen;
+    uint32_t writeSize;
+    uint32_t syncedSize;        // Bytes covered by the last metadata sync
+    
+    // Streaming read state
+    File readHandle;
+    bool readOpen;
+    
     /**
      * Check card presence and write protection
+     * Polled from update(), so reads and writes use the cached state
      */
     void checkCardStatus();
     
     /**
-     * Update free space information
+     * Refresh card status of a mounted card, unmounting it if removed
+     */
+    void pollCardStatus();
+    
+    /**
+     * Send CMD0 (GO_IDLE_STATE) with raw SPI at the probe clock
+     * Takes well under a millisecond whether or not a card answers
+     * @return true if the card replied in idle state
+     */
+    bool probeCard();
+    
+    /**
+     * Mount the responding card and read its size
+     */
+    void mountCard();
+    
+    /**
+     * Update free space information (computed on first use after a change)
      */
-    void updateFreeSpace();
+    void updateFreeSpace() const;
     
     /**
      * Ensure directory structure exists
@@ -56,16 +97,27 @@ public:
     // IStoragePlugin interface implementation
     int initialize() override;
     bool isReady() const override;
+    int update() override;
     StorageType getType() const override;
     const __FlashStringHelper* getName() const override;
     uint32_t getAvailableSpace() const override;
     uint32_t getTotalSpace() const override;
     size_t writeFile(const char* filename, const uint8_t* data, size_t size) override;
+    bool openWrite(const char* filename, uint32_t sizeHint) override;
+    size_t append(const uint8_t* data, size_t size) override;
+    bool closeWrite() override;
+    bool isWriteOpen() const override;
+    bool isBusy() const override;
     size_t readFile(const char* filename, uint8_t* data, size_t maxSize) override;
+    bool openRead(const char* filename) override;
+    size_t readChunk(uint8_t* data, size_t maxSize) override;
+    bool seekRead(uint32_t offset) override;
+    void closeRead() override;
     bool deleteFile(const char* filename) override;
     bool fileExists(const char* filename) const override;
     uint32_t getFileSize(const char* filename) const override;
-    size_t listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles) const override;
+    size_t listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles,
+                     size_t first) const override;
     bool format() override;
     bool getStatus(char* statusBuffer, size_t bufferSize) const override;
     bool validate() const override;
@@ -73,7 +125,7 @@ public:
     
     /**
      * Check if card is present
-     * @return true if SD card is detected
+     * @return true if SD card is detected and mounted
      */
     bool isCardPresent() const;
     
@@ -92,7 +144,8 @@ public:
     bool getCardType(char* typeBuffer, size_t bufferSize) const;
     
     /**
-     * Force card detection refresh
+     * Force card detection refresh (a mounted card only; insertion is
+     * picked up by update())
      */
     void refreshCardStatus();
     
@@ -114,11 +167,12 @@ public:
      * @param dirPath Directory path to list (nullptr for root)
      * @param filenames Array to store filenames
      * @param maxFiles Maximum number of files to list
+     * @param first Files to skip before the first one listed (paging)
      * @return Number of files found
      */
     size_t listFilesInDirectory(const char* dirPath, 
                                char filenames[][MAX_FILENAME_LENGTH], 
-                               size_t maxFiles) const;
+                               size_t maxFiles, size_t first) const;
 };
 
 #endif // SDCARDSTRAGEPLUGIN_H
\ No newline at end of file
@@ -0,0 +1,187 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "HardwareConfig.h"
+#include "ServiceLocator.h"
+#include "TaskProfiler.h"
+
+/**
+ * Scheduler - Cooperative, deadline-aware task table
+ * Replaces calling every component's update() on every loop. Each task
+ * has a period (0 = every pass) and a priority; run() makes one pass over
+ * the due tasks, highest priority first. A task may also have a ready
+ * predicate (the capture drain: "ring above its threshold"); such urgent
+ * tasks are checked before every other task, so the longest a waiting
+ * capture can sit is the longest single task slice. Long work (copies,
+ * erases) keeps its own bounded budget and yields early when
+ * isUrgentPending() says the drain is waiting.
+ * Static class with a fixed table, like ServiceLocator. Components are
+ * scheduled by type, so their update() is a direct call.
+ */
+class Scheduler {
+public:
+    typedef int (*TaskFunction)();
+    typedef bool (*ReadyFunction)();
+
+private:
+    struct Task {
+        TaskFunction function;
+        ReadyFunction ready;                // Urgent trigger, nullptr if none
+        const __FlashStringHelper* name;
+        uint16_t periodMs;
+        uint8_t priority;
+        uint32_t lastRun;                   // millis() of the last run
+        uint16_t maxRunUs;                  // Longest single run
+        uint32_t runs;
+#if TASK_PROFILER
+        TaskProfiler::Entry profile;
+#endif
+    };
+
+    static Task tasks[SCHEDULER_MAX_TASKS];
+    static uint8_t taskCount;
+    static uint32_t lastUrgentCheck;        // micros() of the last urgent check
+    static uint16_t maxUrgentGapUs;         // Longest time between checks
+
+#if IDLE_SLEEP
+    // Idle sleep statistics
+    static uint32_t sleepCount;
+    static uint32_t sleepMs;                // Time asleep
+    static uint16_t sleepCarryUs;           // Remainder not yet in sleepMs
+    static uint32_t statsStartMs;           // millis() the statistics start at
+    static bool wakePending;                // Slept, first byte not yet seen
+    static uint32_t byteWakes;              // Sleeps ended by captured data
+    static uint16_t lastWakeLatencyUs;
+    static uint16_t maxWakeLatencyUs;
+#endif
+
+    Scheduler() = delete;
+
+    /**
+     * Insert a task, keeping the table sorted by priority
+     * @param task Filled-in task
+     * @return false if the table is full
+     */
+    static bool insert(const Task& task);
+
+    /**
+     * Run one task and record its timing
+     * @param task Task to run
+     * @return The task's status code
+     */
+    static int runTask(Task& task);
+
+    /**
+     * Task body for a scheduled component
+     * @return The component's update() status
+     */
+    template <typename T>
+    static int updateComponent() {
+        return ServiceLocator::get<T>().update();
+    }
+
+public:
+    // Priorities: higher runs first within a pass
+    static constexpr uint8_t PRIORITY_CAPTURE = 200;
+    static constexpr uint8_t PRIORITY_IO = 150;
+    static constexpr uint8_t PRIORITY_STORAGE = 100;
+    static constexpr uint8_t PRIORITY_UI = 50;
+    static constexpr uint8_t PRIORITY_IDLE = 0;
+
+    /**
+     * Schedule a component's update()
+     * @tparam T Component type from ServiceLocator::Components
+     * @param periodMs Minimum time between runs, 0 for every pass
+     * @param priority Order within a pass (higher first)
+     * @return false if the table is full
+     */
+    template <typename T>
+    static bool addComponent(uint16_t periodMs, uint8_t priority) {
+        return addTask(ServiceLocator::get<T>().getName(), updateComponent<T>,
+                       periodMs, priority);
+    }
+
+    /**
+     * Schedule a function
+     * @param name Name shown by the "tasks" command
+     * @param function Task body, returns STATUS_OK or an error code
+     * @param periodMs Minimum time between runs, 0 for every pass
+     * @param priority Order within a pass (higher first)
+     * @param ready If set, the task also runs between any two tasks
+     *              whenever this returns true
+     * @return false if the table is full
+     */
+    static bool addTask(const __FlashStringHelper* name, TaskFunction function,
+                        uint16_t periodMs, uint8_t priority, ReadyFunction ready = nullptr);
+
+    /**
+     * Run every due task once
+     * @return STATUS_OK, or the first error a task returned
+     */
+    static int run();
+
+    /**
+     * Run the urgent tasks whose ready predicate is true
+     * @return STATUS_OK, or the first error a task returned
+     */
+    static int serviceUrgent();
+
+    /**
+     * Check if an urgent task is waiting (for long work to yield)
+     * @return true if a ready predicate is true
+     */
+    static bool isUrgentPending();
+
+    /**
+     * Sleep until the next interrupt if nothing is due
+     * The check runs with interrupts off, so a strobe arriving after it
+     * ends the sleep at once instead of waiting for the next tick.
+     * @param quiet Returns true while nothing needs polling (ring empty,
+     *              no job, transfer or command input)
+     * @return true if the CPU slept
+     */
+    static bool idle(ReadyFunction quiet);
+
+    /**
+     * Check if the CPU slept and no captured byte has been seen since
+     * @return true until recordWakeLatency() or the next sleep
+     */
+    static bool isWakePending();
+
+    /**
+     * Record how long the first byte after a sleep waited
+     * @param latencyUs Time from its strobe to the main loop taking it
+     */
+    static void recordWakeLatency(uint16_t latencyUs);
+
+    /**
+     * Print the task table and timing to serial
+     */
+    static void printStatistics();
+
+    /**
+     * Clear the timing statistics
+     */
+    static void resetStatistics();
+
+#if TASK_PROFILER
+    /**
+     * Print the profile of every task to serial
+     */
+    static void printProfile();
+
+    /**
+     * Clear the task profiles
+     */
+    static void resetProfile();
+#endif
+
+    /**
+     * Get the longest time urgent tasks went unchecked
+     * @return Microseconds
+     */
+    static uint16_t getMaxUrgentGap();
+};
+
+#endif // SCHEDULER_H
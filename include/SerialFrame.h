@@ -0,0 +1,81 @@
+#ifndef SERIALFRAME_H
+#define SERIALFRAME_H
+
+#include <Arduino.h>
+#include "HardwareConfig.h"
+#include "Crc32.h"
+
+// Arduino core UART transmit ring, filled by the senders and drained by the UDRE
+// interrupt (raised from the core default by the platformio build flags)
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE   64
+#endif
+
+/**
+ * SerialFrame - Binary packet framing shared by serial senders
+ * A packet is
+ *   type(1) sequence(2, LE) payload(0..SERIAL_FRAME_PAYLOAD) crc32(4, LE)
+ * COBS-encoded and delimited by 0x00 on both sides, so a receiver can
+ * resynchronise on the next zero after any damage. The caller builds the
+ * payload in place at frame + HEADER_SIZE; send() fills in the rest.
+ */
+namespace SerialFrame {
+    static constexpr uint8_t BEGIN = 'B';
+    static constexpr uint8_t DATA = 'D';
+    static constexpr uint8_t END = 'E';
+    static constexpr size_t HEADER_SIZE = 3;    // Type and sequence
+    static constexpr size_t CRC_SIZE = 4;
+    static constexpr size_t BUFFER_SIZE = HEADER_SIZE + SERIAL_FRAME_PAYLOAD + CRC_SIZE;
+    // Worst-case bytes on the wire: both delimiters plus one COBS code
+    // byte per block
+    static constexpr size_t WIRE_SIZE = BUFFER_SIZE + 3;
+    static_assert(BUFFER_SIZE < 254, "COBS packets must fit one code block");
+
+    /**
+     * Store a 32-bit value little-endian
+     * @param dest Four bytes to fill
+     * @param value Value to store
+     */
+    inline void putLE32(uint8_t* dest, uint32_t value) {
+        for (uint8_t i = 0; i < 4; i++) {
+            dest[i] = (uint8_t)(value >> (8 * i));
+        }
+    }
+
+    /**
+     * Seal a packet and send it COBS-encoded
+     * @param frame BUFFER_SIZE bytes, payload already at frame + HEADER_SIZE
+     * @param type BEGIN, DATA, END or a sender-specific type
+     * @param sequence Packet sequence number
+     * @param payloadSize Payload bytes in frame
+     */
+    inline void send(uint8_t* frame, uint8_t type, uint16_t sequence, size_t payloadSize) {
+        frame[0] = type;
+        frame[1] = (uint8_t)sequence;
+        frame[2] = (uint8_t)(sequence >> 8);
+
+        size_t length = HEADER_SIZE + payloadSize;
+        putLE32(frame + length, Crc32::compute(frame, length));
+        length += CRC_SIZE;
+
+        // COBS: every zero becomes the length of the block before it, so the
+        // packet contains no zeros and 0x00 can delimit it
+        Serial.write((uint8_t)0);
+        size_t start = 0;
+        for (;;) {
+            size_t end = start;
+            while (end < length && frame[end] != 0) {
+                end++;
+            }
+            Serial.write((uint8_t)(end - start + 1));
+            Serial.write(frame + start, end - start);
+            if (end == length) {
+                break;
+            }
+            start = end + 1;
+        }
+        Serial.write((uint8_t)0);
+    }
+}
+
+#endif // SERIALFRAME_H
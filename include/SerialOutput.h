@@ -0,0 +1,54 @@
+#ifndef SERIALOUTPUT_H
+#define SERIALOUTPUT_H
+
+#include <Arduino.h>
+#include "HardwareConfig.h"
+
+/**
+ * SerialOutput - Cooperative queue for diagnostic text
+ * Periodic status lines are printed here instead of straight to Serial.
+ * update() hands the UART only as many bytes as Serial.availableForWrite()
+ * reports, so a full TX ring never stalls the main loop, and holds the
+ * text back while a file is being streamed over serial: file data goes
+ * first and is never interleaved with diagnostics.
+ */
+class SerialOutput : public Print {
+private:
+    uint8_t queue[SERIAL_TEXT_QUEUE_SIZE];
+    uint8_t head;                   // Next byte to send
+    uint8_t count;                  // Bytes queued
+    uint16_t droppedBytes;          // Text lost to a full queue
+
+    static_assert(SERIAL_TEXT_QUEUE_SIZE <= 255, "Queue indices are 8 bits");
+
+public:
+    SerialOutput();
+
+    /**
+     * Queue one byte (dropped and counted if the queue is full)
+     * @param value Byte to send
+     * @return 1 if queued, 0 if dropped
+     */
+    size_t write(uint8_t value) override;
+    using Print::write;
+
+    /**
+     * Move queued text into the UART without blocking
+     * Call once per main loop iteration
+     */
+    void update();
+
+    /**
+     * Check if all queued text has been handed to the UART
+     * @return true if the queue is empty
+     */
+    bool isEmpty() const;
+
+    /**
+     * Get bytes lost because the queue was full
+     * @return Dropped byte count
+     */
+    uint16_t getDroppedBytes() const;
+};
+
+#endif // SERIALOUTPUT_H
@@ -0,0 +1,148 @@
+#ifndef SERIALRETRIEVAL_H
+#define SERIALRETRIEVAL_H
+
+#include <Arduino.h>
+#include "HardwareConfig.h"
+#include "Crc32.h"
+#include "SerialFrame.h"
+
+class FileSystemManager;
+
+/**
+ * SerialRetrieval - Windowed, resumable download of a stored file
+ * The host asks for a file from any offset ("get NAME OFFSET") and receives
+ * SerialFrame packets numbered from 0:
+ *   BEGIN (0)       payload = file size (u32 LE) + offset (u32 LE) + filename
+ *   DATA  (1..n)    payload = SERIAL_FRAME_PAYLOAD file bytes from offset on
+ *   END   (n + 1)   payload = file size (u32 LE) + CRC-32 of the bytes from
+ *                   offset to the end (u32 LE)
+ * Up to SERIAL_RETRIEVE_WINDOW packets are in flight. "ack SEQ" confirms
+ * everything up to SEQ and opens the window; "nak SEQ" goes back to SEQ.
+ * If the oldest packet stays unacknowledged for SERIAL_RETRIEVE_TIMEOUT_MS
+ * the window is sent again from there, and the transfer is dropped after
+ * SERIAL_RETRIEVE_RETRIES timeouts in a row. A host that lost the link
+ * resumes with "get NAME BYTES_ALREADY_RECEIVED".
+ */
+class SerialRetrieval {
+private:
+    // BEGIN carries two sizes and the name
+    static_assert(SERIAL_FRAME_PAYLOAD >= 8 + MAX_FILENAME_LENGTH,
+                  "A packet payload must hold a retrieval BEGIN");
+    static_assert(SERIAL_RETRIEVE_WINDOW > 0 && SERIAL_RETRIEVE_WINDOW < 0x8000,
+                  "The window must be well inside the 16-bit sequence space");
+
+    // Room a packet needs in the TX ring before it is started (capped so a
+    // small ring still makes progress, one blocking write at a time)
+    static constexpr size_t TX_RESERVE =
+        SerialFrame::WIRE_SIZE < SERIAL_TX_BUFFER_SIZE - 1 ? SerialFrame::WIRE_SIZE
+                                                           : SERIAL_TX_BUFFER_SIZE - 1;
+
+    uint8_t frame[SerialFrame::BUFFER_SIZE];
+    char filename[MAX_FILENAME_LENGTH];
+    bool active;
+
+    uint32_t fileSize;
+    uint32_t startOffset;       // First byte the host asked for
+    uint32_t baseSequence;      // Oldest unacknowledged packet
+    uint32_t nextSequence;      // Next packet to send
+    uint32_t sentLimit;         // First packet never sent
+    uint32_t endSequence;       // Sequence of the END packet
+    uint32_t lastProgress;      // millis() of the last ack or resend
+    uint8_t retries;            // Timeouts since the last ack
+    Crc32 rangeCrc;             // Data from startOffset sent so far
+
+    // Statistics
+    uint32_t filesSent;
+    uint32_t packetsResent;
+
+    /**
+     * Map a 16-bit wire sequence onto the packets in flight
+     * @param sequence Sequence number from the host
+     * @param full Set to the full sequence number
+     * @return true if the packet has been sent and not yet acknowledged
+     */
+    bool unwrap(uint16_t sequence, uint32_t& full) const;
+
+    /**
+     * Get the file offset of a DATA packet
+     * @param sequence Full sequence number
+     * @return Byte offset of its first byte
+     */
+    uint32_t dataOffset(uint32_t sequence) const;
+
+    /**
+     * Send packet nextSequence
+     * @param fs File system holding the open read
+     * @return true if sent, false on a read error
+     */
+    bool sendNext(FileSystemManager& fs);
+
+    /**
+     * Go back and resend from a packet
+     * @param fs File system holding the open read
+     * @param sequence Full sequence number to resend from
+     * @return true if the read position followed
+     */
+    bool rewind(FileSystemManager& fs, uint32_t sequence);
+
+public:
+    SerialRetrieval();
+
+    /**
+     * Start sending a file (replaces a retrieval in progress)
+     * @param fs File system to read from
+     * @param name File on the current storage
+     * @param offset First byte to send
+     * @return true if the file was opened and BEGIN is queued
+     */
+    bool start(FileSystemManager& fs, const char* name, uint32_t offset);
+
+    /**
+     * Send what the window and the TX ring allow; handle timeouts
+     * Call once per main loop iteration
+     * @param fs File system holding the open read
+     */
+    void update(FileSystemManager& fs);
+
+    /**
+     * Host received every packet up to and including sequence
+     * @param fs File system holding the open read
+     * @param sequence Last packet received in order
+     * @return true if the sequence was in flight
+     */
+    bool acknowledge(FileSystemManager& fs, uint16_t sequence);
+
+    /**
+     * Host is missing a packet: resend from it
+     * @param fs File system holding the open read
+     * @param sequence First packet missing
+     * @return true if the sequence was in flight
+     */
+    bool resendFrom(FileSystemManager& fs, uint16_t sequence);
+
+    /**
+     * Drop the retrieval in progress
+     * @param fs File system holding the open read
+     */
+    void stop(FileSystemManager& fs);
+
+    /**
+     * Check if a file is being sent
+     * @return true while a retrieval owns the serial link
+     */
+    bool isActive() const;
+
+    /**
+     * Get the number of files sent and fully acknowledged
+     * @return File count
+     */
+    uint32_t getFilesSent() const;
+
+    /**
+     * Get the number of packets sent more than once
+     * @return Resent packet count
+     */
+    uint32_t getPacketsResent() const;
+};
+
+#endif // SERIALRETRIEVAL_H
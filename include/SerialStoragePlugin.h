@@ -4,11 +4,22 @@
 #include <Arduino.h>
 #include "IStoragePlugin.h"
 #include "HardwareConfig.h"
+#include "Crc32.h"
+#include "SerialFrame.h"
 
 /**
  * Serial Storage Plugin
  * Implements real-time hex streaming protocol for data export
- * Uses BEGIN/END delimiters with CRLF line formatting (64 bytes per line)
+ * Uses BEGIN/END delimiters with CRLF line formatting (64 bytes per line);
+ * a CRC32: line ahead of END: lets the receiver check the transfer
+ *
+ * Binary mode sends the same transfer as SerialFrame packets:
+ *   FRAME_BEGIN  payload = size hint (u32 LE, 0 if unknown) + filename
+ *   FRAME_DATA   payload = file bytes
+ *   FRAME_END    payload = file size (u32 LE) + file CRC-32 (u32 LE)
+ * The sequence restarts at 0 with each FRAME_BEGIN, so a receiver can
+ * tell a lost packet from a corrupted one. Text printed between packets
+ * (debug output) fails the packet CRC and is skipped by the receiver.
  */
 class SerialStoragePlugin : public IStoragePlugin {
 private:
@@ -21,15 +32,39 @@ private:
     uint32_t totalBytesTransferred;
     uint32_t totalFilesTransferred;
     
-    // Hex formatting buffers - FINAL OPTIMIZATION
-    char hexLineBuffer[8];      // FINAL: Only 8 bytes for 80% target
-    char hexByteBuffer[2];      // FINAL: 2 bytes minimum
-    
     // Protocol constants
     static constexpr size_t HEX_BYTES_PER_LINE = 8; // CRITICAL: 8 bytes per line (16 hex chars)
+    
+    // Output of one TRANSFER_BUFFER_SIZE append as hex lines (a binary
+    // packet is smaller); the plugin reports busy until the TX ring has
+    // room for it, so a copy never waits for the UART
+    static constexpr size_t APPEND_OUTPUT_MAX =
+        (TRANSFER_BUFFER_SIZE + HEX_BYTES_PER_LINE - 1) / HEX_BYTES_PER_LINE *
+        (HEX_BYTES_PER_LINE * 2 + 2);
+    static constexpr size_t TX_RESERVE =
+        APPEND_OUTPUT_MAX < SERIAL_TX_BUFFER_SIZE - 1 ? APPEND_OUTPUT_MAX : SERIAL_TX_BUFFER_SIZE - 1;
+    
+    // Binary packet framing
+    static constexpr uint8_t FRAME_BEGIN = SerialFrame::BEGIN;
+    static constexpr uint8_t FRAME_DATA = SerialFrame::DATA;
+    static constexpr uint8_t FRAME_END = SerialFrame::END;
+    static_assert(SERIAL_FRAME_PAYLOAD >= HEX_BYTES_PER_LINE &&
+                  SERIAL_FRAME_PAYLOAD >= 4 + MAX_FILENAME_LENGTH,
+                  "A packet payload must hold a hex line and a FRAME_BEGIN");
+    
+    // Streaming write state: the packet being built; its payload area holds
+    // the current (partial) hex line in hex mode
+    uint8_t frame[SerialFrame::BUFFER_SIZE];
+    uint8_t lineFill;
+    uint16_t frameSequence;     // Sequence number of the next packet
+    bool binaryMode;
+    uint32_t streamAddress;
+    uint32_t streamSizeHint;    // SIZE: already sent in the header, 0 if not
+    Crc32 streamCrc;            // Checksum of the bytes sent so far
     static constexpr char PROTOCOL_BEGIN[] = "BEGIN:";
     static constexpr char PROTOCOL_END[] = "END:";
     static constexpr char PROTOCOL_SIZE[] = "SIZE:";
+    static constexpr char PROTOCOL_CRC[] = "CRC32:";
     static constexpr char PROTOCOL_CRLF[] = "\r\n";
     
     /**
@@ -55,7 +90,7 @@ private:
     void sendProtocolHeader(const char* filename, uint32_t fileSize);
     
     /**
-     * Send protocol footer
+     * Send protocol footer (CRC32: of the streamed data, then END:)
      * @param filename File name
      */
     void sendProtocolFooter(const char* filename);
@@ -68,6 +103,24 @@ private:
      */
     void sendHexLine(const uint8_t* data, size_t size, uint32_t address);
     
+    /**
+     * Get the payload area of frame[]
+     * @return First payload byte
+     */
+    uint8_t* payload() { return frame + SerialFrame::HEADER_SIZE; }
+    
+    /**
+     * Seal the packet in frame[] and send it COBS-encoded
+     * @param type FRAME_BEGIN, FRAME_DATA or FRAME_END
+     * @param payloadSize Payload bytes already in frame[]
+     */
+    void sendFrame(uint8_t type, size_t payloadSize);
+    
+    /**
+     * Send the bytes of the current line or packet
+     */
+    void sendPending();
+    
     /**
      * Wait for serial output to complete
      */
@@ -93,16 +146,27 @@ public:
     // IStoragePlugin interface implementation
     int initialize() override;
     bool isReady() const override;
+    int update() override;
     StorageType getType() const override;
     const __FlashStringHelper* getName() const override;
     uint32_t getAvailableSpace() const override;
     uint32_t getTotalSpace() const override;
     size_t writeFile(const char* filename, const uint8_t* data, size_t size) override;
+    bool openWrite(const char* filename, uint32_t sizeHint) override;
+    size_t append(const uint8_t* data, size_t size) override;
+    bool closeWrite() override;
+    bool isWriteOpen() const override;
+    bool isBusy() const override;
     size_t readFile(const char* filename, uint8_t* data, size_t maxSize) override;
+    bool openRead(const char* filename) override;
+    size_t readChunk(uint8_t* data, size_t maxSize) override;
+    bool seekRead(uint32_t offset) override;
+    void closeRead() override;
     bool deleteFile(const char* filename) override;
     bool fileExists(const char* filename) const override;
     uint32_t getFileSize(const char* filename) const override;
-    size_t listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles) const override;
+    size_t listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles,
+                     size_t first) const override;
     bool format() override;
     bool getStatus(char* statusBuffer, size_t bufferSize) const override;
     bool validate() const override;
@@ -169,6 +233,19 @@ public:
      */
     bool testProtocol();
     
+    /**
+     * Select the transfer encoding
+     * @param enabled true for COBS-framed binary packets, false for hex lines
+     * @return false if a transfer is in progress (mode unchanged)
+     */
+    bool setBinaryMode(bool enabled);
+    
+    /**
+     * Check the transfer encoding
+     * @return true if binary packets are sent
+     */
+    bool isBinaryMode() const;
+    
     /**
      * Set hex bytes per line (for different terminal capabilities)
      * @param bytesPerLine Bytes per hex line (max 64)
@@ -3,6 +3,8 @@
 
 #include <Arduino.h>
 #include "IComponent.h"
+#include "HardwareConfig.h"
+#include "TaskProfiler.h"
 
 // Forward declarations
 class ParallelPortManager;
@@ -13,141 +15,218 @@ class TimeManager;
 class SystemManager;
 class HeartbeatLEDManager;
 
+/**
+ * Compile-time list of component types
+ * The order is the initialize/update/validate order.
+ */
+template <typename... Types>
+struct ComponentList {
+    static constexpr size_t count = sizeof...(Types);
+
+    /**
+     * Get the position of a type in the list
+     * @return Index, or count if the type is not listed
+     */
+    template <typename T>
+    static constexpr size_t indexOf() {
+        constexpr bool matches[] = {Same<T, Types>::value..., false};
+        for (size_t i = 0; i < count; i++) {
+            if (matches[i]) {
+                return i;
+            }
+        }
+        return count;
+    }
+
+private:
+    template <typename A, typename B> struct Same { static constexpr bool value = false; };
+    template <typename A> struct Same<A, A> { static constexpr bool value = true; };
+};
+
+/**
+ * Statically allocated instance of a component
+ * Specialized and defined in ServiceLocator.cpp for every listed type, as
+ * plain globals (no template initialization guards).
+ */
+template <typename T>
+struct ComponentSlot {
+    static T instance;
+};
+
+template <> ParallelPortManager ComponentSlot<ParallelPortManager>::instance;
+template <> FileSystemManager ComponentSlot<FileSystemManager>::instance;
+template <> DisplayManager ComponentSlot<DisplayManager>::instance;
+template <> ConfigurationManager ComponentSlot<ConfigurationManager>::instance;
+template <> TimeManager ComponentSlot<TimeManager>::instance;
+template <> SystemManager ComponentSlot<SystemManager>::instance;
+template <> HeartbeatLEDManager ComponentSlot<HeartbeatLEDManager>::instance;
+
 /**
  * ServiceLocator pattern implementation for component management
  * Provides centralized access to all system components
  * Uses static allocation for zero-allocation architecture
+ * The component set is the Components type list: every instance is a
+ * statically allocated ComponentSlot, accessors are constant addresses, and
+ * the *All() operations expand into a direct (non-virtual) call per type.
  */
 class ServiceLocator {
+public:
+    typedef ComponentList<
+        ParallelPortManager,
+        FileSystemManager,
+        DisplayManager,
+        ConfigurationManager,
+        TimeManager,
+        SystemManager,
+        HeartbeatLEDManager
+    > Components;
+
 private:
-    // Component pointers
-    static ParallelPortManager* parallelPortManager;
-    static FileSystemManager* fileSystemManager;
-    static DisplayManager* displayManager;
-    static ConfigurationManager* configurationManager;
-    static TimeManager* timeManager;
-    static SystemManager* systemManager;
-    static HeartbeatLEDManager* heartbeatLEDManager;
-    
-    // Cached component array for iteration
-    static IComponent* components[7];
-    static bool componentsInitialized;
-    
+#if TASK_PROFILER
+    // Per-component timing of initializeAll() and updateAll()
+    static TaskProfiler::Entry initProfile[Components::count];
+    static TaskProfiler::Entry updateProfile[Components::count];
+#endif
+
     // Private constructor - static class
     ServiceLocator() = delete;
-    
+
 public:
     /**
-     * Register all components with the service locator
-     * Must be called during system initialization
+     * Get a component instance
+     * @return Reference to the statically allocated component
      */
-    static void registerComponents(
-        ParallelPortManager* ppm,
-        FileSystemManager* fsm,
-        DisplayManager* dm,
-        ConfigurationManager* cm,
-        TimeManager* tm,
-        SystemManager* sm,
-        HeartbeatLEDManager* hlm
-    );
-    
+    template <typename T>
+    static T& get() {
+        static_assert(Components::indexOf<T>() < Components::count,
+                      "Type is not in ServiceLocator::Components");
+        return ComponentSlot<T>::instance;
+    }
+
     /**
      * Get ParallelPortManager instance
-     * @return Pointer to ParallelPortManager or nullptr if not registered
+     * @return Pointer to ParallelPortManager (never nullptr)
      */
-    static ParallelPortManager* getParallelPortManager();
-    
+    static ParallelPortManager* getParallelPortManager() {
+        return &get<ParallelPortManager>();
+    }
+
     /**
      * Get FileSystemManager instance
-     * @return Pointer to FileSystemManager or nullptr if not registered
+     * @return Pointer to FileSystemManager (never nullptr)
      */
-    static FileSystemManager* getFileSystemManager();
-    
+    static FileSystemManager* getFileSystemManager() {
+        return &get<FileSystemManager>();
+    }
+
     /**
      * Get DisplayManager instance
-     * @return Pointer to DisplayManager or nullptr if not registered
+     * @return Pointer to DisplayManager (never nullptr)
      */
-    static DisplayManager* getDisplayManager();
-    
+    static DisplayManager* getDisplayManager() {
+        return &get<DisplayManager>();
+    }
+
     /**
      * Get ConfigurationManager instance
-     * @return Pointer to ConfigurationManager or nullptr if not registered
+     * @return Pointer to ConfigurationManager (never nullptr)
      */
-    static ConfigurationManager* getConfigurationManager();
-    
+    static ConfigurationManager* getConfigurationManager() {
+        return &get<ConfigurationManager>();
+    }
+
     /**
      * Get TimeManager instance
-     * @return Pointer to TimeManager or nullptr if not registered
+     * @return Pointer to TimeManager (never nullptr)
      */
-    static TimeManager* getTimeManager();
-    
+    static TimeManager* getTimeManager() {
+        return &get<TimeManager>();
+    }
+
     /**
      * Get SystemManager instance
-     * @return Pointer to SystemManager or nullptr if not registered
+     * @return Pointer to SystemManager (never nullptr)
      */
-    static SystemManager* getSystemManager();
-    
+    static SystemManager* getSystemManager() {
+        return &get<SystemManager>();
+    }
+
     /**
      * Get HeartbeatLEDManager instance
-     * @return Pointer to HeartbeatLEDManager or nullptr if not registered
+     * @return Pointer to HeartbeatLEDManager (never nullptr)
      */
-    static HeartbeatLEDManager* getHeartbeatLEDManager();
-    
+    static HeartbeatLEDManager* getHeartbeatLEDManager() {
+        return &get<HeartbeatLEDManager>();
+    }
+
     /**
-     * Get array of all registered components
-     * @param count Output parameter for number of components
-     * @return Array of component pointers
+     * Call a function for every component, in list order (for debugging)
+     * @param visit Function called with each component
      */
-    static IComponent** getAllComponents(size_t& count);
-    
+    static void forEachComponent(void (*visit)(IComponent& component));
+
     /**
      * Initialize all registered components
      * @return STATUS_OK if all components initialized successfully
      */
     static int initializeAll();
-    
+
     /**
      * Update all registered components
      * @return STATUS_OK if all components updated successfully
      */
     static int updateAll();
-    
+
     /**
      * Validate all registered components
      * @return true if all components are in valid state
      */
     static bool validateAll();
-    
+
     /**
      * Reset all registered components
      * @return STATUS_OK if all components reset successfully
      */
     static int resetAll();
-    
+
     /**
      * Get total memory usage of all components
      * @return Total memory usage in bytes
      */
     static size_t getTotalMemoryUsage();
-    
+
     /**
      * Check if all components are registered
-     * @return true if all expected components are registered
+     * @return Always true: the component set is fixed at compile time
      */
-    static bool allComponentsRegistered();
-    
+    static constexpr bool allComponentsRegistered() {
+        return true;
+    }
+
     /**
      * Get component by name (for debugging)
      * @param name Component name to find
      * @return Pointer to component or nullptr if not found
      */
     static IComponent* getComponentByName(const char* name);
-    
+
     /**
      * Enable/disable debug output for all components
      * @param enabled true to enable debug output
      */
     static void setAllDebugEnabled(bool enabled);
+
+#if TASK_PROFILER
+    /**
+     * Print the per-component initialize() and updateAll() profiles
+     */
+    static void printProfile();
+
+    /**
+     * Clear the updateAll() profiles (initialize() runs once and is kept)
+     */
+    static void resetProfile();
+#endif
 };
 
-#endif // SERVICELOCATOR_H
\ No newline at end of file
+#endif // SERVICELOCATOR_H
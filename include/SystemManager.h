@@ -9,7 +9,7 @@
  * SystemManager - Health monitoring and validation (placeholder)
  * Will implement system health monitoring and component validation
  */
-class SystemManager : public IComponent {
+class SystemManager final : public IComponent {
 private:
     bool initialized;
     bool debugEnabled;
@@ -0,0 +1,107 @@
+#ifndef TASKPROFILER_H
+#define TASKPROFILER_H
+
+#include <Arduino.h>
+#include "HardwareConfig.h"
+
+/**
+ * TaskProfiler - Execution time of scheduled tasks and component bring-up
+ * Timer1 runs free at F_CPU/8 (the same time base as the LPT timing
+ * histograms), so each run is measured to half a microsecond from two
+ * register reads. Runs longer than one Timer1 wrap (32.8ms) fall back to
+ * micros(). Users compile their entries and calls out with TASK_PROFILER=0.
+ */
+class TaskProfiler {
+public:
+    struct Entry {
+        uint32_t calls;
+        uint32_t totalUs;           // Sum of run times (wraps after 71 minutes)
+        uint32_t maxTicks;          // Timer1 ticks
+        uint32_t lastTicks;
+        uint8_t carry;              // Ticks not yet added to totalUs
+    };
+
+    // Start of one measured run
+    struct Mark {
+        uint16_t tick;
+        uint32_t us;
+    };
+
+    /**
+     * Start Timer1 as the time base (harmless if it already runs)
+     */
+    static void begin() {
+        TCCR1A = 0;
+        TCCR1B = _BV(CS11);
+        TIMSK1 = 0;
+    }
+
+    /**
+     * Take the start mark of a run
+     * @param mark Set to the current time
+     */
+    static void start(Mark& mark) {
+        mark.us = micros();
+        mark.tick = TCNT1;
+    }
+
+    /**
+     * Get the time since a start mark
+     * @param mark Start mark from start()
+     * @return Timer1 ticks (from micros() past one Timer1 wrap)
+     */
+    static uint32_t elapsed(const Mark& mark) {
+        uint16_t ticks16 = TCNT1 - mark.tick;
+        uint32_t us = micros() - mark.us;
+        return us >= (uint32_t)LPT_HIST_WRAP_MS * 1000 ? us * LPT_HIST_TICKS_PER_US : ticks16;
+    }
+
+    /**
+     * Record a finished run
+     * @param entry Statistics to update
+     * @param mark Start mark from start()
+     */
+    static void stop(Entry& entry, const Mark& mark) {
+        uint32_t ticks = elapsed(mark);
+
+        uint32_t total = ticks + entry.carry;
+        entry.calls++;
+        entry.totalUs += total / LPT_HIST_TICKS_PER_US;
+        entry.carry = total % LPT_HIST_TICKS_PER_US;
+        entry.lastTicks = ticks;
+        if (ticks > entry.maxTicks) {
+            entry.maxTicks = ticks;
+        }
+    }
+
+    /**
+     * Clear an entry
+     * @param entry Statistics to clear
+     */
+    static void reset(Entry& entry) {
+        entry.calls = 0;
+        entry.totalUs = 0;
+        entry.maxTicks = 0;
+        entry.lastTicks = 0;
+        entry.carry = 0;
+    }
+
+    /**
+     * Print "calls, total/max/last/avg us" for an entry
+     * @param entry Statistics to print
+     */
+    static void print(const Entry& entry) {
+        Serial.print(entry.calls);
+        Serial.print(F(" calls, total "));
+        Serial.print(entry.totalUs);
+        Serial.print(F("us, max "));
+        Serial.print(entry.maxTicks / LPT_HIST_TICKS_PER_US);
+        Serial.print(F(", last "));
+        Serial.print(entry.lastTicks / LPT_HIST_TICKS_PER_US);
+        Serial.print(F(", avg "));
+        Serial.print(entry.calls ? entry.totalUs / entry.calls : 0);
+        Serial.println(F("us"));
+    }
+};
+
+#endif // TASKPROFILER_H
@@ -4,58 +4,104 @@
 #include <Arduino.h>
 #include "IComponent.h"
 #include "HardwareConfig.h"
+#include "DateTime.h"
 
 /**
- * TimeManager - DS1307 RTC integration (placeholder)
- * Will implement real-time clock operations for timestamp generation
+ * TimeManager - Cached DS1307 time service
+ * The RTC is read over I2C at boot and then once a minute from update(),
+ * deferred while the parallel port is busy; now() adds the millis()
+ * elapsed since the last read, so timestamps cost no I2C traffic. Without
+ * a running RTC the clock counts from 2000-01-01 and isTimeValid() is
+ * false until the time is set.
  */
-class TimeManager : public IComponent {
+class TimeManager final : public IComponent {
 private:
     bool initialized;
     bool debugEnabled;
     
+    // Time base: RTC seconds at baseMillis
+    bool timeValid;                // Base came from a running RTC (or was set)
+    uint32_t baseSeconds;          // Seconds since 2000-01-01 00:00:00
+    uint32_t baseMillis;
+    uint32_t lastSyncAttempt;      // millis() of the last RTC read attempt
+    
+    // Statistics
+    uint32_t syncCount;
+    uint32_t syncErrors;
+    
+    /**
+     * Read the time from the DS1307
+     * @param time Receives the RTC time
+     * @return true if the chip answered and its oscillator runs
+     */
+    bool readRtc(DateTime& time);
+    
+    /**
+     * Re-read the RTC into the time base
+     * Keeps counting from millis() if the read fails
+     * @return true if the RTC was read
+     */
+    bool sync();
+    
+    /**
+     * Fold whole elapsed seconds into the base (keeps millis() wrap out)
+     */
+    void advanceBase();
+    
 public:
-    TimeManager() : initialized(false), debugEnabled(false) {}
+    TimeManager();
     ~TimeManager() override = default;
     
     // IComponent interface implementation
-    int initialize() override { 
-        initialized = true; 
-        return STATUS_OK; 
-    }
-    
-    int update() override { 
-        return STATUS_OK; 
-    }
-    
-    int getStatus() const override { 
-        return initialized ? STATUS_OK : STATUS_NOT_INITIALIZED; 
-    }
-    
-    const __FlashStringHelper* getName() const override {
-        return F("TimeManager");
-    }
-    
-    bool validate() const override { 
-        return initialized; 
-    }
-    
-    int reset() override { 
-        initialized = false; 
-        return initialize(); 
-    }
-    
-    size_t getMemoryUsage() const override { 
-        return sizeof(*this); 
-    }
-    
-    void setDebugEnabled(bool enabled) override { 
-        debugEnabled = enabled; 
-    }
-    
-    bool isDebugEnabled() const override { 
-        return debugEnabled; 
-    }
+    int initialize() override;
+    int update() override;
+    int getStatus() const override;
+    const __FlashStringHelper* getName() const override;
+    bool validate() const override;
+    int reset() override;
+    size_t getMemoryUsage() const override;
+    void setDebugEnabled(bool enabled) override;
+    bool isDebugEnabled() const override;
+    
+    /**
+     * Get the current time (no I2C traffic)
+     * @return Seconds since 2000-01-01 00:00:00
+     */
+    uint32_t now() const;
+    
+    /**
+     * Get the current calendar time (no I2C traffic)
+     * @return Calendar time
+     */
+    DateTime getDateTime() const;
+    
+    /**
+     * Check if the time is real
+     * @return true if it came from a running RTC or setDateTime()
+     */
+    bool isTimeValid() const;
+    
+    /**
+     * Write the current time as a filename stamp ("DDHHMMSS")
+     * @param dest Buffer to receive the stamp
+     * @param destSize Size of dest (at least DATETIME_STAMP_LENGTH + 1)
+     * @return false if the time is not valid (caller falls back to a counter)
+     */
+    bool formatFilenameStamp(char* dest, size_t destSize) const;
+    
+    /**
+     * Set the RTC (starts its oscillator) and the time base
+     * @param time New time
+     * @return true if the RTC accepted it (the base is set either way)
+     */
+    bool setDateTime(const DateTime& time);
+    
+    /**
+     * Get RTC read statistics
+     * @param reads Successful reads
+     * @param errors Failed reads
+     */
+    void getSyncStats(uint32_t& reads, uint32_t& errors) const;
 };
 
-#endif // TIMEMANAGER_H
\ No newline at end of file
+#endif // TIMEMANAGER_H
@@ -0,0 +1,112 @@
+#ifndef TIMINGHISTOGRAM_H
+#define TIMINGHISTOGRAM_H
+
+#ifdef UNIT_TEST
+#include <stdint.h>
+#include <stddef.h>
+#else
+#include <Arduino.h>
+#endif
+
+// log2 buckets for 16-bit tick counts plus one timer-overflow bucket
+#define TIMING_HISTOGRAM_BUCKETS    17
+#define TIMING_HISTOGRAM_OVERFLOW   (TIMING_HISTOGRAM_BUCKETS - 1)
+
+/**
+ * Fixed-bucket log2 histogram of 16-bit timer tick counts
+ * Bucket 0 holds 0-1 ticks, bucket i (1..15) holds [2^i, 2^(i+1)) ticks
+ * and the last bucket counts intervals longer than the timer can measure.
+ * Counters saturate instead of wrapping. record() is branch-light and
+ * loop-free so it can run inside the strobe ISR.
+ */
+class TimingHistogram {
+private:
+    uint16_t counts[TIMING_HISTOGRAM_BUCKETS];
+
+    inline void bump(uint8_t bucket) {
+        if (counts[bucket] != 0xFFFF) {
+            counts[bucket]++;
+        }
+    }
+
+public:
+    /**
+     * Constructor - initializes empty histogram
+     */
+    TimingHistogram() : counts() {}
+
+    /**
+     * Get bucket index for a tick count (floor(log2(ticks)), 0 for 0)
+     * @param ticks Timer ticks
+     * @return Bucket index 0..15
+     */
+    static inline uint8_t bucketOf(uint16_t ticks) {
+        uint8_t bucket = 0;
+        uint8_t value = (uint8_t)(ticks >> 8);
+        if (value) {
+            bucket = 8;
+        } else {
+            value = (uint8_t)ticks;
+        }
+        if (value & 0xF0) { bucket += 4; value >>= 4; }
+        if (value & 0x0C) { bucket += 2; value >>= 2; }
+        if (value & 0x02) { bucket += 1; }
+        return bucket;
+    }
+
+    /**
+     * Record one measured interval
+     * @param ticks Interval in timer ticks
+     */
+    inline void record(uint16_t ticks) {
+        bump(bucketOf(ticks));
+    }
+
+    /**
+     * Record an interval longer than the timer range
+     */
+    inline void recordOverflow() {
+        bump(TIMING_HISTOGRAM_OVERFLOW);
+    }
+
+    /**
+     * Clear all buckets
+     */
+    void reset() {
+        for (uint8_t i = 0; i < TIMING_HISTOGRAM_BUCKETS; i++) {
+            counts[i] = 0;
+        }
+    }
+
+    /**
+     * Get count for a bucket
+     * @param bucket Bucket index
+     * @return Sample count (saturates at 65535)
+     */
+    uint16_t getCount(uint8_t bucket) const {
+        return bucket < TIMING_HISTOGRAM_BUCKETS ? counts[bucket] : 0;
+    }
+
+    /**
+     * Get total samples across all buckets
+     * @return Sample count
+     */
+    uint32_t getTotal() const {
+        uint32_t total = 0;
+        for (uint8_t i = 0; i < TIMING_HISTOGRAM_BUCKETS; i++) {
+            total += counts[i];
+        }
+        return total;
+    }
+
+    /**
+     * Get lower bound of a bucket in ticks
+     * @param bucket Bucket index 0..15
+     * @return Smallest tick count in the bucket
+     */
+    static uint16_t lowerBound(uint8_t bucket) {
+        return bucket == 0 ? 0 : (uint16_t)(1u << bucket);
+    }
+};
+
+#endif // TIMINGHISTOGRAM_H
@@ -4,10 +4,15 @@
 #include "MemoryUtils.h"
 #include "HardwareSelfTest.h"
 #include "HardwareComponentTests.h"
+#include "HardwareBenchmark.h"
 #include "ParallelPortManager.h"
 #include "FileSystemManager.h"
 #include "DisplayManager.h"
 #include "HeartbeatLEDManager.h"
+#include "CaptureSession.h"
+#include "Scheduler.h"
+#include "TimeManager.h"
+#include "ConfigurationManager.h"
 
 /**
  * Debug Commands Implementation
@@ -20,6 +25,14 @@ namespace DebugCommands {
 static char commandBuffer[COMMAND_BUFFER_SIZE];
 static bool commandReady = false;
 
+// Capture session (not a ServiceLocator component)
+static CaptureSession* captureSession = nullptr;
+
+// Link speed negotiation: a new rate only stays once the host confirms it
+static uint32_t linkBaud = SERIAL_BAUD_RATE;
+static uint32_t fallbackBaud = 0;      // Rate to return to, 0 if confirmed
+static uint32_t baudSwitchTime = 0;
+
 /**
  * Process serial input and build command buffer
  */
@@ -33,6 +46,8 @@ void processSerialInput() {
             if (commandPos > 0) {
                 commandBuffer[commandPos] = '\0';
                 commandReady = true;
+                commandPos = 0;
+                return;
             }
         } else if (commandPos < COMMAND_BUFFER_SIZE - 1) {
             commandBuffer[commandPos++] = ch;
@@ -54,6 +69,9 @@ void showHelp() {
     Serial.println(F("  info          - System information"));
     Serial.println(F("  status        - Component status"));
     Serial.println(F("  validate      - Validate all components"));
+    Serial.println(F("  config        - Show stored tunables"));
+    Serial.println(F("  config set {key} {value} - Change one (applies now)"));
+    Serial.println(F("  config save/defaults - Store / restore defaults"));
     Serial.println(F("  restart       - Software restart"));
     Serial.println(F("  selftest      - Run hardware self-test"));
     Serial.println(F("  hwtest        - Comprehensive hardware tests"));
@@ -63,6 +81,14 @@ void showHelp() {
     Serial.println(F("  storage sd    - Switch to SD card"));
     Serial.println(F("  storage eeprom - Switch to EEPROM"));
     Serial.println(F("  storage serial - Switch to Serial"));
+    Serial.println(F("  copyto {storage} {file} - Copy file from current storage"));
+    Serial.println(F("  copyto cancel - Cancel running copy"));
+    Serial.println(F("  serial hex|binary - Serial transfer format"));
+    Serial.println(F("  baud {rate}   - Switch link speed (confirm: baud ok)"));
+    Serial.println(F("  passthru on/off - Forward captures live to serial"));
+    Serial.println(F("  files [first] - List files with sizes (for the host)"));
+    Serial.println(F("  get {file} [offset] - Send file in acked packets"));
+    Serial.println(F("  ack/nak {seq} - Confirm/resend retrieval packets"));
     Serial.println(F("  list          - List files"));
     Serial.println(F("  testwrite     - Test file write"));
     Serial.println();
@@ -70,12 +96,20 @@ void showHelp() {
     Serial.println(F("  parallel      - Parallel port status"));
     Serial.println(F("  testint       - Test interrupts (10s)"));
     Serial.println(F("  testlpt       - Test LPT signals"));
+    Serial.println(F("  timing        - ISR/strobe timing histograms"));
+    Serial.println(F("  timing reset  - Reset timing statistics"));
     Serial.println(F("  buttons       - Show button values"));
     Serial.println(F("  led on/off    - Control LEDs"));
+    Serial.println(F("  time          - Show clock and RTC reads"));
+    Serial.println(F("  time set YYYY-MM-DD HH:MM[:SS] - Set RTC"));
     Serial.println();
     Serial.println(F("Debug Commands:"));
     Serial.println(F("  debug on/off  - Enable/disable debug"));
     Serial.println(F("  memory        - Memory usage info"));
+    Serial.println(F("  tasks         - Scheduler task timing"));
+    Serial.println(F("  tasks reset   - Reset task timing"));
+    Serial.println(F("  prof          - Dump and reset profiler"));
+    Serial.println(F("  bench [flash|sd|serial|lcd|loop] - Timed benchmarks"));
     Serial.println(F("  reset         - Reset components"));
     Serial.println();
 }
@@ -109,46 +143,90 @@ void showSystemInfo() {
     Serial.println();
 }
 
+/**
+ * Print one component's status line
+ */
+void printComponentStatus(IComponent& component) {
+    Serial.print(component.getName());
+    Serial.print(F(": "));
+    
+    int status = component.getStatus();
+    switch (status) {
+        case STATUS_OK:
+            Serial.print(F("OK"));
+            break;
+        case STATUS_ERROR:
+            Serial.print(F("ERROR"));
+            break;
+        case STATUS_NOT_INITIALIZED:
+            Serial.print(F("NOT_INIT"));
+            break;
+        case STATUS_BUSY:
+            Serial.print(F("BUSY"));
+            break;
+        default:
+            Serial.print(F("UNKNOWN("));
+            Serial.print(status);
+            Serial.print(F(")"));
+            break;
+    }
+    
+    Serial.print(F(" ("));
+    Serial.print(component.getMemoryUsage());
+    Serial.println(F(" bytes)"));
+}
+
+/**
+ * Print one component's static footprint line
+ */
+void printComponentMemory(IComponent& component) {
+    Serial.print(F("  "));
+    Serial.print(component.getName());
+    Serial.print(F(": "));
+    Serial.print(component.getMemoryUsage());
+    Serial.println(F(" bytes"));
+}
+
+/**
+ * Show the RAM layout, the stack high-water mark and component footprints
+ */
+void showMemoryUsage() {
+    Serial.println(F("=== Memory ==="));
+    
+    size_t dataBytes, bssBytes;
+    size_t staticBytes = getStaticRAM(dataBytes, bssBytes);
+    Serial.print(F("Static: "));
+    Serial.print(staticBytes);
+    Serial.print(F(" bytes (.data "));
+    Serial.print(dataBytes);
+    Serial.print(F(", .bss "));
+    Serial.print(bssBytes);
+    Serial.println(F(")"));
+    
+    Serial.print(F("Free now: "));
+    Serial.print(getAvailableRAM());
+    Serial.println(F(" bytes"));
+    
+    Serial.print(F("Stack peak: "));
+    Serial.print(getStackHighWaterMark());
+    Serial.print(F(" bytes, never used: "));
+    Serial.print(getUnusedStack());
+    Serial.println(F(" bytes"));
+    
+    Serial.println(F("Components:"));
+    ServiceLocator::forEachComponent(printComponentMemory);
+    Serial.print(F("  Total: "));
+    Serial.print(ServiceLocator::getTotalMemoryUsage());
+    Serial.println(F(" bytes"));
+    Serial.println();
+}
+
 /**
  * Show component status
  */
 void showComponentStatus() {
     Serial.println(F("=== Component Status ==="));
-    
-    size_t componentCount;
-    IComponent** components = ServiceLocator::getAllComponents(componentCount);
-    
-    for (size_t i = 0; i < componentCount; i++) {
-        if (components[i]) {
-            Serial.print(components[i]->getName());
-            Serial.print(F(": "));
-            
-            int status = components[i]->getStatus();
-            switch (status) {
-                case STATUS_OK:
-                    Serial.print(F("OK"));
-                    break;
-                case STATUS_ERROR:
-                    Serial.print(F("ERROR"));
-                    break;
-                case STATUS_NOT_INITIALIZED:
-                    Serial.print(F("NOT_INIT"));
-                    break;
-                case STATUS_BUSY:
-                    Serial.print(F("BUSY"));
-                    break;
-                default:
-                    Serial.print(F("UNKNOWN("));
-                    Serial.print(status);
-                    Serial.print(F(")"));
-                    break;
-            }
-            
-            Serial.print(F(" ("));
-            Serial.print(components[i]->getMemoryUsage());
-            Serial.println(F(" bytes)"));
-        }
-    }
+    ServiceLocator::forEachComponent(printComponentStatus);
     Serial.println();
 }
 
@@ -179,6 +257,49 @@ void showParallelPortStatus() {
     Serial.print(F("Overflow Count: "));
     Serial.println(parallelManager->getOverflowCount());
     
+    Serial.print(F("Dropped Bytes: "));
+    Serial.println(parallelManager->getDroppedBytes());
+    
+    Serial.print(F("Flow Control: "));
+    Serial.print(parallelManager->isFlowControlEnabled() ? F("ON") : F("OFF"));
+    Serial.print(F(", Held: "));
+    Serial.println(parallelManager->isFlowControlAsserted() ? F("YES") : F("NO"));
+    
+#if CAPTURE_SPILL
+    if (captureSession) {
+        Serial.print(F("Flash Spill: "));
+        Serial.print(captureSession->isSpilling() ? F("ACTIVE, ") : F("IDLE, "));
+        Serial.print(captureSession->getSpillEvents());
+        Serial.print(F(" stalls, "));
+        Serial.print(captureSession->getSpilledBytes());
+        Serial.println(F(" bytes"));
+    }
+#endif
+    
+    uint32_t negotiations, ecpSessions;
+    parallelManager->getNegotiationStats(negotiations, ecpSessions);
+    ParallelPortManager::TransferMode mode = parallelManager->getTransferMode();
+    Serial.print(F("Mode: "));
+    if (mode == ParallelPortManager::MODE_ECP_FORWARD) {
+        Serial.print(F("ECP"));
+    } else if (mode == ParallelPortManager::MODE_NEGOTIATING) {
+        Serial.print(F("NEGOTIATING"));
+    } else {
+        Serial.print(F("SPP"));
+    }
+    Serial.print(F(", 1284 Negotiations: "));
+    Serial.print(negotiations);
+    Serial.print(F(", ECP: "));
+    Serial.println(ecpSessions);
+    
+    Serial.print(F("Stalls: "));
+    Serial.print(parallelManager->getStallCount());
+    Serial.print(F(", Total: "));
+    Serial.print(parallelManager->getStallTime());
+    Serial.print(F(" ms, Max: "));
+    Serial.print(parallelManager->getMaxStallTime());
+    Serial.println(F(" ms"));
+    
     uint32_t totalInts;
     uint16_t maxTime, avgTime;
     parallelManager->getInterruptStats(totalInts, maxTime, avgTime);
@@ -203,6 +324,91 @@ void showParallelPortStatus() {
     Serial.println();
 }
 
+#if LPT_ISR_HISTOGRAM
+/**
+ * Print non-empty buckets of a timing histogram
+ */
+void printHistogram(const __FlashStringHelper* title, const TimingHistogram& histogram) {
+    Serial.print(title);
+    Serial.print(F(" ("));
+    Serial.print(histogram.getTotal());
+    Serial.println(F(" samples)"));
+    
+    for (uint8_t i = 0; i < TIMING_HISTOGRAM_OVERFLOW; i++) {
+        uint16_t count = histogram.getCount(i);
+        if (count == 0) {
+            continue;
+        }
+        
+        // Bucket i spans [2^i, 2^(i+1)) ticks
+        Serial.print(F("  "));
+        Serial.print(TimingHistogram::lowerBound(i) / LPT_HIST_TICKS_PER_US);
+        Serial.print(F("-"));
+        Serial.print((2UL << i) / LPT_HIST_TICKS_PER_US);
+        Serial.print(F(" us: "));
+        Serial.println(count);
+    }
+    
+    uint16_t overflow = histogram.getCount(TIMING_HISTOGRAM_OVERFLOW);
+    if (overflow > 0) {
+        Serial.print(F("  >"));
+        Serial.print(LPT_HIST_WRAP_MS);
+        Serial.print(F(" ms: "));
+        Serial.println(overflow);
+    }
+}
+#endif
+
+/**
+ * Show ISR execution time and inter-strobe gap histograms
+ */
+void showTimingHistograms() {
+    auto parallelManager = ServiceLocator::getParallelPortManager();
+    if (!parallelManager) {
+        Serial.println(F("ParallelPortManager not available"));
+        return;
+    }
+    
+    Serial.println(F("=== LPT Timing ==="));
+    
+    uint32_t totalInts;
+    uint16_t maxTime, avgTime;
+    parallelManager->getInterruptStats(totalInts, maxTime, avgTime);
+    Serial.print(F("ISR Time - Avg: "));
+    Serial.print(avgTime);
+    Serial.print(F(" us, Max: "));
+    Serial.print(maxTime);
+    Serial.println(F(" us"));
+    
+#if LPT_ISR_HISTOGRAM
+    TimingHistogram isrTime;
+    TimingHistogram strobeGap;
+    parallelManager->getTimingHistograms(isrTime, strobeGap);
+    printHistogram(F("ISR execution time"), isrTime);
+    printHistogram(F("Inter-strobe gap"), strobeGap);
+#else
+    Serial.println(F("Histograms compiled out (build with -DLPT_ISR_HISTOGRAM=1)"));
+#endif
+    
+    Serial.println();
+}
+
+/**
+ * Dump the task and component profile, then start a new measurement window
+ */
+void showProfile() {
+    Serial.println(F("=== Profile ==="));
+#if TASK_PROFILER
+    Scheduler::printProfile();
+    ServiceLocator::printProfile();
+    Scheduler::resetProfile();
+    ServiceLocator::resetProfile();
+#else
+    Serial.println(F("Profiler compiled out (build with -DTASK_PROFILER=1)"));
+#endif
+    Serial.println();
+}
+
 /**
  * Show storage status
  */
@@ -220,6 +426,12 @@ void showStorageStatus() {
     Serial.print(F("Storage Ready: "));
     Serial.println(fsManager->isStorageReady() ? F("YES") : F("NO"));
     
+    char status[48];
+    if (fsManager->getStorageStatus(status, sizeof(status))) {
+        Serial.print(F("Details: "));
+        Serial.println(status);
+    }
+    
     uint32_t available, total;
     if (fsManager->getStorageSpace(available, total)) {
         Serial.print(F("Available Space: "));
@@ -241,9 +453,437 @@ void showStorageStatus() {
     Serial.print(F("Bytes Read: "));
     Serial.println(bytesRead);
     
+    if (fsManager->isCopying()) {
+        Serial.print(F("Copy Progress: "));
+        Serial.print(fsManager->getCopyProgress());
+        Serial.println(F("%"));
+    }
+    
+    Serial.print(F("Serial Format: "));
+    Serial.println(fsManager->isSerialBinary() ? F("BINARY (COBS)") : F("HEX"));
+    
+    const SerialRetrieval& retrieval = fsManager->getRetrieval();
+    Serial.print(F("Retrieval: "));
+    Serial.print(retrieval.isActive() ? F("ACTIVE, ") : F("IDLE, "));
+    Serial.print(retrieval.getFilesSent());
+    Serial.print(F(" sent, "));
+    Serial.print(retrieval.getPacketsResent());
+    Serial.println(F(" packets resent"));
+    
+    Serial.print(F("Tiered Write-back: "));
+    if (fsManager->isTieredStorage()) {
+        uint32_t migrated, failures;
+        fsManager->getMigrationStatistics(migrated, failures);
+        Serial.print(fsManager->isMigrating() ? F("MIGRATING") : F("IDLE"));
+        Serial.print(F(", "));
+        Serial.print(migrated);
+        Serial.print(F(" moved, "));
+        Serial.print(failures);
+        Serial.println(F(" failed"));
+    } else {
+        Serial.println(F("OFF"));
+    }
+    
     Serial.println();
 }
 
+/**
+ * Start or cancel a copy from the current storage
+ * @param command Arguments after "copyto ": "{storage} {filename}" or "cancel"
+ */
+void copyToStorage(const char* command) {
+    auto fsManager = ServiceLocator::getFileSystemManager();
+    if (!fsManager) {
+        Serial.println(F("FileSystemManager not available"));
+        return;
+    }
+    
+    size_t length = safeStrlen(command, COMMAND_BUFFER_SIZE);
+    
+    if (equalsIgnoreCase(command, length, "cancel")) {
+        if (!fsManager->isCopying()) {
+            Serial.println(F("No copy running"));
+        }
+        fsManager->cancelCopy();
+        return;
+    }
+    
+    IStoragePlugin::StorageType dest;
+    const char* filename;
+    if (startsWith(command, length, "sd ")) {
+        dest = IStoragePlugin::STORAGE_SD_CARD;
+        filename = command + 3;
+    } else if (startsWith(command, length, "eeprom ")) {
+        dest = IStoragePlugin::STORAGE_EEPROM;
+        filename = command + 7;
+    } else if (startsWith(command, length, "serial ")) {
+        dest = IStoragePlugin::STORAGE_SERIAL;
+        filename = command + 7;
+    } else {
+        Serial.println(F("Usage: copyto sd|eeprom|serial {filename}"));
+        return;
+    }
+    
+    if (fsManager->copyFile(filename, fsManager->getCurrentStorageType(), dest)) {
+        Serial.print(F("Copying "));
+        Serial.println(filename);
+    } else {
+        Serial.print(F("Cannot copy "));
+        Serial.println(filename);
+    }
+}
+
+/**
+ * List files on the current storage for a host, one page at a time
+ * Prints FILE:{name},{size} per file and FILES:{count}; a full page means
+ * the host should ask again from first + count
+ * @param command Arguments after "files": "" or " {first}"
+ */
+void listHostFiles(const char* command) {
+    static constexpr size_t FILES_PER_PAGE = 8;
+    
+    auto fsManager = ServiceLocator::getFileSystemManager();
+    if (!fsManager) {
+        Serial.println(F("FileSystemManager not available"));
+        return;
+    }
+    
+    size_t first = strtoul(command, nullptr, 10);
+    char names[FILES_PER_PAGE][MAX_FILENAME_LENGTH];
+    size_t count = fsManager->listFiles(names, FILES_PER_PAGE, first);
+    
+    for (size_t i = 0; i < count; i++) {
+        Serial.print(F("FILE:"));
+        Serial.print(names[i]);
+        Serial.print(F(","));
+        Serial.println(fsManager->getFileSize(names[i]));
+    }
+    Serial.print(F("FILES:"));
+    Serial.println(count);
+}
+
+/**
+ * Start a windowed retrieval; the BEGIN packet is the reply
+ * @param command Arguments after "get ": "{filename}" or "{filename} {offset}"
+ */
+void startRetrieval(const char* command) {
+    auto fsManager = ServiceLocator::getFileSystemManager();
+    if (!fsManager) {
+        Serial.println(F("FileSystemManager not available"));
+        return;
+    }
+    
+    char filename[MAX_FILENAME_LENGTH];
+    size_t length = 0;
+    while (command[length] != '\0' && command[length] != ' ') {
+        if (length == MAX_FILENAME_LENGTH - 1) {
+            Serial.println(F("GET:ERR bad name"));
+            return;
+        }
+        filename[length] = command[length];
+        length++;
+    }
+    filename[length] = '\0';
+    uint32_t offset = strtoul(command + length, nullptr, 10);
+    
+    if (fsManager->isSerialTransferring() && !fsManager->getRetrieval().isActive()) {
+        Serial.println(F("GET:ERR link busy"));
+    } else if (!fsManager->startRetrieval(filename, offset)) {
+        Serial.println(F("GET:ERR cannot read"));
+    }
+}
+
+/**
+ * Select the serial transfer format
+ * @param command Arguments after "serial ": "hex" or "binary"
+ */
+void setSerialFormat(const char* command) {
+    auto fsManager = ServiceLocator::getFileSystemManager();
+    if (!fsManager) {
+        Serial.println(F("FileSystemManager not available"));
+        return;
+    }
+    
+    size_t length = safeStrlen(command, COMMAND_BUFFER_SIZE);
+    bool binary;
+    if (equalsIgnoreCase(command, length, "binary")) {
+        binary = true;
+    } else if (equalsIgnoreCase(command, length, "hex")) {
+        binary = false;
+    } else {
+        Serial.println(F("Usage: serial hex|binary"));
+        return;
+    }
+    
+    if (fsManager->setSerialBinary(binary)) {
+        Serial.print(F("Serial format: "));
+        Serial.println(binary ? F("binary") : F("hex"));
+    } else {
+        Serial.println(F("Cannot change format during a transfer"));
+    }
+}
+
+/**
+ * Get the rate error the UART would run with
+ * Mirrors the Arduino core's divisor choice (U2X unless the divisor
+ * overflows or the 57600 special case applies)
+ * @param baud Requested rate
+ * @return Error in percent
+ */
+uint32_t baudErrorPercent(uint32_t baud) {
+    uint32_t setting = (F_CPU / 4 / baud - 1) / 2;
+    uint32_t actual = F_CPU / 8 / (setting + 1);
+    if (setting > 4095 || (F_CPU == 16000000UL && baud == 57600)) {
+        setting = (F_CPU / 8 / baud - 1) / 2;
+        actual = F_CPU / 16 / (setting + 1);
+    }
+    
+    uint32_t delta = actual > baud ? actual - baud : baud - actual;
+    return delta * 100 / baud;
+}
+
+/**
+ * Switch the UART to a new rate
+ * @param baud New rate
+ */
+void applyBaudRate(uint32_t baud) {
+    Serial.flush();            // The ack goes out at the old rate
+    Serial.begin(baud, SERIAL_8N1);
+    linkBaud = baud;
+}
+
+/**
+ * Negotiate the serial link speed
+ * The device acks with "BAUD:{rate}" at the old rate and switches; the
+ * host switches on the ack and sends "baud ok" at the new rate. Without
+ * that confirmation the old rate returns after SERIAL_BAUD_CONFIRM_MS.
+ * @param command Arguments after "baud": "", " {rate}" or " ok"
+ */
+void changeBaudRate(const char* command) {
+    size_t length = safeStrlen(command, COMMAND_BUFFER_SIZE);
+    
+    if (length == 0) {
+        Serial.print(F("BAUD:"));
+        Serial.println(linkBaud);
+        return;
+    }
+    
+    if (equalsIgnoreCase(command, length, " ok")) {
+        fallbackBaud = 0;
+        Serial.println(F("BAUD:OK"));
+        return;
+    }
+    
+    uint32_t baud = strtoul(command, nullptr, 10);
+    if (baud < 1200 || baud > SERIAL_MAX_BAUD_RATE ||
+        baudErrorPercent(baud) > SERIAL_BAUD_MAX_ERROR) {
+        Serial.println(F("BAUD:ERR unsupported rate"));
+        return;
+    }
+    
+    auto fsManager = ServiceLocator::getFileSystemManager();
+    if (fsManager && (fsManager->isCopying() || fsManager->isWriteOpen() ||
+                      fsManager->isSerialTransferring())) {
+        Serial.println(F("BAUD:ERR transfer in progress"));
+        return;
+    }
+    
+    Serial.print(F("BAUD:"));
+    Serial.println(baud);
+    if (fallbackBaud == 0) {
+        fallbackBaud = linkBaud;
+    }
+    baudSwitchTime = millis();
+    applyBaudRate(baud);
+}
+
+/**
+ * Return to the previous rate if the host never confirmed the new one
+ */
+void checkBaudConfirm() {
+    if (fallbackBaud != 0 && millis() - baudSwitchTime >= SERIAL_BAUD_CONFIRM_MS) {
+        applyBaudRate(fallbackBaud);
+        fallbackBaud = 0;
+        Serial.print(F("BAUD:REVERT "));
+        Serial.println(linkBaud);
+    }
+}
+
+/**
+ * Switch live pass-through of captured data
+ * @param command Arguments after "passthru": "", " on" or " off"
+ */
+void setPassThrough(const char* command) {
+    if (!captureSession) {
+        Serial.println(F("CaptureSession not available"));
+        return;
+    }
+    
+    size_t length = safeStrlen(command, COMMAND_BUFFER_SIZE);
+    if (equalsIgnoreCase(command, length, " on")) {
+        // Raw capture bytes follow this line
+        Serial.println(F("PASSTHRU:ON"));
+        captureSession->setPassThrough(true);
+    } else if (equalsIgnoreCase(command, length, " off")) {
+        captureSession->setPassThrough(false);
+        Serial.println();
+        Serial.println(F("PASSTHRU:OFF"));
+    } else if (length == 0) {
+        Serial.print(F("Pass-through: "));
+        Serial.print(captureSession->isPassThrough() ? F("ON, ") : F("OFF, "));
+        Serial.print(captureSession->getPassThroughBytes());
+        Serial.println(F(" bytes forwarded"));
+    } else {
+        Serial.println(F("Usage: passthru [on|off]"));
+    }
+}
+
+/**
+ * Run on-device benchmarks
+ * @param command Arguments after "bench": "" for all, or " {test}"
+ */
+void runBenchmark(const char* command) {
+#if HARDWARE_BENCHMARK
+    if (captureSession && captureSession->isActive()) {
+        Serial.println(F("BENCH:BUSY capture in progress"));
+        return;
+    }
+    
+    size_t length = safeStrlen(command, COMMAND_BUFFER_SIZE);
+    HardwareBenchmark::Test test;
+    if (length == 0) {
+        test = HardwareBenchmark::TEST_ALL;
+    } else if (equalsIgnoreCase(command, length, " flash")) {
+        test = HardwareBenchmark::TEST_FLASH;
+    } else if (equalsIgnoreCase(command, length, " sd")) {
+        test = HardwareBenchmark::TEST_SD;
+    } else if (equalsIgnoreCase(command, length, " serial")) {
+        test = HardwareBenchmark::TEST_SERIAL;
+    } else if (equalsIgnoreCase(command, length, " lcd")) {
+        test = HardwareBenchmark::TEST_LCD;
+    } else if (equalsIgnoreCase(command, length, " loop")) {
+        test = HardwareBenchmark::TEST_LOOP;
+    } else {
+        Serial.println(F("Usage: bench [flash|sd|serial|lcd|loop]"));
+        return;
+    }
+    HardwareBenchmark::run(test);
+#else
+    (void)command;
+    Serial.println(F("Benchmarks compiled out (build with -DHARDWARE_BENCHMARK=1)"));
+#endif
+}
+
+/**
+ * Show or set the clock
+ * @param command Text after "time": empty, or " set YYYY-MM-DD HH:MM[:SS]"
+ */
+void setTime(const char* command) {
+    auto timeManager = ServiceLocator::getTimeManager();
+    size_t length = safeStrlen(command, COMMAND_BUFFER_SIZE);
+    
+    if (length > 0) {
+        // Seconds are optional and default to :00
+        char text[DATETIME_TEXT_LENGTH + 1];
+        size_t textLength = length > 5 ? length - 5 : 0;
+        bool shortForm = textLength == DATETIME_TEXT_LENGTH - 3;
+        if (startsWith(command, length, " set ") &&
+            (shortForm || textLength == DATETIME_TEXT_LENGTH)) {
+            safeCopy(text, sizeof(text), command + 5);
+            if (shortForm) {
+                safeCopy(text + textLength, sizeof(text) - textLength, ":00");
+            }
+        } else {
+            text[0] = '\0';
+        }
+        
+        DateTime time;
+        if (!DateTime::parse(text, time)) {
+            Serial.println(F("Usage: time [set YYYY-MM-DD HH:MM[:SS]]"));
+            return;
+        }
+        if (!timeManager->setDateTime(time)) {
+            Serial.println(F("RTC write failed (clock set until reset)"));
+        }
+    }
+    
+    char text[DATETIME_TEXT_LENGTH + 1];
+    timeManager->getDateTime().format(text);
+    uint32_t reads, errors;
+    timeManager->getSyncStats(reads, errors);
+    Serial.print(F("Time: "));
+    Serial.print(text);
+    Serial.println(timeManager->isTimeValid() ? F("") : F(" (not set)"));
+    Serial.print(F("RTC reads: "));
+    Serial.print(reads);
+    Serial.print(F(", errors: "));
+    Serial.println(errors);
+}
+
+/**
+ * Show, edit and store the runtime configuration
+ * "set" values apply at once (the baud rate at the next boot), "save"
+ * keeps them across resets
+ * @param command Text after "config": "", " set {key} {value}", " save"
+ *                or " defaults"
+ */
+void editConfig(const char* command) {
+    auto configManager = ServiceLocator::getConfigurationManager();
+    size_t length = safeStrlen(command, COMMAND_BUFFER_SIZE);
+    
+    if (startsWith(command, length, " set ")) {
+        const char* key = command + 5;
+        const char* value = findChar(key, length - 5, ' ');
+        ConfigurationManager::Key id = value ?
+            ConfigurationManager::findKey(key, value - key) : ConfigurationManager::KEY_COUNT;
+        char* end = nullptr;
+        uint32_t number = value ? strtoul(value + 1, &end, 10) : 0;
+        
+        if (id == ConfigurationManager::KEY_COUNT || !end || end == value + 1 || *end != '\0') {
+            Serial.println(F("Usage: config set {key} {value}"));
+            return;
+        }
+        if ((id == ConfigurationManager::KEY_BAUD && baudErrorPercent(number) > SERIAL_BAUD_MAX_ERROR) ||
+            !configManager->setValue(id, number)) {
+            Serial.println(F("CONFIG:ERR value out of range"));
+            return;
+        }
+        configManager->apply(captureSession);
+        Serial.println(F("CONFIG:OK"));
+        return;
+    }
+    
+    if (equalsIgnoreCase(command, length, " save")) {
+        Serial.println(configManager->save() == STATUS_OK ? F("CONFIG:SAVED") : F("CONFIG:ERR write failed"));
+        return;
+    }
+    
+    if (equalsIgnoreCase(command, length, " defaults")) {
+        configManager->restoreDefaults();
+        configManager->apply(captureSession);
+        Serial.println(F("CONFIG:OK defaults (not saved)"));
+        return;
+    }
+    
+    if (length != 0) {
+        Serial.println(F("Usage: config [set {key} {value}|save|defaults]"));
+        return;
+    }
+    
+    Serial.print(F("Configuration ("));
+    ConfigurationManager::Source source = configManager->getSource();
+    Serial.print(source == ConfigurationManager::SOURCE_STORED ? F("stored") :
+                 source == ConfigurationManager::SOURCE_SKIPPED ? F("defaults, SELECT held") :
+                 F("defaults"));
+    Serial.println(F("):"));
+    for (uint8_t key = 0; key < ConfigurationManager::KEY_COUNT; key++) {
+        Serial.print(F("  "));
+        Serial.print(ConfigurationManager::getKeyName((ConfigurationManager::Key)key));
+        Serial.print(F(" = "));
+        Serial.println(configManager->getValue((ConfigurationManager::Key)key));
+    }
+}
+
 /**
  * Control LEDs
  */
@@ -278,8 +918,8 @@ void showButtonValues() {
     
     uint32_t startTime = millis();
     while (millis() - startTime < 10000) {
-        int analogValue = analogRead(ANALOG_BUTTONS_PIN);
-        auto currentButton = displayManager->getCurrentButton();
+        int analogValue = displayManager->getButtonAdcValue();
+        auto currentButton = displayManager->readButton();
         
         Serial.print(F("Analog: "));
         Serial.print(analogValue);
@@ -331,14 +971,62 @@ void processCommand(const char* cmd) {
         if (parallelManager) {
             parallelManager->testProtocolSignals();
         }
+    } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "timing")) {
+        showTimingHistograms();
+    } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "timing reset")) {
+        auto parallelManager = ServiceLocator::getParallelPortManager();
+        if (parallelManager) {
+            parallelManager->resetTimingStats();
+            Serial.println(F("Timing statistics reset"));
+        }
     } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "buttons")) {
         showButtonValues();
+    } else if (startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "copyto ")) {
+        copyToStorage(cmd + 7);
+    } else if (startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "serial ")) {
+        setSerialFormat(cmd + 7);
+    } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "baud") ||
+               startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "baud ")) {
+        changeBaudRate(cmd + 4);
+    } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "passthru") ||
+               startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "passthru ")) {
+        setPassThrough(cmd + 8);
+    } else if (startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "ack ")) {
+        // Silent: stale acks are normal and the host is reading packets
+        auto fsManager = ServiceLocator::getFileSystemManager();
+        if (fsManager) {
+            fsManager->acknowledgeRetrieval((uint16_t)strtoul(cmd + 4, nullptr, 10));
+        }
+    } else if (startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "nak ")) {
+        auto fsManager = ServiceLocator::getFileSystemManager();
+        if (fsManager) {
+            fsManager->resendRetrieval((uint16_t)strtoul(cmd + 4, nullptr, 10));
+        }
+    } else if (startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "get ")) {
+        startRetrieval(cmd + 4);
+    } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "files") ||
+               startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "files ")) {
+        listHostFiles(cmd + 5);
+    } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "config") ||
+               startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "config ")) {
+        editConfig(cmd + 6);
+    } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "time") ||
+               startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "time ")) {
+        setTime(cmd + 4);
     } else if (startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "led ")) {
         controlLED(cmd + 4);
+    } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "tasks")) {
+        Scheduler::printStatistics();
+    } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "tasks reset")) {
+        Scheduler::resetStatistics();
+        Serial.println(F("Task timing reset"));
+    } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "prof")) {
+        showProfile();
+    } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "bench") ||
+               startsWith(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "bench ")) {
+        runBenchmark(cmd + 5);
     } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "memory")) {
-        Serial.print(F("Available RAM: "));
-        Serial.print(getAvailableRAM());
-        Serial.println(F(" bytes"));
+        showMemoryUsage();
     } else if (equalsIgnoreCase(cmd, safeStrlen(cmd, COMMAND_BUFFER_SIZE), "testwrite")) {
         auto fsManager = ServiceLocator::getFileSystemManager();
         if (fsManager) {
@@ -363,6 +1051,7 @@ void processCommand(const char* cmd) {
  */
 void update() {
     processSerialInput();
+    checkBaudConfirm();
     
     if (commandReady) {
         processCommand(commandBuffer);
@@ -376,9 +1065,13 @@ void update() {
 /**
  * Initialize debug command system
  */
-void initialize() {
+void initialize(CaptureSession* session) {
     clearBuffer(commandBuffer, sizeof(commandBuffer));
     commandReady = false;
+    captureSession = session;
+    
+    // The UART was opened at the stored rate
+    linkBaud = ServiceLocator::getConfigurationManager()->getConfig().baudRate;
     
     Serial.println(F("Debug command system initialized"));
     Serial.println(F("Type 'help' for available commands"));
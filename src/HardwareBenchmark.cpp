@@ -0,0 +1,358 @@
+#include <Arduino.h>
+#include "HardwareConfig.h"
+#include "HardwareBenchmark.h"
+
+#if HARDWARE_BENCHMARK
+#include "ServiceLocator.h"
+#include "MemoryUtils.h"
+#include "BenchmarkStat.h"
+#include "ParallelPortManager.h"
+#include "FileSystemManager.h"
+#include "DisplayManager.h"
+#include "IStoragePlugin.h"
+#include "EEPROMStoragePlugin.h"
+
+/**
+ * On-Device Benchmarks
+ * Times storage, serial, LCD and main loop work against free-running Timer1
+ * (0.5us ticks) and prints one row per measurement:
+ *   test  samples  min/avg/max/p90 us  rate
+ * p90 is the end of the log2 bucket holding the 90th percentile.
+ */
+
+namespace HardwareBenchmark {
+
+static const char BENCH_FILENAME[] = "bench.tmp";
+
+// Main loop window
+static BenchmarkStat loopStat;
+static bool loopTiming = false;
+static uint32_t loopStartMs = 0;
+static uint32_t loopWindowMs = 0;
+
+/**
+ * Print a number right-aligned in a column
+ */
+void printColumn(uint32_t value, uint8_t width) {
+    uint8_t digits = 1;
+    for (uint32_t rest = value / 10; rest > 0; rest /= 10) {
+        digits++;
+    }
+    while (width-- > digits) {
+        Serial.print(' ');
+    }
+    Serial.print(value);
+}
+
+/**
+ * Print the column titles
+ */
+void printHeader() {
+    Serial.println(F("test              n     min     avg     max    p90<    KB/s"));
+}
+
+/**
+ * Print one result row
+ * @param name Test name, padded to 14 characters
+ * @param stat Samples in Timer1 ticks
+ * @param bytes Bytes moved, 0 for no rate column
+ * @param spanUs Wall time the bytes took
+ */
+void printRow(const __FlashStringHelper* name, const BenchmarkStat& stat, uint32_t bytes, uint32_t spanUs) {
+    Serial.print(name);
+    printColumn(stat.getCount(), 5);
+    printColumn(stat.getMin() / LPT_HIST_TICKS_PER_US, 8);
+    printColumn(stat.getAverage() / LPT_HIST_TICKS_PER_US, 8);
+    printColumn(stat.getMax() / LPT_HIST_TICKS_PER_US, 8);
+    printColumn(stat.getPercentileBound(90) / LPT_HIST_TICKS_PER_US, 8);
+    if (bytes > 0 && spanUs > 0) {
+        Serial.print(F("  "));
+        Serial.print((float)bytes * 1000.0f / spanUs, 1);
+    }
+    Serial.println();
+}
+
+/**
+ * Print non-empty histogram buckets of a statistic
+ */
+void printHistogram(const BenchmarkStat& stat) {
+    const TimingHistogram& histogram = stat.getHistogram();
+    
+    for (uint8_t i = 0; i < TIMING_HISTOGRAM_OVERFLOW; i++) {
+        uint16_t count = histogram.getCount(i);
+        if (count == 0) {
+            continue;
+        }
+        
+        // Bucket i spans [2^i, 2^(i+1)) scaled ticks
+        Serial.print(F("  "));
+        Serial.print(((uint32_t)TimingHistogram::lowerBound(i) << stat.getShift()) / LPT_HIST_TICKS_PER_US);
+        Serial.print(F("-"));
+        Serial.print(((2UL << i) << stat.getShift()) / LPT_HIST_TICKS_PER_US);
+        Serial.print(F(" us: "));
+        Serial.println(count);
+    }
+    
+    uint16_t overflow = histogram.getCount(TIMING_HISTOGRAM_OVERFLOW);
+    if (overflow > 0) {
+        Serial.print(F("  longer: "));
+        Serial.println(overflow);
+    }
+}
+
+/**
+ * Fill a chunk with printable bytes (raw serial output stays readable)
+ */
+void fillChunk(uint8_t* chunk) {
+    for (size_t i = 0; i < BENCH_CHUNK_SIZE; i++) {
+        chunk[i] = (uint8_t)('A' + i % 26);
+    }
+}
+
+/**
+ * Check that nothing the benchmarks would stall or disturb is running
+ */
+bool canRun() {
+    auto parallelManager = ServiceLocator::getParallelPortManager();
+    auto fsManager = ServiceLocator::getFileSystemManager();
+    
+    return parallelManager && fsManager &&
+           parallelManager->getAvailableBytes() == 0 &&
+           !fsManager->isWriteOpen() &&
+           !fsManager->isReadOpen() &&
+           !fsManager->isCopying() &&
+           !fsManager->isMigrating() &&
+           !fsManager->isSerialTransferring();
+}
+
+/**
+ * Time raw W25Q128 sector erase, page program and page read
+ */
+bool benchmarkFlash() {
+    auto fsManager = ServiceLocator::getFileSystemManager();
+    IStoragePlugin* plugin = fsManager ? fsManager->getPlugin(IStoragePlugin::STORAGE_EEPROM) : nullptr;
+    if (!plugin || !plugin->isReady()) {
+        Serial.println(F("flash         not available"));
+        return false;
+    }
+    
+    // Erases take tens of ms: bin them in 512us steps
+    BenchmarkStat erase(10);
+    BenchmarkStat program;
+    BenchmarkStat read;
+    
+    TaskProfiler::begin();
+    int result = static_cast<EEPROMStoragePlugin*>(plugin)->benchmark(BENCH_FLASH_SECTORS, erase, program, read);
+    
+    printRow(F("flash erase   "), erase, 0, 0);
+    printRow(F("flash program "), program, program.getCount() * EEPROM_PAGE_SIZE,
+             program.getTotal() / LPT_HIST_TICKS_PER_US);
+    printRow(F("flash read    "), read, read.getCount() * EEPROM_PAGE_SIZE,
+             read.getTotal() / LPT_HIST_TICKS_PER_US);
+    
+    if (result != STATUS_OK) {
+        Serial.print(F("flash         FAILED ("));
+        Serial.print(result);
+        Serial.println(F(")"));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Time sequential SD writes, one sample per append
+ */
+bool benchmarkSD() {
+    auto fsManager = ServiceLocator::getFileSystemManager();
+    IStoragePlugin* plugin = fsManager ? fsManager->getPlugin(IStoragePlugin::STORAGE_SD_CARD) : nullptr;
+    if (!plugin || !plugin->isReady()) {
+        Serial.println(F("sd append     no card"));
+        return false;
+    }
+    if (!plugin->openWrite(BENCH_FILENAME, BENCH_TRANSFER_BYTES)) {
+        Serial.println(F("sd append     open failed"));
+        return false;
+    }
+    
+    uint8_t chunk[BENCH_CHUNK_SIZE];
+    fillChunk(chunk);
+    
+    // Card busy times reach milliseconds: bin them in 8us steps
+    BenchmarkStat append(4);
+    uint32_t written = 0;
+    uint32_t startUs = micros();
+    
+    TaskProfiler::begin();
+    while (written < BENCH_TRANSFER_BYTES) {
+        TaskProfiler::Mark mark;
+        TaskProfiler::start(mark);
+        size_t taken = plugin->append(chunk, sizeof(chunk));
+        append.record(TaskProfiler::elapsed(mark));
+        if (taken == 0) {
+            break;
+        }
+        written += taken;
+    }
+    bool closed = plugin->closeWrite();
+    uint32_t spanUs = micros() - startUs;
+    plugin->deleteFile(BENCH_FILENAME);
+    
+    printRow(F("sd append     "), append, written, spanUs);
+    
+    if (!closed || written < BENCH_TRANSFER_BYTES) {
+        Serial.println(F("sd append     FAILED"));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Time serial transmission raw, as hex lines and as binary packets
+ */
+bool benchmarkSerial() {
+    auto fsManager = ServiceLocator::getFileSystemManager();
+    IStoragePlugin* plugin = fsManager ? fsManager->getPlugin(IStoragePlugin::STORAGE_SERIAL) : nullptr;
+    if (!plugin || !plugin->isReady() || plugin->isWriteOpen()) {
+        Serial.println(F("serial        not available"));
+        return false;
+    }
+    
+    uint8_t chunk[BENCH_CHUNK_SIZE];
+    fillChunk(chunk);
+    
+    // Encoding 0 is raw bytes, 1 hex lines, 2 binary packets
+    bool wasBinary = fsManager->isSerialBinary();
+    BenchmarkStat results[3] = {BenchmarkStat(4), BenchmarkStat(4), BenchmarkStat(4)};
+    uint32_t spans[3] = {0, 0, 0};
+    
+    Serial.println(F("BENCH:SERIAL start"));
+    TaskProfiler::begin();
+    for (uint8_t encoding = 0; encoding < 3; encoding++) {
+        if (encoding > 0) {
+            fsManager->setSerialBinary(encoding == 2);
+            plugin->openWrite(BENCH_FILENAME, BENCH_TRANSFER_BYTES);
+        }
+        
+        // Start from an empty TX ring so buffered bytes are not counted as sent
+        Serial.flush();
+        uint32_t startUs = micros();
+        for (uint32_t sent = 0; sent < BENCH_TRANSFER_BYTES; sent += sizeof(chunk)) {
+            TaskProfiler::Mark mark;
+            TaskProfiler::start(mark);
+            if (encoding == 0) {
+                Serial.write(chunk, sizeof(chunk));
+            } else {
+                plugin->append(chunk, sizeof(chunk));
+            }
+            results[encoding].record(TaskProfiler::elapsed(mark));
+        }
+        if (encoding > 0) {
+            plugin->closeWrite();
+        }
+        Serial.flush();
+        spans[encoding] = micros() - startUs;
+        Serial.println();
+    }
+    fsManager->setSerialBinary(wasBinary);
+    Serial.println(F("BENCH:SERIAL end"));
+    printHeader();
+    
+    printRow(F("serial raw    "), results[0], BENCH_TRANSFER_BYTES, spans[0]);
+    printRow(F("serial hex    "), results[1], BENCH_TRANSFER_BYTES, spans[1]);
+    printRow(F("serial binary "), results[2], BENCH_TRANSFER_BYTES, spans[2]);
+    return true;
+}
+
+/**
+ * Time full-frame LCD redraws
+ */
+bool benchmarkLCD() {
+    auto displayManager = ServiceLocator::getDisplayManager();
+    if (!displayManager) {
+        Serial.println(F("lcd redraw    not available"));
+        return false;
+    }
+    
+    // The same frame is resent, so the screen does not change
+    BenchmarkStat redraw(6);
+    TaskProfiler::begin();
+    for (uint8_t i = 0; i < BENCH_LCD_REDRAWS; i++) {
+        displayManager->redraw();
+        TaskProfiler::Mark mark;
+        TaskProfiler::start(mark);
+        displayManager->forceUpdate();
+        redraw.record(TaskProfiler::elapsed(mark));
+    }
+    
+    printRow(F("lcd redraw    "), redraw, 0, 0);
+    return true;
+}
+
+/**
+ * Open a main loop sampling window
+ */
+void startLoopTiming(uint32_t durationMs) {
+    TaskProfiler::begin();
+    loopStat = BenchmarkStat(2);
+    loopStartMs = millis();
+    loopWindowMs = durationMs;
+    loopTiming = true;
+    
+    Serial.print(F("BENCH:LOOP sampling "));
+    Serial.print(durationMs);
+    Serial.println(F(" ms"));
+}
+
+bool isTimingLoop() {
+    return loopTiming;
+}
+
+void recordLoopPass(const TaskProfiler::Mark& start) {
+    loopStat.record(TaskProfiler::elapsed(start));
+    
+    if (millis() - loopStartMs < loopWindowMs) {
+        return;
+    }
+    loopTiming = false;
+    
+    printHeader();
+    printRow(F("loop pass     "), loopStat, 0, 0);
+    printHistogram(loopStat);
+}
+
+bool run(Test test) {
+    if (!canRun()) {
+        Serial.println(F("BENCH:BUSY storage or capture in use"));
+        return false;
+    }
+    
+    if (test == TEST_LOOP) {
+        startLoopTiming(BENCH_LOOP_MS);
+        return true;
+    }
+    
+    Serial.println(F("=== Benchmark (Timer1, times in us) ==="));
+    printHeader();
+    bool allRan = true;
+    if (test == TEST_ALL || test == TEST_FLASH) {
+        allRan &= benchmarkFlash();
+    }
+    if (test == TEST_ALL || test == TEST_SD) {
+        allRan &= benchmarkSD();
+    }
+    if (test == TEST_ALL || test == TEST_LCD) {
+        allRan &= benchmarkLCD();
+    }
+    if (test == TEST_ALL || test == TEST_SERIAL) {
+        allRan &= benchmarkSerial();
+    }
+    
+    if (test == TEST_ALL) {
+        startLoopTiming(BENCH_LOOP_MS);
+    }
+    return allRan;
+}
+
+} // namespace HardwareBenchmark
+
+#endif // HARDWARE_BENCHMARK
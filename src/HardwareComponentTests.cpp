@@ -159,13 +159,13 @@ bool testButtonInterface() {
     int lastValue = -1;
     
     while (millis() - startTime < 30000 && buttonsPressed < 5) {
-        int analogValue = analogRead(ANALOG_BUTTONS_PIN);
+        int analogValue = displayManager->getButtonAdcValue();
         
         if (abs(analogValue - lastValue) > BUTTON_TOLERANCE) {
             Serial.print(F("Button analog value: "));
             Serial.print(analogValue);
             
-            auto currentButton = displayManager->getCurrentButton();
+            auto currentButton = displayManager->readButton();
             Serial.print(F(" -> "));
             Serial.println(displayManager->getButtonName(currentButton));
             
@@ -101,10 +101,12 @@ TestResult testDisplay() {
     
     // Display test message
     displayManager->displayMessagePGM(F("Self-Test"), F("Display OK"), 2000);
+    displayManager->forceUpdate();
     
-    // Test progress bar
+    // Test progress bar (the scheduler is not running the display here)
     for (int i = 0; i <= 100; i += 20) {
         displayManager->displayProgressBar(i, 1, "Progress");
+        displayManager->forceUpdate();
         delay(500);
     }
     
@@ -242,6 +244,7 @@ bool runCompleteSelfTest() {
             
             if (displayManager) {
                 displayManager->displayError(tests[i].description, tests[i].errorCode);
+                displayManager->forceUpdate();
                 delay(2000);
             }
         }
@@ -0,0 +1,257 @@
+#include "Scheduler.h"
+#if IDLE_SLEEP
+#include <avr/sleep.h>
+#endif
+
+// Static member definitions
+Scheduler::Task Scheduler::tasks[SCHEDULER_MAX_TASKS];
+uint8_t Scheduler::taskCount = 0;
+uint32_t Scheduler::lastUrgentCheck = 0;
+uint16_t Scheduler::maxUrgentGapUs = 0;
+#if IDLE_SLEEP
+uint32_t Scheduler::sleepCount = 0;
+uint32_t Scheduler::sleepMs = 0;
+uint16_t Scheduler::sleepCarryUs = 0;
+uint32_t Scheduler::statsStartMs = 0;
+bool Scheduler::wakePending = false;
+uint32_t Scheduler::byteWakes = 0;
+uint16_t Scheduler::lastWakeLatencyUs = 0;
+uint16_t Scheduler::maxWakeLatencyUs = 0;
+#endif
+
+bool Scheduler::insert(const Task& task) {
+    if (taskCount >= SCHEDULER_MAX_TASKS) {
+        return false;
+    }
+
+    // Equal priorities keep registration order
+    uint8_t pos = taskCount;
+    while (pos > 0 && tasks[pos - 1].priority < task.priority) {
+        tasks[pos] = tasks[pos - 1];
+        pos--;
+    }
+    tasks[pos] = task;
+    taskCount++;
+
+    return true;
+}
+
+bool Scheduler::addTask(const __FlashStringHelper* name, TaskFunction function,
+                        uint16_t periodMs, uint8_t priority, ReadyFunction ready) {
+    if (!function) {
+        return false;
+    }
+
+    // Counters (and the profile entry, when built) start zeroed
+    Task task = {};
+    task.function = function;
+    task.ready = ready;
+    task.name = name;
+    task.periodMs = periodMs;
+    task.priority = priority;
+    return insert(task);
+}
+
+int Scheduler::runTask(Task& task) {
+#if TASK_PROFILER
+    TaskProfiler::Mark mark;
+    TaskProfiler::start(mark);
+#endif
+    uint32_t start = micros();
+    int result = task.function();
+    uint32_t elapsed = micros() - start;
+#if TASK_PROFILER
+    TaskProfiler::stop(task.profile, mark);
+#endif
+
+    task.lastRun = millis();
+    task.runs++;
+    if (elapsed > task.maxRunUs) {
+        task.maxRunUs = elapsed > 0xFFFF ? 0xFFFF : (uint16_t)elapsed;
+    }
+
+    return result;
+}
+
+int Scheduler::run() {
+    uint32_t now = millis();
+
+    for (uint8_t i = 0; i < taskCount; i++) {
+        int result = serviceUrgent();
+        if (result != STATUS_OK) {
+            return result;
+        }
+
+        Task& task = tasks[i];
+        if (task.periodMs != 0 && task.runs != 0 && now - task.lastRun < task.periodMs) {
+            continue;
+        }
+
+        result = runTask(task);
+        if (result != STATUS_OK) {
+            return result;
+        }
+    }
+
+    return serviceUrgent();
+}
+
+int Scheduler::serviceUrgent() {
+    uint32_t now = micros();
+    if (lastUrgentCheck != 0) {
+        uint32_t gap = now - lastUrgentCheck;
+        if (gap > maxUrgentGapUs) {
+            maxUrgentGapUs = gap > 0xFFFF ? 0xFFFF : (uint16_t)gap;
+        }
+    }
+
+    for (uint8_t i = 0; i < taskCount; i++) {
+        if (tasks[i].ready && tasks[i].ready()) {
+            int result = runTask(tasks[i]);
+            if (result != STATUS_OK) {
+                lastUrgentCheck = micros();
+                return result;
+            }
+        }
+    }
+
+    lastUrgentCheck = micros();
+    return STATUS_OK;
+}
+
+bool Scheduler::isUrgentPending() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        if (tasks[i].ready && tasks[i].ready()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Scheduler::idle(ReadyFunction quiet) {
+#if IDLE_SLEEP
+    cli();
+    if (isUrgentPending() || !quiet || !quiet()) {
+        sei();
+        return false;
+    }
+
+    uint32_t start = micros();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sei();          // The instruction after SEI runs before any interrupt
+    sleep_cpu();
+    sleep_disable();
+
+    uint32_t slept = micros() - start + sleepCarryUs;
+    sleepMs += slept / 1000;
+    sleepCarryUs = slept % 1000;
+    sleepCount++;
+    wakePending = true;
+
+    // A pass right after the wake must not count as an urgent gap
+    lastUrgentCheck = 0;
+    return true;
+#else
+    (void)quiet;
+    return false;
+#endif
+}
+
+bool Scheduler::isWakePending() {
+#if IDLE_SLEEP
+    return wakePending;
+#else
+    return false;
+#endif
+}
+
+void Scheduler::recordWakeLatency(uint16_t latencyUs) {
+#if IDLE_SLEEP
+    wakePending = false;
+    byteWakes++;
+    lastWakeLatencyUs = latencyUs;
+    if (latencyUs > maxWakeLatencyUs) {
+        maxWakeLatencyUs = latencyUs;
+    }
+#else
+    (void)latencyUs;
+#endif
+}
+
+void Scheduler::printStatistics() {
+    Serial.println(F("=== Scheduler Tasks ==="));
+    for (uint8_t i = 0; i < taskCount; i++) {
+        const Task& task = tasks[i];
+        Serial.print(task.name);
+        Serial.print(F(": every "));
+        Serial.print(task.periodMs);
+        Serial.print(F("ms, prio "));
+        Serial.print(task.priority);
+        if (task.ready) {
+            Serial.print(F(", urgent"));
+        }
+        Serial.print(F(", runs "));
+        Serial.print(task.runs);
+        Serial.print(F(", max "));
+        Serial.print(task.maxRunUs);
+        Serial.println(F("us"));
+    }
+    Serial.print(F("Max urgent gap: "));
+    Serial.print(maxUrgentGapUs);
+    Serial.println(F("us"));
+#if IDLE_SLEEP
+    uint32_t elapsed = millis() - statsStartMs;
+    Serial.print(F("Idle sleep: "));
+    Serial.print(sleepCount);
+    Serial.print(F(" sleeps, "));
+    Serial.print(elapsed ? (uint8_t)((uint64_t)sleepMs * 100 / elapsed) : 0);
+    Serial.print(F("% asleep, "));
+    Serial.print(byteWakes);
+    Serial.print(F(" woken by data, wake-to-byte last "));
+    Serial.print(lastWakeLatencyUs);
+    Serial.print(F(" max "));
+    Serial.print(maxWakeLatencyUs);
+    Serial.println(F("us"));
+#endif
+}
+
+void Scheduler::resetStatistics() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        tasks[i].maxRunUs = 0;
+        tasks[i].runs = 0;
+    }
+    maxUrgentGapUs = 0;
+    lastUrgentCheck = 0;
+#if IDLE_SLEEP
+    sleepCount = 0;
+    sleepMs = 0;
+    sleepCarryUs = 0;
+    statsStartMs = millis();
+    byteWakes = 0;
+    lastWakeLatencyUs = 0;
+    maxWakeLatencyUs = 0;
+#endif
+}
+
+#if TASK_PROFILER
+void Scheduler::printProfile() {
+    Serial.println(F("Tasks:"));
+    for (uint8_t i = 0; i < taskCount; i++) {
+        Serial.print(F("  "));
+        Serial.print(tasks[i].name);
+        Serial.print(F(": "));
+        TaskProfiler::print(tasks[i].profile);
+    }
+}
+
+void Scheduler::resetProfile() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        TaskProfiler::reset(tasks[i].profile);
+    }
+}
+#endif
+
+uint16_t Scheduler::getMaxUrgentGap() {
+    return maxUrgentGapUs;
+}
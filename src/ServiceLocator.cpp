@@ -10,199 +10,169 @@
 #include "SystemManager.h"
 #include "HeartbeatLEDManager.h"
 
-// Static member definitions
-ParallelPortManager* ServiceLocator::parallelPortManager = nullptr;
-FileSystemManager* ServiceLocator::fileSystemManager = nullptr;
-DisplayManager* ServiceLocator::displayManager = nullptr;
-ConfigurationManager* ServiceLocator::configurationManager = nullptr;
-TimeManager* ServiceLocator::timeManager = nullptr;
-SystemManager* ServiceLocator::systemManager = nullptr;
-HeartbeatLEDManager* ServiceLocator::heartbeatLEDManager = nullptr;
-
-IComponent* ServiceLocator::components[7] = {nullptr};
-bool ServiceLocator::componentsInitialized = false;
-
-void ServiceLocator::registerComponents(
-    ParallelPortManager* ppm,
-    FileSystemManager* fsm,
-    DisplayManager* dm,
-    ConfigurationManager* cm,
-    TimeManager* tm,
-    SystemManager* sm,
-    HeartbeatLEDManager* hlm
-) {
-    parallelPortManager = ppm;
-    fileSystemManager = fsm;
-    displayManager = dm;
-    configurationManager = cm;
-    timeManager = tm;
-    systemManager = sm;
-    heartbeatLEDManager = hlm;
-    
-    // Initialize components array for iteration
-    components[0] = static_cast<IComponent*>(parallelPortManager);
-    components[1] = static_cast<IComponent*>(fileSystemManager);
-    components[2] = static_cast<IComponent*>(displayManager);
-    components[3] = static_cast<IComponent*>(configurationManager);
-    components[4] = static_cast<IComponent*>(timeManager);
-    components[5] = static_cast<IComponent*>(systemManager);
-    components[6] = static_cast<IComponent*>(heartbeatLEDManager);
-    
-    componentsInitialized = true;
-}
-
-ParallelPortManager* ServiceLocator::getParallelPortManager() {
-    return parallelPortManager;
-}
-
-FileSystemManager* ServiceLocator::getFileSystemManager() {
-    return fileSystemManager;
-}
-
-DisplayManager* ServiceLocator::getDisplayManager() {
-    return displayManager;
-}
-
-ConfigurationManager* ServiceLocator::getConfigurationManager() {
-    return configurationManager;
-}
-
-TimeManager* ServiceLocator::getTimeManager() {
-    return timeManager;
-}
-
-SystemManager* ServiceLocator::getSystemManager() {
-    return systemManager;
-}
-
-HeartbeatLEDManager* ServiceLocator::getHeartbeatLEDManager() {
-    return heartbeatLEDManager;
-}
-
-IComponent** ServiceLocator::getAllComponents(size_t& count) {
-    count = 7;
-    return components;
+// Component instances, one per listed type (static allocation)
+template <> ParallelPortManager ComponentSlot<ParallelPortManager>::instance{};
+template <> FileSystemManager ComponentSlot<FileSystemManager>::instance{};
+template <> DisplayManager ComponentSlot<DisplayManager>::instance{};
+template <> ConfigurationManager ComponentSlot<ConfigurationManager>::instance{};
+template <> TimeManager ComponentSlot<TimeManager>::instance{};
+template <> SystemManager ComponentSlot<SystemManager>::instance{};
+template <> HeartbeatLEDManager ComponentSlot<HeartbeatLEDManager>::instance{};
+
+#if TASK_PROFILER
+TaskProfiler::Entry ServiceLocator::initProfile[ServiceLocator::Components::count];
+TaskProfiler::Entry ServiceLocator::updateProfile[ServiceLocator::Components::count];
+#endif
+
+namespace {
+
+/**
+ * Call visit(component, index) for every listed component, in order
+ * Each call is made with the concrete type, so component methods are
+ * called directly. Stops at the first visit that returns false.
+ * @return true if every visit returned true
+ */
+template <typename... Types, typename Visitor>
+bool visitAll(ComponentList<Types...>, Visitor&& visit) {
+    size_t index = 0;
+    return (visit(ComponentSlot<Types>::instance, index++) && ...);
+}
+
+} // namespace
+
+void ServiceLocator::forEachComponent(void (*visit)(IComponent& component)) {
+    visitAll(Components(), [visit](IComponent& component, size_t) {
+        visit(component);
+        return true;
+    });
 }
 
 int ServiceLocator::initializeAll() {
-    if (!componentsInitialized) {
-        return STATUS_NOT_INITIALIZED;
-    }
-    
-    for (size_t i = 0; i < 7; i++) {
-        if (components[i] != nullptr) {
-            int result = components[i]->initialize();
-            if (result != STATUS_OK) {
-                return result;
-            }
-        }
-    }
-    
-    return STATUS_OK;
+#if TASK_PROFILER
+    TaskProfiler::begin();
+#endif
+
+    int result = STATUS_OK;
+    visitAll(Components(), [&result](auto& component, size_t index) {
+#if TASK_PROFILER
+        TaskProfiler::Mark mark;
+        TaskProfiler::start(mark);
+        result = component.initialize();
+        TaskProfiler::stop(initProfile[index], mark);
+#else
+        (void)index;
+        result = component.initialize();
+#endif
+        return result == STATUS_OK;
+    });
+
+    return result;
 }
 
 int ServiceLocator::updateAll() {
-    if (!componentsInitialized) {
-        return STATUS_NOT_INITIALIZED;
-    }
-    
-    for (size_t i = 0; i < 7; i++) {
-        if (components[i] != nullptr) {
-            int result = components[i]->update();
-            if (result != STATUS_OK) {
-                return result;
-            }
-        }
-    }
-    
-    return STATUS_OK;
+    int result = STATUS_OK;
+    visitAll(Components(), [&result](auto& component, size_t index) {
+#if TASK_PROFILER
+        TaskProfiler::Mark mark;
+        TaskProfiler::start(mark);
+        result = component.update();
+        TaskProfiler::stop(updateProfile[index], mark);
+#else
+        (void)index;
+        result = component.update();
+#endif
+        return result == STATUS_OK;
+    });
+
+    return result;
 }
 
 bool ServiceLocator::validateAll() {
-    if (!componentsInitialized) {
-        return false;
-    }
-    
-    for (size_t i = 0; i < 7; i++) {
-        if (components[i] != nullptr) {
-            if (!components[i]->validate()) {
-                return false;
-            }
-        }
-    }
-    
-    return true;
+    return visitAll(Components(), [](auto& component, size_t) {
+        return component.validate();
+    });
 }
 
 int ServiceLocator::resetAll() {
-    if (!componentsInitialized) {
-        return STATUS_NOT_INITIALIZED;
-    }
-    
-    for (size_t i = 0; i < 7; i++) {
-        if (components[i] != nullptr) {
-            int result = components[i]->reset();
-            if (result != STATUS_OK) {
-                return result;
-            }
-        }
-    }
-    
-    return STATUS_OK;
+    int result = STATUS_OK;
+    visitAll(Components(), [&result](auto& component, size_t) {
+        result = component.reset();
+        return result == STATUS_OK;
+    });
+
+    return result;
 }
 
 size_t ServiceLocator::getTotalMemoryUsage() {
-    if (!componentsInitialized) {
-        return 0;
-    }
-    
     size_t totalUsage = 0;
-    for (size_t i = 0; i < 7; i++) {
-        if (components[i] != nullptr) {
-            totalUsage += components[i]->getMemoryUsage();
-        }
-    }
-    
-    return totalUsage;
-}
+    visitAll(Components(), [&totalUsage](auto& component, size_t) {
+        totalUsage += component.getMemoryUsage();
+        return true;
+    });
 
-bool ServiceLocator::allComponentsRegistered() {
-    return parallelPortManager != nullptr &&
-           fileSystemManager != nullptr &&
-           displayManager != nullptr &&
-           configurationManager != nullptr &&
-           timeManager != nullptr &&
-           systemManager != nullptr &&
-           heartbeatLEDManager != nullptr;
+    return totalUsage;
 }
 
 IComponent* ServiceLocator::getComponentByName(const char* name) {
-    if (!componentsInitialized || !name) {
+    if (!name) {
         return nullptr;
     }
-    
+
     size_t nameLen = safeStrlen(name, 32);
-    
-    for (size_t i = 0; i < 7; i++) {
-        if (components[i] != nullptr) {
-            // Compare component name (stored in PROGMEM)
-            if (equalsIgnoreCasePGM(name, nameLen, components[i]->getName())) {
-                return components[i];
-            }
+    IComponent* found = nullptr;
+
+    // Compare component name (stored in PROGMEM)
+    visitAll(Components(), [name, nameLen, &found](auto& component, size_t) {
+        if (equalsIgnoreCasePGM(name, nameLen, component.getName())) {
+            found = &component;
+            return false;
         }
-    }
-    
-    return nullptr;
+        return true;
+    });
+
+    return found;
 }
 
 void ServiceLocator::setAllDebugEnabled(bool enabled) {
-    if (!componentsInitialized) {
+    visitAll(Components(), [enabled](auto& component, size_t) {
+        component.setDebugEnabled(enabled);
+        return true;
+    });
+}
+
+#if TASK_PROFILER
+void ServiceLocator::printProfile() {
+    Serial.println(F("Initialize:"));
+    visitAll(Components(), [](auto& component, size_t index) {
+        Serial.print(F("  "));
+        Serial.print(component.getName());
+        Serial.print(F(": "));
+        TaskProfiler::print(initProfile[index]);
+        return true;
+    });
+
+    // updateAll() only runs when the scheduler is bypassed
+    bool updated = false;
+    for (size_t i = 0; i < Components::count; i++) {
+        updated = updated || updateProfile[i].calls != 0;
+    }
+    if (!updated) {
         return;
     }
-    
-    for (size_t i = 0; i < 7; i++) {
-        if (components[i] != nullptr) {
-            components[i]->setDebugEnabled(enabled);
-        }
+
+    Serial.println(F("Update:"));
+    visitAll(Components(), [](auto& component, size_t index) {
+        Serial.print(F("  "));
+        Serial.print(component.getName());
+        Serial.print(F(": "));
+        TaskProfiler::print(updateProfile[index]);
+        return true;
+    });
+}
+
+void ServiceLocator::resetProfile() {
+    for (size_t i = 0; i < Components::count; i++) {
+        TaskProfiler::reset(updateProfile[i]);
     }
-}
\ No newline at end of file
+}
+#endif
@@ -7,6 +7,8 @@
 #include "MemoryUtils.h"
 #include "HardwareSelfTest.h"
 #include "DebugCommands.h"
+#include "Scheduler.h"
+#include "HardwareBenchmark.h"
 
 // Component includes
 #include "ParallelPortManager.h"
@@ -16,6 +18,8 @@
 #include "TimeManager.h"
 #include "SystemManager.h"
 #include "HeartbeatLEDManager.h"
+#include "CaptureSession.h"
+#include "SerialOutput.h"
 
 // Storage plugins
 #include "SDCardStoragePlugin.h"
@@ -28,14 +32,16 @@
  * Implements IEEE-1284 compliant parallel port interface with multi-storage support
  */
 
-// Global component instances (static allocation)
-static ParallelPortManager parallelPortManager;
-static FileSystemManager fileSystemManager;
-static DisplayManager displayManager;
-static ConfigurationManager configurationManager;
-static TimeManager timeManager;
-static SystemManager systemManager;
-static HeartbeatLEDManager heartbeatLEDManager;
+// Component instances live in ServiceLocator; these are constant addresses
+static ParallelPortManager& parallelPortManager = ServiceLocator::get<ParallelPortManager>();
+static FileSystemManager& fileSystemManager = ServiceLocator::get<FileSystemManager>();
+static DisplayManager& displayManager = ServiceLocator::get<DisplayManager>();
+static ConfigurationManager& configurationManager = ServiceLocator::get<ConfigurationManager>();
+static TimeManager& timeManager = ServiceLocator::get<TimeManager>();
+static SystemManager& systemManager = ServiceLocator::get<SystemManager>();
+static HeartbeatLEDManager& heartbeatLEDManager = ServiceLocator::get<HeartbeatLEDManager>();
+static CaptureSession captureSession;
+static SerialOutput serialOutput;      // Status text, sent as the UART allows
 
 // Storage plugin instances
 static SDCardStoragePlugin sdCardPlugin;
@@ -54,8 +60,11 @@ static uint32_t loopCounter = 0;
  * @return true if initialization successful
  */
 bool initializeSystem() {
+    // Stored settings first: they carry the link speed
+    configurationManager.initialize();
+    
     // Initialize serial communication first with explicit configuration
-    Serial.begin(SERIAL_BAUD_RATE, SERIAL_8N1);
+    Serial.begin(configurationManager.getConfig().baudRate, SERIAL_8N1);
     
     // Ensure serial is ready before proceeding
     while (!Serial && millis() < 5000) {
@@ -73,7 +82,9 @@ bool initializeSystem() {
     Serial.println(F("====================================="));
     Serial.println(F("MegaDeviceBridge v1.0"));
     Serial.println(F("Tektronix TDS2024 Data Acquisition"));
-    Serial.println(F("Serial: 115200 8N1"));
+    Serial.print(F("Serial: "));
+    Serial.print(configurationManager.getConfig().baudRate);
+    Serial.println(F(" 8N1"));
     Serial.println(F("====================================="));
     Serial.println(F("Starting initialization..."));
     Serial.flush(); // Ensure all data is sent
@@ -84,17 +95,6 @@ bool initializeSystem() {
     // Register storage plugins with FileSystemManager
     fileSystemManager.registerPlugins(&sdCardPlugin, &eepromPlugin, &serialPlugin);
     
-    // Register all components with ServiceLocator
-    ServiceLocator::registerComponents(
-        &parallelPortManager,
-        &fileSystemManager,
-        &displayManager,
-        &configurationManager,
-        &timeManager,
-        &systemManager,
-        &heartbeatLEDManager
-    );
-    
     // Initialize all components (continue even if some fail)
     int result = ServiceLocator::initializeAll();
     if (result != STATUS_OK) {
@@ -145,51 +145,62 @@ void handleSystemError(int errorCode, const char* errorMessage) {
 
 /**
  * Process captured parallel port data
+ * @return STATUS_OK
  */
-void processParallelPortData() {
-    size_t availableBytes = parallelPortManager.getAvailableBytes();
+int processParallelPortData() {
+    // First byte after a sleep: time from its strobe until it is taken
+    bool woken = Scheduler::isWakePending() && parallelPortManager.getAvailableBytes() > 0;
     
-    if (availableBytes > 0) {
-        // EMERGENCY: Single byte processing to prevent corruption
-        static uint8_t dataBuffer[1];   // EMERGENCY: 1 byte to prevent corruption
-        size_t bytesToRead = min(availableBytes, sizeof(dataBuffer));
-        
-        // Read data from parallel port manager
-        size_t bytesRead = parallelPortManager.readData(dataBuffer, bytesToRead);
-        
-        if (bytesRead > 0) {
-            // Generate filename with timestamp
-            char filename[MAX_FILENAME_LENGTH];
-            
-            // Get current time for filename
-            // For now, use simple counter-based naming
-            static uint16_t fileCounter = 1;
-            snprintf(filename, sizeof(filename), "data_%04d.bin", fileCounter++);
-            
-            // Write to current storage
-            size_t bytesWritten = fileSystemManager.writeFile(filename, dataBuffer, bytesRead);
-            
-            if (bytesWritten == bytesRead) {
-                // Update display with capture status
-                char statusMsg[17];
-                snprintf(statusMsg, sizeof(statusMsg), "Saved: %s", filename);
-                displayManager.displayMessage("Data Captured", statusMsg, 2000);
-                
-                Serial.print(F("Captured "));
-                Serial.print(bytesRead);
-                Serial.print(F(" bytes to "));
-                Serial.println(filename);
-            } else {
-                // Rate limit write error messages to prevent LCD flashing
-                static uint32_t lastWriteError = 0;
-                if (millis() - lastWriteError >= 5000) {
-                    Serial.println(F("Warning: Partial write or write failed"));
-                    displayManager.displayError("Write err");
-                    lastWriteError = millis();
-                }
-            }
-        }
+    // Stream the capture buffer into the current print job's file
+    captureSession.update();
+    
+    if (woken) {
+        Scheduler::recordWakeLatency(parallelPortManager.getStrobeAge());
     }
+    return STATUS_OK;
+}
+
+/**
+ * Check if the capture ring needs draining ahead of other tasks
+ * @return true once the ring holds SCHEDULER_DRAIN_THRESHOLD bytes
+ */
+bool isCaptureWaiting() {
+    return parallelPortManager.getAvailableBytes() >= SCHEDULER_DRAIN_THRESHOLD;
+}
+
+/**
+ * Check if the loop may sleep until the next interrupt
+ * Called with interrupts disabled
+ * @return true with no captured data, job, transfer or command input pending
+ */
+bool isSystemQuiet() {
+    return parallelPortManager.getAvailableBytes() == 0 &&
+           !captureSession.isActive() &&
+           !Serial.available() &&
+           !fileSystemManager.isCopying() &&
+           !fileSystemManager.isMigrating() &&
+           !fileSystemManager.isSerialTransferring();
+}
+
+/**
+ * Process serial debug commands
+ * @return STATUS_OK
+ */
+int processDebugCommands() {
+    DebugCommands::update();
+    return STATUS_OK;
+}
+
+/**
+ * Send queued status text without waiting on the UART
+ * @return STATUS_OK
+ */
+int sendSerialOutput() {
+    // Pass-through output is the raw capture only
+    if (!captureSession.isPassThrough()) {
+        serialOutput.update();
+    }
+    return STATUS_OK;
 }
 
 /**
@@ -198,27 +209,126 @@ void processParallelPortData() {
 void updateSystemStatus() {
     uint32_t currentTime = millis();
     
-    if (currentTime - lastStatusUpdate >= 5000) { // Update every 5 seconds
+    // Update every 5 seconds, once the previous line has gone out
+    if (currentTime - lastStatusUpdate >= 5000 && serialOutput.isEmpty()) {
         // Get system statistics
         uint32_t totalBytes = parallelPortManager.getTotalBytesReceived();
         uint32_t overflows = parallelPortManager.getOverflowCount();
         uint8_t bufferUtil = parallelPortManager.getBufferUtilization();
         
         // Display on serial
-        Serial.print(F("Status - Bytes: "));
-        Serial.print(totalBytes);
-        Serial.print(F(", Overflows: "));
-        Serial.print(overflows);
-        Serial.print(F(", Buffer: "));
-        Serial.print(bufferUtil);
-        Serial.print(F("%, RAM: "));
-        Serial.print(getAvailableRAM());
-        Serial.println(F("B"));
+        serialOutput.print(F("Status - Bytes: "));
+        serialOutput.print(totalBytes);
+        serialOutput.print(F(", Overflows: "));
+        serialOutput.print(overflows);
+        serialOutput.print(F(", Dropped: "));
+        serialOutput.print(parallelPortManager.getDroppedBytes());
+        serialOutput.print(F(", Stalls: "));
+        serialOutput.print(parallelPortManager.getStallCount());
+        serialOutput.print(F("/"));
+        serialOutput.print(parallelPortManager.getStallTime());
+        serialOutput.print(F("ms"));
+        
+        // Block pipeline: fill latency and writer falling behind
+        const CaptureBlockPipeline& pipeline = captureSession.getPipeline();
+        uint32_t lastFill, maxFill, avgFill;
+        pipeline.getFillLatency(lastFill, maxFill, avgFill);
+        serialOutput.print(F(", Blocks: "));
+        serialOutput.print(pipeline.getBlocksWritten());
+        serialOutput.print(F(" fill "));
+        serialOutput.print(avgFill);
+        serialOutput.print(F("/"));
+        serialOutput.print(maxFill);
+        serialOutput.print(F("us behind "));
+        serialOutput.print(pipeline.getWriterStalls());
+        serialOutput.print(F(", Buffer: "));
+        serialOutput.print(bufferUtil);
+        serialOutput.print(F("%, RAM: "));
+        serialOutput.print(getAvailableRAM());
+        serialOutput.println(F("B"));
         
         lastStatusUpdate = currentTime;
     }
 }
 
+/**
+ * Periodic status, overflow, memory and performance reports
+ * @return STATUS_OK
+ */
+int reportSystemHealth() {
+    uint32_t now = millis();
+    
+    // Update system status display
+    updateSystemStatus();
+    
+    // Check for buffer overflow conditions (rate limited)
+    static uint32_t lastOverflowCheck = 0;
+    if (now - lastOverflowCheck >= 5000) { // Check every 5 seconds
+        if (parallelPortManager.hasBufferOverflow()) {
+            serialOutput.println(F("Warning: Parallel port buffer overflow"));
+            parallelPortManager.clearBufferOverflow();
+            
+            // Brief error indication on display
+            displayManager.displayError("Buf ovflow", 0);
+        }
+        lastOverflowCheck = now;
+    }
+    
+    // Monitor memory usage (rate limited)
+    static uint32_t lastMemoryCheck = 0;
+    if (now - lastMemoryCheck >= 10000) { // Check every 10 seconds
+        int availableRAM = getAvailableRAM();
+        if (availableRAM < 100) { // Critical threshold
+            serialOutput.print(F("Warning: Low memory - "));
+            serialOutput.print(availableRAM);
+            serialOutput.println(F(" bytes free"));
+            
+            displayManager.displayError("Low mem");
+        }
+        lastMemoryCheck = now;
+    }
+    
+    // Performance monitoring (every 10 seconds, behind queued status text)
+    if (now - lastLoopTime >= 10000 && serialOutput.isEmpty()) {
+        float loopsPerSecond = loopCounter / ((now - lastLoopTime) / 1000.0);
+        
+        serialOutput.print(F("Performance: "));
+        serialOutput.print(loopsPerSecond);
+        serialOutput.println(F(" loops/sec"));
+        
+        loopCounter = 0;
+        lastLoopTime = now;
+    }
+    
+    return STATUS_OK;
+}
+
+/**
+ * Register the main loop tasks with the scheduler
+ */
+void registerTasks() {
+    // Capture first: drain whenever the ring fills, then let the port
+    // release BUSY
+    Scheduler::addTask(F("Capture"), processParallelPortData, 0,
+                       Scheduler::PRIORITY_CAPTURE, isCaptureWaiting);
+    Scheduler::addComponent<ParallelPortManager>(0, Scheduler::PRIORITY_CAPTURE);
+    
+    // Serial link: command input and queued text
+    Scheduler::addTask(F("Commands"), processDebugCommands, 0, Scheduler::PRIORITY_IO);
+    Scheduler::addTask(F("SerialOut"), sendSerialOutput, 0, Scheduler::PRIORITY_IO);
+    
+    // Storage work is sliced by its own budgets (TRANSFER_STEP_US, erase polling)
+    Scheduler::addComponent<FileSystemManager>(SCHEDULER_STORAGE_MS, Scheduler::PRIORITY_STORAGE);
+    
+    Scheduler::addComponent<DisplayManager>(SCHEDULER_DISPLAY_MS, Scheduler::PRIORITY_UI);
+    Scheduler::addComponent<HeartbeatLEDManager>(SCHEDULER_LED_MS, Scheduler::PRIORITY_UI);
+    
+    Scheduler::addTask(F("Health"), reportSystemHealth, SCHEDULER_IDLE_MS, Scheduler::PRIORITY_IDLE);
+    Scheduler::addComponent<ConfigurationManager>(SCHEDULER_IDLE_MS, Scheduler::PRIORITY_IDLE);
+    Scheduler::addComponent<TimeManager>(SCHEDULER_IDLE_MS, Scheduler::PRIORITY_IDLE);
+    Scheduler::addComponent<SystemManager>(SCHEDULER_IDLE_MS, Scheduler::PRIORITY_IDLE);
+}
+
 /**
  * Arduino setup function - called once at startup
  */
@@ -245,17 +355,24 @@ void setup() {
     
     if (!systemInitialized) {
         handleSystemError(STATUS_ERROR, "Init failed");
+        displayManager.forceUpdate();     // No display task will run
         return;
     }
     
+    // Stored port and capture tunables
+    configurationManager.apply(&captureSession);
+    captureSession.setOutput(serialOutput);
+    
     // Enable parallel port data capture
     parallelPortManager.setCaptureEnabled(true);
     
     // Enable auto status updates on display
     displayManager.setAutoStatusUpdate(true, 3000);
     
-    // DEBUG COMMANDS DISABLED - CRITICAL MEMORY SHORTAGE
-    // DebugCommands::initialize();
+    // Serial debug command interface
+    DebugCommands::initialize(&captureSession);
+    
+    registerTasks();
     
     // SELF-TEST DISABLED TO SAVE CRITICAL MEMORY
     // Quick validation only
@@ -270,8 +387,6 @@ void setup() {
  * Implements cooperative multitasking for all system components
  */
 void loop() {
-    uint32_t currentTime = millis();
-    
     // Skip loop if system not initialized or in error state
     if (!systemInitialized) {
         delay(1000);
@@ -281,62 +396,27 @@ void loop() {
     // Increment loop counter for performance monitoring
     loopCounter++;
     
-    // Update all system components (cooperative multitasking)
-    int updateResult = ServiceLocator::updateAll();
+    // Run the due tasks; the capture drain also runs between any two of
+    // them once the ring fills, so there is no idle delay here either
+#if HARDWARE_BENCHMARK
+    // The "bench loop" window times each pass, idle sleep excluded
+    bool timingPass = HardwareBenchmark::isTimingLoop();
+    TaskProfiler::Mark passStart;
+    if (timingPass) {
+        TaskProfiler::start(passStart);
+    }
+#endif
+    int updateResult = Scheduler::run();
+#if HARDWARE_BENCHMARK
+    if (timingPass) {
+        HardwareBenchmark::recordLoopPass(passStart);
+    }
+#endif
     if (updateResult != STATUS_OK) {
         handleSystemError(updateResult, "Component update failed");
         return;
     }
     
-    // Process captured parallel port data
-    processParallelPortData();
-    
-    // Update system status display
-    updateSystemStatus();
-    
-    // DEBUG COMMANDS DISABLED - CRITICAL MEMORY SHORTAGE
-    // DebugCommands::update();
-    
-    // Check for buffer overflow conditions (rate limited)
-    static uint32_t lastOverflowCheck = 0;
-    if (currentTime - lastOverflowCheck >= 5000) { // Check every 5 seconds
-        if (parallelPortManager.hasBufferOverflow()) {
-            Serial.println(F("Warning: Parallel port buffer overflow"));
-            parallelPortManager.clearBufferOverflow();
-            
-            // Brief error indication on display
-            displayManager.displayError("Buf ovflow", 0);
-        }
-        lastOverflowCheck = currentTime;
-    }
-    
-    // Monitor memory usage (rate limited)
-    static uint32_t lastMemoryCheck = 0;
-    if (currentTime - lastMemoryCheck >= 10000) { // Check every 10 seconds
-        int availableRAM = getAvailableRAM();
-        if (availableRAM < 100) { // Critical threshold
-            Serial.print(F("Warning: Low memory - "));
-            Serial.print(availableRAM);
-            Serial.println(F(" bytes free"));
-            
-            displayManager.displayError("Low mem");
-        }
-        lastMemoryCheck = currentTime;
-    }
-    
-    // Performance monitoring (every 10 seconds)
-    if (currentTime - lastLoopTime >= 10000) {
-        float loopsPerSecond = loopCounter / 10.0;
-        
-        Serial.print(F("Performance: "));
-        Serial.print(loopsPerSecond);
-        Serial.println(F(" loops/sec"));
-        
-        loopCounter = 0;
-        lastLoopTime = currentTime;
-    }
-    
-    // Small delay to prevent overwhelming the system
-    // This maintains cooperative multitasking behavior
-    delay(1);
+    // Nothing in flight: sleep until a strobe, serial byte or timer tick
+    Scheduler::idle(isSystemQuiet);
 }
\ No newline at end of file
@@ -0,0 +1,270 @@
+#include "CaptureBlockPipeline.h"
+#include "ServiceLocator.h"
+#include "FileSystemManager.h"
+
+CaptureBlockPipeline::CaptureBlockPipeline()
+    : blocks(), fillIndex(0), fillLevel(0), blockPending(false),
+      writerBehind(false), blockStartTime(0), bytesCommitted(0), bytesCaptured(0),
+#if CAPTURE_COMPRESSION
+      compressing(false),
+#endif
+      blocksWritten(0), writerStalls(0), lastFillLatency(0),
+      maxFillLatency(0), fillLatencyTotal(0), fillLatencySamples(0) {
+}
+
+void CaptureBlockPipeline::reset() {
+    fillIndex = 0;
+    fillLevel = 0;
+    blockPending = false;
+    writerBehind = false;
+    bytesCommitted = 0;
+    bytesCaptured = 0;
+#if CAPTURE_COMPRESSION
+    encoder.reset();
+    compressing = false;
+#endif
+}
+
+bool CaptureBlockPipeline::rotate() {
+    if (fillLevel < CAPTURE_BLOCK_SIZE || blockPending) {
+        return false;
+    }
+
+    // Block-fill latency: first byte in to last byte in
+    lastFillLatency = micros() - blockStartTime;
+    if (lastFillLatency > maxFillLatency) {
+        maxFillLatency = lastFillLatency;
+    }
+
+    // Exact mean; near 32-bit wrap both halve, which keeps the mean
+    if (fillLatencyTotal > 0xFFFFFFFFUL - lastFillLatency) {
+        fillLatencyTotal /= 2;
+        fillLatencySamples /= 2;
+    }
+    fillLatencyTotal += lastFillLatency;
+    fillLatencySamples++;
+
+    blockPending = true;
+    fillIndex ^= 1;
+    fillLevel = 0;
+    writerBehind = false;
+    return true;
+}
+
+size_t CaptureBlockPipeline::fill(const uint8_t* data, size_t size) {
+    if (!data || size == 0) {
+        return 0;
+    }
+
+    size_t accepted = 0;
+
+#if CAPTURE_COMPRESSION
+    if (compressing) {
+        BlockSink sink = {*this};
+        while (accepted < size) {
+            // One input byte may release a whole literal packet
+            if (getFreeSpace() < PACKBITS_MAX_EMIT) {
+                if (!writerBehind) {
+                    writerBehind = true;
+                    writerStalls++;
+                }
+                break;
+            }
+            encoder.feed(data[accepted++], sink);
+        }
+
+        rotate();
+        bytesCaptured += accepted;
+        return accepted;
+    }
+#endif
+
+    while (accepted < size) {
+        if (fillLevel == CAPTURE_BLOCK_SIZE && !rotate()) {
+            // Both blocks full - count each episode once
+            if (!writerBehind) {
+                writerBehind = true;
+                writerStalls++;
+            }
+            break;
+        }
+
+        if (fillLevel == 0) {
+            blockStartTime = micros();
+        }
+
+        size_t chunk = min((size_t)(CAPTURE_BLOCK_SIZE - fillLevel), size - accepted);
+        memcpy(&blocks[fillIndex][fillLevel], data + accepted, chunk);
+        fillLevel += chunk;
+        accepted += chunk;
+    }
+
+    // Queue a just-completed block straight away
+    rotate();
+
+    bytesCaptured += accepted;
+    return accepted;
+}
+
+#if CAPTURE_COMPRESSION
+void CaptureBlockPipeline::putByte(uint8_t value) {
+    if (fillLevel == CAPTURE_BLOCK_SIZE) {
+        rotate();
+    }
+    if (fillLevel == 0) {
+        blockStartTime = micros();
+    }
+    blocks[fillIndex][fillLevel++] = value;
+}
+
+size_t CaptureBlockPipeline::getFreeSpace() const {
+    return (CAPTURE_BLOCK_SIZE - fillLevel) + (blockPending ? 0 : CAPTURE_BLOCK_SIZE);
+}
+#endif
+
+bool CaptureBlockPipeline::startCompression() {
+#if CAPTURE_COMPRESSION
+    if (compressing) {
+        return true;
+    }
+
+    // Only the fill block can hold data this early; its bytes are encoded
+    // into the other block, which must not need to rotate meanwhile
+    uint16_t buffered = fillLevel;
+    if (blockPending || bytesCommitted > 0 ||
+        PACKBITS_HEADER_SIZE + buffered + buffered / PACKBITS_MAX_LITERAL + 1 > CAPTURE_BLOCK_SIZE) {
+        return false;
+    }
+
+    const uint8_t* raw = blocks[fillIndex];
+    fillIndex ^= 1;
+    fillLevel = 0;
+
+    BlockSink sink = {*this};
+    for (uint8_t i = 0; i < PACKBITS_HEADER_SIZE; i++) {
+        putByte(PackBits::HEADER[i]);
+    }
+    encoder.reset();
+    encoder.feed(raw, buffered, sink);
+
+    compressing = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool CaptureBlockPipeline::isCompressing() const {
+#if CAPTURE_COMPRESSION
+    return compressing;
+#else
+    return false;
+#endif
+}
+
+int CaptureBlockPipeline::writeBlock(const uint8_t* data, size_t size) {
+    auto fileSystem = ServiceLocator::getFileSystemManager();
+    if (!fileSystem) {
+        return STATUS_ERROR;
+    }
+
+    size_t written = fileSystem->append(data, size);
+    bytesCommitted += written;
+    blocksWritten++;
+
+    return written == size ? STATUS_OK : STATUS_ERROR;
+}
+
+int CaptureBlockPipeline::service() {
+    if (!blockPending) {
+        return STATUS_OK;
+    }
+
+    auto fileSystem = ServiceLocator::getFileSystemManager();
+    if (!fileSystem) {
+        return STATUS_ERROR;
+    }
+
+    // Let the previous block finish programming while capture keeps filling
+    if (fileSystem->isWriteBusy()) {
+        return STATUS_BUSY;
+    }
+
+    int result = writeBlock(blocks[fillIndex ^ 1], CAPTURE_BLOCK_SIZE);
+    blockPending = false;
+
+    // Fill block may have completed while this one was waiting
+    rotate();
+
+    return result;
+}
+
+int CaptureBlockPipeline::flush() {
+    int result = STATUS_OK;
+
+#if CAPTURE_COMPRESSION
+    if (compressing) {
+        // Make room for the encoder's last packet
+        if (getFreeSpace() < PACKBITS_MAX_EMIT) {
+            if (writeBlock(blocks[fillIndex ^ 1], CAPTURE_BLOCK_SIZE) != STATUS_OK) {
+                result = STATUS_ERROR;
+            }
+            blockPending = false;
+        }
+        BlockSink sink = {*this};
+        encoder.finish(sink);
+    }
+#endif
+
+    if (blockPending) {
+        if (writeBlock(blocks[fillIndex ^ 1], CAPTURE_BLOCK_SIZE) != STATUS_OK) {
+            result = STATUS_ERROR;
+        }
+        blockPending = false;
+    }
+
+    if (fillLevel > 0) {
+        if (writeBlock(blocks[fillIndex], fillLevel) != STATUS_OK) {
+            result = STATUS_ERROR;
+        }
+        fillLevel = 0;
+    }
+
+    writerBehind = false;
+    return result;
+}
+
+size_t CaptureBlockPipeline::getBufferedBytes() const {
+    return fillLevel + (blockPending ? CAPTURE_BLOCK_SIZE : 0);
+}
+
+uint32_t CaptureBlockPipeline::getBytesCommitted() const {
+    return bytesCommitted;
+}
+
+uint32_t CaptureBlockPipeline::getBytesCaptured() const {
+    return bytesCaptured;
+}
+
+uint32_t CaptureBlockPipeline::getBlocksWritten() const {
+    return blocksWritten;
+}
+
+uint32_t CaptureBlockPipeline::getWriterStalls() const {
+    return writerStalls;
+}
+
+void CaptureBlockPipeline::getFillLatency(uint32_t& lastUs, uint32_t& maxUs, uint32_t& avgUs) const {
+    lastUs = lastFillLatency;
+    maxUs = maxFillLatency;
+    avgUs = fillLatencySamples ? fillLatencyTotal / fillLatencySamples : 0;
+}
+
+void CaptureBlockPipeline::resetStatistics() {
+    blocksWritten = 0;
+    writerStalls = 0;
+    lastFillLatency = 0;
+    maxFillLatency = 0;
+    fillLatencyTotal = 0;
+    fillLatencySamples = 0;
+}
@@ -0,0 +1,474 @@
+#include "CaptureSession.h"
+#include "ServiceLocator.h"
+#include "ParallelPortManager.h"
+#include "FileSystemManager.h"
+#include "DisplayManager.h"
+#if CAPTURE_SPILL
+#include "EEPROMStoragePlugin.h"
+#endif
+
+CaptureSession::CaptureSession()
+    : active(false), fileOpen(false), sessionBytes(0), lastDataTime(0),
+      idleTimeoutMs(CAPTURE_IDLE_TIMEOUT), compressionEnabled(CAPTURE_COMPRESSION != 0),
+      passThrough(CAPTURE_PASS_THROUGH != 0), debugEnabled(false), output(&Serial),
+      jobCount(0), writeErrors(0), passThroughBytes(0)
+#if CAPTURE_SPILL
+      , spill(nullptr), spilledBytes(0), spillEvents(0)
+#endif
+{
+    filename[0] = '\0';
+}
+
+void CaptureSession::update() {
+    auto parallelPort = ServiceLocator::getParallelPortManager();
+    if (!parallelPort) {
+        return;
+    }
+
+    if (passThrough) {
+        forward();
+        return;
+    }
+
+    size_t drained = drain();
+    if (drained > 0) {
+        lastDataTime = millis();
+        return;
+    }
+
+    if (!active) {
+        return;
+    }
+
+    // Bytes still waiting (pipeline or storage stalled while BUSY holds
+    // the host) belong to this job: that wait is not an idle gap
+    if (parallelPort->getAvailableBytes() > 0) {
+        return;
+    }
+
+    // Job boundary: host reset or idle gap
+    if (parallelPort->isInitAsserted()) {
+        if (debugEnabled) {
+            output->println(F("CaptureSession: /INIT asserted, closing job"));
+        }
+        closeSession();
+    } else if (millis() - lastDataTime >= idleTimeoutMs) {
+        closeSession();
+    }
+}
+
+size_t CaptureSession::drain() {
+    auto parallelPort = ServiceLocator::getParallelPortManager();
+    if (!parallelPort) {
+        return 0;
+    }
+
+    size_t total = 0;
+
+#if CAPTURE_SPILL
+    if (spill) {
+        total = drainSpill();
+    }
+#endif
+
+    // At most two spans: the tail of the ring and the part that wrapped
+    for (uint8_t span = 0; span < 2 && !isSpilling(); span++) {
+        const uint8_t* data = nullptr;
+        size_t length = parallelPort->peekContiguous(data);
+        if (length == 0) {
+            break;
+        }
+
+        if (!active) {
+            startSession();
+        }
+
+        size_t accepted = pipeline.fill(data, length);
+        detector.feed(data, accepted);
+        parallelPort->consume(accepted);
+        total += accepted;
+
+        if (accepted < length) {
+            // Writer is behind: the rest stays in the capture buffer
+#if CAPTURE_SPILL
+            if (parallelPort->getAvailableBytes() >= CAPTURE_SPILL_WATERMARK) {
+                startSpill();
+            }
+#endif
+            break;
+        }
+    }
+
+    // Name the file once the leading bytes are classified
+    if (active && !fileOpen && detector.isDecided()) {
+        openFile();
+    }
+
+    // Hand a full block to storage once it is free to take it
+    if (fileOpen && pipeline.service() == STATUS_ERROR) {
+        writeErrors++;
+    }
+    updateSessionBytes();
+
+    return total;
+}
+
+#if CAPTURE_SPILL
+void CaptureSession::startSpill() {
+    auto fileSystem = ServiceLocator::getFileSystemManager();
+    spill = fileSystem ? fileSystem->getSpillStorage() : nullptr;
+    if (!spill) {
+        return;
+    }
+
+    spillEvents++;
+    if (debugEnabled) {
+        output->println(F("CaptureSession: Storage stalled, spilling to flash"));
+    }
+}
+
+size_t CaptureSession::drainSpill() {
+    auto parallelPort = ServiceLocator::getParallelPortManager();
+    size_t total = 0;
+
+    // New bytes queue behind the spilled ones, so the order is kept
+    for (uint8_t span = 0; span < 2; span++) {
+        const uint8_t* data = nullptr;
+        size_t length = parallelPort->peekContiguous(data);
+        if (length == 0) {
+            break;
+        }
+
+        size_t written = spill->spillWrite(data, length);
+        parallelPort->consume(written);
+        spilledBytes += written;
+        total += written;
+
+        if (written < length) {
+            // Page program still running: BUSY holds the host meanwhile
+            break;
+        }
+    }
+
+    // Feed the oldest bytes back as the pipeline frees up
+    uint8_t chunk[CAPTURE_SPILL_CHUNK];
+    size_t count;
+    while ((count = spill->spillPeek(chunk, sizeof(chunk))) > 0) {
+        size_t accepted = pipeline.fill(chunk, count);
+        detector.feed(chunk, accepted);
+        spill->spillConsume(accepted);
+        total += accepted;
+
+        if (accepted < count) {
+            break;
+        }
+    }
+
+    if (spill->getSpillPending() == 0) {
+        dropSpill();
+        if (debugEnabled) {
+            output->println(F("CaptureSession: Spill drained"));
+        }
+    }
+
+    return total;
+}
+
+void CaptureSession::dropSpill() {
+    if (spill) {
+        spill->endSpill();
+        spill = nullptr;
+    }
+}
+#endif
+
+size_t CaptureSession::forward() {
+    auto parallelPort = ServiceLocator::getParallelPortManager();
+    if (!parallelPort) {
+        return 0;
+    }
+
+    // A file being streamed over serial keeps the link until it closes
+    auto fileSystem = ServiceLocator::getFileSystemManager();
+    if (fileSystem && fileSystem->isSerialTransferring()) {
+        return 0;
+    }
+
+    size_t total = 0;
+
+    // At most two spans: the tail of the ring and the part that wrapped
+    for (uint8_t span = 0; span < 2; span++) {
+        const uint8_t* data = nullptr;
+        size_t length = parallelPort->peekContiguous(data);
+        size_t room = Serial.availableForWrite();
+        size_t count = length < room ? length : room;
+        if (count == 0) {
+            break;
+        }
+
+        Serial.write(data, count);
+        parallelPort->consume(count);
+        total += count;
+
+        if (count < length) {
+            break;
+        }
+    }
+
+    passThroughBytes += total;
+    return total;
+}
+
+void CaptureSession::startSession() {
+    active = true;
+    fileOpen = false;
+    filename[0] = '\0';
+    sessionBytes = 0;
+    pipeline.reset();
+    detector.reset();
+
+    // Timing statistics describe one job at a time
+    auto parallelPort = ServiceLocator::getParallelPortManager();
+    if (parallelPort) {
+        parallelPort->resetTimingStats();
+    }
+}
+
+bool CaptureSession::openFile() {
+    auto fileSystem = ServiceLocator::getFileSystemManager();
+
+    // Rate limit open error messages to prevent LCD flashing
+    static uint32_t lastOpenError = 0;
+
+    const char* extension = detector.getFormat() == FormatDetector::FORMAT_UNKNOWN
+                            ? CAPTURE_FILE_EXTENSION : detector.getExtension();
+
+    // Pre-size from the BMP header, but a bogus header must not cost the
+    // capture: retry without the hint if storage refuses it
+    uint32_t sizeHint = detector.getDeclaredSize();
+    bool opened = fileSystem &&
+                  fileSystem->openWriteAuto(CAPTURE_FILE_PREFIX, extension,
+                                            filename, sizeof(filename), sizeHint);
+    if (!opened && fileSystem && sizeHint != 0) {
+        opened = fileSystem->openWriteAuto(CAPTURE_FILE_PREFIX, extension,
+                                           filename, sizeof(filename));
+    }
+
+    if (!opened) {
+        // No storage: drop the job rather than stalling the host forever
+        filename[0] = '\0';
+        writeErrors++;
+        pipeline.reset();
+#if CAPTURE_SPILL
+        dropSpill();
+#endif
+        active = false;
+
+        if (millis() - lastOpenError >= 5000) {
+            output->println(F("Warning: Could not open capture file"));
+            auto display = ServiceLocator::getDisplayManager();
+            if (display) {
+                display->displayError("Open err");
+            }
+            lastOpenError = millis();
+        }
+        return false;
+    }
+
+    fileOpen = true;
+
+    // Flat screenshots shrink a lot; formats that are already compressed
+    // would only grow
+    if (compressionEnabled && !detector.isCompressed()) {
+        pipeline.startCompression();
+    }
+
+    if (debugEnabled) {
+        output->print(F("CaptureSession: Started "));
+        output->print(filename);
+        if (pipeline.isCompressing()) {
+            output->print(F(" (packed)"));
+        }
+        output->println();
+    }
+
+    return true;
+}
+
+void CaptureSession::updateSessionBytes() {
+    // The capture size is what the host sent; a packed file only knows its
+    // stored size per block
+    sessionBytes = pipeline.isCompressing() ? pipeline.getBytesCaptured()
+                                            : pipeline.getBytesCommitted();
+}
+
+bool CaptureSession::closeSession() {
+    if (!active) {
+        return false;
+    }
+
+    // Pick up anything that arrived since the last update and write
+    // out the partial block
+    size_t moved;
+    do {
+        moved = drain();
+        if (!active) {
+            return false;
+        }
+        if (!fileOpen) {
+            // Job shorter than the detection window
+            detector.finish();
+            if (!openFile()) {
+                return false;
+            }
+        }
+        if (pipeline.flush() != STATUS_OK) {
+            writeErrors++;
+        }
+    } while (moved > 0);
+    updateSessionBytes();
+
+#if CAPTURE_SPILL
+    if (spill) {
+        // Spill could not be read back: the file misses its tail
+        writeErrors++;
+        dropSpill();
+    }
+#endif
+
+    auto fileSystem = ServiceLocator::getFileSystemManager();
+    bool committed = fileSystem && fileSystem->closeWrite();
+    active = false;
+    fileOpen = false;
+
+    if (committed) {
+        jobCount++;
+    }
+
+    reportSession(committed);
+    return committed;
+}
+
+void CaptureSession::reportSession(bool committed) {
+    auto display = ServiceLocator::getDisplayManager();
+
+    if (committed) {
+        output->print(F("Captured "));
+        output->print(sessionBytes);
+        output->print(F(" bytes to "));
+        output->print(filename);
+        if (pipeline.isCompressing()) {
+            output->print(F(" ("));
+            output->print(pipeline.getBytesCommitted());
+            output->print(F(" packed)"));
+        }
+        output->println();
+
+        // Truncated or padded image: header and capture disagree
+        uint32_t declared = detector.getDeclaredSize();
+        if (declared != 0 && declared != sessionBytes) {
+            output->print(F("Warning: header declares "));
+            output->print(declared);
+            output->println(F(" bytes"));
+        }
+
+        if (display) {
+            // One 16-column row: "Saved: " leaves 9 characters of the name
+            char statusMsg[17];
+            snprintf(statusMsg, sizeof(statusMsg), "Saved: %.9s", filename);
+            display->displayMessage("Data Captured", statusMsg, 2000);
+        }
+    } else {
+        output->print(F("Warning: Capture not saved: "));
+        output->println(filename);
+
+        if (display) {
+            display->displayError("Write err");
+        }
+    }
+}
+
+bool CaptureSession::isActive() const {
+    return active;
+}
+
+const char* CaptureSession::getFilename() const {
+    return filename;
+}
+
+uint32_t CaptureSession::getSessionBytes() const {
+    return sessionBytes;
+}
+
+uint32_t CaptureSession::getJobCount() const {
+    return jobCount;
+}
+
+uint32_t CaptureSession::getWriteErrors() const {
+    return writeErrors;
+}
+
+const FormatDetector& CaptureSession::getDetector() const {
+    return detector;
+}
+
+const CaptureBlockPipeline& CaptureSession::getPipeline() const {
+    return pipeline;
+}
+
+bool CaptureSession::isSpilling() const {
+#if CAPTURE_SPILL
+    return spill != nullptr;
+#else
+    return false;
+#endif
+}
+
+#if CAPTURE_SPILL
+uint32_t CaptureSession::getSpilledBytes() const {
+    return spilledBytes;
+}
+
+uint32_t CaptureSession::getSpillEvents() const {
+    return spillEvents;
+}
+#endif
+
+void CaptureSession::setIdleTimeout(uint32_t timeoutMs) {
+    idleTimeoutMs = timeoutMs;
+}
+
+uint32_t CaptureSession::getIdleTimeout() const {
+    return idleTimeoutMs;
+}
+
+void CaptureSession::setPassThrough(bool enabled) {
+    if (enabled && active) {
+        closeSession();
+    }
+    passThrough = enabled;
+}
+
+bool CaptureSession::isPassThrough() const {
+    return passThrough;
+}
+
+uint32_t CaptureSession::getPassThroughBytes() const {
+    return passThroughBytes;
+}
+
+void CaptureSession::setCompressionEnabled(bool enabled) {
+    compressionEnabled = enabled;
+}
+
+bool CaptureSession::isCompressionEnabled() const {
+    return compressionEnabled;
+}
+
+void CaptureSession::setDebugEnabled(bool enabled) {
+    debugEnabled = enabled;
+}
+
+void CaptureSession::setOutput(Print& text) {
+    output = &text;
+}
@@ -0,0 +1,252 @@
+#include "ConfigurationManager.h"
+#include <avr/eeprom.h>
+#include "MemoryUtils.h"
+#include "ServiceLocator.h"
+#include "ParallelPortManager.h"
+#include "CaptureSession.h"
+#include "DisplayManager.h"
+#include "Crc32.h"
+
+static_assert(CONFIG_EEPROM_ADDRESS + sizeof(RuntimeConfig) <= 4096,
+              "Runtime configuration must fit the 4KB internal EEPROM");
+
+// Range of the idle gap that ends a job
+#define CONFIG_MIN_IDLE_TIMEOUT     100
+#define CONFIG_MAX_IDLE_TIMEOUT     60000
+
+ConfigurationManager::ConfigurationManager()
+    : initialized(false), debugEnabled(false), booted(false), source(SOURCE_DEFAULTS) {
+    loadDefaults(config);
+}
+
+int ConfigurationManager::initialize() {
+    if (initialized) {
+        return STATUS_OK;
+    }
+
+    // Recovery from a stored setting that locks the host out (e.g. baud).
+    // analogRead() only at boot, before the display starts its ADC
+    // sampling; a reset() takes the display's latest reading instead
+    auto display = ServiceLocator::getDisplayManager();
+    int buttons = booted && display ? display->getButtonAdcValue()
+                                    : analogRead(ANALOG_BUTTONS_PIN);
+    booted = true;
+    bool selectHeld = buttons > BUTTON_LEFT_VALUE + BUTTON_TOLERANCE &&
+                      buttons < BUTTON_SELECT_VALUE + BUTTON_TOLERANCE;
+
+    if (selectHeld) {
+        loadDefaults(config);
+        source = SOURCE_SKIPPED;
+    } else if (load()) {
+        source = SOURCE_STORED;
+    } else {
+        loadDefaults(config);
+        source = SOURCE_DEFAULTS;
+    }
+
+    initialized = true;
+
+    if (debugEnabled) {
+        Serial.print(F("ConfigurationManager: "));
+        Serial.println(source == SOURCE_STORED ? F("Stored settings loaded") :
+                       source == SOURCE_SKIPPED ? F("SELECT held, defaults used") :
+                       F("No stored settings, defaults used"));
+    }
+
+    return STATUS_OK;
+}
+
+int ConfigurationManager::update() {
+    return STATUS_OK;
+}
+
+int ConfigurationManager::getStatus() const {
+    return initialized ? STATUS_OK : STATUS_NOT_INITIALIZED;
+}
+
+const __FlashStringHelper* ConfigurationManager::getName() const {
+    return F("ConfigurationManager");
+}
+
+bool ConfigurationManager::validate() const {
+    return initialized && isValid(config);
+}
+
+int ConfigurationManager::reset() {
+    initialized = false;
+    return initialize();
+}
+
+size_t ConfigurationManager::getMemoryUsage() const {
+    return sizeof(*this);
+}
+
+void ConfigurationManager::setDebugEnabled(bool enabled) {
+    debugEnabled = enabled;
+}
+
+bool ConfigurationManager::isDebugEnabled() const {
+    return debugEnabled;
+}
+
+void ConfigurationManager::loadDefaults(RuntimeConfig& record) {
+    record.magic = CONFIG_MAGIC;
+    record.version = CONFIG_VERSION;
+    record.size = sizeof(RuntimeConfig);
+    record.baudRate = SERIAL_BAUD_RATE;
+    record.flowHighWatermark = LPT_FLOW_HIGH_WATERMARK;
+    record.flowLowWatermark = LPT_FLOW_LOW_WATERMARK;
+    record.ackDelayUs = HARDWARE_DELAY;
+    record.ackPulseUs = ACK_PULSE_WIDTH;
+    record.idleTimeoutMs = CAPTURE_IDLE_TIMEOUT;
+    record.flags = (CAPTURE_COMPRESSION ? CONFIG_FLAG_COMPRESSION : 0) |
+                   (LPT_FLOW_CONTROL ? CONFIG_FLAG_FLOW_CONTROL : 0);
+    record.crc = 0;
+}
+
+bool ConfigurationManager::isValid(const RuntimeConfig& record) {
+    // Watermarks are checked against this build's ring, which may be
+    // smaller than the one the record was saved from
+    return record.baudRate >= 1200 && record.baudRate <= SERIAL_MAX_BAUD_RATE &&
+           record.flowLowWatermark > 0 &&
+           record.flowLowWatermark < record.flowHighWatermark &&
+           record.flowHighWatermark <= RING_BUFFER_SIZE &&
+           record.ackDelayUs > 0 && record.ackDelayUs <= LPT_MAX_HANDSHAKE_US &&
+           record.ackPulseUs > 0 && record.ackPulseUs <= LPT_MAX_HANDSHAKE_US &&
+           record.idleTimeoutMs >= CONFIG_MIN_IDLE_TIMEOUT &&
+           record.idleTimeoutMs <= CONFIG_MAX_IDLE_TIMEOUT &&
+           (record.flags & ~(CONFIG_FLAG_COMPRESSION | CONFIG_FLAG_FLOW_CONTROL)) == 0;
+}
+
+uint32_t ConfigurationManager::computeCrc(const RuntimeConfig& record) {
+    return Crc32::compute((const uint8_t*)&record, offsetof(RuntimeConfig, crc));
+}
+
+bool ConfigurationManager::load() {
+    RuntimeConfig stored;
+    eeprom_read_block(&stored, (const void*)CONFIG_EEPROM_ADDRESS, sizeof(stored));
+
+    // Erased EEPROM reads 0xFF and fails the magic check
+    if (stored.magic != CONFIG_MAGIC || stored.version != CONFIG_VERSION ||
+        stored.size != sizeof(RuntimeConfig) || stored.crc != computeCrc(stored) ||
+        !isValid(stored)) {
+        return false;
+    }
+
+    config = stored;
+    return true;
+}
+
+int ConfigurationManager::save() {
+    config.crc = computeCrc(config);
+    eeprom_update_block(&config, (void*)CONFIG_EEPROM_ADDRESS, sizeof(config));
+
+    RuntimeConfig readback;
+    eeprom_read_block(&readback, (const void*)CONFIG_EEPROM_ADDRESS, sizeof(readback));
+    if (memcmp(&readback, &config, sizeof(config)) != 0) {
+        if (debugEnabled) {
+            Serial.println(F("ConfigurationManager: EEPROM readback mismatch"));
+        }
+        return STATUS_ERROR;
+    }
+
+    source = SOURCE_STORED;
+    return STATUS_OK;
+}
+
+const RuntimeConfig& ConfigurationManager::getConfig() const {
+    return config;
+}
+
+ConfigurationManager::Source ConfigurationManager::getSource() const {
+    return source;
+}
+
+ConfigurationManager::Key ConfigurationManager::findKey(const char* name, size_t length) {
+    for (uint8_t key = 0; key < KEY_COUNT; key++) {
+        if (equalsIgnoreCasePGM(name, length, getKeyName((Key)key))) {
+            return (Key)key;
+        }
+    }
+    return KEY_COUNT;
+}
+
+const __FlashStringHelper* ConfigurationManager::getKeyName(Key key) {
+    switch (key) {
+        case KEY_BAUD:          return F("baud");
+        case KEY_FLOW_HIGH:     return F("flowhigh");
+        case KEY_FLOW_LOW:      return F("flowlow");
+        case KEY_FLOW_CONTROL:  return F("flow");
+        case KEY_ACK_DELAY:     return F("ackdelay");
+        case KEY_ACK_PULSE:     return F("ackpulse");
+        case KEY_IDLE_TIMEOUT:  return F("idle");
+        case KEY_COMPRESSION:   return F("compress");
+        default:                return F("?");
+    }
+}
+
+uint32_t ConfigurationManager::getValue(Key key) const {
+    switch (key) {
+        case KEY_BAUD:          return config.baudRate;
+        case KEY_FLOW_HIGH:     return config.flowHighWatermark;
+        case KEY_FLOW_LOW:      return config.flowLowWatermark;
+        case KEY_FLOW_CONTROL:  return (config.flags & CONFIG_FLAG_FLOW_CONTROL) ? 1 : 0;
+        case KEY_ACK_DELAY:     return config.ackDelayUs;
+        case KEY_ACK_PULSE:     return config.ackPulseUs;
+        case KEY_IDLE_TIMEOUT:  return config.idleTimeoutMs;
+        case KEY_COMPRESSION:   return (config.flags & CONFIG_FLAG_COMPRESSION) ? 1 : 0;
+        default:                return 0;
+    }
+}
+
+bool ConfigurationManager::setValue(Key key, uint32_t value) {
+    // Narrow fields: reject values that would be truncated
+    if (key != KEY_BAUD && value > 0xFFFF) {
+        return false;
+    }
+
+    RuntimeConfig candidate = config;
+    switch (key) {
+        case KEY_BAUD:          candidate.baudRate = value; break;
+        case KEY_FLOW_HIGH:     candidate.flowHighWatermark = (uint16_t)value; break;
+        case KEY_FLOW_LOW:      candidate.flowLowWatermark = (uint16_t)value; break;
+        case KEY_ACK_DELAY:     candidate.ackDelayUs = (uint16_t)value; break;
+        case KEY_ACK_PULSE:     candidate.ackPulseUs = (uint16_t)value; break;
+        case KEY_IDLE_TIMEOUT:  candidate.idleTimeoutMs = (uint16_t)value; break;
+        case KEY_FLOW_CONTROL:
+        case KEY_COMPRESSION: {
+            uint8_t flag = key == KEY_COMPRESSION ? CONFIG_FLAG_COMPRESSION
+                                                  : CONFIG_FLAG_FLOW_CONTROL;
+            if (value > 1) {
+                return false;
+            }
+            candidate.flags = value ? (candidate.flags | flag) : (candidate.flags & ~flag);
+            break;
+        }
+        default:
+            return false;
+    }
+
+    if (!isValid(candidate)) {
+        return false;
+    }
+
+    config = candidate;
+    return true;
+}
+
+void ConfigurationManager::restoreDefaults() {
+    loadDefaults(config);
+}
+
+void ConfigurationManager::apply(CaptureSession* session) const {
+    auto parallelPort = ServiceLocator::getParallelPortManager();
+    parallelPort->setFlowWatermarks(config.flowHighWatermark, config.flowLowWatermark);
+    parallelPort->setFlowControlEnabled((config.flags & CONFIG_FLAG_FLOW_CONTROL) != 0);
+    parallelPort->setHandshakeTiming(config.ackDelayUs, config.ackPulseUs);
+
+    if (session) {
+        session->setIdleTimeout(config.idleTimeoutMs);
+        session->setCompressionEnabled((config.flags & CONFIG_FLAG_COMPRESSION) != 0);
+    }
+}
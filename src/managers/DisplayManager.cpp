@@ -1,6 +1,7 @@
 #include "DisplayManager.h"
 #include "MemoryUtils.h"
 #include "ServiceLocator.h"
+#include <avr/interrupt.h>
 
 // Custom characters for progress bar
 uint8_t progressBarChars[8][8] = {
@@ -14,20 +15,72 @@ uint8_t progressBarChars[8][8] = {
     {0x1F, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x1F, 0x00}  // Warning pattern
 };
 
-DisplayManager::DisplayManager() 
+/**
+ * Map a divider reading to the button pulling it down
+ * @param analogValue ADC value (0-1023)
+ * @return Button type
+ */
+static DisplayManager::ButtonType classifyButton(uint16_t analogValue) {
+    // Determine button based on analog value with tolerance
+    if (analogValue < BUTTON_RIGHT_VALUE + BUTTON_TOLERANCE) {
+        return DisplayManager::BUTTON_RIGHT;
+    } else if (analogValue < BUTTON_UP_VALUE + BUTTON_TOLERANCE) {
+        return DisplayManager::BUTTON_UP;
+    } else if (analogValue < BUTTON_DOWN_VALUE + BUTTON_TOLERANCE) {
+        return DisplayManager::BUTTON_DOWN;
+    } else if (analogValue < BUTTON_LEFT_VALUE + BUTTON_TOLERANCE) {
+        return DisplayManager::BUTTON_LEFT;
+    } else if (analogValue < BUTTON_SELECT_VALUE + BUTTON_TOLERANCE) {
+        return DisplayManager::BUTTON_SELECT;
+    } else {
+        return DisplayManager::BUTTON_NONE;
+    }
+}
+
+#if BUTTON_ADC_INTERRUPT
+// Written by the ADC ISR only
+static volatile uint16_t buttonAdcValue = BUTTON_NONE_VALUE;
+static volatile uint8_t sampledButton = DisplayManager::BUTTON_NONE;
+static uint8_t candidateButton = DisplayManager::BUTTON_NONE;
+static uint8_t candidateCount = 0;
+static uint8_t sampleDivider = 0;
+
+// ADC complete: one conversion per Timer0 overflow, every Nth one kept
+ISR(ADC_vect) {
+    if (++sampleDivider < BUTTON_SAMPLE_DIVIDER) {
+        return;
+    }
+    sampleDivider = 0;
+    
+    uint16_t value = ADC;
+    buttonAdcValue = value;
+    
+    // Commit only after the same button several samples in a row
+    uint8_t button = classifyButton(value);
+    if (button != candidateButton) {
+        candidateButton = button;
+        candidateCount = 1;
+    } else if (candidateCount < BUTTON_DEBOUNCE_SAMPLES) {
+        candidateCount++;
+    }
+    if (candidateCount >= BUTTON_DEBOUNCE_SAMPLES) {
+        sampledButton = button;
+    }
+}
+#endif
+
+DisplayManager::DisplayManager()
     : lcd(LCD_RESET_PIN, LCD_ENABLE_PIN, LCD_DATA4_PIN, LCD_DATA5_PIN, LCD_DATA6_PIN, LCD_DATA7_PIN),
       initialized(false), debugEnabled(false), currentState(STATE_IDLE),
       lastButton(BUTTON_NONE), currentButton(BUTTON_NONE),
-      buttonPressTime(0), buttonReleaseTime(0), buttonHeld(false),
-      displayUpdateTime(0), messageTimeout(0), messageTimedOut(false),
-      currentMenuItem(0), totalMenuItems(0),
-      scrollPosition(0), scrollUpdateTime(0), scrollEnabled(false),
-      statusUpdateTime(0), autoStatusUpdate(false), backlightEnabled(true) {
-    
-    clearBuffer(line1Buffer, sizeof(line1Buffer));
-    clearBuffer(line2Buffer, sizeof(line2Buffer));
-    clearBuffer(messageBuffer, sizeof(messageBuffer));
-    clearBuffer(menuItems, sizeof(menuItems));
+      buttonPressTime(0), buttonReleaseTime(0), buttonHeld(false), pendingPress(BUTTON_NONE),
+      messageTimeout(0), messageTimedOut(false),
+      menuItems(nullptr), currentMenuItem(0), totalMenuItems(0),
+      menuActivityTime(0), menuTimeout(0), menuSelection(-1), menuClosed(false),
+      scrollText(nullptr), scrollPosition(0), scrollUpdateTime(0), scrollInterval(300),
+      scrollLine(0), scrollEnabled(false),
+      errorBlinks(0), errorBlinkTime(0), buttonTestStep(0), buttonTestTime(0),
+      statusUpdateTime(0), statusUpdateInterval(2000), autoStatusUpdate(false), backlightEnabled(true) {
 }
 
 int DisplayManager::initialize() {
@@ -59,14 +112,17 @@ int DisplayManager::initialize() {
     // Setup custom characters for progress bar
     setupProgressBarChars();
     
-    // Clear display again after custom characters
-    clearDisplay();
+    // Buttons are sampled in the background from here on
+    startButtonSampling();
+    
+    // Resend the whole frame: the LCD content is unknown after a reset
+    frame.clear();
+    frame.invalidate();
     
     // Display startup message with proper timing
-    lcd.setCursor(0, 0);
-    lcd.print(F("MegaDeviceBridge"));
-    lcd.setCursor(0, 1);
-    lcd.print(F("Initializing... "));
+    putLinePGM(0, F("MegaDeviceBridge"));
+    putLinePGM(1, F("Initializing..."));
+    forceUpdate();
     delay(1000); // Show message for 1 second
     
     initialized = true;
@@ -87,14 +143,8 @@ int DisplayManager::update() {
     // Update button state
     updateButtonState();
     
-    // Handle message timeout
-    if (currentState == STATE_MESSAGE && messageTimeout > 0) {
-        if (currentTime >= messageTimeout) {
-            currentState = STATE_IDLE;
-            messageTimedOut = true;
-            clearDisplay();
-        }
-    }
+    // Message/menu timeouts, error blink, button test
+    updateTimers(currentTime);
     
     // Update scrolling text
     if (currentState == STATE_SCROLLING && scrollEnabled) {
@@ -103,7 +153,7 @@ int DisplayManager::update() {
     
     // Auto status update
     if (autoStatusUpdate && currentState == STATE_IDLE) {
-        if (currentTime - statusUpdateTime >= 2000) { // Update every 2 seconds
+        if (currentTime - statusUpdateTime >= statusUpdateInterval) {
             // Get system status from SystemManager
             auto systemManager = ServiceLocator::getSystemManager();
             if (systemManager) {
@@ -123,8 +173,8 @@ int DisplayManager::update() {
         }
     }
     
-    // Update display content
-    updateDisplay();
+    // Send a bounded share of the changed cells
+    frame.flush(lcd, LCD_BUS_OPS_PER_UPDATE);
     
     return STATUS_OK;
 }
@@ -153,6 +203,10 @@ int DisplayManager::reset() {
         messageTimedOut = false;
         scrollEnabled = false;
         autoStatusUpdate = false;
+        errorBlinks = 0;
+        menuClosed = false;
+        pendingPress = BUTTON_NONE;
+        initialized = false;
     }
     
     return initialize();
@@ -170,23 +224,45 @@ bool DisplayManager::isDebugEnabled() const {
     return debugEnabled;
 }
 
-DisplayManager::ButtonType DisplayManager::readButton() {
-    int analogValue = analogRead(ANALOG_BUTTONS_PIN);
+DisplayManager::ButtonType DisplayManager::readButton() const {
+#if BUTTON_ADC_INTERRUPT
+    // Single byte: no interrupt guard needed
+    return (ButtonType)sampledButton;
+#else
+    return classifyButton(analogRead(ANALOG_BUTTONS_PIN));
+#endif
+}
+
+int DisplayManager::getButtonAdcValue() const {
+#if BUTTON_ADC_INTERRUPT
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t value = buttonAdcValue;
+    SREG = oldSREG;
+    return value;
+#else
+    return analogRead(ANALOG_BUTTONS_PIN);
+#endif
+}
+
+void DisplayManager::startButtonSampling() {
+#if BUTTON_ADC_INTERRUPT
+    static_assert(ANALOG_BUTTONS_PIN - A0 < 8, "Button channel must be ADC0-ADC7");
     
-    // Determine button based on analog value with tolerance
-    if (analogValue < BUTTON_RIGHT_VALUE + BUTTON_TOLERANCE) {
-        return BUTTON_RIGHT;
-    } else if (analogValue < BUTTON_UP_VALUE + BUTTON_TOLERANCE) {
-        return BUTTON_UP;
-    } else if (analogValue < BUTTON_DOWN_VALUE + BUTTON_TOLERANCE) {
-        return BUTTON_DOWN;
-    } else if (analogValue < BUTTON_LEFT_VALUE + BUTTON_TOLERANCE) {
-        return BUTTON_LEFT;
-    } else if (analogValue < BUTTON_SELECT_VALUE + BUTTON_TOLERANCE) {
-        return BUTTON_SELECT;
-    } else {
-        return BUTTON_NONE;
-    }
+    uint8_t oldSREG = SREG;
+    cli();
+    
+    // AVcc reference, right adjusted, button channel (MUX5 clear)
+    ADMUX = _BV(REFS0) | (ANALOG_BUTTONS_PIN - A0);
+    ADCSRB = _BV(ADTS2);                  // Auto trigger: Timer0 overflow
+    DIDR0 |= _BV(ANALOG_BUTTONS_PIN - A0 + ADC0D); // No digital buffer on A0
+    
+    // 125kHz ADC clock; each conversion runs in the background
+    ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADIF) |
+             _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+    
+    SREG = oldSREG;
+#endif
 }
 
 void DisplayManager::updateButtonState() {
@@ -220,43 +296,67 @@ void DisplayManager::updateButtonState() {
 }
 
 void DisplayManager::clearDisplay() {
-    lcd.clear();
-    clearBuffer(line1Buffer, sizeof(line1Buffer));
-    clearBuffer(line2Buffer, sizeof(line2Buffer));
-    clearBuffer(messageBuffer, sizeof(messageBuffer));
+    frame.clear();
 }
 
-void DisplayManager::updateDisplay() {
-    uint32_t currentTime = millis();
+void DisplayManager::putLinePGM(uint8_t row, const __FlashStringHelper* text) {
+    char line[17];
+    line[0] = '\0';
+    if (text) {
+        safeCopyPGM(line, sizeof(line), text);
+    }
+    frame.putText(row, 0, line);
+}
+
+void DisplayManager::renderMenu() {
+    putLinePGM(0, F("Menu:"));
+    frame.putText(1, 0, "> ", 2);
+    frame.putText(1, 2, menuItems[currentMenuItem], 14);
+}
+
+void DisplayManager::closeMenu(int8_t selection) {
+    menuSelection = selection;
+    menuClosed = true;
+    currentState = STATE_IDLE;
+    clearDisplay();
+}
+
+void DisplayManager::renderButtonTest() {
+    putLinePGM(1, F("Press"));
+    char name[8];
+    safeCopyPGM(name, sizeof(name), getButtonName((ButtonType)(buttonTestStep + 1)));
+    frame.putText(1, 6, name, 10);
+}
+
+void DisplayManager::updateTimers(uint32_t currentTime) {
+    // Handle message timeout
+    if (currentState == STATE_MESSAGE && messageTimeout > 0 &&
+        (int32_t)(currentTime - messageTimeout) >= 0) {
+        currentState = STATE_IDLE;
+        messageTimedOut = true;
+        errorBlinks = 0;
+        clearDisplay();
+    }
     
-    // Throttle updates to prevent flicker
-    if (currentTime - displayUpdateTime < 100) { // 100ms minimum between updates
-        return;
+    // Menu gives up after the inactivity timeout
+    if (currentState == STATE_MENU && menuTimeout > 0 &&
+        currentTime - menuActivityTime >= menuTimeout) {
+        closeMenu(-1);
     }
     
-    switch (currentState) {
-        case STATE_IDLE:
-            // Display default content
-            break;
-            
-        case STATE_MESSAGE:
-            // Message is already displayed, just check timeout
-            break;
-            
-        case STATE_STATUS:
-            // Status display - could add blinking indicators here
-            break;
-            
-        case STATE_SCROLLING:
-            // Scrolling is handled in updateScrolling()
-            break;
-            
-        case STATE_MENU:
-            // Menu display is handled in showMenu()
-            break;
+    // Error marker in the top right corner: on/off every 200ms
+    if (errorBlinks > 0 && currentState != STATE_MESSAGE) {
+        errorBlinks = 0;
+    } else if (errorBlinks > 0 && currentTime - errorBlinkTime >= 200) {
+        errorBlinks--;
+        errorBlinkTime = currentTime;
+        frame.put(0, 15, (errorBlinks > 0 && (errorBlinks & 1) == 0) ? (char)6 : ' ');
     }
     
-    displayUpdateTime = currentTime;
+    // Button test: 5 seconds per button
+    if (currentState == STATE_BUTTON_TEST && currentTime - buttonTestTime >= 5000) {
+        displayError("Button failed", buttonTestStep + 1);
+    }
 }
 
 void DisplayManager::handleButtonPress(ButtonType button) {
@@ -269,13 +369,53 @@ void DisplayManager::handleButtonPress(ButtonType button) {
         case STATE_MESSAGE:
             // Any button press clears message
             currentState = STATE_IDLE;
+            errorBlinks = 0;
             clearDisplay();
+            pendingPress = button;
             break;
-            
+        
         case STATE_MENU:
-            // Menu navigation is handled by showMenu()
+            menuActivityTime = millis();
+            switch (button) {
+                case BUTTON_UP:
+                    if (currentMenuItem > 0) {
+                        currentMenuItem--;
+                        renderMenu();
+                    }
+                    break;
+                
+                case BUTTON_DOWN:
+                    if (currentMenuItem < totalMenuItems - 1) {
+                        currentMenuItem++;
+                        renderMenu();
+                    }
+                    break;
+                
+                case BUTTON_SELECT:
+                    closeMenu((int8_t)currentMenuItem);
+                    break;
+                
+                case BUTTON_LEFT:
+                    // Cancel menu
+                    closeMenu(-1);
+                    break;
+                
+                default:
+                    break;
+            }
             break;
-            
+        
+        case STATE_BUTTON_TEST:
+            if (button != (ButtonType)(buttonTestStep + 1)) {
+                displayError("Button failed", buttonTestStep + 1);
+            } else if (++buttonTestStep == BUTTON_SELECT) {
+                displayMessagePGM(F("Button Test"), F("PASSED"), 2000);
+            } else {
+                buttonTestTime = millis();
+                renderButtonTest();
+            }
+            break;
+        
         case STATE_IDLE:
         case STATE_STATUS:
             // Button actions in idle/status state
@@ -289,14 +429,16 @@ void DisplayManager::handleButtonPress(ButtonType button) {
                         clearDisplay();
                     }
                     break;
-                    
+                
                 default:
                     // Other buttons could trigger specific actions
                     break;
             }
+            pendingPress = button;
             break;
-            
+        
         default:
+            pendingPress = button;
             break;
     }
 }
@@ -304,24 +446,15 @@ void DisplayManager::handleButtonPress(ButtonType button) {
 void DisplayManager::updateScrolling() {
     uint32_t currentTime = millis();
     
-    if (currentTime - scrollUpdateTime >= 300) { // Scroll every 300ms
-        size_t messageLen = safeStrlen(messageBuffer, sizeof(messageBuffer));
+    if (currentTime - scrollUpdateTime >= scrollInterval) {
+        size_t messageLen = safeStrlen(scrollText, 256);
         
         if (messageLen > 16) {
-            // Extract 16 characters starting from scrollPosition
-            char displayText[17];
-            clearBuffer(displayText, sizeof(displayText));
-            
-            for (size_t i = 0; i < 16 && (scrollPosition + i) < messageLen; i++) {
-                displayText[i] = messageBuffer[scrollPosition + i];
-            }
-            
-            // Display on line 1
-            lcd.setCursor(0, 0);
-            lcd.print(displayText);
+            // 16 characters starting from scrollPosition
+            frame.putText(scrollLine, 0, scrollText + scrollPosition);
             
             scrollPosition++;
-            if (scrollPosition >= messageLen - 16) {
+            if (scrollPosition > messageLen - 16) {
                 scrollPosition = 0; // Restart scrolling
             }
         }
@@ -330,14 +463,6 @@ void DisplayManager::updateScrolling() {
     }
 }
 
-void DisplayManager::formatStatusLine(const char* statusText, char* buffer, size_t bufferSize) {
-    if (!statusText || !buffer || bufferSize == 0) {
-        return;
-    }
-    
-    truncateText(statusText, buffer, bufferSize);
-}
-
 void DisplayManager::centerText(const char* text, char* buffer, size_t bufferSize) {
     if (!text || !buffer || bufferSize < 17) {
         return;
@@ -357,34 +482,18 @@ void DisplayManager::centerText(const char* text, char* buffer, size_t bufferSiz
     safeCopy(buffer + padding, bufferSize - padding, text, textLen);
 }
 
-void DisplayManager::truncateText(const char* text, char* buffer, size_t bufferSize) {
-    if (!text || !buffer || bufferSize == 0) {
-        return;
-    }
-    
-    safeCopy(buffer, bufferSize, text, 16);
-}
-
 void DisplayManager::displayMessage(const char* line1, const char* line2, uint32_t timeoutMs) {
     if (!initialized) {
         return;
     }
     
-    clearDisplay();
-    
-    if (line1) {
-        truncateText(line1, line1Buffer, sizeof(line1Buffer));
-        lcd.setCursor(0, 0);
-        lcd.print(line1Buffer);
-    }
-    
-    if (line2) {
-        truncateText(line2, line2Buffer, sizeof(line2Buffer));
-        lcd.setCursor(0, 1);
-        lcd.print(line2Buffer);
-    }
+    // Full-width rows: only cells that differ are sent
+    frame.putText(0, 0, line1);
+    frame.putText(1, 0, line2);
     
     currentState = STATE_MESSAGE;
+    scrollEnabled = false;
+    errorBlinks = 0;
     
     if (timeoutMs > 0) {
         messageTimeout = millis() + timeoutMs;
@@ -403,28 +512,19 @@ void DisplayManager::displayMessage(const char* line1, const char* line2, uint32
     }
 }
 
-void DisplayManager::displayMessagePGM(const __FlashStringHelper* line1, 
-                                      const __FlashStringHelper* line2, 
+void DisplayManager::displayMessagePGM(const __FlashStringHelper* line1,
+                                      const __FlashStringHelper* line2,
                                       uint32_t timeoutMs) {
     if (!initialized) {
         return;
     }
     
-    clearDisplay();
-    
-    if (line1) {
-        safeCopyPGM(line1Buffer, sizeof(line1Buffer), line1);
-        lcd.setCursor(0, 0);
-        lcd.print(line1Buffer);
-    }
-    
-    if (line2) {
-        safeCopyPGM(line2Buffer, sizeof(line2Buffer), line2);
-        lcd.setCursor(0, 1);
-        lcd.print(line2Buffer);
-    }
+    putLinePGM(0, line1);
+    putLinePGM(1, line2);
     
     currentState = STATE_MESSAGE;
+    scrollEnabled = false;
+    errorBlinks = 0;
     
     if (timeoutMs > 0) {
         messageTimeout = millis() + timeoutMs;
@@ -434,19 +534,21 @@ void DisplayManager::displayMessagePGM(const __FlashStringHelper* line1,
 }
 
 void DisplayManager::displayScrollingMessage(const char* message, uint8_t line, uint32_t scrollSpeed) {
-    if (!initialized || !message) {
+    if (!initialized || !message || line > 1) {
         return;
     }
     
-    safeCopy(messageBuffer, sizeof(messageBuffer), message);
+    scrollText = message;
+    scrollLine = line;
+    scrollInterval = scrollSpeed > 0xFFFF ? 0xFFFF : (uint16_t)scrollSpeed;
     scrollPosition = 0;
     scrollUpdateTime = millis();
     scrollEnabled = true;
     currentState = STATE_SCROLLING;
     
-    // Clear the other line
-    lcd.setCursor(0, line == 0 ? 1 : 0);
-    lcd.print(F("                ")); // 16 spaces
+    // First window now, the other line blank
+    frame.putText(line, 0, message);
+    frame.putText(line == 0 ? 1 : 0, 0, nullptr);
 }
 
 void DisplayManager::displayStatus(const char* statusLine1, const char* statusLine2) {
@@ -454,19 +556,8 @@ void DisplayManager::displayStatus(const char* statusLine1, const char* statusLi
         return;
     }
     
-    clearDisplay();
-    
-    if (statusLine1) {
-        formatStatusLine(statusLine1, line1Buffer, sizeof(line1Buffer));
-        lcd.setCursor(0, 0);
-        lcd.print(line1Buffer);
-    }
-    
-    if (statusLine2) {
-        formatStatusLine(statusLine2, line2Buffer, sizeof(line2Buffer));
-        lcd.setCursor(0, 1);
-        lcd.print(line2Buffer);
-    }
+    frame.putText(0, 0, statusLine1);
+    frame.putText(1, 0, statusLine2);
     
     currentState = STATE_STATUS;
 }
@@ -476,118 +567,69 @@ void DisplayManager::clearAndIdle() {
     currentState = STATE_IDLE;
     messageTimeout = 0;
     scrollEnabled = false;
+    errorBlinks = 0;
 }
 
 void DisplayManager::setAutoStatusUpdate(bool enabled, uint32_t updateInterval) {
     autoStatusUpdate = enabled;
     if (enabled) {
+        statusUpdateInterval = updateInterval;
         statusUpdateTime = millis();
     }
 }
 
-void DisplayManager::setupMenu(const char* items[], size_t itemCount) {
-    if (!items || itemCount == 0 || itemCount > 4) {
+void DisplayManager::setupMenu(const char* const items[], size_t itemCount) {
+    if (!items || itemCount == 0 || itemCount > 127) {
         return;
     }
     
-    totalMenuItems = itemCount;
-    currentMenuItem = 0;
-    
     for (size_t i = 0; i < itemCount; i++) {
-        if (items[i]) {
-            safeCopy(menuItems[i], sizeof(menuItems[i]), items[i]);
+        if (!items[i]) {
+            return;
         }
     }
+    
+    menuItems = items;
+    totalMenuItems = itemCount;
+    currentMenuItem = 0;
 }
 
-int DisplayManager::showMenu() {
+bool DisplayManager::openMenu(uint32_t timeoutMs) {
     if (!initialized || totalMenuItems == 0) {
-        return -1;
+        return false;
     }
     
     currentState = STATE_MENU;
-    int selectedItem = -1;
-    
-    while (currentState == STATE_MENU) {
-        // Display current menu item
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print(F("Menu:"));
-        
-        lcd.setCursor(0, 1);
-        lcd.print(F("> "));
-        lcd.print(menuItems[currentMenuItem]);
-        
-        // Wait for button press
-        ButtonType button = waitForButton(10000); // 10 second timeout
-        
-        switch (button) {
-            case BUTTON_UP:
-                if (currentMenuItem > 0) {
-                    currentMenuItem--;
-                }
-                break;
-                
-            case BUTTON_DOWN:
-                if (currentMenuItem < totalMenuItems - 1) {
-                    currentMenuItem++;
-                }
-                break;
-                
-            case BUTTON_SELECT:
-                selectedItem = currentMenuItem;
-                currentState = STATE_IDLE;
-                break;
-                
-            case BUTTON_LEFT:
-                // Cancel menu
-                currentState = STATE_IDLE;
-                selectedItem = -1;
-                break;
-                
-            case BUTTON_NONE:
-                // Timeout
-                currentState = STATE_IDLE;
-                selectedItem = -1;
-                break;
-                
-            default:
-                break;
-        }
+    scrollEnabled = false;
+    menuTimeout = timeoutMs;
+    menuActivityTime = millis();
+    menuClosed = false;
+    renderMenu();
+    return true;
+}
+
+bool DisplayManager::isMenuOpen() const {
+    return currentState == STATE_MENU;
+}
+
+bool DisplayManager::pollMenu(int& selection) {
+    if (!menuClosed) {
+        return false;
     }
     
-    clearDisplay();
-    return selectedItem;
+    selection = menuSelection;
+    menuClosed = false;
+    return true;
 }
 
 DisplayManager::ButtonType DisplayManager::getCurrentButton() const {
     return currentButton;
 }
 
-DisplayManager::ButtonType DisplayManager::waitForButton(uint32_t timeoutMs) {
-    uint32_t startTime = millis();
-    
-    // Wait for button release if one is currently pressed
-    while (currentButton != BUTTON_NONE && (millis() - startTime) < timeoutMs) {
-        updateButtonState();
-        delay(10);
-    }
-    
-    // Wait for new button press
-    while (currentButton == BUTTON_NONE && (millis() - startTime) < timeoutMs) {
-        updateButtonState();
-        delay(10);
-    }
-    
-    ButtonType pressedButton = currentButton;
-    
-    // Wait for button release
-    while (currentButton != BUTTON_NONE && (millis() - startTime) < timeoutMs) {
-        updateButtonState();
-        delay(10);
-    }
-    
-    return pressedButton;
+DisplayManager::ButtonType DisplayManager::takeButtonPress() {
+    ButtonType button = pendingPress;
+    pendingPress = BUTTON_NONE;
+    return button;
 }
 
 bool DisplayManager::isButtonHeld(ButtonType button) const {
@@ -616,14 +658,15 @@ void DisplayManager::displayProgressBar(uint8_t percentage, uint8_t line, const
         return;
     }
     
-    lcd.setCursor(0, line);
+    if (percentage > 100) {
+        percentage = 100;
+    }
     
+    uint8_t col = 0;
     if (label) {
         // Display label first (truncated to fit)
-        char labelBuffer[9]; // 8 chars + null
-        safeCopy(labelBuffer, sizeof(labelBuffer), label, 8);
-        lcd.print(labelBuffer);
-        lcd.setCursor(8, line);
+        frame.putText(line, 0, label, 8);
+        col = 8;
     }
     
     // Calculate progress bar segments
@@ -633,11 +676,11 @@ void DisplayManager::displayProgressBar(uint8_t percentage, uint8_t line, const
     // Display progress bar (8 characters)
     for (uint8_t i = 0; i < 8; i++) {
         if (i < fullSegments) {
-            lcd.write((uint8_t)5); // Full character
+            frame.put(line, col + i, (char)5); // Full character
         } else if (i == fullSegments && partialSegment > 0) {
-            lcd.write((uint8_t)partialSegment); // Partial character
+            frame.put(line, col + i, (char)partialSegment); // Partial character
         } else {
-            lcd.write((uint8_t)0); // Empty character
+            frame.put(line, col + i, (char)0); // Empty character
         }
     }
 }
@@ -646,6 +689,8 @@ void DisplayManager::setupProgressBarChars() {
     for (uint8_t i = 0; i < 8; i++) {
         lcd.createChar(i, progressBarChars[i]);
     }
+    // createChar leaves the address in CGRAM
+    frame.invalidateCursor();
 }
 
 void DisplayManager::displayValue(const char* label, uint32_t value, const char* unit) {
@@ -680,8 +725,7 @@ void DisplayManager::displayTime(uint8_t hours, uint8_t minutes, uint8_t line) {
     char timeStr[9]; // "HH:MM" + spaces
     snprintf(timeStr, sizeof(timeStr), "%02d:%02d", hours, minutes);
     
-    lcd.setCursor(0, line);
-    lcd.print(timeStr);
+    frame.putText(line, 0, timeStr, 5);
 }
 
 void DisplayManager::displayError(const char* errorMsg, int errorCode) {
@@ -702,15 +746,10 @@ void DisplayManager::displayError(const char* errorMsg, int errorCode) {
     
     displayMessage(line1, line2, 5000); // 5 second timeout
     
-    // Flash error pattern
-    for (int i = 0; i < 3; i++) {
-        lcd.setCursor(15, 0);
-        lcd.write((uint8_t)6); // Error pattern character
-        delay(200);
-        lcd.setCursor(15, 0);
-        lcd.print(" ");
-        delay(200);
-    }
+    // Flash error pattern three times from update()
+    frame.put(0, 15, (char)6);
+    errorBlinks = 6;
+    errorBlinkTime = millis();
 }
 
 const __FlashStringHelper* DisplayManager::getButtonName(ButtonType button) const {
@@ -725,33 +764,22 @@ const __FlashStringHelper* DisplayManager::getButtonName(ButtonType button) cons
     }
 }
 
-bool DisplayManager::testButtons() {
+void DisplayManager::startButtonTest() {
     if (!initialized) {
-        return false;
-    }
-    
-    displayMessagePGM(F("Button Test"), F("Press any button"), 0);
-    
-    for (int i = 0; i < 5; i++) { // Test each button
-        ButtonType expectedButton = (ButtonType)(i + 1);
-        
-        char testMsg[17];
-        snprintf(testMsg, sizeof(testMsg), "Press %s", 
-                (char*)getButtonName(expectedButton));
-        displayMessage("Button Test", testMsg, 0);
-        
-        ButtonType pressedButton = waitForButton(5000);
-        
-        if (pressedButton != expectedButton) {
-            displayError("Button failed", i + 1);
-            return false;
-        }
-        
-        delay(500);
+        return;
     }
     
-    displayMessagePGM(F("Button Test"), F("PASSED"), 2000);
-    return true;
+    currentState = STATE_BUTTON_TEST;
+    scrollEnabled = false;
+    errorBlinks = 0;
+    buttonTestStep = 0;
+    buttonTestTime = millis();
+    putLinePGM(0, F("Button Test"));
+    renderButtonTest();
+}
+
+bool DisplayManager::isButtonTestRunning() const {
+    return currentState == STATE_BUTTON_TEST;
 }
 
 DisplayManager::DisplayState DisplayManager::getCurrentState() const {
@@ -759,6 +787,14 @@ DisplayManager::DisplayState DisplayManager::getCurrentState() const {
 }
 
 void DisplayManager::forceUpdate() {
-    displayUpdateTime = 0; // Force immediate update
-    updateDisplay();
-}
\ No newline at end of file
+    // Whole frame in one go: at most two operations per cell
+    frame.flush(lcd, 0xFF);
+}
+
+void DisplayManager::redraw() {
+    frame.invalidate();
+}
+
+uint8_t DisplayManager::getPendingCells() const {
+    return frame.getDirtyCount();
+}
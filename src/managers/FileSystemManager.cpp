@@ -1,6 +1,9 @@
 #include "FileSystemManager.h"
 #include "MemoryUtils.h"
 #include "ServiceLocator.h"
+#include "DisplayManager.h"
+#include "Scheduler.h"
+#include "TimeManager.h"
 
 // Include storage plugins (will be created)
 #include "SDCardStoragePlugin.h"
@@ -10,11 +13,19 @@
 FileSystemManager::FileSystemManager() 
     : sdCardPlugin(nullptr), eepromPlugin(nullptr), serialPlugin(nullptr),
       currentStorage(nullptr), currentStorageType(IStoragePlugin::STORAGE_AUTO),
-      initialized(false), debugEnabled(false),
+      writeStorage(nullptr), readStorage(nullptr), initialized(false), debugEnabled(false),
+      nameCounter(0),
+      transferPhase(TRANSFER_IDLE), transferSource(nullptr), transferDest(nullptr),
+      transferIsMigration(false), transferSize(0), transferOffset(0),
+      transferWritten(0), transferDecode(false), packedPos(0), packedLength(0),
+      transferShown(0xFF),
+      tieredEnabled(STORAGE_TIERED != 0), migrationTarget(IStoragePlugin::STORAGE_SD_CARD),
+      migrationFailedAt(0), filesMigrated(0), migrationFailures(0),
       totalFilesWritten(0), totalBytesWritten(0), 
       totalFilesRead(0), totalBytesRead(0) {
     clearBuffer(transferBuffer, TRANSFER_BUFFER_SIZE);
-    clearBuffer(filenameBuffer, MAX_FILENAME_LENGTH);
+    clearBuffer(transferTarget, MAX_FILENAME_LENGTH);
+    clearBuffer(transferName, MAX_FILENAME_LENGTH);
 }
 
 int FileSystemManager::initialize() {
@@ -80,11 +91,24 @@ int FileSystemManager::update() {
         return STATUS_NOT_INITIALIZED;
     }
     
-    // Check current storage status
-    if (currentStorage && !currentStorage->isReady()) {
-        // Try to auto-detect alternative storage
-        IStoragePlugin::StorageType newType = autoDetectStorage();
-        if (newType != currentStorageType) {
+    // Background maintenance (e.g. flash pre-erase, SD bring-up) on every backend
+    if (sdCardPlugin) {
+        sdCardPlugin->update();
+    }
+    if (eepromPlugin) {
+        eepromPlugin->update();
+    }
+    if (serialPlugin) {
+        serialPlugin->update();
+    }
+    
+    // Follow the best ready backend: falls back when the current one goes
+    // away and promotes the SD card once it has mounted. An open write
+    // stays on the backend it started on.
+    IStoragePlugin::StorageType newType = autoDetectStorage();
+    if (newType != currentStorageType) {
+        IStoragePlugin* newStorage = getPluginByType(newType);
+        if (newStorage && newStorage->isReady()) {
             if (debugEnabled) {
                 Serial.println(F("FileSystemManager: Storage changed, switching"));
             }
@@ -92,6 +116,9 @@ int FileSystemManager::update() {
         }
     }
     
+    stepTransfer();
+    retrieval.update(*this);
+    
     return STATUS_OK;
 }
 
@@ -119,6 +146,11 @@ bool FileSystemManager::validate() const {
 
 int FileSystemManager::reset() {
     if (initialized) {
+        // Commit any open streaming write
+        abortTransfer(false);
+        closeWrite();
+        closeRead();
+        
         // Reset statistics
         totalFilesWritten = 0;
         totalBytesWritten = 0;
@@ -127,7 +159,7 @@ int FileSystemManager::reset() {
         
         // Clear buffers
         clearBuffer(transferBuffer, TRANSFER_BUFFER_SIZE);
-        clearBuffer(filenameBuffer, MAX_FILENAME_LENGTH);
+        clearBuffer(transferTarget, MAX_FILENAME_LENGTH);
         
         initialized = false;
     }
@@ -266,21 +298,110 @@ bool FileSystemManager::isValidFilename(const char* filename) const {
 
 bool FileSystemManager::generateUniqueFilename(const char* prefix, const char* extension, 
                                              char* dest, size_t destSize) {
-    if (!prefix || !extension || !dest || destSize < 16) {
+    if (!prefix || !extension || !dest || destSize < MAX_FILENAME_LENGTH) {
         return false;
     }
     
-    // Get TimeManager for timestamp
+    // Timestamp from the cached clock (no I2C); 8.3 leaves no room for the prefix
+    static uint32_t lastStampSeconds = 0;
     auto timeManager = ServiceLocator::getTimeManager();
-    if (!timeManager) {
-        // Fallback to simple counter
-        static uint16_t counter = 1;
-        return snprintf(dest, destSize, "%s_%04d%s", prefix, counter++, extension) > 0;
+    char stamp[DATETIME_STAMP_LENGTH + 1];
+    uint32_t seconds = timeManager->now();
+    if (timeManager->isTimeValid() && seconds != lastStampSeconds) {
+        lastStampSeconds = seconds;
+        DateTime::fromSeconds(seconds).formatStamp(stamp);
+        int len = snprintf(dest, destSize, "%s%s", stamp, extension);
+        
+        // DDHHMMSS repeats every month: an older file of that name stays
+        if (len > 0 && (size_t)len < destSize && !isNameTaken(dest)) {
+            return true;
+        }
+    }
+    
+    // No valid time, a second file within the same second or a clash
+    return generateCounterFilename(prefix, extension, dest, destSize);
+}
+
+bool FileSystemManager::generateCounterFilename(const char* prefix, const char* extension,
+                                                char* dest, size_t destSize) {
+    if (nameCounter == 0) {
+        IStoragePlugin* storages[3] = {
+            getCaptureStorage(), currentStorage,
+            tieredEnabled ? getPluginByType(migrationTarget) : nullptr
+        };
+        uint16_t highest = 0;
+        for (uint8_t i = 0; i < 3; i++) {
+            if (storages[i] && storages[i]->isReady()) {
+                uint16_t found = findHighestCounter(storages[i], prefix);
+                if (found > highest) {
+                    highest = found;
+                }
+            }
+        }
+        nameCounter = highest + 1;
+    }
+    
+    // Four digits keep the name 8.3; past 9999 the free gaps are reused
+    for (uint16_t tries = 0; tries < 9999; tries++) {
+        if (nameCounter > 9999) {
+            nameCounter = 1;
+        }
+        int len = snprintf(dest, destSize, "%s_%04u%s", prefix, nameCounter++, extension);
+        if (len <= 0 || (size_t)len >= destSize) {
+            return false;
+        }
+        if (!isNameTaken(dest)) {
+            return true;
+        }
     }
     
-    // Generate timestamp-based filename (will implement when TimeManager is ready)
-    static uint16_t counter = 1;
-    return snprintf(dest, destSize, "%s_%04d%s", prefix, counter++, extension) > 0;
+    return false;
+}
+
+bool FileSystemManager::isNameTaken(const char* filename) {
+    IStoragePlugin* storages[3] = {
+        getCaptureStorage(), currentStorage,
+        tieredEnabled ? getPluginByType(migrationTarget) : nullptr
+    };
+    for (uint8_t i = 0; i < 3; i++) {
+        if (storages[i] && storages[i]->isReady() && storages[i]->fileExists(filename)) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+uint16_t FileSystemManager::findHighestCounter(const IStoragePlugin* storage, const char* prefix) {
+    size_t prefixLength = safeStrlen(prefix, MAX_FILENAME_LENGTH);
+    char names[4][MAX_FILENAME_LENGTH];
+    uint16_t highest = 0;
+    size_t first = 0;
+    size_t count;
+    
+    do {
+        count = storage->listFiles(names, 4, first);
+        for (size_t i = 0; i < count; i++) {
+            // prefix, '_', then four digits
+            const char* name = names[i];
+            if (!startsWith(name, safeStrlen(name, MAX_FILENAME_LENGTH), prefix) ||
+                name[prefixLength] != '_') {
+                continue;
+            }
+            uint16_t number = 0;
+            uint8_t digits = 0;
+            for (const char* ch = name + prefixLength + 1; digits < 4 && *ch >= '0' && *ch <= '9'; ch++) {
+                number = number * 10 + (*ch - '0');
+                digits++;
+            }
+            if (digits == 4 && number > highest) {
+                highest = number;
+            }
+        }
+        first += count;
+    } while (count == 4);
+    
+    return highest;
 }
 
 size_t FileSystemManager::writeFile(const char* filename, const uint8_t* data, size_t size) {
@@ -302,6 +423,7 @@ size_t FileSystemManager::writeFile(const char* filename, const uint8_t* data, s
         return 0;
     }
     
+    releaseTransfer(currentStorage);
     size_t bytesWritten = currentStorage->writeFile(filename, data, size);
     
     if (bytesWritten > 0) {
@@ -342,6 +464,111 @@ size_t FileSystemManager::writeFileAuto(const char* prefix, const char* extensio
     return writeFile(filename, data, size);
 }
 
+bool FileSystemManager::openWrite(const char* filename, uint32_t sizeHint) {
+    IStoragePlugin* storage = getCaptureStorage();
+    if (!initialized || !storage || !filename || writeStorage) {
+        return false;
+    }
+    
+    if (!isValidFilename(filename)) {
+        if (debugEnabled) {
+            Serial.println(F("FileSystemManager: Invalid filename"));
+        }
+        return false;
+    }
+    
+    if (!storage->isReady()) {
+        if (debugEnabled) {
+            Serial.println(F("FileSystemManager: Storage not ready"));
+        }
+        return false;
+    }
+    
+    releaseTransfer(storage);
+    
+    bool opened = storage->openWrite(filename, sizeHint);
+    
+    // Full flash: write straight to the current storage instead
+    if (!opened && storage != currentStorage && currentStorage && currentStorage->isReady()) {
+        storage = currentStorage;
+        releaseTransfer(storage);
+        opened = storage->openWrite(filename, sizeHint);
+    }
+    
+    if (!opened) {
+        if (debugEnabled) {
+            Serial.print(F("FileSystemManager: Failed to open "));
+            Serial.println(filename);
+        }
+        return false;
+    }
+    
+    writeStorage = storage;
+    
+    if (debugEnabled) {
+        Serial.print(F("FileSystemManager: Opened "));
+        Serial.println(filename);
+    }
+    
+    return true;
+}
+
+bool FileSystemManager::openWriteAuto(const char* prefix, const char* extension,
+                                     char* generatedName, size_t nameBufferSize,
+                                     uint32_t sizeHint) {
+    if (!prefix || !extension) {
+        return false;
+    }
+    
+    char filename[MAX_FILENAME_LENGTH];
+    if (!generateUniqueFilename(prefix, extension, filename, sizeof(filename))) {
+        return false;
+    }
+    
+    // Copy generated name to output buffer if provided
+    if (generatedName && nameBufferSize > 0) {
+        safeCopy(generatedName, nameBufferSize, filename);
+    }
+    
+    return openWrite(filename, sizeHint);
+}
+
+size_t FileSystemManager::append(const uint8_t* data, size_t size) {
+    if (!writeStorage || !data || size == 0) {
+        return 0;
+    }
+    
+    size_t bytesWritten = writeStorage->append(data, size);
+    totalBytesWritten += bytesWritten;
+    
+    return bytesWritten;
+}
+
+bool FileSystemManager::closeWrite() {
+    if (!writeStorage) {
+        return false;
+    }
+    
+    bool result = writeStorage->closeWrite();
+    writeStorage = nullptr;
+    
+    if (result) {
+        totalFilesWritten++;
+    } else if (debugEnabled) {
+        Serial.println(F("FileSystemManager: Failed to commit file"));
+    }
+    
+    return result;
+}
+
+bool FileSystemManager::isWriteOpen() const {
+    return writeStorage != nullptr;
+}
+
+bool FileSystemManager::isWriteBusy() const {
+    return writeStorage && writeStorage->isBusy();
+}
+
 size_t FileSystemManager::readFile(const char* filename, uint8_t* data, size_t maxSize) {
     if (!initialized || !currentStorage || !filename || !data || maxSize == 0) {
         return 0;
@@ -361,7 +588,16 @@ size_t FileSystemManager::readFile(const char* filename, uint8_t* data, size_t m
         return 0;
     }
     
-    size_t bytesRead = currentStorage->readFile(filename, data, maxSize);
+    // Packed captures are expanded unless the read handle is taken
+    uint8_t header[PACKBITS_HEADER_SIZE];
+    size_t bytesRead;
+    if (readStorage != currentStorage &&
+        currentStorage->readFile(filename, header, sizeof(header)) == sizeof(header) &&
+        PackBits::isPacked(header, sizeof(header))) {
+        bytesRead = readPacked(filename, data, maxSize);
+    } else {
+        bytesRead = currentStorage->readFile(filename, data, maxSize);
+    }
     
     if (bytesRead > 0) {
         totalFilesRead++;
@@ -381,9 +617,106 @@ size_t FileSystemManager::readFile(const char* filename, uint8_t* data, size_t m
     return bytesRead;
 }
 
+size_t FileSystemManager::readPacked(const char* filename, uint8_t* data, size_t maxSize) {
+    releaseTransfer(currentStorage);
+    
+    uint8_t packed[TRANSFER_PACKED_SIZE];
+    if (!currentStorage->openRead(filename) ||
+        currentStorage->readChunk(packed, PACKBITS_HEADER_SIZE) != PACKBITS_HEADER_SIZE) {
+        currentStorage->closeRead();
+        return 0;
+    }
+    
+    PackBitsDecoder unpacker;
+    size_t produced = 0;
+    size_t length = 0;
+    size_t pos = 0;
+    
+    while (produced < maxSize) {
+        if (pos == length && !unpacker.hasPendingOutput()) {
+            length = currentStorage->readChunk(packed, sizeof(packed));
+            pos = 0;
+            if (length == 0) {
+                break;
+            }
+        }
+        
+        size_t used;
+        produced += unpacker.decode(packed + pos, length - pos, used,
+                                    data + produced, maxSize - produced);
+        pos += used;
+    }
+    
+    currentStorage->closeRead();
+    return produced;
+}
+
+bool FileSystemManager::openRead(const char* filename) {
+    if (!initialized || !currentStorage || !filename || readStorage) {
+        return false;
+    }
+    
+    if (!isValidFilename(filename)) {
+        if (debugEnabled) {
+            Serial.println(F("FileSystemManager: Invalid filename"));
+        }
+        return false;
+    }
+    
+    if (!currentStorage->isReady()) {
+        if (debugEnabled) {
+            Serial.println(F("FileSystemManager: Storage not ready"));
+        }
+        return false;
+    }
+    
+    releaseTransfer(currentStorage);
+    
+    if (!currentStorage->openRead(filename)) {
+        if (debugEnabled) {
+            Serial.print(F("FileSystemManager: Failed to open "));
+            Serial.println(filename);
+        }
+        return false;
+    }
+    
+    readStorage = currentStorage;
+    totalFilesRead++;
+    
+    return true;
+}
+
+size_t FileSystemManager::readChunk(uint8_t* data, size_t maxSize) {
+    if (!readStorage || !data || maxSize == 0) {
+        return 0;
+    }
+    
+    size_t bytesRead = readStorage->readChunk(data, maxSize);
+    totalBytesRead += bytesRead;
+    
+    return bytesRead;
+}
+
+bool FileSystemManager::seekRead(uint32_t offset) {
+    return readStorage && readStorage->seekRead(offset);
+}
+
+void FileSystemManager::closeRead() {
+    if (!readStorage) {
+        return;
+    }
+    
+    readStorage->closeRead();
+    readStorage = nullptr;
+}
+
+bool FileSystemManager::isReadOpen() const {
+    return readStorage != nullptr;
+}
+
 bool FileSystemManager::copyFile(const char* filename, IStoragePlugin::StorageType sourceType,
                                 IStoragePlugin::StorageType destType) {
-    if (!filename || sourceType == destType) {
+    if (!initialized || !filename || sourceType == destType || isCopying()) {
         return false;
     }
     
@@ -395,6 +728,17 @@ bool FileSystemManager::copyFile(const char* filename, IStoragePlugin::StorageTy
         return false;
     }
     
+    // A capture keeps its handles; migration simply starts over later
+    if (writeStorage == sourcePlugin || writeStorage == destPlugin) {
+        return false;
+    }
+    
+    // A retrieval owns the link until the host has the whole file
+    if (destPlugin == serialPlugin && retrieval.isActive()) {
+        return false;
+    }
+    abortTransfer(false);
+    
     // Check if source file exists
     if (!sourcePlugin->fileExists(filename)) {
         if (debugEnabled) {
@@ -403,48 +747,499 @@ bool FileSystemManager::copyFile(const char* filename, IStoragePlugin::StorageTy
         return false;
     }
     
-    uint32_t fileSize = sourcePlugin->getFileSize(filename);
-    if (fileSize == 0 || fileSize > TRANSFER_BUFFER_SIZE) {
+    if (!startTransfer(filename, sourcePlugin, destPlugin, false, filename)) {
         if (debugEnabled) {
-            Serial.println(F("FileSystemManager: File too large for transfer"));
+            Serial.println(F("FileSystemManager: Failed to open copy"));
         }
         return false;
     }
     
-    // Read from source
-    size_t bytesRead = sourcePlugin->readFile(filename, transferBuffer, fileSize);
-    if (bytesRead != fileSize) {
-        if (debugEnabled) {
-            Serial.println(F("FileSystemManager: Failed to read source file"));
+    auto display = ServiceLocator::getDisplayManager();
+    if (display) {
+        display->displayMessage("Copying", filename, 0);
+    }
+    
+    return true;
+}
+
+void FileSystemManager::cancelCopy() {
+    if (isCopying()) {
+        abortTransfer(false);
+        Serial.println(F("Copy cancelled"));
+        
+        auto display = ServiceLocator::getDisplayManager();
+        if (display) {
+            display->displayMessage("Copy", "Cancelled", 2000);
         }
+    }
+}
+
+bool FileSystemManager::isCopying() const {
+    return transferPhase != TRANSFER_IDLE && !transferIsMigration;
+}
+
+uint8_t FileSystemManager::getCopyProgress() const {
+    if (!isCopying()) {
+        return 0;
+    }
+    
+    return transferPercent();
+}
+
+IStoragePlugin* FileSystemManager::getCaptureStorage() const {
+    if (tieredEnabled && eepromPlugin && eepromPlugin->isReady()) {
+        return eepromPlugin;
+    }
+    
+    return currentStorage;
+}
+
+bool FileSystemManager::startTransfer(const char* filename, IStoragePlugin* source,
+                                      IStoragePlugin* dest, bool migration, const char* target) {
+    safeCopy(transferName, sizeof(transferName), filename);
+    safeCopy(transferTarget, sizeof(transferTarget), target);
+    transferSize = source->getFileSize(transferName);
+    
+    if (!source->openRead(transferName)) {
         return false;
     }
     
-    // Write to destination
-    size_t bytesWritten = destPlugin->writeFile(filename, transferBuffer, bytesRead);
-    if (bytesWritten != bytesRead) {
-        if (debugEnabled) {
-            Serial.println(F("FileSystemManager: Failed to write destination file"));
+    // SD copies are stored unpacked so the card reads on a PC; flash and
+    // serial offload pass packed files through as they are
+    transferDecode = false;
+    if (dest->getType() == IStoragePlugin::STORAGE_SD_CARD && transferSize >= PACKBITS_HEADER_SIZE) {
+        if (source->readChunk(packedBuffer, PACKBITS_HEADER_SIZE) != PACKBITS_HEADER_SIZE) {
+            source->closeRead();
+            return false;
+        }
+        transferDecode = PackBits::isPacked(packedBuffer, PACKBITS_HEADER_SIZE);
+        
+        // Not packed: start over so the peeked bytes are copied too
+        if (!transferDecode) {
+            source->closeRead();
+            if (!source->openRead(transferName)) {
+                return false;
+            }
+        }
+    }
+    
+    // No size hint: checking SD free space can scan the whole FAT, and a
+    // full card shows up as a failed append anyway
+    if (!dest->openWrite(transferTarget, 0)) {
+        source->closeRead();
+        return false;
+    }
+    
+    transferSource = source;
+    transferDest = dest;
+    transferIsMigration = migration;
+    transferPhase = TRANSFER_COPY;
+    transferOffset = transferDecode ? PACKBITS_HEADER_SIZE : 0;
+    transferWritten = 0;
+    packedPos = 0;
+    packedLength = 0;
+    decoder.reset();
+    sourceSum.reset();
+    verifySum.reset();
+    transferShown = 0xFF;
+    
+    return true;
+}
+
+void FileSystemManager::stepTransfer() {
+    // Nothing moves while a capture is open, so the slow tier never adds
+    // latency to a capture; migration also yields to foreground reads
+    if (writeStorage) {
+        return;
+    }
+    
+    if (transferPhase == TRANSFER_IDLE) {
+        if (!tieredEnabled || readStorage || !startMigration()) {
+            return;
+        }
+    } else if (transferIsMigration && readStorage) {
+        return;
+    }
+    
+    if (!transferSource->isReady() || !transferDest->isReady()) {
+        abortTransfer(true);
+        return;
+    }
+    
+    // Move chunks until the time budget for this call is spent, or the
+    // capture ring needs draining (at least one chunk per call)
+    uint32_t start = micros();
+    do {
+        if (isPhaseComplete()) {
+            finishTransfer();
+            return;
+        }
+        
+        // A destination still taking the last chunk (serial TX ring full,
+        // flash program pending) is left for the next call
+        if (transferPhase == TRANSFER_COPY && transferDest->isBusy()) {
+            break;
+        }
+        
+        if (!moveChunk()) {
+            abortTransfer(true);
+            return;
+        }
+    } while (micros() - start < TRANSFER_STEP_US && !Scheduler::isUrgentPending());
+    
+    showTransferProgress();
+}
+
+bool FileSystemManager::isPhaseComplete() const {
+    if (transferPhase == TRANSFER_VERIFY) {
+        return transferOffset >= transferWritten;
+    }
+    
+    return transferOffset >= transferSize &&
+           (!transferDecode || (packedPos == packedLength && !decoder.hasPendingOutput()));
+}
+
+bool FileSystemManager::moveChunk() {
+    if (transferPhase == TRANSFER_VERIFY) {
+        size_t chunk = min(transferWritten - transferOffset, (uint32_t)TRANSFER_BUFFER_SIZE);
+        if (transferDest->readChunk(transferBuffer, chunk) != chunk) {
+            return false;
+        }
+        verifySum.update(transferBuffer, chunk);
+        transferOffset += chunk;
+        return true;
+    }
+    
+    size_t produced;
+    
+    if (transferDecode) {
+        if (packedPos == packedLength && !decoder.hasPendingOutput()) {
+            size_t chunk = min(transferSize - transferOffset, (uint32_t)TRANSFER_PACKED_SIZE);
+            if (transferSource->readChunk(packedBuffer, chunk) != chunk) {
+                return false;
+            }
+            transferOffset += chunk;
+            packedLength = chunk;
+            packedPos = 0;
+        }
+        
+        size_t used;
+        produced = decoder.decode(packedBuffer + packedPos, packedLength - packedPos, used,
+                                  transferBuffer, TRANSFER_BUFFER_SIZE);
+        packedPos += used;
+    } else {
+        produced = min(transferSize - transferOffset, (uint32_t)TRANSFER_BUFFER_SIZE);
+        if (transferSource->readChunk(transferBuffer, produced) != produced) {
+            return false;
         }
+        transferOffset += produced;
+    }
+    
+    if (produced > 0 && transferDest->append(transferBuffer, produced) != produced) {
         return false;
     }
+    sourceSum.update(transferBuffer, produced);
+    transferWritten += produced;
+    
+    return true;
+}
+
+void FileSystemManager::finishTransfer() {
+    if (transferPhase == TRANSFER_COPY) {
+        transferSource->closeRead();
+        if (!transferDest->closeWrite()) {
+            abortTransfer(true);
+            return;
+        }
+        
+        // Read the copy back where the target can; a serial stream cannot be
+        if (transferDest->getType() != IStoragePlugin::STORAGE_SERIAL) {
+            if (transferDest->getFileSize(transferTarget) != transferWritten ||
+                !transferDest->openRead(transferTarget)) {
+                abortTransfer(true);
+                return;
+            }
+            transferPhase = TRANSFER_VERIFY;
+            transferOffset = 0;
+            return;
+        }
+        verifySum = sourceSum;
+    } else {
+        transferDest->closeRead();
+    }
+    
+    if (verifySum.get() != sourceSum.get()) {
+        if (debugEnabled) {
+            Serial.println(F("FileSystemManager: Copy verify failed"));
+        }
+        abortTransfer(true);
+        return;
+    }
+    
+    IStoragePlugin* source = transferSource;
+    transferPhase = TRANSFER_IDLE;
+    transferSource = nullptr;
+    transferDest = nullptr;
+    
+    if (!transferIsMigration) {
+        Serial.print(F("Copied "));
+        Serial.print(transferName);
+        Serial.print(F(" ("));
+        Serial.print(transferWritten);
+        Serial.println(F(" bytes)"));
+        
+        auto display = ServiceLocator::getDisplayManager();
+        if (display) {
+            display->displayMessage("Copy done", transferName, 2000);
+        }
+        return;
+    }
+    
+    migrationFailedAt = 0;
+    
+    if (!source->deleteFile(transferName)) {
+        // Target holds the file; the flash copy is retried (under a free name)
+        migrationFailedAt = millis();
+        migrationFailures++;
+        return;
+    }
+    
+    filesMigrated++;
     
     if (debugEnabled) {
-        Serial.print(F("FileSystemManager: Copied "));
-        Serial.print(filename);
+        Serial.print(F("FileSystemManager: Migrated "));
+        Serial.print(transferName);
         Serial.print(F(" ("));
-        Serial.print(bytesWritten);
+        Serial.print(transferSize);
         Serial.println(F(" bytes)"));
     }
+}
+
+void FileSystemManager::abortTransfer(bool failed) {
+    if (transferPhase == TRANSFER_IDLE) {
+        return;
+    }
+    
+    if (transferPhase == TRANSFER_COPY) {
+        transferSource->closeRead();
+        transferDest->closeWrite();
+    } else {
+        transferDest->closeRead();
+    }
+    
+    // Leave no partial copy behind; the source is untouched
+    if (transferDest->getType() != IStoragePlugin::STORAGE_SERIAL) {
+        transferDest->deleteFile(transferTarget);
+    }
+    
+    transferPhase = TRANSFER_IDLE;
+    transferSource = nullptr;
+    transferDest = nullptr;
+    
+    if (!failed) {
+        return;
+    }
+    
+    if (transferIsMigration) {
+        migrationFailedAt = millis();
+        migrationFailures++;
+        
+        if (debugEnabled) {
+            Serial.print(F("FileSystemManager: Migration failed: "));
+            Serial.println(transferName);
+        }
+    } else {
+        Serial.print(F("Copy failed: "));
+        Serial.println(transferName);
+        
+        auto display = ServiceLocator::getDisplayManager();
+        if (display) {
+            display->displayError("Copy err");
+        }
+    }
+}
+
+void FileSystemManager::releaseTransfer(const IStoragePlugin* plugin) {
+    if (transferPhase == TRANSFER_IDLE || !plugin ||
+        (plugin != transferSource && plugin != transferDest)) {
+        return;
+    }
+    
+    // Migration starts over later; a foreground copy is lost
+    abortTransfer(!transferIsMigration);
+}
+
+uint8_t FileSystemManager::transferPercent() const {
+    uint32_t total = transferPhase == TRANSFER_VERIFY ? transferWritten : transferSize;
+    if (total == 0) {
+        return 100;
+    }
+    
+    uint32_t percent = total >= 100 ? transferOffset / (total / 100)
+                                    : transferOffset * 100 / total;
+    if (percent > 100) {
+        percent = 100;
+    }
+    
+    // A copy that is read back counts the copy as the first half
+    if (transferDest && transferDest->getType() == IStoragePlugin::STORAGE_SERIAL) {
+        return (uint8_t)percent;
+    }
+    return (uint8_t)(transferPhase == TRANSFER_VERIFY ? 50 + percent / 2 : percent / 2);
+}
+
+void FileSystemManager::showTransferProgress() {
+    if (transferIsMigration) {
+        return;
+    }
+    
+    uint8_t percent = transferPercent();
+    if (percent == transferShown) {
+        return;
+    }
+    transferShown = percent;
+    
+    auto display = ServiceLocator::getDisplayManager();
+    if (display) {
+        display->displayProgressBar(percent, 1, transferPhase == TRANSFER_VERIFY ? "Verify" : "Copy");
+    }
+}
+
+bool FileSystemManager::startMigration() {
+    if (migrationFailedAt != 0 && millis() - migrationFailedAt < MIGRATE_RETRY_MS) {
+        return false;
+    }
+    
+    if (!eepromPlugin || !eepromPlugin->isReady()) {
+        return false;
+    }
+    
+    IStoragePlugin* dest = getPluginByType(migrationTarget);
+    if (!dest || dest == eepromPlugin || !dest->isReady()) {
+        return false;
+    }
+    
+    // Lowest directory slot first; the file being captured is not listed
+    // until it is committed
+    char names[1][MAX_FILENAME_LENGTH];
+    if (eepromPlugin->listFiles(names, 1, 0) == 0) {
+        return false;
+    }
+    
+    // Never replace a file already on the target (an older capture of the
+    // same name, or one from another card): copy under a free name instead
+    char target[MAX_FILENAME_LENGTH];
+    safeCopy(target, sizeof(target), names[0]);
+    if (dest->fileExists(target)) {
+        const char* extension = strrchr(names[0], '.');
+        if (!generateCounterFilename(CAPTURE_FILE_PREFIX, extension ? extension : "",
+                                     target, sizeof(target))) {
+            migrationFailedAt = millis();
+            migrationFailures++;
+            return false;
+        }
+    }
+    
+    if (!startTransfer(names[0], eepromPlugin, dest, true, target)) {
+        migrationFailedAt = millis();
+        migrationFailures++;
+        return false;
+    }
+    
+    if (debugEnabled) {
+        Serial.print(F("FileSystemManager: Migrating "));
+        Serial.print(transferName);
+        if (strcmp(transferName, transferTarget) != 0) {
+            Serial.print(F(" as "));
+            Serial.print(transferTarget);
+        }
+        Serial.println();
+    }
     
     return true;
 }
 
+void FileSystemManager::setTieredStorage(bool enabled) {
+    if (!enabled && transferIsMigration) {
+        abortTransfer(false);
+    }
+    tieredEnabled = enabled;
+}
+
+bool FileSystemManager::isTieredStorage() const {
+    return tieredEnabled;
+}
+
+bool FileSystemManager::setMigrationTarget(IStoragePlugin::StorageType type) {
+    if (type != IStoragePlugin::STORAGE_SD_CARD && type != IStoragePlugin::STORAGE_SERIAL) {
+        return false;
+    }
+    
+    if (type != migrationTarget) {
+        if (transferIsMigration) {
+            abortTransfer(false);
+        }
+        migrationTarget = type;
+    }
+    return true;
+}
+
+IStoragePlugin::StorageType FileSystemManager::getMigrationTarget() const {
+    return migrationTarget;
+}
+
+bool FileSystemManager::isMigrating() const {
+    return transferPhase != TRANSFER_IDLE && transferIsMigration;
+}
+
+void FileSystemManager::getMigrationStatistics(uint32_t& migrated, uint32_t& failures) const {
+    migrated = filesMigrated;
+    failures = migrationFailures;
+}
+
+bool FileSystemManager::setSerialBinary(bool enabled) {
+    return serialPlugin && serialPlugin->setBinaryMode(enabled);
+}
+
+bool FileSystemManager::isSerialBinary() const {
+    return serialPlugin && serialPlugin->isBinaryMode();
+}
+
+bool FileSystemManager::isSerialTransferring() const {
+    return retrieval.isActive() || (serialPlugin && serialPlugin->isTransferInProgress());
+}
+
+bool FileSystemManager::startRetrieval(const char* filename, uint32_t offset) {
+    if (!initialized || !currentStorage || currentStorage == serialPlugin) {
+        return false;
+    }
+    
+    // One sender on the link at a time
+    if (serialPlugin && serialPlugin->isTransferInProgress()) {
+        return false;
+    }
+    
+    return retrieval.start(*this, filename, offset);
+}
+
+bool FileSystemManager::acknowledgeRetrieval(uint16_t sequence) {
+    return retrieval.acknowledge(*this, sequence);
+}
+
+bool FileSystemManager::resendRetrieval(uint16_t sequence) {
+    return retrieval.resendFrom(*this, sequence);
+}
+
+const SerialRetrieval& FileSystemManager::getRetrieval() const {
+    return retrieval;
+}
+
 bool FileSystemManager::deleteFile(const char* filename) {
     if (!initialized || !currentStorage || !filename) {
         return false;
     }
     
+    releaseTransfer(currentStorage);
     bool result = currentStorage->deleteFile(filename);
     
     if (result && debugEnabled) {
@@ -471,12 +1266,13 @@ uint32_t FileSystemManager::getFileSize(const char* filename) const {
     return currentStorage->getFileSize(filename);
 }
 
-size_t FileSystemManager::listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles) const {
+size_t FileSystemManager::listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles,
+                                    size_t first) const {
     if (!initialized || !currentStorage || !filenames || maxFiles == 0) {
         return 0;
     }
     
-    return currentStorage->listFiles(filenames, maxFiles);
+    return currentStorage->listFiles(filenames, maxFiles, first);
 }
 
 bool FileSystemManager::getStorageSpace(uint32_t& available, uint32_t& total) const {
@@ -504,6 +1300,7 @@ bool FileSystemManager::formatStorage() {
         return false;
     }
     
+    releaseTransfer(currentStorage);
     bool result = currentStorage->format();
     
     if (result && debugEnabled) {
@@ -591,4 +1388,14 @@ bool FileSystemManager::validateAllStorages() const {
 
 IStoragePlugin* FileSystemManager::getPlugin(IStoragePlugin::StorageType type) {
     return getPluginByType(type);
-}
\ No newline at end of file
+}
+
+#if CAPTURE_SPILL
+EEPROMStoragePlugin* FileSystemManager::getSpillStorage() {
+    if (!eepromPlugin || writeStorage == eepromPlugin || !eepromPlugin->spillAvailable()) {
+        return nullptr;
+    }
+    
+    return eepromPlugin;
+}
+#endif
\ No newline at end of file
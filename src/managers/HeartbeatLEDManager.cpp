@@ -0,0 +1,218 @@
+#include "HeartbeatLEDManager.h"
+#include "ServiceLocator.h"
+#include "ParallelPortManager.h"
+#include "FileSystemManager.h"
+
+static_assert(SCHEDULER_LED_MS == LedPatternPlayer::UNIT_MS,
+              "LED patterns are timed in LED task periods");
+static_assert(HEARTBEAT_INTERVAL / LedPatternPlayer::UNIT_MS <= 0x7F,
+              "Heartbeat half period must fit one pattern step");
+
+#define LED_DOT     2           // 100ms
+#define LED_DASH    6           // 300ms
+#define LED_GAP     2           // Between marks
+#define LED_LETTER  6           // Between letters
+#define LED_WORD    14          // After the message
+
+static const uint8_t sosPattern[] PROGMEM = {
+    LED_ON | LED_DOT,  LED_OFF | LED_GAP,
+    LED_ON | LED_DOT,  LED_OFF | LED_GAP,
+    LED_ON | LED_DOT,  LED_OFF | LED_LETTER,
+    LED_ON | LED_DASH, LED_OFF | LED_GAP,
+    LED_ON | LED_DASH, LED_OFF | LED_GAP,
+    LED_ON | LED_DASH, LED_OFF | LED_LETTER,
+    LED_ON | LED_DOT,  LED_OFF | LED_GAP,
+    LED_ON | LED_DOT,  LED_OFF | LED_GAP,
+    LED_ON | LED_DOT,  LED_OFF | LED_WORD,
+    0
+};
+
+static const uint8_t heartbeatPattern[] PROGMEM = {
+    LED_ON | (HEARTBEAT_INTERVAL / LedPatternPlayer::UNIT_MS),
+    LED_OFF | (HEARTBEAT_INTERVAL / LedPatternPlayer::UNIT_MS),
+    0
+};
+
+// One second of 10Hz flicker, restarted by each new overflow
+static const uint8_t overflowPattern[] PROGMEM = {
+    LED_ON | 1, LED_OFF | 1, LED_ON | 1, LED_OFF | 1, LED_ON | 1, LED_OFF | 1,
+    LED_ON | 1, LED_OFF | 1, LED_ON | 1, LED_OFF | 1, LED_ON | 1, LED_OFF | 1,
+    LED_ON | 1, LED_OFF | 1, LED_ON | 1, LED_OFF | 1, LED_ON | 1, LED_OFF | 1,
+    LED_ON | 1, LED_OFF | 1,
+    0
+};
+
+static const uint8_t solidPattern[] PROGMEM = {
+    LED_ON | 0x7F,
+    0
+};
+
+static const uint8_t writingPattern[] PROGMEM = {
+    LED_ON | 3, LED_OFF | 3,
+    0
+};
+
+// LED index to pin
+static const uint8_t ledPins[] = {
+    HEARTBEAT_LED_PIN, LPT_ACTIVITY_LED_PIN, WRITE_ACTIVITY_LED_PIN
+};
+#define LED_COUNT (sizeof(ledPins) / sizeof(ledPins[0]))
+
+HeartbeatLEDManager::HeartbeatLEDManager()
+    : initialized(false), debugEnabled(false),
+      ledLevels(0), ledLevelsValid(false), lastOverflowCount(0) {
+}
+
+int HeartbeatLEDManager::initialize() {
+    if (initialized) {
+        return STATUS_OK;
+    }
+    
+    for (uint8_t i = 0; i < LED_COUNT; i++) {
+        pinMode(ledPins[i], OUTPUT);
+        digitalWrite(ledPins[i], LOW);
+    }
+    ledLevels = 0;
+    ledLevelsValid = true;
+    
+    // Overflows from before the LEDs came up are not news
+    lastOverflowCount = ServiceLocator::getParallelPortManager()->getOverflowCount();
+    
+    startPattern(LAYER_HEARTBEAT);
+    initialized = true;
+    
+    return STATUS_OK;
+}
+
+int HeartbeatLEDManager::update() {
+    if (!initialized) {
+        return STATUS_NOT_INITIALIZED;
+    }
+    
+    uint32_t now = millis();
+    
+    // Layers that follow system state
+    auto parallelPort = ServiceLocator::getParallelPortManager();
+    uint32_t overflows = parallelPort->getOverflowCount();
+    if (overflows != lastOverflowCount) {
+        lastOverflowCount = overflows;
+        layers[LAYER_OVERFLOW].start(overflowPattern, false, now);
+    }
+    holdLayer(LAYER_CAPTURE, parallelPort->getAvailableBytes() > 0, now);
+    holdLayer(LAYER_WRITING, ServiceLocator::getFileSystemManager()->isWriteOpen(), now);
+    
+    // Highest active layer wins each LED
+    uint8_t claimed = 0;
+    uint8_t levels = 0;
+    for (uint8_t i = 0; i < LAYER_COUNT; i++) {
+        bool on = layers[i].update(now);
+        uint8_t bit = 1 << getLayerLed((Layer)i);
+        if (layers[i].isActive() && !(claimed & bit)) {
+            claimed |= bit;
+            if (on) {
+                levels |= bit;
+            }
+        }
+    }
+    
+    // Pins change only on a new level
+    uint8_t changed = ledLevelsValid ? (levels ^ ledLevels) : 0xFF;
+    for (uint8_t i = 0; i < LED_COUNT; i++) {
+        if (changed & (1 << i)) {
+            digitalWrite(ledPins[i], (levels & (1 << i)) ? HIGH : LOW);
+        }
+    }
+    ledLevels = levels;
+    ledLevelsValid = true;
+    
+    return STATUS_OK;
+}
+
+int HeartbeatLEDManager::getStatus() const {
+    return initialized ? STATUS_OK : STATUS_NOT_INITIALIZED;
+}
+
+const __FlashStringHelper* HeartbeatLEDManager::getName() const {
+    return F("HeartbeatLEDManager");
+}
+
+bool HeartbeatLEDManager::validate() const {
+    return initialized;
+}
+
+int HeartbeatLEDManager::reset() {
+    for (uint8_t i = 0; i < LAYER_COUNT; i++) {
+        layers[i].stop();
+    }
+    initialized = false;
+    return initialize();
+}
+
+size_t HeartbeatLEDManager::getMemoryUsage() const {
+    return sizeof(*this);
+}
+
+void HeartbeatLEDManager::setDebugEnabled(bool enabled) {
+    debugEnabled = enabled;
+}
+
+bool HeartbeatLEDManager::isDebugEnabled() const {
+    return debugEnabled;
+}
+
+void HeartbeatLEDManager::startPattern(Layer layer) {
+    if (layer >= LAYER_COUNT) {
+        return;
+    }
+    layers[layer].start(getLayerPattern(layer), isLayerLooping(layer), millis());
+}
+
+void HeartbeatLEDManager::stopPattern(Layer layer) {
+    if (layer < LAYER_COUNT) {
+        layers[layer].stop();
+    }
+}
+
+bool HeartbeatLEDManager::isPatternActive(Layer layer) const {
+    return layer < LAYER_COUNT && layers[layer].isActive();
+}
+
+void HeartbeatLEDManager::triggerSOSPattern() {
+    startPattern(LAYER_SOS);
+    
+    if (debugEnabled) {
+        Serial.println(F("HeartbeatLEDManager: SOS pattern started"));
+    }
+}
+
+void HeartbeatLEDManager::holdLayer(Layer layer, bool active, uint32_t now) {
+    if (active && !layers[layer].isActive()) {
+        layers[layer].start(getLayerPattern(layer), isLayerLooping(layer), now);
+    } else if (!active && layers[layer].isActive()) {
+        layers[layer].stop();
+    }
+}
+
+const uint8_t* HeartbeatLEDManager::getLayerPattern(Layer layer) {
+    switch (layer) {
+        case LAYER_SOS:         return sosPattern;
+        case LAYER_HEARTBEAT:   return heartbeatPattern;
+        case LAYER_OVERFLOW:    return overflowPattern;
+        case LAYER_CAPTURE:     return solidPattern;
+        case LAYER_WRITING:     return writingPattern;
+        default:                return nullptr;
+    }
+}
+
+uint8_t HeartbeatLEDManager::getLayerLed(Layer layer) {
+    switch (layer) {
+        case LAYER_OVERFLOW:
+        case LAYER_CAPTURE:     return 1;
+        case LAYER_WRITING:     return 2;
+        default:                return 0;
+    }
+}
+
+bool HeartbeatLEDManager::isLayerLooping(Layer layer) {
+    return layer != LAYER_SOS && layer != LAYER_OVERFLOW;
+}
@@ -1,15 +1,84 @@
 #include "ParallelPortManager.h"
 #include "MemoryUtils.h"
 #include "ServiceLocator.h"
+#include "LptPinMap.h"
+#include <avr/interrupt.h>
+
+static_assert(LPT_FLOW_LOW_WATERMARK < LPT_FLOW_HIGH_WATERMARK &&
+              LPT_FLOW_HIGH_WATERMARK <= RING_BUFFER_SIZE,
+              "LPT flow control watermarks must satisfy low < high <= RING_BUFFER_SIZE");
+
+#if XMEM_CAPTURE_BUFFER
+/**
+ * Enable the external memory interface before any constructor runs
+ * Runs from .init3 like the stack painting; nothing outside internal
+ * SRAM is touched until this has run.
+ */
+void enableExternalMemory() __attribute__((naked, used, section(".init3")));
+void enableExternalMemory() {
+    XMCRB = 0;                                  // All of PORTC is address, no bus keeper
+    XMCRA = _BV(SRE) | (XMEM_WAIT_STATES << SRW10);
+}
+#endif
 
 // Global pointer for ISR access
 static ParallelPortManager* g_parallelPortManager = nullptr;
 
+// Read 8-bit parallel data
+static inline __attribute__((always_inline)) uint8_t sampleDataBus() {
+#if LPT_DIRECT_PORT_IO
+    // One PINx read per port used by D0-D7
+    return LptPinMap::readDataBus();
+#else
+    uint8_t data = 0;
+    data |= (digitalRead(LPT_DATA0_PIN) ? 0x01 : 0x00);
+    data |= (digitalRead(LPT_DATA1_PIN) ? 0x02 : 0x00);
+    data |= (digitalRead(LPT_DATA2_PIN) ? 0x04 : 0x00);
+    data |= (digitalRead(LPT_DATA3_PIN) ? 0x08 : 0x00);
+    data |= (digitalRead(LPT_DATA4_PIN) ? 0x10 : 0x00);
+    data |= (digitalRead(LPT_DATA5_PIN) ? 0x20 : 0x00);
+    data |= (digitalRead(LPT_DATA6_PIN) ? 0x40 : 0x00);
+    data |= (digitalRead(LPT_DATA7_PIN) ? 0x80 : 0x00);
+    return data;
+#endif
+}
+
+#if LPT_IEEE1284_NEGOTIATION
+// Read a host control line (true = HIGH)
+template <uint8_t Pin>
+static inline __attribute__((always_inline)) bool readLine() {
+#if LPT_DIRECT_PORT_IO
+    return LptPinMap::read<Pin>();
+#else
+    return digitalRead(Pin) == HIGH;
+#endif
+}
+#endif
+
 ParallelPortManager::ParallelPortManager() 
     : initialized(false), captureEnabled(false), bytesReceived(0), 
-      overflowCount(0), lastInterruptTime(0), debugEnabled(false),
-      busyAsserted(false), errorState(false), totalInterrupts(0),
-      maxISRTime(0), avgISRTime(0) {
+      overflowCount(0), lastInterruptTime(0), lastStrobeStamp(0), debugEnabled(false),
+      busyAsserted(false), errorState(false),
+      flowControlEnabled(LPT_FLOW_CONTROL != 0),
+      flowHighWatermark(LPT_FLOW_HIGH_WATERMARK), flowLowWatermark(LPT_FLOW_LOW_WATERMARK),
+      droppedBytes(0),
+      stallCount(0), stallStartTime(0), stallTimeTotal(0), maxStallTime(0),
+      totalInterrupts(0),
+      maxISRTime(0), isrTimeTotal(0), isrTimeSamples(0),
+#if LPT_ISR_HISTOGRAM
+      lastStrobeTick(0), strobeHistogramPrimed(false),
+#endif
+      ackDelayUs(HARDWARE_DELAY),
+      ackPulseUs(ACK_PULSE_WIDTH),
+      ackDelayTicks(HARDWARE_DELAY * LPT_TIMER_TICKS_PER_US),
+      ackPulseTicks(ACK_PULSE_WIDTH * LPT_TIMER_TICKS_PER_US),
+      handshakePhase(HANDSHAKE_IDLE)
+#if LPT_IEEE1284_NEGOTIATION
+      , transferMode(MODE_COMPATIBILITY), negotiationState(NEG_IDLE),
+      extensibilityByte(0), extensibilityLatched(false), lastSelectIn(false),
+      negotiationStartTime(0), negotiationCount(0), ecpSessions(0)
+#endif
+{
     g_parallelPortManager = this;
 }
 
@@ -35,8 +104,31 @@ int ParallelPortManager::initialize() {
     bytesReceived = 0;
     overflowCount = 0;
     totalInterrupts = 0;
-    maxISRTime = 0;
-    avgISRTime = 0;
+    resetTimingStats();
+    droppedBytes = 0;
+    stallCount = 0;
+    stallTimeTotal = 0;
+    maxStallTime = 0;
+    busyAsserted = false;
+    
+#if LPT_TIMER_HANDSHAKE
+    // Timer3 time base for ACK/BUSY generation
+    configureHandshakeTimer();
+#endif
+    
+#if LPT_IEEE1284_NEGOTIATION
+    // Start in compatibility mode; negotiation is edge-triggered on 1284Active
+    transferMode = MODE_COMPATIBILITY;
+    negotiationState = NEG_IDLE;
+    lastSelectIn = readLine<LPT_SELECT_IN_PIN>();
+#endif
+    
+#if LPT_ISR_HISTOGRAM
+    // Timer1 free-running at F_CPU/8 as the histogram time base
+    TCCR1A = 0;
+    TCCR1B = _BV(CS11);
+    TIMSK1 = 0;
+#endif
     
     // Attach interrupt handler
     attachInterrupt(LPT_STROBE_INTERRUPT, parallelPortISR, FALLING);
@@ -66,8 +158,13 @@ int ParallelPortManager::update() {
         ringBuffer.clearOverflow();
     }
     
-    // Update LED indicators
-    digitalWrite(LPT_ACTIVITY_LED_PIN, ringBuffer.available() > 0 ? HIGH : LOW);
+    // Release BUSY once the consumer has drained below the low watermark
+    checkFlowControlRelease();
+    
+#if LPT_IEEE1284_NEGOTIATION
+    // Answer IEEE-1284 negotiation/termination requests
+    updateNegotiation();
+#endif
     
     return STATUS_OK;
 }
@@ -103,6 +200,13 @@ int ParallelPortManager::reset() {
         // Detach interrupt
         detachInterrupt(LPT_STROBE_INTERRUPT);
         
+#if LPT_TIMER_HANDSHAKE
+        // Abort any handshake in progress
+        TIMSK3 &= ~_BV(OCIE3A);
+        handshakePhase = HANDSHAKE_IDLE;
+        digitalWrite(LPT_ACKNOWLEDGE_PIN, HIGH);
+#endif
+        
         // Clear buffer
         ringBuffer.clear();
         
@@ -110,8 +214,7 @@ int ParallelPortManager::reset() {
         bytesReceived = 0;
         overflowCount = 0;
         totalInterrupts = 0;
-        maxISRTime = 0;
-        avgISRTime = 0;
+        resetTimingStats();
         
         // Reset state
         captureEnabled = false;
@@ -165,14 +268,68 @@ void ParallelPortManager::configurePins() {
     digitalWrite(LPT_ACTIVITY_LED_PIN, LOW);
 }
 
+void ParallelPortManager::configureHandshakeTimer() {
+    uint8_t oldSREG = SREG;
+    cli();
+    
+    // Normal mode, free running at F_CPU/8 (0.5μs per tick at 16MHz)
+    TCCR3A = 0;
+    TCCR3B = _BV(CS31);
+    TIMSK3 &= ~_BV(OCIE3A);
+    TIFR3 = _BV(OCF3A);
+    handshakePhase = HANDSHAKE_IDLE;
+    
+    SREG = oldSREG;
+}
+
 void ParallelPortManager::assertFlowControl() {
+    // BUSY is already high for the current handshake; keep it there
+#if LPT_DIRECT_PORT_IO
+    LptPinMap::setHigh<LPT_BUSY_PIN>();
+#else
     digitalWrite(LPT_BUSY_PIN, HIGH);
+#endif
     busyAsserted = true;
+    stallCount++;
+    stallStartTime = millis();
 }
 
 void ParallelPortManager::releaseFlowControl() {
-    digitalWrite(LPT_BUSY_PIN, LOW);
+    uint8_t oldSREG = SREG;
+    cli();
+    
     busyAsserted = false;
+    
+    // A handshake still in progress releases BUSY from the timer ISR;
+    // in ECP mode the /Strobe rising edge releases it
+    bool releaseNow = (handshakePhase == HANDSHAKE_IDLE);
+#if LPT_IEEE1284_NEGOTIATION
+    if (transferMode == MODE_ECP_FORWARD && !readLine<LPT_STROBE_PIN>()) {
+        releaseNow = false;
+    }
+#endif
+    if (releaseNow) {
+#if LPT_DIRECT_PORT_IO
+        LptPinMap::setLow<LPT_BUSY_PIN>();
+#else
+        digitalWrite(LPT_BUSY_PIN, LOW);
+#endif
+    }
+    
+    uint32_t stalled = millis() - stallStartTime;
+    SREG = oldSREG;
+    
+    stallTimeTotal += stalled;
+    if (stalled > maxStallTime) {
+        maxStallTime = stalled;
+    }
+}
+
+void ParallelPortManager::checkFlowControlRelease() {
+    if (busyAsserted &&
+        (!flowControlEnabled || ringBuffer.available() <= flowLowWatermark)) {
+        releaseFlowControl();
+    }
 }
 
 void ParallelPortManager::updateTimingStats(uint16_t executionTime) {
@@ -180,10 +337,29 @@ void ParallelPortManager::updateTimingStats(uint16_t executionTime) {
         maxISRTime = executionTime;
     }
     
-    // Update running average (simple moving average)
-    avgISRTime = (avgISRTime + executionTime) / 2;
+    // Exact mean over the measurement window
+    isrTimeTotal += executionTime;
+    isrTimeSamples++;
 }
 
+#if LPT_ISR_HISTOGRAM
+void ParallelPortManager::recordTimingHistograms(uint16_t startTick, uint32_t nowMs) {
+    isrHistogram.record(TCNT1 - startTick);
+    
+    if (strobeHistogramPrimed) {
+        // Timer1 wraps every 32.8ms; longer gaps only fit the overflow bucket
+        if (nowMs - lastInterruptTime > LPT_HIST_WRAP_MS) {
+            strobeHistogram.recordOverflow();
+        } else {
+            strobeHistogram.record(startTick - lastStrobeTick);
+        }
+    }
+    
+    lastStrobeTick = startTick;
+    strobeHistogramPrimed = true;
+}
+#endif
+
 void ParallelPortManager::setCaptureEnabled(bool enabled) {
     captureEnabled = enabled;
     
@@ -206,7 +382,23 @@ size_t ParallelPortManager::readData(uint8_t* dest, size_t maxBytes) {
         return 0;
     }
     
-    return ringBuffer.readBytes(dest, maxBytes);
+    size_t bytesRead = ringBuffer.readBytes(dest, maxBytes);
+    checkFlowControlRelease();
+    return bytesRead;
+}
+
+size_t ParallelPortManager::peekContiguous(const uint8_t*& ptr) const {
+    if (!initialized) {
+        return 0;
+    }
+    
+    return ringBuffer.peekContiguous(ptr);
+}
+
+size_t ParallelPortManager::consume(size_t numBytes) {
+    size_t released = ringBuffer.consume(numBytes);
+    checkFlowControlRelease();
+    return released;
 }
 
 bool ParallelPortManager::peekData(uint8_t& data) const {
@@ -215,6 +407,7 @@ bool ParallelPortManager::peekData(uint8_t& data) const {
 
 void ParallelPortManager::clearBuffer() {
     ringBuffer.clear();
+    checkFlowControlRelease();
     
     if (debugEnabled) {
         Serial.println(F("ParallelPortManager: Buffer cleared"));
@@ -241,12 +434,331 @@ uint32_t ParallelPortManager::getOverflowCount() const {
     return overflowCount;
 }
 
+uint32_t ParallelPortManager::getDroppedBytes() const {
+    return droppedBytes;
+}
+
+uint32_t ParallelPortManager::getStallCount() const {
+    return stallCount;
+}
+
+uint32_t ParallelPortManager::getStallTime() const {
+    uint32_t total = stallTimeTotal;
+    if (busyAsserted) {
+        total += millis() - stallStartTime;
+    }
+    return total;
+}
+
+uint16_t ParallelPortManager::getStrobeAge() const {
+    // Stamp and timer together, so the ISR cannot land in between
+    uint8_t oldSREG = SREG;
+    cli();
+#if LPT_TIMER_HANDSHAKE
+    uint16_t age = (uint16_t)(TCNT3 - lastStrobeStamp) / LPT_TIMER_TICKS_PER_US;
+#else
+    uint16_t age = (uint16_t)micros() - lastStrobeStamp;
+#endif
+    SREG = oldSREG;
+    return age;
+}
+
+uint32_t ParallelPortManager::getLastStrobeTime() const {
+    uint8_t oldSREG = SREG;
+    cli();
+    uint32_t time = lastInterruptTime;
+    SREG = oldSREG;
+    return time;
+}
+
+uint32_t ParallelPortManager::getMaxStallTime() const {
+    return maxStallTime;
+}
+
+void ParallelPortManager::setFlowControlEnabled(bool enabled) {
+    flowControlEnabled = enabled;
+    checkFlowControlRelease();
+    
+    if (debugEnabled) {
+        Serial.print(F("ParallelPortManager: Flow control "));
+        Serial.println(enabled ? F("enabled") : F("disabled"));
+    }
+}
+
+bool ParallelPortManager::isFlowControlEnabled() const {
+    return flowControlEnabled;
+}
+
+bool ParallelPortManager::setFlowWatermarks(uint16_t high, uint16_t low) {
+    if (low == 0 || low >= high || high > RING_BUFFER_SIZE) {
+        return false;
+    }
+    
+    // The strobe ISR compares against the high watermark
+    uint8_t oldSREG = SREG;
+    cli();
+    flowHighWatermark = high;
+    flowLowWatermark = low;
+    SREG = oldSREG;
+    
+    checkFlowControlRelease();
+    return true;
+}
+
+void ParallelPortManager::getFlowWatermarks(uint16_t& high, uint16_t& low) const {
+    high = flowHighWatermark;
+    low = flowLowWatermark;
+}
+
+bool ParallelPortManager::isFlowControlAsserted() const {
+    return busyAsserted;
+}
+
+bool ParallelPortManager::isInitAsserted() const {
+    return digitalRead(LPT_INITIALIZE_PIN) == LOW;
+}
+
+ParallelPortManager::TransferMode ParallelPortManager::getTransferMode() const {
+#if LPT_IEEE1284_NEGOTIATION
+    return (TransferMode)transferMode;
+#else
+    return MODE_COMPATIBILITY;
+#endif
+}
+
+void ParallelPortManager::getNegotiationStats(uint32_t& attempts, uint32_t& ecp) const {
+#if LPT_IEEE1284_NEGOTIATION
+    attempts = negotiationCount;
+    ecp = ecpSessions;
+#else
+    attempts = 0;
+    ecp = 0;
+#endif
+}
+
+#if LPT_IEEE1284_NEGOTIATION
+void ParallelPortManager::restoreCompatibilitySignals() {
+    digitalWrite(LPT_PAPER_OUT_PIN, LOW);   // Paper out forced low
+    digitalWrite(LPT_SELECT_PIN, HIGH);     // Select forced high
+    digitalWrite(LPT_ERROR_PIN, HIGH);      // No error
+    digitalWrite(LPT_BUSY_PIN, busyAsserted ? HIGH : LOW);
+    digitalWrite(LPT_ACKNOWLEDGE_PIN, HIGH);
+}
+
+void ParallelPortManager::beginTermination() {
+    // Back to single-edge strobe handling; ignore strobes until done
+    attachInterrupt(LPT_STROBE_INTERRUPT, parallelPortISR, FALLING);
+    transferMode = MODE_NEGOTIATING;
+    
+    // Event 24: nAck low
+    digitalWrite(LPT_ACKNOWLEDGE_PIN, LOW);
+    negotiationState = NEG_TERMINATE;
+    negotiationStartTime = millis();
+}
+
+void ParallelPortManager::updateNegotiation() {
+    bool selectIn = readLine<LPT_SELECT_IN_PIN>();  // 1284Active
+    bool autoFeed = readLine<LPT_AUTO_FEED_PIN>();  // HostBusy / HostAck
+    bool selectInRose = selectIn && !lastSelectIn;
+    lastSelectIn = selectIn;
+    
+    switch (negotiationState) {
+    case NEG_IDLE: {
+        // Event 1: host raises 1284Active with HostBusy low. Edge-triggered
+        // so an unwired (pulled-up) /SelectIn never starts a negotiation.
+        if (!selectInRose || autoFeed) {
+            break;
+        }
+        
+        uint8_t oldSREG = SREG;
+        cli();
+        bool idle = (handshakePhase == HANDSHAKE_IDLE);
+        if (idle) {
+            transferMode = MODE_NEGOTIATING;
+            extensibilityLatched = false;
+        }
+        SREG = oldSREG;
+        
+        if (!idle) {
+            break;
+        }
+        
+        // Event 2: nAck low, PError high, nFault high, Select high
+        digitalWrite(LPT_ACKNOWLEDGE_PIN, LOW);
+        digitalWrite(LPT_PAPER_OUT_PIN, HIGH);
+        digitalWrite(LPT_ERROR_PIN, HIGH);
+        digitalWrite(LPT_SELECT_PIN, HIGH);
+        
+        negotiationState = NEG_AWAIT_REQUEST;
+        negotiationStartTime = millis();
+        negotiationCount++;
+        break;
+    }
+    
+    case NEG_AWAIT_REQUEST:
+        if (!selectIn || millis() - negotiationStartTime > LPT_1284_TIMEOUT_MS) {
+            // Host gave up (or we answered too late): plain SPP again
+            restoreCompatibilitySignals();
+            transferMode = MODE_COMPATIBILITY;
+            negotiationState = NEG_IDLE;
+            if (debugEnabled) {
+                Serial.println(F("ParallelPortManager: 1284 negotiation aborted"));
+            }
+            break;
+        }
+        
+        // Event 4: host released /Strobe and HostBusy after event 3
+        if (extensibilityLatched && readLine<LPT_STROBE_PIN>() && autoFeed) {
+            uint8_t request = extensibilityByte;
+            bool accept = (request == LPT_1284_REQUEST_ECP);
+            
+            // Event 5: XFlag answers the request. Its sense is inverted for
+            // the nibble-mode request (0x00), which is declined as well.
+            digitalWrite(LPT_SELECT_PIN, (accept || request == 0x00) ? HIGH : LOW);
+            digitalWrite(LPT_PAPER_OUT_PIN, LOW);
+            digitalWrite(LPT_BUSY_PIN, LOW);
+            
+            // Event 6: nAck high, status lines valid
+            digitalWrite(LPT_ACKNOWLEDGE_PIN, HIGH);
+            
+            negotiationState = accept ? NEG_ECP_SETUP : NEG_DECLINED;
+            negotiationStartTime = millis();
+            
+            if (debugEnabled) {
+                Serial.print(F("ParallelPortManager: 1284 request 0x"));
+                Serial.print(request, HEX);
+                Serial.println(accept ? F(" accepted (ECP)") : F(" declined"));
+            }
+        }
+        break;
+    
+    case NEG_ECP_SETUP:
+        if (!selectIn) {
+            beginTermination();
+            break;
+        }
+        
+        // Event 30: HostAck low -> event 31: PError high, forward idle
+        if (!autoFeed) {
+            digitalWrite(LPT_PAPER_OUT_PIN, HIGH);
+            attachInterrupt(LPT_STROBE_INTERRUPT, parallelPortISR, CHANGE);
+            transferMode = MODE_ECP_FORWARD;
+            negotiationState = NEG_ECP_ACTIVE;
+            ecpSessions++;
+        }
+        break;
+    
+    case NEG_ECP_ACTIVE:
+    case NEG_DECLINED:
+        // Event 22: host dropped 1284Active
+        if (!selectIn) {
+            beginTermination();
+        }
+        break;
+    
+    case NEG_TERMINATE:
+        // Event 25: HostBusy low -> events 26/27: compatibility signals, nAck high
+        if (!autoFeed || millis() - negotiationStartTime > LPT_1284_TIMEOUT_MS) {
+            restoreCompatibilitySignals();
+            transferMode = MODE_COMPATIBILITY;
+            negotiationState = NEG_IDLE;
+            if (debugEnabled) {
+                Serial.println(F("ParallelPortManager: Back to compatibility mode"));
+            }
+        }
+        break;
+    }
+}
+
+void ParallelPortManager::handleNegotiatedStrobe() {
+    bool strobeLow = !readLine<LPT_STROBE_PIN>();
+    
+    if (transferMode == MODE_NEGOTIATING) {
+        // Event 3: host strobes the extensibility request byte
+        if (strobeLow) {
+            extensibilityByte = sampleDataBus();
+            extensibilityLatched = true;
+        }
+        return;
+    }
+    
+    if (!strobeLow) {
+        // Event 37: HostClk high -> PeriphAck low unless flow control holds it
+        if (!busyAsserted) {
+#if LPT_DIRECT_PORT_IO
+            LptPinMap::setLow<LPT_BUSY_PIN>();
+#else
+            digitalWrite(LPT_BUSY_PIN, LOW);
+#endif
+        }
+        return;
+    }
+    
+    // Event 35: HostClk low -> event 36: PeriphAck (BUSY) high
+#if LPT_DIRECT_PORT_IO
+    LptPinMap::setHigh<LPT_BUSY_PIN>();
+#else
+    digitalWrite(LPT_BUSY_PIN, HIGH);
+#endif
+    
+    uint8_t data = sampleDataBus();
+    
+    // HostAck low marks a command byte (channel address), not data
+    if (readLine<LPT_AUTO_FEED_PIN>()) {
+        if (ringBuffer.write(data)) {
+            bytesReceived++;
+        } else {
+            droppedBytes++;
+        }
+        
+        if (flowControlEnabled && !busyAsserted &&
+            ringBuffer.available() >= flowHighWatermark) {
+            assertFlowControl();
+        }
+    }
+    
+    totalInterrupts++;
+    lastInterruptTime = millis();
+}
+#endif
+
 void ParallelPortManager::getInterruptStats(uint32_t& totalInts, uint16_t& maxTime, uint16_t& avgTime) const {
+    // Snapshot multi-byte counters the ISR updates
+    uint8_t oldSREG = SREG;
+    cli();
     totalInts = totalInterrupts;
     maxTime = maxISRTime;
-    avgTime = avgISRTime;
+    uint32_t total = isrTimeTotal;
+    uint32_t samples = isrTimeSamples;
+    SREG = oldSREG;
+    
+    avgTime = samples ? (uint16_t)(total / samples) : 0;
 }
 
+void ParallelPortManager::resetTimingStats() {
+    uint8_t oldSREG = SREG;
+    cli();
+    maxISRTime = 0;
+    isrTimeTotal = 0;
+    isrTimeSamples = 0;
+#if LPT_ISR_HISTOGRAM
+    isrHistogram.reset();
+    strobeHistogram.reset();
+    strobeHistogramPrimed = false;
+#endif
+    SREG = oldSREG;
+}
+
+#if LPT_ISR_HISTOGRAM
+void ParallelPortManager::getTimingHistograms(TimingHistogram& isrTime, TimingHistogram& strobeGap) const {
+    uint8_t oldSREG = SREG;
+    cli();
+    isrTime = isrHistogram;
+    strobeGap = strobeHistogram;
+    SREG = oldSREG;
+}
+#endif
+
 uint32_t ParallelPortManager::testInterrupt(uint32_t durationMs) {
     uint32_t startCount = totalInterrupts;
     uint32_t startTime = millis();
@@ -308,56 +820,202 @@ bool ParallelPortManager::testProtocolSignals() {
 }
 
 void ParallelPortManager::getPortStatus(bool& busy, bool& ack, bool& error) const {
-    busy = busyAsserted;
+    busy = digitalRead(LPT_BUSY_PIN) == HIGH;
     ack = !digitalRead(LPT_ACKNOWLEDGE_PIN); // Active LOW
     error = !digitalRead(LPT_ERROR_PIN);     // Active LOW
 }
 
 void ParallelPortManager::handleInterrupt() {
     // CRITICAL: This function must execute in ≤2μs for IEEE-1284 compliance
-    uint32_t startTime = micros();
-    
     if (!captureEnabled || !initialized) {
         return;
     }
     
+#if LPT_IEEE1284_NEGOTIATION
+    if (transferMode != MODE_COMPATIBILITY) {
+        handleNegotiatedStrobe();
+        return;
+    }
+#endif
+    
+#if LPT_ISR_HISTOGRAM
+    uint16_t histStartTick = TCNT1;
+#endif
+    
+#if LPT_TIMER_HANDSHAKE
+    uint16_t startTick = TCNT3;
+    lastStrobeStamp = startTick;
+    
     // Assert BUSY signal immediately
+#if LPT_DIRECT_PORT_IO
+    LptPinMap::setHigh<LPT_BUSY_PIN>();
+#else
     digitalWrite(LPT_BUSY_PIN, HIGH);
+#endif
+    
+    // Latch data: SPP guarantees D0-D7 are valid while /Strobe is low
+    uint8_t data = sampleDataBus();
+    
+    // Write to ring buffer
+    if (ringBuffer.write(data)) {
+        bytesReceived++;
+    } else {
+        droppedBytes++;
+    }
+    
+    // Hold BUSY once the buffer passes the high watermark
+    if (flowControlEnabled && !busyAsserted &&
+        ringBuffer.available() >= flowHighWatermark) {
+        assertFlowControl();
+    }
+    
+    // Arm compare channel A; the timer ISR produces ACK and releases BUSY.
+    // A strobe during a running handshake (host ignored BUSY) keeps the
+    // pending handshake instead of restarting it.
+    if (handshakePhase == HANDSHAKE_IDLE) {
+        // Schedule relative to the strobe, but never behind TCNT3 or the
+        // compare would only fire after a full 32ms timer wrap
+        uint16_t now = TCNT3;
+        uint16_t elapsed = now - startTick;
+        uint16_t remaining = (elapsed + LPT_MIN_ARM_TICKS < ackDelayTicks)
+                             ? (uint16_t)(ackDelayTicks - elapsed) : LPT_MIN_ARM_TICKS;
+        TIFR3 = _BV(OCF3A);
+        OCR3A = now + remaining;
+        handshakePhase = HANDSHAKE_ACK_ASSERT;
+        TIMSK3 |= _BV(OCIE3A);
+    }
+    
+    // Update statistics (Timer3 ticks -> μs, rounded up)
+    totalInterrupts++;
+    uint16_t elapsedTicks = TCNT3 - startTick;
+    updateTimingStats((elapsedTicks + LPT_TIMER_TICKS_PER_US - 1) / LPT_TIMER_TICKS_PER_US);
+    
+    uint32_t nowMs = millis();
+#if LPT_ISR_HISTOGRAM
+    recordTimingHistograms(histStartTick, nowMs);
+#endif
+    lastInterruptTime = nowMs;
+#else
+    uint32_t startTime = micros();
+    lastStrobeStamp = (uint16_t)startTime;
+    
+    // Assert BUSY signal immediately
+#if LPT_DIRECT_PORT_IO
+    LptPinMap::setHigh<LPT_BUSY_PIN>();
+#else
+    digitalWrite(LPT_BUSY_PIN, HIGH);
+#endif
     
     // Hardware delay for data stability (5μs per spec)
-    delayMicroseconds(HARDWARE_DELAY);
+    delayMicroseconds(ackDelayUs);
     
-    // Read 8-bit parallel data atomically
-    uint8_t data = 0;
-    data |= (digitalRead(LPT_DATA0_PIN) ? 0x01 : 0x00);
-    data |= (digitalRead(LPT_DATA1_PIN) ? 0x02 : 0x00);
-    data |= (digitalRead(LPT_DATA2_PIN) ? 0x04 : 0x00);
-    data |= (digitalRead(LPT_DATA3_PIN) ? 0x08 : 0x00);
-    data |= (digitalRead(LPT_DATA4_PIN) ? 0x10 : 0x00);
-    data |= (digitalRead(LPT_DATA5_PIN) ? 0x20 : 0x00);
-    data |= (digitalRead(LPT_DATA6_PIN) ? 0x40 : 0x00);
-    data |= (digitalRead(LPT_DATA7_PIN) ? 0x80 : 0x00);
+    uint8_t data = sampleDataBus();
     
     // Write to ring buffer
     if (ringBuffer.write(data)) {
         bytesReceived++;
+    } else {
+        droppedBytes++;
+    }
+    
+    // Hold BUSY once the buffer passes the high watermark
+    if (flowControlEnabled && !busyAsserted &&
+        ringBuffer.available() >= flowHighWatermark) {
+        assertFlowControl();
     }
     
     // Send acknowledge pulse (20μs per TDS2024 requirements)
+#if LPT_DIRECT_PORT_IO
+    LptPinMap::setLow<LPT_ACKNOWLEDGE_PIN>();
+    delayMicroseconds(ackPulseUs);
+    LptPinMap::setHigh<LPT_ACKNOWLEDGE_PIN>();
+    
+    // Release BUSY signal unless flow control is holding it
+    if (!busyAsserted) {
+        LptPinMap::setLow<LPT_BUSY_PIN>();
+    }
+#else
     digitalWrite(LPT_ACKNOWLEDGE_PIN, LOW);
-    delayMicroseconds(ACK_PULSE_WIDTH);
+    delayMicroseconds(ackPulseUs);
     digitalWrite(LPT_ACKNOWLEDGE_PIN, HIGH);
     
-    // Release BUSY signal
-    digitalWrite(LPT_BUSY_PIN, LOW);
+    // Release BUSY signal unless flow control is holding it
+    if (!busyAsserted) {
+        digitalWrite(LPT_BUSY_PIN, LOW);
+    }
+#endif
     
     // Update statistics
     totalInterrupts++;
-    uint32_t endTime = micros();
-    uint16_t executionTime = (uint16_t)(endTime - startTime);
+    uint16_t executionTime = (uint16_t)(micros() - startTime);
     updateTimingStats(executionTime);
     
-    lastInterruptTime = endTime;
+    uint32_t nowMs = millis();
+#if LPT_ISR_HISTOGRAM
+    recordTimingHistograms(histStartTick, nowMs);
+#endif
+    lastInterruptTime = nowMs;
+#endif
+}
+
+void ParallelPortManager::handleHandshakeTimer() {
+    if (handshakePhase == HANDSHAKE_ACK_ASSERT) {
+        // Start ACK low pulse
+#if LPT_DIRECT_PORT_IO
+        LptPinMap::setLow<LPT_ACKNOWLEDGE_PIN>();
+#else
+        digitalWrite(LPT_ACKNOWLEDGE_PIN, LOW);
+#endif
+        // Pulse width measured from the actual ACK edge
+        OCR3A = TCNT3 + ackPulseTicks;
+        handshakePhase = HANDSHAKE_ACK_RELEASE;
+        return;
+    }
+    
+    // End ACK pulse and release BUSY (unless flow control is holding it)
+#if LPT_DIRECT_PORT_IO
+    LptPinMap::setHigh<LPT_ACKNOWLEDGE_PIN>();
+    if (!busyAsserted) {
+        LptPinMap::setLow<LPT_BUSY_PIN>();
+    }
+#else
+    digitalWrite(LPT_ACKNOWLEDGE_PIN, HIGH);
+    if (!busyAsserted) {
+        digitalWrite(LPT_BUSY_PIN, LOW);
+    }
+#endif
+    TIMSK3 &= ~_BV(OCIE3A);
+    handshakePhase = HANDSHAKE_IDLE;
+}
+
+bool ParallelPortManager::setHandshakeTiming(uint16_t delayUs, uint16_t pulseUs) {
+    if (delayUs == 0 || pulseUs == 0 ||
+        delayUs > LPT_MAX_HANDSHAKE_US || pulseUs > LPT_MAX_HANDSHAKE_US) {
+        return false;
+    }
+    
+    uint8_t oldSREG = SREG;
+    cli();
+    ackDelayUs = delayUs;
+    ackPulseUs = pulseUs;
+    ackDelayTicks = delayUs * LPT_TIMER_TICKS_PER_US;
+    ackPulseTicks = pulseUs * LPT_TIMER_TICKS_PER_US;
+    SREG = oldSREG;
+    
+    if (debugEnabled) {
+        Serial.print(F("ParallelPortManager: Handshake delay "));
+        Serial.print(delayUs);
+        Serial.print(F("us, ACK pulse "));
+        Serial.print(pulseUs);
+        Serial.println(F("us"));
+    }
+    
+    return true;
+}
+
+void ParallelPortManager::getHandshakeTiming(uint16_t& delayUs, uint16_t& pulseUs) const {
+    delayUs = ackDelayUs;
+    pulseUs = ackPulseUs;
 }
 
 void ParallelPortManager::setErrorState(bool error) {
@@ -370,4 +1028,13 @@ void parallelPortISR() {
     if (g_parallelPortManager != nullptr) {
         g_parallelPortManager->handleInterrupt();
     }
-}
\ No newline at end of file
+}
+
+#if LPT_TIMER_HANDSHAKE
+// Timer3 compare A: ACK pulse / BUSY release
+ISR(TIMER3_COMPA_vect) {
+    if (g_parallelPortManager != nullptr) {
+        g_parallelPortManager->handleHandshakeTimer();
+    }
+}
+#endif
\ No newline at end of file
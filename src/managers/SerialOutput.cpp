@@ -0,0 +1,54 @@
+#include "SerialOutput.h"
+#include "ServiceLocator.h"
+#include "FileSystemManager.h"
+
+SerialOutput::SerialOutput() : head(0), count(0), droppedBytes(0) {
+}
+
+size_t SerialOutput::write(uint8_t value) {
+    if (count == SERIAL_TEXT_QUEUE_SIZE) {
+        droppedBytes++;
+        return 0;
+    }
+
+    queue[(head + count) % SERIAL_TEXT_QUEUE_SIZE] = value;
+    count++;
+    return 1;
+}
+
+void SerialOutput::update() {
+    if (count == 0) {
+        return;
+    }
+
+    // File data owns the link until its transfer closes
+    auto fileSystem = ServiceLocator::getFileSystemManager();
+    if (fileSystem && fileSystem->isSerialTransferring()) {
+        return;
+    }
+
+    // At most two spans: up to the end of the queue and the part that wrapped
+    size_t room = Serial.availableForWrite();
+    while (count > 0 && room > 0) {
+        size_t span = SERIAL_TEXT_QUEUE_SIZE - head;
+        if (span > count) {
+            span = count;
+        }
+        if (span > room) {
+            span = room;
+        }
+
+        Serial.write(queue + head, span);
+        head = (head + span) % SERIAL_TEXT_QUEUE_SIZE;
+        count -= span;
+        room -= span;
+    }
+}
+
+bool SerialOutput::isEmpty() const {
+    return count == 0;
+}
+
+uint16_t SerialOutput::getDroppedBytes() const {
+    return droppedBytes;
+}
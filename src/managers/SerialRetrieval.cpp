@@ -0,0 +1,196 @@
+#include "SerialRetrieval.h"
+#include "FileSystemManager.h"
+#include "MemoryUtils.h"
+
+SerialRetrieval::SerialRetrieval()
+    : active(false), fileSize(0), startOffset(0), baseSequence(0), nextSequence(0),
+      sentLimit(0), endSequence(0), lastProgress(0), retries(0),
+      filesSent(0), packetsResent(0) {
+    clearBuffer(frame, sizeof(frame));
+    clearBuffer(filename, sizeof(filename));
+}
+
+bool SerialRetrieval::start(FileSystemManager& fs, const char* name, uint32_t offset) {
+    stop(fs);
+
+    if (!name || safeStrlen(name, MAX_FILENAME_LENGTH) >= MAX_FILENAME_LENGTH ||
+        !fs.fileExists(name)) {
+        return false;
+    }
+
+    uint32_t size = fs.getFileSize(name);
+    if (offset > size || !fs.openRead(name)) {
+        return false;
+    }
+    if (offset != 0 && !fs.seekRead(offset)) {
+        fs.closeRead();
+        return false;
+    }
+
+    strcpy(filename, name);
+    fileSize = size;
+    startOffset = offset;
+    baseSequence = 0;
+    nextSequence = 0;
+    sentLimit = 0;
+    endSequence = 1 + (size - offset + SERIAL_FRAME_PAYLOAD - 1) / SERIAL_FRAME_PAYLOAD;
+    lastProgress = millis();
+    retries = 0;
+    rangeCrc.reset();
+    active = true;
+
+    return true;
+}
+
+void SerialRetrieval::update(FileSystemManager& fs) {
+    if (!active) {
+        return;
+    }
+
+    // Nothing heard for a while: the oldest packet (or its ack) was lost
+    if (millis() - lastProgress >= SERIAL_RETRIEVE_TIMEOUT_MS) {
+        if (++retries > SERIAL_RETRIEVE_RETRIES) {
+            stop(fs);
+            return;
+        }
+        if (!rewind(fs, baseSequence)) {
+            return;
+        }
+    }
+
+    while (nextSequence <= endSequence &&
+           nextSequence - baseSequence < SERIAL_RETRIEVE_WINDOW &&
+           (size_t)Serial.availableForWrite() >= TX_RESERVE) {
+        if (!sendNext(fs)) {
+            stop(fs);
+            return;
+        }
+    }
+}
+
+bool SerialRetrieval::unwrap(uint16_t sequence, uint32_t& full) const {
+    full = baseSequence + (uint16_t)(sequence - (uint16_t)baseSequence);
+    return full < nextSequence;
+}
+
+uint32_t SerialRetrieval::dataOffset(uint32_t sequence) const {
+    if (sequence == 0) {
+        return startOffset;
+    }
+
+    uint32_t offset = startOffset + (sequence - 1) * (uint32_t)SERIAL_FRAME_PAYLOAD;
+    return offset < fileSize ? offset : fileSize;
+}
+
+bool SerialRetrieval::sendNext(FileSystemManager& fs) {
+    uint8_t* payload = frame + SerialFrame::HEADER_SIZE;
+    uint8_t type;
+    size_t length;
+
+    if (nextSequence == 0) {
+        size_t nameLength = strlen(filename);
+        SerialFrame::putLE32(payload, fileSize);
+        SerialFrame::putLE32(payload + 4, startOffset);
+        memcpy(payload + 8, filename, nameLength);
+        type = SerialFrame::BEGIN;
+        length = 8 + nameLength;
+    } else if (nextSequence == endSequence) {
+        SerialFrame::putLE32(payload, fileSize);
+        SerialFrame::putLE32(payload + 4, rangeCrc.get());
+        type = SerialFrame::END;
+        length = 8;
+    } else {
+        uint32_t offset = dataOffset(nextSequence);
+        size_t wanted = fileSize - offset < SERIAL_FRAME_PAYLOAD
+                        ? (size_t)(fileSize - offset) : SERIAL_FRAME_PAYLOAD;
+
+        // A plugin may hand over less than asked for; the packet stays full
+        length = 0;
+        while (length < wanted) {
+            size_t got = fs.readChunk(payload + length, wanted - length);
+            if (got == 0) {
+                return false;
+            }
+            length += got;
+        }
+        type = SerialFrame::DATA;
+
+        if (nextSequence == sentLimit) {
+            rangeCrc.update(payload, length);
+        }
+    }
+
+    SerialFrame::send(frame, type, (uint16_t)nextSequence, length);
+
+    if (nextSequence == sentLimit) {
+        sentLimit++;
+    } else {
+        packetsResent++;
+    }
+    nextSequence++;
+
+    return true;
+}
+
+bool SerialRetrieval::rewind(FileSystemManager& fs, uint32_t sequence) {
+    lastProgress = millis();
+    nextSequence = sequence;
+
+    // BEGIN and END carry no file data; the next DATA packet reads from here
+    uint32_t data = sequence == 0 ? 1 : sequence;
+    if (!fs.seekRead(dataOffset(data))) {
+        stop(fs);
+        return false;
+    }
+    return true;
+}
+
+bool SerialRetrieval::acknowledge(FileSystemManager& fs, uint16_t sequence) {
+    uint32_t full;
+    if (!active || !unwrap(sequence, full)) {
+        return false;
+    }
+
+    baseSequence = full + 1;
+    lastProgress = millis();
+    retries = 0;
+
+    if (baseSequence > endSequence) {
+        filesSent++;
+        stop(fs);
+    }
+    return true;
+}
+
+bool SerialRetrieval::resendFrom(FileSystemManager& fs, uint16_t sequence) {
+    uint32_t full;
+    if (!active || !unwrap(sequence, full)) {
+        return false;
+    }
+
+    // Everything before the missing packet arrived
+    baseSequence = full;
+    retries = 0;
+    return rewind(fs, full);
+}
+
+void SerialRetrieval::stop(FileSystemManager& fs) {
+    if (!active) {
+        return;
+    }
+
+    fs.closeRead();
+    active = false;
+}
+
+bool SerialRetrieval::isActive() const {
+    return active;
+}
+
+uint32_t SerialRetrieval::getFilesSent() const {
+    return filesSent;
+}
+
+uint32_t SerialRetrieval::getPacketsResent() const {
+    return packetsResent;
+}
@@ -0,0 +1,195 @@
+#include "TimeManager.h"
+#include <Wire.h>
+#include "ServiceLocator.h"
+#include "ParallelPortManager.h"
+
+TimeManager::TimeManager()
+    : initialized(false), debugEnabled(false), timeValid(false),
+      baseSeconds(0), baseMillis(0), lastSyncAttempt(0),
+      syncCount(0), syncErrors(0) {
+}
+
+int TimeManager::initialize() {
+    if (initialized) {
+        return STATUS_OK;
+    }
+    
+    // Wire.begin() has run in main before the components start
+    baseMillis = millis();
+    sync();
+    initialized = true;
+    
+    if (debugEnabled) {
+        char text[DATETIME_TEXT_LENGTH + 1];
+        getDateTime().format(text);
+        Serial.print(F("TimeManager: "));
+        Serial.print(text);
+        Serial.println(timeValid ? F("") : F(" (RTC not running)"));
+    }
+    
+    // A missing RTC only costs timestamps
+    return STATUS_OK;
+}
+
+int TimeManager::update() {
+    if (!initialized) {
+        return STATUS_NOT_INITIALIZED;
+    }
+    
+    uint32_t nowMs = millis();
+    if (nowMs - lastSyncAttempt < RTC_SYNC_INTERVAL_MS) {
+        return STATUS_OK;
+    }
+    
+    // The I2C read blocks for about a millisecond: wait for a quiet port
+    auto parallelPort = ServiceLocator::getParallelPortManager();
+    if (parallelPort->getAvailableBytes() > 0 ||
+        nowMs - parallelPort->getLastStrobeTime() < RTC_SYNC_QUIET_MS) {
+        return STATUS_OK;
+    }
+    
+    sync();
+    return STATUS_OK;
+}
+
+bool TimeManager::readRtc(DateTime& time) {
+    Wire.beginTransmission(RTC_I2C_ADDRESS);
+    Wire.write((uint8_t)0x00);     // Seconds register
+    if (Wire.endTransmission() != 0) {
+        return false;
+    }
+    
+    uint8_t reg[7];
+    if (Wire.requestFrom((uint8_t)RTC_I2C_ADDRESS, (uint8_t)sizeof(reg)) != sizeof(reg)) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(reg); i++) {
+        reg[i] = Wire.read();
+    }
+    
+    // CH (bit 7 of seconds) set: oscillator stopped, time never set
+    if (reg[0] & 0x80) {
+        return false;
+    }
+    
+    time.second = DateTime::fromBcd(reg[0] & 0x7F);
+    time.minute = DateTime::fromBcd(reg[1] & 0x7F);
+    if (reg[2] & 0x40) {
+        // 12-hour mode: bit 5 is PM
+        time.hour = DateTime::fromBcd(reg[2] & 0x1F) % 12 + ((reg[2] & 0x20) ? 12 : 0);
+    } else {
+        time.hour = DateTime::fromBcd(reg[2] & 0x3F);
+    }
+    time.day = DateTime::fromBcd(reg[4] & 0x3F);
+    time.month = DateTime::fromBcd(reg[5] & 0x1F);
+    time.year = DATETIME_EPOCH_YEAR + DateTime::fromBcd(reg[6]);
+    
+    return time.isValid();
+}
+
+bool TimeManager::sync() {
+    lastSyncAttempt = millis();
+    
+    DateTime time;
+    if (!readRtc(time)) {
+        syncErrors++;
+        advanceBase();
+        return false;
+    }
+    
+    baseSeconds = time.toSeconds();
+    baseMillis = millis();
+    timeValid = true;
+    syncCount++;
+    return true;
+}
+
+void TimeManager::advanceBase() {
+    uint32_t elapsed = (millis() - baseMillis) / 1000;
+    baseSeconds += elapsed;
+    baseMillis += elapsed * 1000;
+}
+
+uint32_t TimeManager::now() const {
+    return baseSeconds + (millis() - baseMillis) / 1000;
+}
+
+DateTime TimeManager::getDateTime() const {
+    return DateTime::fromSeconds(now());
+}
+
+bool TimeManager::isTimeValid() const {
+    return timeValid;
+}
+
+bool TimeManager::formatFilenameStamp(char* dest, size_t destSize) const {
+    if (!timeValid || !dest || destSize < DATETIME_STAMP_LENGTH + 1) {
+        return false;
+    }
+    
+    getDateTime().formatStamp(dest);
+    return true;
+}
+
+bool TimeManager::setDateTime(const DateTime& time) {
+    if (!time.isValid()) {
+        return false;
+    }
+    
+    baseSeconds = time.toSeconds();
+    baseMillis = millis();
+    timeValid = true;
+    
+    // Day of week (register 3) is not used; writing seconds clears CH
+    Wire.beginTransmission(RTC_I2C_ADDRESS);
+    Wire.write((uint8_t)0x00);
+    Wire.write(DateTime::toBcd(time.second));
+    Wire.write(DateTime::toBcd(time.minute));
+    Wire.write(DateTime::toBcd(time.hour));   // 24-hour mode
+    Wire.write((uint8_t)1);
+    Wire.write(DateTime::toBcd(time.day));
+    Wire.write(DateTime::toBcd(time.month));
+    Wire.write(DateTime::toBcd((uint8_t)(time.year - DATETIME_EPOCH_YEAR)));
+    bool written = Wire.endTransmission() == 0;
+    
+    if (debugEnabled && !written) {
+        Serial.println(F("TimeManager: RTC write failed"));
+    }
+    
+    lastSyncAttempt = millis();
+    return written;
+}
+
+void TimeManager::getSyncStats(uint32_t& reads, uint32_t& errors) const {
+    reads = syncCount;
+    errors = syncErrors;
+}
+
+int TimeManager::getStatus() const {
+    return initialized ? STATUS_OK : STATUS_NOT_INITIALIZED;
+}
+
+const __FlashStringHelper* TimeManager::getName() const {
+    return F("TimeManager");
+}
+
+bool TimeManager::validate() const {
+    return initialized;
+}
+
+int TimeManager::reset() {
+    initialized = false;
+    return initialize();
+}
+
+size_t TimeManager::getMemoryUsage() const {
+    return sizeof(*this);
+}
+
+void TimeManager::setDebugEnabled(bool enabled) {
+    debugEnabled = enabled;
+}
+
+bool TimeManager::isDebugEnabled() const {
+    return debugEnabled;
+}
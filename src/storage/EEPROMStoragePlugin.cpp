@@ -1,12 +1,37 @@
 #include "EEPROMStoragePlugin.h"
 #include "MemoryUtils.h"
+#if HARDWARE_BENCHMARK
+#include "BenchmarkStat.h"
+#include "TaskProfiler.h"
+#endif
+#if LPT_DIRECT_PORT_IO
+#include "LptPinMap.h"
+#endif
+
+#if XMEM_CAPTURE_BUFFER && XMEM_EEPROM_PAGE_BUFFER
+uint8_t (&EEPROMStoragePlugin::pageBuffer)[EEPROM_PAGE_SIZE] =
+    *reinterpret_cast<uint8_t (*)[EEPROM_PAGE_SIZE]>(XMEM_PAGE_BUFFER_ADDRESS);
+#endif
 
 EEPROMStoragePlugin::EEPROMStoragePlugin() 
     : initialized(false), debugEnabled(false), nextFreeSector(DATA_START_SECTOR),
-      totalFiles(0), deletedFiles(0) {
+      totalFiles(0), deletedFiles(0), journalSector(0), journalOffset(0),
+      journalGeneration(0), wearDirty(0), writeOpen(false), writeEntry(nullptr),
+      writeStartSector(0), writeLimitSector(0), writeSize(0), replacedEntry(nullptr),
+      readOpen(false), readStart(0), readAddress(0), readRemaining(0), verifyReads(false),
+      readVerifying(false), readExpectedCrc(0),
+      poolStart(0), poolEnd(0), poolLimit(0), poolStale(true),
+      journalSpareErased(false), backgroundErase(ERASE_NONE),
+      relocateSlot(-1), relocateTarget(0), relocateDone(0), relocateErased(false),
+      compactCheck(true), compactRequested(false),
+#if CAPTURE_SPILL
+      spillHead(0), spillTail(0), spillErased(0), spillChecked(0), spillEraseSector(0),
+#endif
+      programPending(false) {
     clearBuffer(directory, sizeof(directory));
-    clearBuffer(sectorBuffer, sizeof(sectorBuffer));
+    clearBuffer(writeName, sizeof(writeName));
     clearBuffer(pageBuffer, sizeof(pageBuffer));
+    clearBuffer(blockWear, sizeof(blockWear));
 }
 
 int EEPROMStoragePlugin::initialize() {
@@ -62,6 +87,69 @@ bool EEPROMStoragePlugin::isReady() const {
     return initialized;
 }
 
+int EEPROMStoragePlugin::update() {
+    // Never block here: an erase in progress is simply polled again later
+    if (!initialized || isBusy()) {
+        return STATUS_OK;
+    }
+    
+    completeBackgroundErase();
+    
+#if CAPTURE_SPILL
+    // A burst in flight owns the device until it has been fed back
+    if (spillHead != 0) {
+        return STATUS_OK;
+    }
+#endif
+    
+    // Only erase while idle, so captures and retrievals never queue
+    // behind a background erase
+    if (writeOpen || readOpen) {
+        return STATUS_OK;
+    }
+    
+    // Ready the journal sector the next compaction moves into
+    if (!journalSpareErased) {
+        if (startErase(JOURNAL_START_SECTOR + (journalSector + 1) % JOURNAL_SECTORS)) {
+            backgroundErase = ERASE_JOURNAL;
+        }
+        return STATUS_OK;
+    }
+    
+    // Compaction goes first: it changes where the pool belongs
+    if (relocateSlot < 0 && compactCheck) {
+        compactCheck = false;
+        uint32_t freeSectors;
+        uint32_t largest = getLargestFreeRun(freeSectors);
+        bool fragmented = largest < COMPACT_RUNWAY_SECTORS && freeSectors > largest;
+        if ((fragmented || compactRequested) && !selectRelocation()) {
+            compactRequested = false;   // Nothing left to move
+        }
+    }
+    if (relocateSlot >= 0) {
+        stepRelocation();
+        return STATUS_OK;
+    }
+    
+#if CAPTURE_SPILL
+    if (prepareSpill()) {
+        return STATUS_OK;
+    }
+#endif
+    
+    if (poolStale) {
+        placePool();
+    }
+    
+    if (poolEnd < poolLimit && poolEnd - poolStart < PRE_ERASE_SECTORS) {
+        if (startErase(poolEnd)) {
+            backgroundErase = ERASE_POOL;
+        }
+    }
+    
+    return STATUS_OK;
+}
+
 IStoragePlugin::StorageType EEPROMStoragePlugin::getType() const {
     return STORAGE_EEPROM;
 }
@@ -75,45 +163,110 @@ uint32_t EEPROMStoragePlugin::getAvailableSpace() const {
         return 0;
     }
     
-    uint32_t usedSectors = nextFreeSector - DATA_START_SECTOR;
-    uint32_t availableSectors = TOTAL_SECTORS - nextFreeSector;
+    // Files from before the spill region was reserved may sit inside it
+    uint32_t usedSectors = getUsedSectors();
+    uint32_t dataSectors = DATA_END_SECTOR - DATA_START_SECTOR;
+    uint32_t availableSectors = usedSectors < dataSectors ? dataSectors - usedSectors : 0;
     
     return availableSectors * EEPROM_SECTOR_SIZE;
 }
 
 uint32_t EEPROMStoragePlugin::getTotalSpace() const {
-    // Total space minus directory sector
-    return (TOTAL_SECTORS - 1) * EEPROM_SECTOR_SIZE;
+    // Total space minus legacy directory sector and journal ring
+    return (DATA_END_SECTOR - DATA_START_SECTOR) * EEPROM_SECTOR_SIZE;
 }
 
 void EEPROMStoragePlugin::initSPI() {
     pinMode(EEPROM_CS_PIN, OUTPUT);
     digitalWrite(EEPROM_CS_PIN, HIGH);
     
+    // Clock, mode and bit order are applied per transaction, since the
+    // SD card shares the bus with different settings
     SPI.begin();
-    SPI.setClockDivider(SPI_CLOCK_DIV4); // 4MHz for W25Q128
-    SPI.setDataMode(SPI_MODE0);
-    SPI.setBitOrder(MSBFIRST);
 }
 
-void EEPROMStoragePlugin::sendCommand(uint8_t cmd) {
+void EEPROMStoragePlugin::select() {
+    SPI.beginTransaction(SPISettings(SPI_CLOCK_SPEED, MSBFIRST, SPI_MODE0));
+#if LPT_DIRECT_PORT_IO
+    LptPinMap::setLow<EEPROM_CS_PIN>();
+#else
+    digitalWrite(EEPROM_CS_PIN, LOW);
+#endif
+}
+
+void EEPROMStoragePlugin::deselect() {
+#if LPT_DIRECT_PORT_IO
+    LptPinMap::setHigh<EEPROM_CS_PIN>();
+#else
+    digitalWrite(EEPROM_CS_PIN, HIGH);
+#endif
+    SPI.endTransaction();
+}
+
+void EEPROMStoragePlugin::transmitBurst(const uint8_t* data, size_t size) {
+#if EEPROM_SPI_BURST
+    if (size == 0) {
+        return;
+    }
+    
+    // Fetch the next byte while the current one shifts out, so SPDR is
+    // reloaded the moment SPIF sets (no status round trip per byte)
+    SPDR = *data++;
+    while (--size) {
+        uint8_t next = *data++;
+        while (!(SPSR & _BV(SPIF))) {}
+        SPDR = next;
+    }
+    while (!(SPSR & _BV(SPIF))) {}
+    (void)SPDR;
+#else
+    for (size_t i = 0; i < size; i++) {
+        SPI.transfer(data[i]);
+    }
+#endif
+}
+
+void EEPROMStoragePlugin::receiveBurst(uint8_t* data, size_t size) {
+#if EEPROM_SPI_BURST
+    if (size == 0) {
+        return;
+    }
+    
+    // Start the next transfer before storing the byte just received
+    SPDR = 0x00;
+    while (--size) {
+        while (!(SPSR & _BV(SPIF))) {}
+        uint8_t in = SPDR;
+        SPDR = 0x00;
+        *data++ = in;
+    }
+    while (!(SPSR & _BV(SPIF))) {}
+    *data = SPDR;
+#else
+    for (size_t i = 0; i < size; i++) {
+        data[i] = SPI.transfer(0x00);
+    }
+#endif
+}
+
+void EEPROMStoragePlugin::sendCommand(uint8_t cmd) const {
     SPI.transfer(cmd);
 }
 
-void EEPROMStoragePlugin::sendAddress(uint32_t address) {
+void EEPROMStoragePlugin::sendAddress(uint32_t address) const {
     SPI.transfer((address >> 16) & 0xFF);
     SPI.transfer((address >> 8) & 0xFF);
     SPI.transfer(address & 0xFF);
 }
 
-bool EEPROMStoragePlugin::waitForWriteComplete(uint32_t timeoutMs) {
+bool EEPROMStoragePlugin::waitForWriteComplete(uint32_t timeoutMs) const {
     uint32_t startTime = millis();
     
     while (millis() - startTime < timeoutMs) {
-        digitalWrite(EEPROM_CS_PIN, LOW);
+        select();
         sendCommand(CMD_READ_STATUS1);
         uint8_t status = SPI.transfer(0x00);
-        digitalWrite(EEPROM_CS_PIN, HIGH);
+        deselect();
         
         if ((status & 0x01) == 0) { // WIP bit cleared
             return true;
@@ -125,26 +278,42 @@ bool EEPROMStoragePlugin::waitForWriteComplete(uint32_t timeoutMs) {
     return false;
 }
 
+bool EEPROMStoragePlugin::waitForIdle() const {
+    if (!programPending) {
+        return true;
+    }
+    
+    // Long enough for a sector erase left running in the background
+    if (!waitForWriteComplete(5000)) {
+        return false;
+    }
+    
+    programPending = false;
+    return true;
+}
+
 void EEPROMStoragePlugin::writeEnable() {
-    digitalWrite(EEPROM_CS_PIN, LOW);
+    select();
     sendCommand(CMD_WRITE_ENABLE);
-    digitalWrite(EEPROM_CS_PIN, HIGH);
+    deselect();
 }
 
-bool EEPROMStoragePlugin::readData(uint32_t address, uint8_t* data, size_t size) {
+bool EEPROMStoragePlugin::readData(uint32_t address, uint8_t* data, size_t size) const {
     if (!data || size == 0) {
         return false;
     }
     
-    digitalWrite(EEPROM_CS_PIN, LOW);
-    sendCommand(CMD_READ_DATA);
-    sendAddress(address);
-    
-    for (size_t i = 0; i < size; i++) {
-        data[i] = SPI.transfer(0x00);
+    if (!waitForIdle()) {
+        return false;
     }
     
-    digitalWrite(EEPROM_CS_PIN, HIGH);
+    select();
+    sendCommand(CMD_FAST_READ);
+    sendAddress(address);
+    SPI.transfer(0x00); // Dummy byte
+    receiveBurst(data, size);
+    deselect();
+    
     return true;
 }
 
@@ -153,42 +322,131 @@ bool EEPROMStoragePlugin::writePage(uint32_t address, const uint8_t* data, size_
         return false;
     }
     
+    // The chip wraps within the page instead of crossing into the next
+    if ((address % EEPROM_PAGE_SIZE) + size > EEPROM_PAGE_SIZE) {
+        return false;
+    }
+    
+    // Previous program must finish before the chip accepts another
+    if (!waitForIdle()) {
+        return false;
+    }
+    
     writeEnable();
     
-    digitalWrite(EEPROM_CS_PIN, LOW);
+    select();
     sendCommand(CMD_PAGE_PROGRAM);
     sendAddress(address);
+    transmitBurst(data, size);
+    deselect();
     
-    for (size_t i = 0; i < size; i++) {
-        SPI.transfer(data[i]);
+    // Completion is checked by the next command (or isBusy()), so the
+    // ~0.7ms program time overlaps with the caller's work
+    programPending = true;
+    return true;
+}
+
+bool EEPROMStoragePlugin::eraseSector(uint32_t sectorNum) {
+    if (!startErase(sectorNum)) {
+        return false;
     }
     
-    digitalWrite(EEPROM_CS_PIN, HIGH);
-    
-    return waitForWriteComplete();
+    return waitForIdle(); // Sector erase can take up to 3s
 }
 
-bool EEPROMStoragePlugin::eraseSector(uint32_t sectorNum) {
+bool EEPROMStoragePlugin::startErase(uint32_t sectorNum) {
     if (sectorNum >= TOTAL_SECTORS) {
         return false;
     }
     
     uint32_t address = sectorNum * EEPROM_SECTOR_SIZE;
     
+    if (!waitForIdle()) {
+        return false;
+    }
+    completeBackgroundErase();
+    
     writeEnable();
     
-    digitalWrite(EEPROM_CS_PIN, LOW);
+    select();
     sendCommand(CMD_SECTOR_ERASE);
     sendAddress(address);
-    digitalWrite(EEPROM_CS_PIN, HIGH);
+    deselect();
+    
+    // Count the erase whether or not it completes in time
+    uint32_t block = sectorNum / SECTORS_PER_WEAR_BLOCK;
+    if (blockWear[block] != 0xFFFF) {
+        blockWear[block]++;
+    }
+    wearDirty |= 1UL << (block / WEAR_COUNTERS_PER_RECORD);
     
-    return waitForWriteComplete(5000); // Sector erase can take up to 3s
+    programPending = true;
+    return true;
+}
+
+void EEPROMStoragePlugin::completeBackgroundErase() {
+    if (backgroundErase == ERASE_POOL) {
+        poolEnd++;
+    } else if (backgroundErase == ERASE_JOURNAL) {
+        journalSpareErased = true;
+    } else if (backgroundErase == ERASE_RELOCATE) {
+        relocateErased = true;
+#if CAPTURE_SPILL
+    } else if (backgroundErase == ERASE_SPILL) {
+        spillErased |= 1UL << spillEraseSector;
+#endif
+    }
+    backgroundErase = ERASE_NONE;
+}
+
+void EEPROMStoragePlugin::placePool() {
+    uint32_t regionEnd = 0;
+    uint32_t start = allocateSectors(0, regionEnd);
+    poolStale = false;
+    
+    if (start == 0) {
+        poolStart = poolEnd = poolLimit = 0;
+        return;
+    }
+    
+    // Sectors erased earlier stay usable if the next write starts among them
+    if (start < poolStart || start >= poolEnd) {
+        poolEnd = start;
+    }
+    poolStart = start;
+    poolLimit = regionEnd;
+    if (poolEnd > poolLimit) {
+        poolEnd = poolLimit;
+    }
 }
 
 bool EEPROMStoragePlugin::loadDirectory() {
-    // Read directory from first sector
-    if (!readData(0, (uint8_t*)directory, sizeof(directory))) {
-        return false;
+    bool imported = false;
+    
+    if (!replayJournal()) {
+        // No journal yet: pick up the legacy table from the first sector
+        // (an erased chip reads back as an empty directory). Names stay
+        // there until the first snapshot has copied them.
+        for (size_t i = 0; i < MAX_FILES; i++) {
+            directory[i].status = STATUS_EMPTY;
+            if (i >= LEGACY_MAX_FILES) {
+                continue;
+            }
+            
+            LegacyEntry legacy;
+            if (!readData(LEGACY_DIRECTORY_SECTOR * EEPROM_SECTOR_SIZE + i * sizeof(LegacyEntry),
+                          (uint8_t*)&legacy, sizeof(legacy))) {
+                return false;
+            }
+            
+            EntryPayload payload;
+            memcpy(payload.filename, legacy.filename, MAX_FILENAME_LENGTH);
+            payload.startSector = legacy.startSector;
+            payload.sizeBytes = legacy.sizeBytes;
+            payload.sizeComplement = legacy.sizeComplement;
+            applyEntry(i, RECORD_ENTRY, legacy.status, payload, LEGACY_RECORD | i);
+        }
+        imported = true;
     }
     
     // Count active and deleted files
@@ -198,235 +456,781 @@ bool EEPROMStoragePlugin::loadDirectory() {
     
     for (size_t i = 0; i < MAX_FILES; i++) {
         if (directory[i].status == STATUS_ACTIVE) {
-            if (validateFileEntry(&directory[i])) {
-                totalFiles++;
-                uint32_t fileEndSector = directory[i].startSector + getSectorCount(directory[i].sizeBytes);
-                if (fileEndSector > nextFreeSector) {
-                    nextFreeSector = fileEndSector;
-                }
-            } else {
-                // Invalid entry, mark as deleted
-                directory[i].status = STATUS_DELETED;
-                deletedFiles++;
+            totalFiles++;
+            uint32_t fileEndSector = directory[i].startSector + getSectorCount(directory[i].sizeBytes);
+            if (fileEndSector > nextFreeSector) {
+                nextFreeSector = fileEndSector;
             }
         } else if (directory[i].status == STATUS_DELETED) {
             deletedFiles++;
         }
     }
     
+    if (imported) {
+        if (!saveDirectory()) {
+            return false;
+        }
+        
+        // Retire the legacy table so it is never imported twice
+        eraseSector(LEGACY_DIRECTORY_SECTOR);
+        
+        if (debugEnabled) {
+            Serial.println(F("EEPROMStoragePlugin: Directory journal created"));
+        }
+    }
+    
     return true;
 }
 
-bool EEPROMStoragePlugin::saveDirectory() {
-    // Erase directory sector
-    if (!eraseSector(DIRECTORY_SECTOR)) {
+bool EEPROMStoragePlugin::replayJournal() {
+    JournalRecord record;
+    bool found = false;
+    
+    // Newest valid header wins (generation compare survives wrap-around)
+    for (uint8_t i = 0; i < JOURNAL_SECTORS; i++) {
+        if (!readData(journalAddress(i), (uint8_t*)&record, sizeof(record))) {
+            return false;
+        }
+        
+        if (record.type != RECORD_HEADER || record.checksum != recordChecksum(record)) {
+            continue;
+        }
+        
+        if (!found || (int32_t)(record.generation - journalGeneration) > 0) {
+            journalSector = i;
+            journalGeneration = record.generation;
+            found = true;
+        }
+    }
+    
+    if (!found) {
         return false;
     }
     
-    // Write directory in pages
-    uint32_t address = 0;
-    const uint8_t* dirData = (const uint8_t*)directory;
-    size_t remaining = sizeof(directory);
+    for (size_t i = 0; i < MAX_FILES; i++) {
+        clearBuffer(&directory[i], sizeof(FileEntry));
+        directory[i].status = STATUS_EMPTY;
+    }
+    
+    // Apply records in order up to the first erased slot; a torn record
+    // fails its checksum and is skipped
+    uint32_t base = journalAddress(journalSector);
+    uint16_t offset = JOURNAL_RECORD_SIZE;
     
-    while (remaining > 0) {
-        size_t pageSize = min(remaining, (size_t)EEPROM_PAGE_SIZE);
-        
-        if (!writePage(address, dirData, pageSize)) {
+    while (offset + JOURNAL_RECORD_SIZE <= EEPROM_SECTOR_SIZE) {
+        if (!readData(base + offset, (uint8_t*)&record, sizeof(record))) {
             return false;
         }
         
-        address += pageSize;
-        dirData += pageSize;
-        remaining -= pageSize;
+        if (record.type == RECORD_ERASED) {
+            break;
+        }
+        
+        if (record.checksum != recordChecksum(record)) {
+            // Torn record
+        } else if ((record.type == RECORD_ENTRY || record.type == RECORD_FILE) &&
+                   record.slot < MAX_FILES) {
+            applyEntry(record.slot, record.type, record.status, record.entry,
+                       recordIndex(journalSector, offset));
+        } else if (record.type == RECORD_WEAR && record.slot < WEAR_RECORDS) {
+            size_t first = record.slot * WEAR_COUNTERS_PER_RECORD;
+            for (size_t i = 0; i < WEAR_COUNTERS_PER_RECORD && first + i < WEAR_BLOCKS; i++) {
+                blockWear[first + i] = record.wear[i];
+            }
+        }
+        
+        offset += JOURNAL_RECORD_SIZE;
     }
     
+    journalOffset = offset;
     return true;
 }
 
-EEPROMStoragePlugin::FileEntry* EEPROMStoragePlugin::findFileEntry(const char* filename) {
-    if (!filename) {
-        return nullptr;
+bool EEPROMStoragePlugin::saveDirectory() {
+    uint8_t nextSector = (journalSector + 1) % JOURNAL_SECTORS;
+    uint32_t base = journalAddress(nextSector);
+    
+    // Skip the erase if the sector was readied in the background
+    if (!waitForIdle()) {
+        return false;
+    }
+    completeBackgroundErase();
+    if (!journalSpareErased && !eraseSector(JOURNAL_START_SECTOR + nextSector)) {
+        return false;
     }
+    journalSpareErased = false;
     
+    // Snapshot every slot in use and all erase counters (including the
+    // erase just done), leaving room for the header
+    JournalRecord record;
+    uint16_t offset = JOURNAL_RECORD_SIZE;
     for (size_t i = 0; i < MAX_FILES; i++) {
-        if (directory[i].status == STATUS_ACTIVE &&
-            equalsIgnoreCase(directory[i].filename, MAX_FILENAME_LENGTH, filename)) {
-            return &directory[i];
+        if (directory[i].status == STATUS_EMPTY) {
+            continue;
+        }
+        if (!buildEntryRecord(i, record) || !writeRecord(base + offset, record)) {
+            return false;
         }
+        offset += JOURNAL_RECORD_SIZE;
     }
     
-    return nullptr;
-}
-
-const EEPROMStoragePlugin::FileEntry* EEPROMStoragePlugin::findFileEntry(const char* filename) const {
-    if (!filename) {
-        return nullptr;
+    for (size_t group = 0; group < WEAR_RECORDS; group++) {
+        buildWearRecord(group, record);
+        if (!writeRecord(base + offset, record)) {
+            return false;
+        }
+        offset += JOURNAL_RECORD_SIZE;
+    }
+    
+    // Header last: only now does the new sector replace the old one
+    memset(&record, 0xFF, sizeof(record));
+    record.type = RECORD_HEADER;
+    record.generation = journalGeneration + 1;
+    
+    if (!writeRecord(base, record)) {
+        return false;
     }
     
+    journalSector = nextSector;
+    journalOffset = offset;
+    journalGeneration++;
+    wearDirty = 0;
+    
+    // Names are read from the new sector from now on
+    offset = JOURNAL_RECORD_SIZE;
     for (size_t i = 0; i < MAX_FILES; i++) {
-        if (directory[i].status == STATUS_ACTIVE &&
-            equalsIgnoreCase(directory[i].filename, MAX_FILENAME_LENGTH, filename)) {
-            return &directory[i];
+        if (directory[i].status != STATUS_EMPTY) {
+            directory[i].record = recordIndex(journalSector, offset);
+            offset += JOURNAL_RECORD_SIZE;
         }
     }
     
-    return nullptr;
+    return true;
 }
 
-EEPROMStoragePlugin::FileEntry* EEPROMStoragePlugin::findEmptyEntry() {
-    for (size_t i = 0; i < MAX_FILES; i++) {
-        if (directory[i].status == STATUS_EMPTY || directory[i].status == STATUS_DELETED) {
-            return &directory[i];
-        }
+bool EEPROMStoragePlugin::logEntry(const FileEntry* entry) {
+    if (!entry) {
+        return false;
     }
     
-    return nullptr;
+    JournalRecord record;
+    if (!buildEntryRecord(entry - directory, record)) {
+        return false;
+    }
+    return appendRecord(record);
 }
 
-uint32_t EEPROMStoragePlugin::allocateSectors(uint32_t sizeBytes) {
-    uint32_t sectorsNeeded = getSectorCount(sizeBytes);
+bool EEPROMStoragePlugin::logWear() {
+    JournalRecord record;
     
-    if (nextFreeSector + sectorsNeeded > TOTAL_SECTORS) {
-        // Try defragmentation
-        if (defragment()) {
-            if (nextFreeSector + sectorsNeeded > TOTAL_SECTORS) {
-                return 0; // Still not enough space
-            }
-        } else {
-            return 0; // Defragmentation failed
+    // A compaction along the way logs every group and clears the mask
+    for (size_t group = 0; group < WEAR_RECORDS && wearDirty; group++) {
+        if (!(wearDirty & (1UL << group))) {
+            continue;
+        }
+        buildWearRecord(group, record);
+        if (!appendRecord(record)) {
+            return false;
         }
+        wearDirty &= ~(1UL << group);
     }
     
-    uint32_t startSector = nextFreeSector;
-    nextFreeSector += sectorsNeeded;
-    
-    return startSector;
+    return true;
 }
 
-void EEPROMStoragePlugin::freeSectors(uint32_t startSector, uint32_t sizeBytes) {
-    uint32_t sectorsToFree = getSectorCount(sizeBytes);
+bool EEPROMStoragePlugin::appendRecord(JournalRecord& record) {
+    // Sector full: compaction writes the change as part of the snapshot
+    if (journalOffset + JOURNAL_RECORD_SIZE > EEPROM_SECTOR_SIZE) {
+        return saveDirectory();
+    }
+    
+    if (!writeRecord(journalAddress(journalSector) + journalOffset, record)) {
+        return false;
+    }
     
-    // Erase sectors (this is a simplified approach)
-    for (uint32_t i = 0; i < sectorsToFree; i++) {
-        eraseSector(startSector + i);
+    if (record.type == RECORD_ENTRY || record.type == RECORD_FILE) {
+        directory[record.slot].record = recordIndex(journalSector, journalOffset);
     }
+    journalOffset += JOURNAL_RECORD_SIZE;
+    return true;
 }
 
-uint32_t EEPROMStoragePlugin::getSectorCount(uint32_t sizeBytes) const {
-    return (sizeBytes + EEPROM_SECTOR_SIZE - 1) / EEPROM_SECTOR_SIZE;
+bool EEPROMStoragePlugin::writeRecord(uint32_t address, JournalRecord& record) {
+    record.checksum = recordChecksum(record);
+    return writePage(address, (const uint8_t*)&record, sizeof(record));
 }
 
-bool EEPROMStoragePlugin::validateFileEntry(const FileEntry* entry) const {
-    if (!entry) {
-        return false;
+bool EEPROMStoragePlugin::buildEntryRecord(size_t slot, JournalRecord& record) const {
+    const FileEntry& entry = directory[slot];
+    
+    uint32_t crc;
+    bool hasCrc = getStoredCrc(slot, crc);
+    
+    memset(&record, 0xFF, sizeof(record));
+    record.type = hasCrc ? RECORD_FILE : RECORD_ENTRY;
+    record.slot = (uint8_t)slot;
+    record.status = entry.status;
+    record.entry.startSector = entry.startSector;
+    record.entry.sizeBytes = entry.sizeBytes;
+    if (hasCrc) {
+        record.entry.crc = crc;
+    } else {
+        record.entry.sizeComplement = ~entry.sizeBytes;
     }
     
-    // Check size complement
-    if (entry->sizeBytes != (~entry->sizeComplement)) {
-        return false;
+    return readName(slot, record.entry.filename);
+}
+
+void EEPROMStoragePlugin::applyEntry(size_t slot, uint8_t type, uint8_t status,
+                                     const EntryPayload& payload, uint16_t record) {
+    FileEntry& entry = directory[slot];
+    
+    if (status == STATUS_ACTIVE && !validateEntry(type, payload)) {
+        status = STATUS_DELETED;   // Invalid entry, mark as deleted
+    } else if (status != STATUS_ACTIVE && status != STATUS_DELETED) {
+        status = STATUS_EMPTY;
     }
     
-    // Check sector bounds
-    if (entry->startSector < DATA_START_SECTOR || 
-        entry->startSector >= TOTAL_SECTORS) {
-        return false;
+    entry.startSector = payload.startSector;
+    entry.sizeBytes = payload.sizeBytes;
+    entry.record = record;
+    entry.nameHash = hashName(payload.filename);
+    entry.status = status;
+}
+
+bool EEPROMStoragePlugin::readEntryRecord(size_t slot, JournalRecord& record) const {
+    uint16_t index = directory[slot].record;
+    uint32_t address = journalAddress(index / RECORDS_PER_SECTOR) +
+                       (index % RECORDS_PER_SECTOR) * JOURNAL_RECORD_SIZE;
+    return readData(address, (uint8_t*)&record, sizeof(record));
+}
+
+bool EEPROMStoragePlugin::getStoredCrc(size_t slot, uint32_t& crc) const {
+    // A committed write is logged before its slot is released; while the
+    // write is still open the slot describes the file being replaced
+    if (writeEntry == &directory[slot] && !writeOpen) {
+        crc = writeCrc.get();
+        return true;
     }
     
-    // Check filename validity
-    if (safeStrlen(entry->filename, MAX_FILENAME_LENGTH) == 0) {
+    if (directory[slot].record & LEGACY_RECORD) {
         return false;
     }
     
+    JournalRecord record;
+    if (!readEntryRecord(slot, record) || record.type != RECORD_FILE ||
+        record.checksum != recordChecksum(record)) {
+        return false;
+    }
+    crc = record.entry.crc;
     return true;
 }
 
-size_t EEPROMStoragePlugin::writeFile(const char* filename, const uint8_t* data, size_t size) {
-    if (!initialized || !filename || !data || size == 0) {
-        return 0;
+bool EEPROMStoragePlugin::verifyFileData(size_t slot) {
+    uint32_t expected;
+    if (!getStoredCrc(slot, expected)) {
+        return true;               // Nothing to compare against
     }
     
-    // Check if file already exists
-    FileEntry* existingEntry = findFileEntry(filename);
-    if (existingEntry) {
-        // Delete existing file first
-        deleteFile(filename);
-    }
+    Crc32 crc;
+    uint32_t address = directory[slot].startSector * EEPROM_SECTOR_SIZE;
+    uint32_t remaining = directory[slot].sizeBytes;
     
-    // Find empty directory entry
-    FileEntry* entry = findEmptyEntry();
-    if (!entry) {
-        if (debugEnabled) {
-            Serial.println(F("EEPROMStoragePlugin: Directory full"));
+    while (remaining > 0) {
+        size_t chunk = min(remaining, (uint32_t)EEPROM_PAGE_SIZE);
+        if (!readData(address, pageBuffer, chunk)) {
+            return false;
         }
-        return 0;
+        crc.update(pageBuffer, chunk);
+        address += chunk;
+        remaining -= chunk;
     }
     
-    // Allocate sectors
-    uint32_t startSector = allocateSectors(size);
-    if (startSector == 0) {
-        if (debugEnabled) {
-            Serial.println(F("EEPROMStoragePlugin: No space available"));
-        }
-        return 0;
+    return crc.get() == expected;
+}
+
+bool EEPROMStoragePlugin::readName(size_t slot, char* name) const {
+    // The file being written has no record of its own yet
+    if (writeEntry == &directory[slot]) {
+        safeCopy(name, MAX_FILENAME_LENGTH, writeName);
+        return true;
     }
     
-    // Write data to allocated sectors
-    uint32_t address = startSector * EEPROM_SECTOR_SIZE;
-    const uint8_t* srcData = data;
-    size_t remaining = size;
-    size_t totalWritten = 0;
-    
-    while (remaining > 0) {
-        size_t pageSize = min(remaining, (size_t)EEPROM_PAGE_SIZE);
-        
-        if (!writePage(address + totalWritten, srcData, pageSize)) {
-            if (debugEnabled) {
-                Serial.println(F("EEPROMStoragePlugin: Write failed"));
-            }
-            // Free allocated sectors
-            freeSectors(startSector, size);
-            return 0;
-        }
-        
-        srcData += pageSize;
-        remaining -= pageSize;
-        totalWritten += pageSize;
+    uint16_t record = directory[slot].record;
+    uint32_t address;
+    if (record & LEGACY_RECORD) {
+        address = LEGACY_DIRECTORY_SECTOR * EEPROM_SECTOR_SIZE +
+                  (record & ~LEGACY_RECORD) * sizeof(LegacyEntry);
+    } else {
+        address = journalAddress(record / RECORDS_PER_SECTOR) +
+                  (record % RECORDS_PER_SECTOR) * JOURNAL_RECORD_SIZE +
+                  offsetof(JournalRecord, entry);
     }
     
-    // Update directory entry
-    safeCopy(entry->filename, MAX_FILENAME_LENGTH, filename);
-    entry->startSector = startSector;
-    entry->sizeBytes = size;
-    entry->sizeComplement = ~size;
-    entry->status = STATUS_ACTIVE;
-    
-    // Save directory
-    if (!saveDirectory()) {
-        if (debugEnabled) {
-            Serial.println(F("EEPROMStoragePlugin: Failed to save directory"));
-        }
-        freeSectors(startSector, size);
-        return 0;
+    if (!readData(address, (uint8_t*)name, MAX_FILENAME_LENGTH)) {
+        return false;
     }
+    name[MAX_FILENAME_LENGTH - 1] = '\0';
+    return true;
+}
+
+uint8_t EEPROMStoragePlugin::hashName(const char* name) {
+    uint8_t hash = 0;
     
-    totalFiles++;
-    
-    if (debugEnabled) {
-        Serial.print(F("EEPROMStoragePlugin: Wrote file "));
-        Serial.print(filename);
-        Serial.print(F(" ("));
-        Serial.print(size);
-        Serial.println(F(" bytes)"));
+    for (size_t i = 0; i < MAX_FILENAME_LENGTH && name[i] != '\0'; i++) {
+        hash = (uint8_t)((hash << 1) | (hash >> 7)) ^ (uint8_t)tolower(name[i]);
     }
     
-    return size;
+    return hash;
 }
 
-size_t EEPROMStoragePlugin::readFile(const char* filename, uint8_t* data, size_t maxSize) {
-    if (!initialized || !filename || !data || maxSize == 0) {
-        return 0;
+uint16_t EEPROMStoragePlugin::recordIndex(uint8_t ringIndex, uint16_t offset) {
+    return ringIndex * RECORDS_PER_SECTOR + offset / JOURNAL_RECORD_SIZE;
+}
+
+void EEPROMStoragePlugin::buildWearRecord(size_t group, JournalRecord& record) const {
+    size_t first = group * WEAR_COUNTERS_PER_RECORD;
+    
+    memset(&record, 0xFF, sizeof(record));
+    record.type = RECORD_WEAR;
+    record.slot = (uint8_t)group;
+    for (size_t i = 0; i < WEAR_COUNTERS_PER_RECORD && first + i < WEAR_BLOCKS; i++) {
+        record.wear[i] = blockWear[first + i];
     }
-    
+}
+
+uint8_t EEPROMStoragePlugin::recordChecksum(const JournalRecord& record) {
+    const uint8_t* bytes = (const uint8_t*)&record;
+    uint8_t sum = 0;
+    
+    for (size_t i = 0; i < sizeof(record); i++) {
+        if (bytes + i != &record.checksum) {
+            sum += bytes[i];
+        }
+    }
+    
+    return (uint8_t)~sum;
+}
+
+uint32_t EEPROMStoragePlugin::journalAddress(uint8_t ringIndex) {
+    return (JOURNAL_START_SECTOR + ringIndex) * EEPROM_SECTOR_SIZE;
+}
+
+const EEPROMStoragePlugin::FileEntry* EEPROMStoragePlugin::findFileEntry(const char* filename) const {
+    if (!filename) {
+        return nullptr;
+    }
+    
+    // Only a hash match costs a name read and compare
+    uint8_t hash = hashName(filename);
+    char name[MAX_FILENAME_LENGTH];
+    
+    for (size_t i = 0; i < MAX_FILES; i++) {
+        if (directory[i].status == STATUS_ACTIVE && directory[i].nameHash == hash &&
+            readName(i, name) &&
+            equalsIgnoreCase(name, safeStrlen(name, MAX_FILENAME_LENGTH), filename)) {
+            return &directory[i];
+        }
+    }
+    
+    return nullptr;
+}
+
+EEPROMStoragePlugin::FileEntry* EEPROMStoragePlugin::findFileEntry(const char* filename) {
+    // Same lookup; the entry belongs to this non-const object
+    return const_cast<FileEntry*>(static_cast<const EEPROMStoragePlugin*>(this)->findFileEntry(filename));
+}
+
+EEPROMStoragePlugin::FileEntry* EEPROMStoragePlugin::findEmptyEntry() {
+    for (size_t i = 0; i < MAX_FILES; i++) {
+        if (directory[i].status == STATUS_EMPTY || directory[i].status == STATUS_DELETED) {
+            return &directory[i];
+        }
+    }
+    
+    return nullptr;
+}
+
+uint32_t EEPROMStoragePlugin::allocateSectors(uint32_t sizeBytes, uint32_t& regionEnd) {
+    uint32_t minimumSectors = sizeBytes > 0 ? getSectorCount(sizeBytes) : 1;
+    uint32_t sectorsNeeded = max(minimumSectors, MIN_ALLOCATION_SECTORS);
+    
+    uint32_t startSector = findLeastWornRegion(sectorsNeeded, regionEnd);
+    
+    // Tight on space: shrink the runway down to what the file must have
+    while (startSector == 0 && sectorsNeeded > minimumSectors) {
+        sectorsNeeded = max(sectorsNeeded / 2, minimumSectors);
+        startSector = findLeastWornRegion(sectorsNeeded, regionEnd);
+    }
+    
+    if (startSector == 0) {
+        // Try defragmentation
+        if (!defragment()) {
+            return 0;
+        }
+        startSector = findLeastWornRegion(sectorsNeeded, regionEnd);
+        if (startSector == 0) {
+            return 0; // Still not enough space
+        }
+    }
+    
+    // Prefer the sequential cursor while it is not markedly more worn:
+    // keeps files contiguous and only diverts writes away from hot blocks
+    uint32_t cursorEnd;
+    uint32_t cursor = nextFreeRun(nextFreeSector, cursorEnd);
+    if (cursor == nextFreeSector && cursorEnd - cursor >= sectorsNeeded &&
+        blockWear[cursor / SECTORS_PER_WEAR_BLOCK] <=
+            blockWear[startSector / SECTORS_PER_WEAR_BLOCK] + WEAR_LEVEL_THRESHOLD) {
+        startSector = cursor;
+        regionEnd = cursorEnd;
+    }
+    
+    return startSector;
+}
+
+uint32_t EEPROMStoragePlugin::nextFreeRun(uint32_t from, uint32_t& runEnd) const {
+    uint32_t start = from < DATA_START_SECTOR ? DATA_START_SECTOR : from;
+    
+    // Step over files covering the start
+    bool moved = true;
+    while (moved && start < DATA_END_SECTOR) {
+        moved = false;
+        for (size_t i = 0; i < MAX_FILES; i++) {
+            if (directory[i].status != STATUS_ACTIVE) {
+                continue;
+            }
+            uint32_t fileStart = directory[i].startSector;
+            uint32_t fileEnd = fileStart + getSectorCount(directory[i].sizeBytes);
+            if (fileStart <= start && start < fileEnd) {
+                start = fileEnd;
+                moved = true;
+            }
+        }
+    }
+    
+    // Run ends at the nearest file above it
+    runEnd = DATA_END_SECTOR;
+    for (size_t i = 0; i < MAX_FILES; i++) {
+        if (directory[i].status == STATUS_ACTIVE &&
+            directory[i].startSector > start && directory[i].startSector < runEnd) {
+            runEnd = directory[i].startSector;
+        }
+    }
+    
+    if (start > DATA_END_SECTOR) {
+        start = DATA_END_SECTOR;
+    }
+    return start;
+}
+
+uint32_t EEPROMStoragePlugin::findLeastWornRegion(uint32_t sectorsNeeded, uint32_t& regionEnd) const {
+    uint32_t bestStart = 0;
+    uint16_t bestWear = 0xFFFF;
+    uint32_t cursor = DATA_START_SECTOR;
+    
+    while (cursor < DATA_END_SECTOR) {
+        uint32_t runEnd;
+        uint32_t runStart = nextFreeRun(cursor, runEnd);
+        if (runStart >= DATA_END_SECTOR) {
+            break;
+        }
+        
+        // Ties go to the lowest address
+        for (uint32_t candidate = runStart; candidate + sectorsNeeded <= runEnd;
+             candidate = (candidate / SECTORS_PER_WEAR_BLOCK + 1) * SECTORS_PER_WEAR_BLOCK) {
+            uint16_t wear = blockWear[candidate / SECTORS_PER_WEAR_BLOCK];
+            if (bestStart == 0 || wear < bestWear) {
+                bestStart = candidate;
+                bestWear = wear;
+                regionEnd = runEnd;
+            }
+        }
+        
+        cursor = runEnd;
+    }
+    
+    return bestStart;
+}
+
+uint32_t EEPROMStoragePlugin::getUsedSectors() const {
+    uint32_t used = 0;
+    
+    for (size_t i = 0; i < MAX_FILES; i++) {
+        if (directory[i].status == STATUS_ACTIVE) {
+            used += getSectorCount(directory[i].sizeBytes);
+        }
+    }
+    
+    return used;
+}
+
+uint32_t EEPROMStoragePlugin::getSectorCount(uint32_t sizeBytes) const {
+    return (sizeBytes + EEPROM_SECTOR_SIZE - 1) / EEPROM_SECTOR_SIZE;
+}
+
+bool EEPROMStoragePlugin::validateEntry(uint8_t type, const EntryPayload& payload) const {
+    // Check size complement (a RECORD_FILE holds the data CRC there instead)
+    if (type == RECORD_ENTRY && payload.sizeBytes != (~payload.sizeComplement)) {
+        return false;
+    }
+    
+    // Check sector bounds (file must end before the journal ring; files
+    // written before the spill region was reserved may extend into it)
+    if (payload.startSector < DATA_START_SECTOR || 
+        payload.startSector >= JOURNAL_START_SECTOR ||
+        getSectorCount(payload.sizeBytes) > JOURNAL_START_SECTOR - payload.startSector) {
+        return false;
+    }
+    
+    // Check filename validity
+    if (safeStrlen(payload.filename, MAX_FILENAME_LENGTH) == 0) {
+        return false;
+    }
+    
+    return true;
+}
+
+bool EEPROMStoragePlugin::validateFileEntry(size_t slot) const {
+    const FileEntry& entry = directory[slot];
+    if (entry.record & LEGACY_RECORD) {
+        return true;               // Checked when the legacy table was imported
+    }
+    
+    JournalRecord record;
+    if (!readEntryRecord(slot, record)) {
+        return false;
+    }
+    
+    return (record.type == RECORD_ENTRY || record.type == RECORD_FILE) &&
+           record.slot == slot &&
+           record.checksum == recordChecksum(record) &&
+           record.entry.startSector == entry.startSector &&
+           record.entry.sizeBytes == entry.sizeBytes &&
+           validateEntry(record.type, record.entry);
+}
+
+size_t EEPROMStoragePlugin::writeFile(const char* filename, const uint8_t* data, size_t size) {
+    if (!initialized || !filename || !data || size == 0 || writeOpen) {
+        return 0;
+    }
+    
+    if (!openWrite(filename, size)) {
+        return 0;
+    }
+    
+    if (append(data, size) != size) {
+        if (debugEnabled) {
+            Serial.println(F("EEPROMStoragePlugin: Write failed"));
+        }
+        discardWrite();
+        return 0;
+    }
+    
+    if (!closeWrite()) {
+        return 0;
+    }
+    
+    return size;
+}
+
+bool EEPROMStoragePlugin::openWrite(const char* filename, uint32_t sizeHint) {
+    if (!initialized || !filename || writeOpen) {
+        return false;
+    }
+    
+    // Settle a background erase so the pool is accurate for this file
+    if (backgroundErase != ERASE_NONE) {
+        if (!waitForIdle()) {
+            return false;
+        }
+        completeBackgroundErase();
+    }
+    
+    // The move's destination looks free, so it cannot outlive this write
+    cancelRelocation();
+    
+    // Pick the region while a file being replaced still holds its sectors;
+    // sectors are erased lazily as data arrives. A size hint that fits
+    // nowhere is refused up front.
+    uint32_t regionEnd = 0;
+    uint32_t startSector = allocateSectors(sizeHint, regionEnd);
+    if (startSector == 0) {
+        if (debugEnabled) {
+            Serial.println(F("EEPROMStoragePlugin: No space available"));
+        }
+        return false;
+    }
+    
+    // Replace an existing file in its own slot, so the single journal
+    // record logged at close swaps old for new
+    FileEntry* entry = findFileEntry(filename);
+    if (entry) {
+        entry->status = STATUS_DELETED;
+        totalFiles--;
+        deletedFiles++;
+        replacedEntry = entry;
+    } else {
+        // Reserve directory entry; it becomes active at closeWrite()
+        entry = findEmptyEntry();
+        if (!entry) {
+            if (debugEnabled) {
+                Serial.println(F("EEPROMStoragePlugin: Directory full"));
+            }
+            return false;
+        }
+    }
+    
+    safeCopy(writeName, MAX_FILENAME_LENGTH, filename);
+    writeEntry = entry;
+    writeStartSector = startSector;
+    writeLimitSector = regionEnd;
+    writeSize = 0;
+    writeCrc.reset();
+    writeOpen = true;
+    
+    return true;
+}
+
+size_t EEPROMStoragePlugin::append(const uint8_t* data, size_t size) {
+    if (!writeOpen || !data || size == 0) {
+        return 0;
+    }
+    
+    size_t written = 0;
+    
+    while (written < size) {
+        uint32_t address = writeStartSector * EEPROM_SECTOR_SIZE + writeSize;
+        if (address >= writeLimitSector * EEPROM_SECTOR_SIZE) {
+            if (debugEnabled) {
+                Serial.println(F("EEPROMStoragePlugin: No space available"));
+            }
+            break;
+        }
+        
+        // Erase each sector as the write enters it, unless the pool
+        // already holds it erased
+        if ((address % EEPROM_SECTOR_SIZE) == 0) {
+            uint32_t sector = address / EEPROM_SECTOR_SIZE;
+            if (sector >= poolStart && sector < poolEnd) {
+                poolStart = sector + 1;
+            } else if (!eraseSector(sector)) {
+                break;
+            }
+        }
+        
+        // Program up to the end of the current page
+        size_t pageRoom = EEPROM_PAGE_SIZE - (address % EEPROM_PAGE_SIZE);
+        size_t chunk = min(size - written, pageRoom);
+        
+        if (!writePage(address, data + written, chunk)) {
+            break;
+        }
+        writeCrc.update(data + written, chunk);
+        
+        written += chunk;
+        writeSize += chunk;
+    }
+    
+    return written;
+}
+
+bool EEPROMStoragePlugin::closeWrite() {
+    if (!writeOpen) {
+        return false;
+    }
+    
+    writeOpen = false;
+    poolStale = true;
+    compactCheck = true;
+    
+    if (writeSize == 0) {
+        // Nothing written - release the reserved slot
+        writeEntry = nullptr;
+        if (replacedEntry) {
+            logEntry(replacedEntry);
+            replacedEntry = nullptr;
+        }
+        logWear();
+        return false;
+    }
+    
+    // Commit directory entry
+    writeEntry->startSector = writeStartSector;
+    writeEntry->sizeBytes = writeSize;
+    writeEntry->nameHash = hashName(writeName);
+    writeEntry->status = STATUS_ACTIVE;
+    nextFreeSector = writeStartSector + getSectorCount(writeSize);
+    
+    // One record commits the file (and retires the one it replaced)
+    bool replaced = replacedEntry != nullptr;
+    replacedEntry = nullptr;
+    if (!logEntry(writeEntry)) {
+        if (debugEnabled) {
+            Serial.println(F("EEPROMStoragePlugin: Failed to save directory"));
+        }
+        writeEntry->status = STATUS_DELETED;
+        writeEntry = nullptr;
+        return false;
+    }
+    
+    totalFiles++;
+    if (replaced) {
+        deletedFiles--;            // Slot is live again
+    }
+    logWear();
+    
+    if (debugEnabled) {
+        Serial.print(F("EEPROMStoragePlugin: Wrote file "));
+        Serial.print(writeName);
+        Serial.print(F(" ("));
+        Serial.print(writeSize);
+        Serial.println(F(" bytes)"));
+    }
+    
+    writeEntry = nullptr;
+    return true;
+}
+
+bool EEPROMStoragePlugin::isWriteOpen() const {
+    return writeOpen;
+}
+
+bool EEPROMStoragePlugin::isBusy() const {
+    if (!programPending) {
+        return false;
+    }
+    
+    select();
+    SPI.transfer(CMD_READ_STATUS1);
+    uint8_t status = SPI.transfer(0x00);
+    deselect();
+    
+    if ((status & 0x01) == 0) { // WIP bit cleared
+        programPending = false;
+    }
+    
+    return programPending;
+}
+
+void EEPROMStoragePlugin::discardWrite() {
+    writeOpen = false;
+    poolStale = true;
+    compactCheck = true;
+    writeEntry = nullptr;
+    writeSize = 0;
+    
+    if (replacedEntry) {
+        logEntry(replacedEntry);
+        replacedEntry = nullptr;
+    }
+    logWear();
+}
+
+size_t EEPROMStoragePlugin::readFile(const char* filename, uint8_t* data, size_t maxSize) {
+    if (!initialized || !filename || !data || maxSize == 0) {
+        return 0;
+    }
+    
     FileEntry* entry = findFileEntry(filename);
     if (!entry) {
         return 0;
@@ -442,6 +1246,78 @@ size_t EEPROMStoragePlugin::readFile(const char* filename, uint8_t* data, size_t
     return bytesToRead;
 }
 
+bool EEPROMStoragePlugin::openRead(const char* filename) {
+    if (!initialized || !filename || readOpen) {
+        return false;
+    }
+    
+    const FileEntry* entry = findFileEntry(filename);
+    if (!entry) {
+        return false;
+    }
+    
+    readStart = entry->startSector * EEPROM_SECTOR_SIZE;
+    readAddress = readStart;
+    readRemaining = entry->sizeBytes;
+    readVerifying = verifyReads && getStoredCrc(entry - directory, readExpectedCrc);
+    readCrc.reset();
+    readOpen = true;
+    
+    return true;
+}
+
+size_t EEPROMStoragePlugin::readChunk(uint8_t* data, size_t maxSize) {
+    if (!readOpen || !data || maxSize == 0 || readRemaining == 0) {
+        return 0;
+    }
+    
+    size_t bytesToRead = min(readRemaining, (uint32_t)maxSize);
+    if (!readData(readAddress, data, bytesToRead)) {
+        return 0;
+    }
+    
+    readAddress += bytesToRead;
+    readRemaining -= bytesToRead;
+    
+    if (readVerifying) {
+        readCrc.update(data, bytesToRead);
+        if (readRemaining == 0 && readCrc.get() != readExpectedCrc) {
+            if (debugEnabled) {
+                Serial.println(F("EEPROMStoragePlugin: CRC mismatch on read"));
+            }
+            return 0;
+        }
+    }
+    
+    return bytesToRead;
+}
+
+bool EEPROMStoragePlugin::seekRead(uint32_t offset) {
+    if (!readOpen) {
+        return false;
+    }
+    
+    uint32_t size = (readAddress - readStart) + readRemaining;
+    if (offset > size) {
+        return false;
+    }
+    
+    // Only a read from the start sees every byte the CRC covers
+    if (offset != 0) {
+        readVerifying = false;
+    }
+    readCrc.reset();
+    readAddress = readStart + offset;
+    readRemaining = size - offset;
+    
+    return true;
+}
+
+void EEPROMStoragePlugin::closeRead() {
+    readOpen = false;
+    readRemaining = 0;
+}
+
 bool EEPROMStoragePlugin::deleteFile(const char* filename) {
     if (!initialized || !filename) {
         return false;
@@ -452,13 +1328,20 @@ bool EEPROMStoragePlugin::deleteFile(const char* filename) {
         return false;
     }
     
+    if (relocateSlot >= 0 && entry == &directory[relocateSlot]) {
+        cancelRelocation();
+    }
+    
     // Mark entry as deleted
     entry->status = STATUS_DELETED;
     totalFiles--;
     deletedFiles++;
     
-    // Save directory
-    if (!saveDirectory()) {
+    // One journal record; the sectors are erased when next written, or
+    // ahead of time by update()
+    poolStale = true;
+    compactCheck = true;
+    if (!logEntry(entry)) {
         return false;
     }
     
@@ -479,7 +1362,8 @@ uint32_t EEPROMStoragePlugin::getFileSize(const char* filename) const {
     return entry ? entry->sizeBytes : 0;
 }
 
-size_t EEPROMStoragePlugin::listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles) const {
+size_t EEPROMStoragePlugin::listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles,
+                                      size_t first) const {
     if (!filenames || maxFiles == 0) {
         return 0;
     }
@@ -487,8 +1371,12 @@ size_t EEPROMStoragePlugin::listFiles(char filenames[][MAX_FILENAME_LENGTH], siz
     size_t fileCount = 0;
     
     for (size_t i = 0; i < MAX_FILES && fileCount < maxFiles; i++) {
-        if (directory[i].status == STATUS_ACTIVE) {
-            safeCopy(filenames[fileCount], MAX_FILENAME_LENGTH, directory[i].filename);
+        if (directory[i].status != STATUS_ACTIVE) {
+            continue;
+        }
+        if (first > 0) {
+            first--;
+        } else if (readName(i, filenames[fileCount])) {
             fileCount++;
         }
     }
@@ -511,6 +1399,11 @@ bool EEPROMStoragePlugin::format() {
     totalFiles = 0;
     deletedFiles = 0;
     nextFreeSector = DATA_START_SECTOR;
+    poolStale = true;
+    compactCheck = true;
+    compactRequested = false;
+    cancelRelocation();
+    closeRead();
     
     // Save empty directory
     if (!saveDirectory()) {
@@ -537,7 +1430,8 @@ bool EEPROMStoragePlugin::getStatus(char* statusBuffer, size_t bufferSize) const
         appendString(statusBuffer, bufferSize, "Ready");
         
         char info[32];
-        snprintf(info, sizeof(info), " (%lu files)", totalFiles);
+        snprintf(info, sizeof(info), " (%lu files, %lu erased)",
+                 totalFiles, getPreErasedSectors());
         appendString(statusBuffer, bufferSize, info);
     }
     
@@ -553,7 +1447,9 @@ size_t EEPROMStoragePlugin::getMemoryUsage() const {
 }
 
 uint32_t EEPROMStoragePlugin::getJEDECID() {
-    digitalWrite(EEPROM_CS_PIN, LOW);
+    waitForIdle();
+    
+    select();
     sendCommand(CMD_JEDEC_ID);
     
     uint32_t id = 0;
@@ -561,7 +1457,7 @@ uint32_t EEPROMStoragePlugin::getJEDECID() {
     id |= ((uint32_t)SPI.transfer(0x00)) << 8;
     id |= SPI.transfer(0x00);
     
-    digitalWrite(EEPROM_CS_PIN, HIGH);
+    deselect();
     
     return id;
 }
@@ -570,9 +1466,11 @@ void EEPROMStoragePlugin::getFilesystemStats(uint32_t& totalFiles_, uint32_t& de
     totalFiles_ = totalFiles;
     deletedFiles_ = deletedFiles;
     
-    // Calculate fragmentation as percentage of deleted files
-    if (totalFiles + deletedFiles > 0) {
-        fragmentation = (deletedFiles * 100) / (totalFiles + deletedFiles);
+    // Share of free space unusable by one contiguous write
+    uint32_t freeSectors;
+    uint32_t largest = getLargestFreeRun(freeSectors);
+    if (freeSectors > 0) {
+        fragmentation = 100 - (largest * 100) / freeSectors;
     } else {
         fragmentation = 0;
     }
@@ -583,46 +1481,440 @@ void EEPROMStoragePlugin::setDebugEnabled(bool enabled) {
 }
 
 bool EEPROMStoragePlugin::defragment() {
-    // This is a simplified defragmentation - in practice, this would be more complex
-    if (debugEnabled) {
-        Serial.println(F("EEPROMStoragePlugin: Defragmentation not implemented"));
+    if (!compactRequested && debugEnabled) {
+        Serial.println(F("EEPROMStoragePlugin: Compaction scheduled"));
     }
+    compactRequested = true;
+    compactCheck = true;
     return false;
 }
 
+uint32_t EEPROMStoragePlugin::getLargestFreeRun(uint32_t& freeSectors) const {
+    uint32_t largest = 0;
+    uint32_t cursor = DATA_START_SECTOR;
+    freeSectors = 0;
+    
+    while (cursor < DATA_END_SECTOR) {
+        uint32_t runEnd;
+        uint32_t runStart = nextFreeRun(cursor, runEnd);
+        if (runStart >= DATA_END_SECTOR) {
+            break;
+        }
+        
+        freeSectors += runEnd - runStart;
+        if (runEnd - runStart > largest) {
+            largest = runEnd - runStart;
+        }
+        cursor = runEnd;
+    }
+    
+    return largest;
+}
+
+bool EEPROMStoragePlugin::selectRelocation() {
+    uint32_t cursor = DATA_START_SECTOR;
+    
+    while (cursor < DATA_END_SECTOR) {
+        uint32_t holeEnd;
+        uint32_t hole = nextFreeRun(cursor, holeEnd);
+        if (hole >= DATA_END_SECTOR) {
+            break;
+        }
+        
+        int8_t best = -1;
+        for (size_t i = 0; i < MAX_FILES; i++) {
+            if (directory[i].status != STATUS_ACTIVE || directory[i].startSector < holeEnd ||
+                getSectorCount(directory[i].sizeBytes) > holeEnd - hole) {
+                continue;
+            }
+            if (directory[i].startSector == holeEnd) {
+                best = i;
+                break;
+            }
+            if (best < 0 || directory[i].startSector > directory[best].startSector) {
+                best = i;
+            }
+        }
+        
+        if (best >= 0) {
+            relocateSlot = best;
+            relocateTarget = hole;
+            relocateDone = 0;
+            relocateErased = false;
+            return true;
+        }
+        
+        cursor = holeEnd;
+    }
+    
+    return false;
+}
+
+void EEPROMStoragePlugin::stepRelocation() {
+    FileEntry* entry = &directory[relocateSlot];
+    uint32_t sectors = getSectorCount(entry->sizeBytes);
+    
+    if (relocateDone == sectors) {
+        // One record switches the file over and frees the old sectors
+        uint32_t source = entry->startSector;
+        entry->startSector = relocateTarget;
+        if (!logEntry(entry)) {
+            entry->startSector = source;
+            cancelRelocation();
+            return;
+        }
+        logWear();
+        
+        char name[MAX_FILENAME_LENGTH];
+        if (debugEnabled && readName(relocateSlot, name)) {
+            Serial.print(F("EEPROMStoragePlugin: Relocated "));
+            Serial.println(name);
+        }
+        
+        relocateSlot = -1;
+        poolStale = true;
+        compactCheck = true;
+        return;
+    }
+    
+    uint32_t dest = relocateTarget + relocateDone;
+    if (!relocateErased) {
+        if (dest >= poolStart && dest < poolEnd) {
+            poolStart = dest + 1;
+            relocateErased = true;
+        } else {
+            // Copy on a later call, once the erase is done
+            if (startErase(dest)) {
+                backgroundErase = ERASE_RELOCATE;
+            }
+            return;
+        }
+    }
+    
+    // Copy the file's bytes in this sector a page at a time
+    uint32_t offset = relocateDone * EEPROM_SECTOR_SIZE;
+    uint32_t length = min(entry->sizeBytes - offset, (uint32_t)EEPROM_SECTOR_SIZE);
+    uint32_t from = entry->startSector * EEPROM_SECTOR_SIZE + offset;
+    uint32_t to = dest * EEPROM_SECTOR_SIZE;
+    
+    for (uint32_t done = 0; done < length; done += EEPROM_PAGE_SIZE) {
+        size_t chunk = min(length - done, (uint32_t)EEPROM_PAGE_SIZE);
+        if (!readData(from + done, pageBuffer, chunk) ||
+            !writePage(to + done, pageBuffer, chunk)) {
+            cancelRelocation();
+            return;
+        }
+    }
+    
+    relocateDone++;
+    relocateErased = false;
+}
+
+void EEPROMStoragePlugin::cancelRelocation() {
+    relocateSlot = -1;
+    relocateDone = 0;
+    relocateErased = false;
+}
+
 bool EEPROMStoragePlugin::fsck() {
     if (!initialized) {
         return false;
     }
     
     bool hasErrors = false;
+    bool corrupted = false;
     
-    // Check all file entries for validity
+    // Check all file entries for validity, then their data
     for (size_t i = 0; i < MAX_FILES; i++) {
         if (directory[i].status == STATUS_ACTIVE) {
-            if (!validateFileEntry(&directory[i])) {
+            if (!validateFileEntry(i)) {
                 if (debugEnabled) {
-                    Serial.print(F("EEPROMStoragePlugin: Invalid entry: "));
-                    Serial.println(directory[i].filename);
+                    Serial.print(F("EEPROMStoragePlugin: Invalid entry in slot "));
+                    Serial.println(i);
                 }
                 directory[i].status = STATUS_DELETED;
                 hasErrors = true;
+            } else if (!verifyFileData(i)) {
+                // Keep the file: a flipped bit still leaves most of an image
+                if (debugEnabled) {
+                    Serial.print(F("EEPROMStoragePlugin: CRC mismatch in slot "));
+                    Serial.println(i);
+                }
+                corrupted = true;
             }
         }
     }
     
     if (hasErrors) {
+        cancelRelocation();
         saveDirectory();
         loadDirectory(); // Recalculate statistics
     }
     
-    return !hasErrors;
+    return !hasErrors && !corrupted;
 }
 
 void EEPROMStoragePlugin::getWearStats(uint32_t& minEraseCount, uint32_t& maxEraseCount, uint32_t& avgEraseCount) const {
-    // Wear leveling statistics would require tracking erase counts per sector
-    // This is a simplified implementation
-    minEraseCount = 0;
+    // Sector erases per 64KB block
+    uint32_t total = 0;
+    minEraseCount = 0xFFFF;
     maxEraseCount = 0;
-    avgEraseCount = 0;
-}
\ No newline at end of file
+    
+    for (size_t i = 0; i < WEAR_BLOCKS; i++) {
+        uint16_t wear = blockWear[i];
+        if (wear < minEraseCount) {
+            minEraseCount = wear;
+        }
+        if (wear > maxEraseCount) {
+            maxEraseCount = wear;
+        }
+        total += wear;
+    }
+    
+    avgEraseCount = total / WEAR_BLOCKS;
+}
+
+uint32_t EEPROMStoragePlugin::getPreErasedSectors() const {
+    return poolEnd - poolStart;
+}
+
+void EEPROMStoragePlugin::setVerifyReads(bool enabled) {
+    verifyReads = enabled;
+}
+
+bool EEPROMStoragePlugin::isVerifyReads() const {
+    return verifyReads;
+}
+
+bool EEPROMStoragePlugin::isCompacting() const {
+    return relocateSlot >= 0;
+}
+
+#if HARDWARE_BENCHMARK
+bool EEPROMStoragePlugin::pollReady(uint32_t timeoutMs) const {
+    uint32_t startTime = millis();
+    bool ready = false;
+    
+    select();
+    sendCommand(CMD_READ_STATUS1);
+    while (!ready && millis() - startTime < timeoutMs) {
+        ready = (SPI.transfer(0x00) & 0x01) == 0; // WIP bit cleared
+    }
+    deselect();
+    
+    if (ready) {
+        programPending = false;
+    }
+    return ready;
+}
+
+int EEPROMStoragePlugin::benchmark(uint8_t sectors, BenchmarkStat& erase, BenchmarkStat& program,
+                                   BenchmarkStat& read) {
+    if (!initialized) {
+        return STATUS_NOT_INITIALIZED;
+    }
+    
+    // pageBuffer is the relocation copy, and open streams own the cursor
+    if (writeOpen || readOpen || relocateSlot >= 0 || sectors == 0) {
+        return STATUS_BUSY;
+    }
+#if CAPTURE_SPILL
+    if (spillHead != 0) {
+        return STATUS_BUSY;
+    }
+#endif
+    
+    if (!waitForIdle()) {
+        return STATUS_TIMEOUT;
+    }
+    completeBackgroundErase();
+    
+    // Top of the first free run, away from the pool at its start
+    uint32_t first = 0;
+    uint32_t cursor = DATA_START_SECTOR;
+    while (cursor < DATA_END_SECTOR) {
+        uint32_t runEnd;
+        uint32_t runStart = nextFreeRun(cursor, runEnd);
+        if (runStart >= DATA_END_SECTOR) {
+            break;
+        }
+        if (runEnd - runStart >= sectors) {
+            first = runEnd - sectors;
+            break;
+        }
+        cursor = runEnd;
+    }
+    if (first == 0) {
+        return STATUS_ERROR;
+    }
+    
+    int result = STATUS_OK;
+    for (uint32_t sector = first; sector < first + sectors && result == STATUS_OK; sector++) {
+        uint32_t base = sector * EEPROM_SECTOR_SIZE;
+        TaskProfiler::Mark mark;
+        
+        TaskProfiler::start(mark);
+        if (!startErase(sector) || !pollReady(5000)) {
+            result = STATUS_TIMEOUT;
+            break;
+        }
+        erase.record(TaskProfiler::elapsed(mark));
+        
+        for (uint32_t page = 0; page < EEPROM_SECTOR_SIZE && result == STATUS_OK; page += EEPROM_PAGE_SIZE) {
+            for (size_t i = 0; i < EEPROM_PAGE_SIZE; i++) {
+                pageBuffer[i] = (uint8_t)(i + page / EEPROM_PAGE_SIZE + sector);
+            }
+            
+            // tPP is 3ms at most
+            TaskProfiler::start(mark);
+            if (!writePage(base + page, pageBuffer, EEPROM_PAGE_SIZE) || !pollReady(10)) {
+                result = STATUS_TIMEOUT;
+            }
+            program.record(TaskProfiler::elapsed(mark));
+        }
+        
+        for (uint32_t page = 0; page < EEPROM_SECTOR_SIZE && result == STATUS_OK; page += EEPROM_PAGE_SIZE) {
+            TaskProfiler::start(mark);
+            readData(base + page, pageBuffer, EEPROM_PAGE_SIZE);
+            read.record(TaskProfiler::elapsed(mark));
+            
+            for (size_t i = 0; i < EEPROM_PAGE_SIZE; i++) {
+                if (pageBuffer[i] != (uint8_t)(i + page / EEPROM_PAGE_SIZE + sector)) {
+                    result = STATUS_ERROR;
+                    break;
+                }
+            }
+        }
+        
+        // Leave the sector erased for the pool
+        TaskProfiler::start(mark);
+        if (!startErase(sector) || !pollReady(5000)) {
+            result = STATUS_TIMEOUT;
+            break;
+        }
+        erase.record(TaskProfiler::elapsed(mark));
+    }
+    
+    // A sector left programmed must not count as pre-erased
+    if (result != STATUS_OK && first < poolEnd && first + sectors > poolStart) {
+        poolEnd = first > poolStart ? first : poolStart;
+    }
+    
+    clearBuffer(pageBuffer, sizeof(pageBuffer));
+    logWear();
+    
+    if (debugEnabled && result != STATUS_OK) {
+        Serial.print(F("EEPROMStoragePlugin: Benchmark failed on sector run at "));
+        Serial.println(first);
+    }
+    return result;
+}
+#endif
+
+#if CAPTURE_SPILL
+bool EEPROMStoragePlugin::spillRegionFree() const {
+    for (size_t i = 0; i < MAX_FILES; i++) {
+        if (directory[i].status == STATUS_ACTIVE &&
+            directory[i].startSector + getSectorCount(directory[i].sizeBytes) > SPILL_START_SECTOR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EEPROMStoragePlugin::prepareSpill() {
+    uint8_t sector = 0;
+    while (sector < SPILL_SECTORS && (spillErased & (1UL << sector))) {
+        sector++;
+    }
+    if (sector == SPILL_SECTORS || !spillRegionFree()) {
+        return false;
+    }
+    
+    // After boot the region is usually still erased from last time: a
+    // read costs far less than an erase and no wear
+    uint32_t bit = 1UL << sector;
+    if (!(spillChecked & bit)) {
+        spillChecked |= bit;
+        uint32_t address = (SPILL_START_SECTOR + sector) * EEPROM_SECTOR_SIZE;
+        bool blank = true;
+        for (uint32_t offset = 0; blank && offset < EEPROM_SECTOR_SIZE; offset += EEPROM_PAGE_SIZE) {
+            if (!readData(address + offset, pageBuffer, EEPROM_PAGE_SIZE)) {
+                blank = false;
+                break;
+            }
+            for (size_t i = 0; i < EEPROM_PAGE_SIZE; i++) {
+                if (pageBuffer[i] != 0xFF) {
+                    blank = false;
+                    break;
+                }
+            }
+        }
+        if (blank) {
+            spillErased |= bit;
+        }
+        return true;
+    }
+    
+    if (startErase(SPILL_START_SECTOR + sector)) {
+        backgroundErase = ERASE_SPILL;
+        spillEraseSector = sector;
+    }
+    return true;
+}
+
+bool EEPROMStoragePlugin::spillAvailable() const {
+    return initialized && spillHead == 0 && (spillErased & 1) && spillRegionFree();
+}
+
+size_t EEPROMStoragePlugin::spillWrite(const uint8_t* data, size_t size) {
+    if (!initialized || !data || size == 0 || spillHead >= SPILL_SIZE) {
+        return 0;
+    }
+    
+    // Never wait: the caller keeps the bytes and offers them again
+    if (isBusy()) {
+        return 0;
+    }
+    completeBackgroundErase();
+    
+    if (!(spillErased & (1UL << (spillHead / EEPROM_SECTOR_SIZE)))) {
+        return 0;
+    }
+    
+    size_t room = EEPROM_PAGE_SIZE - spillHead % EEPROM_PAGE_SIZE;
+    size_t count = size < room ? size : room;
+    if (!writePage(SPILL_START_SECTOR * EEPROM_SECTOR_SIZE + spillHead, data, count)) {
+        return 0;
+    }
+    
+    spillHead += count;
+    return count;
+}
+
+size_t EEPROMStoragePlugin::spillPeek(uint8_t* data, size_t maxSize) const {
+    uint32_t pending = spillHead - spillTail;
+    size_t count = pending < maxSize ? pending : maxSize;
+    if (count == 0 ||
+        !readData(SPILL_START_SECTOR * EEPROM_SECTOR_SIZE + spillTail, data, count)) {
+        return 0;
+    }
+    return count;
+}
+
+void EEPROMStoragePlugin::spillConsume(size_t size) {
+    uint32_t pending = spillHead - spillTail;
+    spillTail += size < pending ? size : pending;
+}
+
+uint32_t EEPROMStoragePlugin::getSpillPending() const {
+    return spillHead - spillTail;
+}
+
+void EEPROMStoragePlugin::endSpill() {
+    uint32_t used = (spillHead + EEPROM_SECTOR_SIZE - 1) / EEPROM_SECTOR_SIZE;
+    spillErased &= used >= 32 ? 0 : ~((1UL << used) - 1);
+    spillHead = 0;
+    spillTail = 0;
+}
+#endif
@@ -1,9 +1,12 @@
 #include "SDCardStoragePlugin.h"
 #include "MemoryUtils.h"
+#include <SPI.h>
 
 SDCardStoragePlugin::SDCardStoragePlugin() 
     : initialized(false), cardPresent(false), writeProtected(false),
-      debugEnabled(false), cardSize(0), freeSpace(0) {
+      debugEnabled(false), cardSize(0), freeSpace(0), freeSpaceValid(false),
+      lastCardPoll(0), initState(INIT_WAIT_CARD), initStart(0),
+      writeOpen(false), writeSize(0), syncedSize(0), readOpen(false) {
     clearBuffer(pathBuffer, sizeof(pathBuffer));
 }
 
@@ -12,33 +15,17 @@ int SDCardStoragePlugin::initialize() {
         return STATUS_OK;
     }
     
-    // TEMPORARY: Skip SD card initialization to prevent hanging
-    // SD.begin() can cause system hang if SD card hardware not connected properly
-    Serial.println(F("SDCardStoragePlugin: SD card init DISABLED to prevent hang"));
-    Serial.println(F("SDCardStoragePlugin: System will use EEPROM or Serial storage"));
-    cardPresent = false;  // Force SD card as unavailable
-    
-    // TODO: Re-enable SD card initialization once hardware is confirmed working
-    // checkCardStatus();
-    // if (cardPresent && !SD.begin(SD_CS_PIN)) { cardPresent = false; }
-    
-    if (cardPresent) {
-        // Get card information
-        File root = SD.open("/");
-        if (root) {
-            cardSize = root.size(); // This may not work reliably on all cards
-            root.close();
-        }
-        
-        updateFreeSpace();
-        
-        if (debugEnabled) {
-            Serial.print(F("SDCardStoragePlugin: Card initialized, size: "));
-            Serial.print(cardSize / 1024);
-            Serial.println(F("KB"));
-        }
-    }
+    // A blocking SD.begin() here used to hang boot when the card or shield
+    // did not respond. The card is brought up by update() instead, and
+    // SD.begin() only runs once the card has answered a probe.
+    pinMode(SD_CS_PIN, OUTPUT);
+    digitalWrite(SD_CS_PIN, HIGH);   // Keep the card off the shared bus
+    pinMode(SD_DETECT_PIN, INPUT_PULLUP);
+    pinMode(SD_WRITE_PROTECT_PIN, INPUT);
+    SPI.begin();
     
+    cardPresent = false;
+    initState = INIT_WAIT_CARD;
     initialized = true;
     return STATUS_OK;
 }
@@ -47,6 +34,63 @@ bool SDCardStoragePlugin::isReady() const {
     return initialized && cardPresent && !writeProtected;
 }
 
+int SDCardStoragePlugin::update() {
+    if (!initialized) {
+        return STATUS_OK;
+    }
+    
+    bool detected = digitalRead(SD_DETECT_PIN) == LOW; // Active LOW
+    
+    switch (initState) {
+        case INIT_WAIT_CARD:
+            if (detected) {
+                initStart = millis();
+                initState = INIT_SETTLE;
+            }
+            break;
+        
+        case INIT_SETTLE:
+            if (!detected) {
+                initState = INIT_WAIT_CARD;
+            } else if (millis() - initStart >= SD_INIT_SETTLE_MS) {
+                lastCardPoll = millis() - SD_PROBE_INTERVAL;
+                initState = INIT_PROBE;
+            }
+            break;
+        
+        case INIT_PROBE:
+            if (!detected) {
+                initState = INIT_WAIT_CARD;
+            } else if (millis() - lastCardPoll >= SD_PROBE_INTERVAL) {
+                lastCardPoll = millis();
+                if (probeCard()) {
+                    mountCard();
+                } else if (millis() - initStart >= SD_INIT_TIMEOUT) {
+                    Serial.println(F("SDCardStoragePlugin: Card not responding, giving up"));
+                    initState = INIT_FAILED;
+                }
+            }
+            break;
+        
+        case INIT_MOUNTED:
+            // Card status is polled here so reads and writes never touch the pins
+            if (millis() - lastCardPoll >= SD_CARD_POLL_INTERVAL) {
+                lastCardPoll = millis();
+                pollCardStatus();
+            }
+            break;
+        
+        case INIT_FAILED:
+            // Try again once the card has been pulled and reinserted
+            if (!detected) {
+                initState = INIT_WAIT_CARD;
+            }
+            break;
+    }
+    
+    return STATUS_OK;
+}
+
 IStoragePlugin::StorageType SDCardStoragePlugin::getType() const {
     return STORAGE_SD_CARD;
 }
@@ -56,6 +100,9 @@ const __FlashStringHelper* SDCardStoragePlugin::getName() const {
 }
 
 uint32_t SDCardStoragePlugin::getAvailableSpace() const {
+    if (!freeSpaceValid) {
+        updateFreeSpace();
+    }
     return freeSpace;
 }
 
@@ -64,23 +111,112 @@ uint32_t SDCardStoragePlugin::getTotalSpace() const {
 }
 
 void SDCardStoragePlugin::checkCardStatus() {
+    bool wasPresent = cardPresent;
+    bool wasProtected = writeProtected;
+    
     // Check card detect pin
     cardPresent = (digitalRead(SD_DETECT_PIN) == LOW); // Active LOW
     
     // Check write protect pin
     writeProtected = (digitalRead(SD_WRITE_PROTECT_PIN) == HIGH); // Active HIGH
     
-    if (debugEnabled && cardPresent) {
-        Serial.print(F("SDCardStoragePlugin: Card present"));
-        if (writeProtected) {
-            Serial.println(F(" (write protected)"));
+    if (cardPresent == wasPresent && writeProtected == wasProtected) {
+        return;
+    }
+    
+    freeSpaceValid = false;
+    
+    if (debugEnabled) {
+        if (!cardPresent) {
+            Serial.println(F("SDCardStoragePlugin: Card removed"));
         } else {
-            Serial.println();
+            Serial.print(F("SDCardStoragePlugin: Card present"));
+            if (writeProtected) {
+                Serial.println(F(" (write protected)"));
+            } else {
+                Serial.println();
+            }
+        }
+    }
+}
+
+void SDCardStoragePlugin::pollCardStatus() {
+    checkCardStatus();
+    
+    if (!cardPresent) {
+        // Card pulled: the open handles went with it
+        if (writeOpen) {
+            writeHandle.close();
+            writeOpen = false;
         }
+        closeRead();
+        SD.end();
+        cardSize = 0;
+        initState = INIT_WAIT_CARD;
     }
 }
 
-void SDCardStoragePlugin::updateFreeSpace() {
+bool SDCardStoragePlugin::probeCard() {
+    static const uint8_t cmd0[6] = {0x40, 0x00, 0x00, 0x00, 0x00, 0x95};
+    
+    SPI.beginTransaction(SPISettings(SD_PROBE_CLOCK, MSBFIRST, SPI_MODE0));
+    
+    // At least 74 clocks with CS high put the card into native mode
+    digitalWrite(SD_CS_PIN, HIGH);
+    for (uint8_t i = 0; i < 10; i++) {
+        SPI.transfer(0xFF);
+    }
+    
+    digitalWrite(SD_CS_PIN, LOW);
+    for (uint8_t i = 0; i < sizeof(cmd0); i++) {
+        SPI.transfer(cmd0[i]);
+    }
+    
+    // R1 arrives within 8 bytes
+    uint8_t response = 0xFF;
+    for (uint8_t i = 0; i < 8 && response == 0xFF; i++) {
+        response = SPI.transfer(0xFF);
+    }
+    
+    digitalWrite(SD_CS_PIN, HIGH);
+    SPI.transfer(0xFF);
+    SPI.endTransaction();
+    
+    return response == 0x01;
+}
+
+void SDCardStoragePlugin::mountCard() {
+    if (!SD.begin(SD_CS_PIN)) {
+        Serial.println(F("SDCardStoragePlugin: Card init failed"));
+        initState = INIT_FAILED;
+        return;
+    }
+    
+    checkCardStatus();
+    
+    // Get card information
+    File root = SD.open("/");
+    if (root) {
+        cardSize = root.size(); // This may not work reliably on all cards
+        root.close();
+    }
+    
+    freeSpaceValid = false;
+    lastCardPoll = millis();
+    initState = INIT_MOUNTED;
+    
+    Serial.print(F("SDCardStoragePlugin: Card mounted"));
+    if (debugEnabled) {
+        Serial.print(F(", size: "));
+        Serial.print(cardSize / 1024);
+        Serial.print(F("KB"));
+    }
+    Serial.println();
+}
+
+void SDCardStoragePlugin::updateFreeSpace() const {
+    freeSpaceValid = true;
+    
     if (!cardPresent) {
         freeSpace = 0;
         return;
@@ -123,63 +259,109 @@ size_t SDCardStoragePlugin::writeFile(const char* filename, const uint8_t* data,
         return 0;
     }
     
-    // Refresh card status
-    checkCardStatus();
-    if (!cardPresent || writeProtected) {
-        if (debugEnabled) {
-            Serial.println(F("SDCardStoragePlugin: Card not ready for write"));
-        }
+    // Same path as a streaming write: one open and one metadata update
+    if (!openWrite(filename, size)) {
         return 0;
     }
     
-    // Ensure directory structure exists
+    size_t bytesWritten = append(data, size);
+    closeWrite();
+    
+    if (bytesWritten != size && debugEnabled) {
+        Serial.print(F("SDCardStoragePlugin: Partial write: "));
+        Serial.print(bytesWritten);
+        Serial.print(F("/"));
+        Serial.println(size);
+    }
+    
+    return bytesWritten;
+}
+
+bool SDCardStoragePlugin::openWrite(const char* filename, uint32_t sizeHint) {
+    if (!isReady() || !filename || writeOpen) {
+        return false;
+    }
+    
+    // The SD library cannot pre-allocate clusters or count free ones, so
+    // the hint is not checked: a full card shows as a short append()
+    (void)sizeHint;
+    
     if (!ensureDirectoryExists(filename)) {
         if (debugEnabled) {
             Serial.println(F("SDCardStoragePlugin: Failed to create directory"));
         }
-        return 0;
+        return false;
     }
     
-    // Open file for writing
-    File file = SD.open(filename, FILE_WRITE);
-    if (!file) {
+    // FILE_WRITE appends, so replace any previous file explicitly
+    if (SD.exists(filename) && SD.remove(filename)) {
+        freeSpaceValid = false;
+    }
+    
+    writeHandle = SD.open(filename, FILE_WRITE);
+    if (!writeHandle) {
         if (debugEnabled) {
             Serial.print(F("SDCardStoragePlugin: Failed to open file: "));
             Serial.println(filename);
         }
-        return 0;
+        return false;
     }
     
-    // Write data
-    size_t bytesWritten = file.write(data, size);
-    file.close();
-    
-    if (bytesWritten != size && debugEnabled) {
-        Serial.print(F("SDCardStoragePlugin: Partial write: "));
-        Serial.print(bytesWritten);
-        Serial.print(F("/"));
-        Serial.println(size);
+    writeOpen = true;
+    writeSize = 0;
+    syncedSize = 0;
+    return true;
+}
+
+size_t SDCardStoragePlugin::append(const uint8_t* data, size_t size) {
+    if (!writeOpen || !data || size == 0) {
+        return 0;
     }
     
+    size_t bytesWritten = writeHandle.write(data, size);
+    writeSize += bytesWritten;
+    
     // Update free space estimate
-    if (bytesWritten > 0) {
-        freeSpace = (freeSpace > bytesWritten) ? freeSpace - bytesWritten : 0;
+    freeSpace = (freeSpace > bytesWritten) ? freeSpace - bytesWritten : 0;
+    
+    // Commit FAT and directory entry every few blocks rather than per
+    // write, bounding what a power cut can lose
+    if (writeSize - syncedSize >= (uint32_t)SD_SYNC_INTERVAL_BLOCKS * SD_BLOCK_SIZE) {
+        writeHandle.flush();
+        syncedSize = writeSize;
     }
     
     return bytesWritten;
 }
 
-size_t SDCardStoragePlugin::readFile(const char* filename, uint8_t* data, size_t maxSize) {
-    if (!initialized || !cardPresent || !filename || !data || maxSize == 0) {
-        return 0;
+bool SDCardStoragePlugin::closeWrite() {
+    if (!writeOpen) {
+        return false;
     }
     
-    // Refresh card status
-    checkCardStatus();
-    if (!cardPresent) {
-        if (debugEnabled) {
-            Serial.println(F("SDCardStoragePlugin: Card not present"));
-        }
+    writeHandle.close();
+    writeOpen = false;
+    
+    if (debugEnabled) {
+        Serial.print(F("SDCardStoragePlugin: Closed file ("));
+        Serial.print(writeSize);
+        Serial.println(F(" bytes)"));
+    }
+    
+    return writeSize > 0;
+}
+
+bool SDCardStoragePlugin::isWriteOpen() const {
+    return writeOpen;
+}
+
+bool SDCardStoragePlugin::isBusy() const {
+    // SD library writes are synchronous
+    return false;
+}
+
+size_t SDCardStoragePlugin::readFile(const char* filename, uint8_t* data, size_t maxSize) {
+    if (!initialized || !cardPresent || !filename || !data || maxSize == 0) {
         return 0;
     }
     
@@ -200,18 +382,59 @@ size_t SDCardStoragePlugin::readFile(const char* filename, uint8_t* data, size_t
     return bytesRead;
 }
 
-bool SDCardStoragePlugin::deleteFile(const char* filename) {
-    if (!isReady() || !filename) {
+bool SDCardStoragePlugin::openRead(const char* filename) {
+    if (!initialized || !cardPresent || !filename || readOpen) {
         return false;
     }
     
-    // Refresh card status
-    checkCardStatus();
-    if (!cardPresent || writeProtected) {
+    readHandle = SD.open(filename, FILE_READ);
+    if (!readHandle) {
+        if (debugEnabled) {
+            Serial.print(F("SDCardStoragePlugin: Failed to open file: "));
+            Serial.println(filename);
+        }
+        return false;
+    }
+    
+    readOpen = true;
+    return true;
+}
+
+size_t SDCardStoragePlugin::readChunk(uint8_t* data, size_t maxSize) {
+    if (!readOpen || !data || maxSize == 0) {
+        return 0;
+    }
+    
+    int bytesRead = readHandle.read(data, maxSize);
+    return bytesRead > 0 ? (size_t)bytesRead : 0;
+}
+
+bool SDCardStoragePlugin::seekRead(uint32_t offset) {
+    if (!readOpen || offset > readHandle.size()) {
+        return false;
+    }
+    
+    return readHandle.seek(offset);
+}
+
+void SDCardStoragePlugin::closeRead() {
+    if (!readOpen) {
+        return;
+    }
+    
+    readHandle.close();
+    readOpen = false;
+}
+
+bool SDCardStoragePlugin::deleteFile(const char* filename) {
+    if (!isReady() || !filename) {
         return false;
     }
     
     bool result = SD.remove(filename);
+    if (result) {
+        freeSpaceValid = false;
+    }
     
     if (debugEnabled) {
         Serial.print(F("SDCardStoragePlugin: Delete "));
@@ -246,13 +469,14 @@ uint32_t SDCardStoragePlugin::getFileSize(const char* filename) const {
     return size;
 }
 
-size_t SDCardStoragePlugin::listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles) const {
-    return listFilesInDirectory(nullptr, filenames, maxFiles);
+size_t SDCardStoragePlugin::listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles,
+                                      size_t first) const {
+    return listFilesInDirectory(nullptr, filenames, maxFiles, first);
 }
 
 size_t SDCardStoragePlugin::listFilesInDirectory(const char* dirPath, 
                                                 char filenames[][MAX_FILENAME_LENGTH], 
-                                                size_t maxFiles) const {
+                                                size_t maxFiles, size_t first) const {
     if (!initialized || !cardPresent || !filenames || maxFiles == 0) {
         return 0;
     }
@@ -275,8 +499,12 @@ size_t SDCardStoragePlugin::listFilesInDirectory(const char* dirPath,
         if (!entry.isDirectory()) {
             const char* name = entry.name();
             if (name && safeStrlen(name, MAX_FILENAME_LENGTH) < MAX_FILENAME_LENGTH) {
-                safeCopy(filenames[fileCount], MAX_FILENAME_LENGTH, name);
-                fileCount++;
+                if (first > 0) {
+                    first--;
+                } else {
+                    safeCopy(filenames[fileCount], MAX_FILENAME_LENGTH, name);
+                    fileCount++;
+                }
             }
         }
         
@@ -307,7 +535,11 @@ bool SDCardStoragePlugin::getStatus(char* statusBuffer, size_t bufferSize) const
     
     safeCopy(statusBuffer, bufferSize, "SD: ");
     
-    if (!cardPresent) {
+    if (initState == INIT_SETTLE || initState == INIT_PROBE) {
+        appendString(statusBuffer, bufferSize, "Starting");
+    } else if (initState == INIT_FAILED) {
+        appendString(statusBuffer, bufferSize, "Init failed");
+    } else if (!cardPresent) {
         appendString(statusBuffer, bufferSize, "No card");
     } else if (writeProtected) {
         appendString(statusBuffer, bufferSize, "Write protected");
@@ -355,11 +587,12 @@ bool SDCardStoragePlugin::getCardType(char* typeBuffer, size_t bufferSize) const
 }
 
 void SDCardStoragePlugin::refreshCardStatus() {
-    checkCardStatus();
-    
-    if (cardPresent && initialized) {
-        updateFreeSpace();
+    if (initState != INIT_MOUNTED) {
+        return;
     }
+    
+    pollCardStatus();
+    freeSpaceValid = false;
 }
 
 void SDCardStoragePlugin::setDebugEnabled(bool enabled) {
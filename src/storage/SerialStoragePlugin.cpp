@@ -3,10 +3,11 @@
 
 SerialStoragePlugin::SerialStoragePlugin() 
     : initialized(false), debugEnabled(false), transferInProgress(false),
-      totalBytesTransferred(0), totalFilesTransferred(0) {
+      totalBytesTransferred(0), totalFilesTransferred(0), lineFill(0),
+      frameSequence(0), binaryMode(SERIAL_TRANSFER_BINARY != 0),
+      streamAddress(0), streamSizeHint(0) {
     clearBuffer(currentFilename, sizeof(currentFilename));
-    clearBuffer(hexLineBuffer, sizeof(hexLineBuffer));
-    clearBuffer(hexByteBuffer, sizeof(hexByteBuffer));
+    clearBuffer(frame, sizeof(frame));
 }
 
 int SerialStoragePlugin::initialize() {
@@ -33,6 +34,11 @@ bool SerialStoragePlugin::isReady() const {
     return initialized && isSerialReady();
 }
 
+int SerialStoragePlugin::update() {
+    // Streams complete inside the write calls
+    return STATUS_OK;
+}
+
 IStoragePlugin::StorageType SerialStoragePlugin::getType() const {
     return STORAGE_SERIAL;
 }
@@ -95,16 +101,18 @@ void SerialStoragePlugin::sendProtocolHeader(const char* filename, uint32_t file
     Serial.print(F("SIZE:"));
     Serial.print(fileSize);
     Serial.print(PROTOCOL_CRLF);
-    
-    flushSerial();
 }
 
 void SerialStoragePlugin::sendProtocolFooter(const char* filename) {
+    char crcStr[9];
+    snprintf(crcStr, sizeof(crcStr), "%08lX", (unsigned long)streamCrc.get());
+    Serial.print(F("CRC32:"));
+    Serial.print(crcStr);
+    Serial.print(PROTOCOL_CRLF);
+    
     Serial.print(F("END:"));
     Serial.print(filename);
     Serial.print(PROTOCOL_CRLF);
-    
-    flushSerial();
 }
 
 void SerialStoragePlugin::sendHexLine(const uint8_t* data, size_t size, uint32_t address) {
@@ -112,32 +120,41 @@ void SerialStoragePlugin::sendHexLine(const uint8_t* data, size_t size, uint32_t
         return;
     }
     
-    // Clear line buffer
-    clearBuffer(hexLineBuffer, sizeof(hexLineBuffer));
-    
     // Add address prefix (optional, for debugging)
     if (debugEnabled) {
-        char addrStr[10];
+        char addrStr[11];
         snprintf(addrStr, sizeof(addrStr), "%08lX: ", (unsigned long)address);
-        safeCopy(hexLineBuffer, sizeof(hexLineBuffer), addrStr);
+        Serial.print(addrStr);
     }
     
-    // Convert bytes to hex
+    // Convert bytes to hex directly into the serial TX buffer
+    char hexByte[3];
     for (size_t i = 0; i < size; i++) {
-        byteToHex(data[i], hexByteBuffer);
-        appendString(hexLineBuffer, sizeof(hexLineBuffer), hexByteBuffer);
-        
-        // Add space every 8 bytes for readability
-        if ((i + 1) % 8 == 0 && i < size - 1) {
-            appendString(hexLineBuffer, sizeof(hexLineBuffer), " ");
-        }
+        byteToHex(data[i], hexByte);
+        Serial.write((const uint8_t*)hexByte, 2);
     }
     
-    // Send line
-    Serial.print(hexLineBuffer);
     Serial.print(PROTOCOL_CRLF);
 }
 
+void SerialStoragePlugin::sendFrame(uint8_t type, size_t payloadSize) {
+    SerialFrame::send(frame, type, frameSequence++, payloadSize);
+}
+
+void SerialStoragePlugin::sendPending() {
+    if (lineFill == 0) {
+        return;
+    }
+    
+    if (binaryMode) {
+        sendFrame(FRAME_DATA, lineFill);
+    } else {
+        sendHexLine(payload(), lineFill, streamAddress);
+    }
+    streamAddress += lineFill;
+    lineFill = 0;
+}
+
 void SerialStoragePlugin::flushSerial() {
     Serial.flush();
 }
@@ -154,6 +171,95 @@ size_t SerialStoragePlugin::writeFile(const char* filename, const uint8_t* data,
     return streamFile(filename, data, size);
 }
 
+bool SerialStoragePlugin::openWrite(const char* filename, uint32_t sizeHint) {
+    if (!isReady() || !filename || transferInProgress) {
+        return false;
+    }
+    
+    transferInProgress = true;
+    safeCopy(currentFilename, sizeof(currentFilename), filename);
+    lineFill = 0;
+    streamAddress = 0;
+    streamSizeHint = sizeHint;
+    streamCrc.reset();
+    
+    if (binaryMode) {
+        size_t nameLength = safeStrlen(filename, MAX_FILENAME_LENGTH - 1);
+        frameSequence = 0;
+        SerialFrame::putLE32(payload(), sizeHint);
+        memcpy(payload() + 4, filename, nameLength);
+        sendFrame(FRAME_BEGIN, 4 + nameLength);
+    } else if (sizeHint > 0) {
+        // Same header as writeFile(); SIZE: only trails the data if it was wrong
+        sendProtocolHeader(filename, sizeHint);
+    } else {
+        // Size is unknown while streaming; SIZE: trails the data at close
+        Serial.print(F("BEGIN:"));
+        Serial.print(filename);
+        Serial.print(PROTOCOL_CRLF);
+    }
+    
+    return true;
+}
+
+size_t SerialStoragePlugin::append(const uint8_t* data, size_t size) {
+    if (!transferInProgress || !data || size == 0) {
+        return 0;
+    }
+    
+    streamCrc.update(data, size);
+    
+    size_t capacity = binaryMode ? SERIAL_FRAME_PAYLOAD : HEX_BYTES_PER_LINE;
+    for (size_t i = 0; i < size; i++) {
+        payload()[lineFill++] = data[i];
+        
+        if (lineFill == capacity) {
+            sendPending();
+        }
+    }
+    
+    return size;
+}
+
+bool SerialStoragePlugin::closeWrite() {
+    if (!transferInProgress) {
+        return false;
+    }
+    
+    // Flush partial line
+    sendPending();
+    
+    if (binaryMode) {
+        SerialFrame::putLE32(payload(), streamAddress);
+        SerialFrame::putLE32(payload() + 4, streamCrc.get());
+        sendFrame(FRAME_END, 8);
+    } else {
+        if (streamAddress != streamSizeHint) {
+            Serial.print(F("SIZE:"));
+            Serial.print(streamAddress);
+            Serial.print(PROTOCOL_CRLF);
+        }
+        sendProtocolFooter(currentFilename);
+    }
+    
+    totalFilesTransferred++;
+    totalBytesTransferred += streamAddress;
+    
+    transferInProgress = false;
+    clearBuffer(currentFilename, sizeof(currentFilename));
+    
+    return streamAddress > 0;
+}
+
+bool SerialStoragePlugin::isWriteOpen() const {
+    return transferInProgress;
+}
+
+bool SerialStoragePlugin::isBusy() const {
+    // Busy until the UART transmit ring can take another chunk
+    return transferInProgress && (size_t)Serial.availableForWrite() < TX_RESERVE;
+}
+
 size_t SerialStoragePlugin::streamFile(const char* filename, const uint8_t* data, size_t size) {
     if (!isReady() || !filename || !data || size == 0) {
         return 0;
@@ -166,12 +272,23 @@ size_t SerialStoragePlugin::streamFile(const char* filename, const uint8_t* data
         return 0;
     }
     
+    // Packets need no pacing: Serial.write() blocks while the TX buffer is full
+    if (binaryMode) {
+        if (!openWrite(filename, size)) {
+            return 0;
+        }
+        size_t sent = append(data, size);
+        closeWrite();
+        return sent;
+    }
+    
     // Start transfer
     transferInProgress = true;
     safeCopy(currentFilename, sizeof(currentFilename), filename);
     
     // Send protocol header
     sendProtocolHeader(filename, size);
+    streamCrc.reset();
     
     // Send data in hex lines
     const uint8_t* srcData = data;
@@ -183,6 +300,7 @@ size_t SerialStoragePlugin::streamFile(const char* filename, const uint8_t* data
         size_t lineSize = min(remaining, HEX_BYTES_PER_LINE);
         
         sendHexLine(srcData, lineSize, address);
+        streamCrc.update(srcData, lineSize);
         
         srcData += lineSize;
         remaining -= lineSize;
@@ -232,6 +350,22 @@ size_t SerialStoragePlugin::readFile(const char* filename, uint8_t* data, size_t
     return 0;
 }
 
+bool SerialStoragePlugin::openRead(const char* filename) {
+    // Write-only (streaming), nothing to read back
+    return false;
+}
+
+size_t SerialStoragePlugin::readChunk(uint8_t* data, size_t maxSize) {
+    return 0;
+}
+
+bool SerialStoragePlugin::seekRead(uint32_t offset) {
+    return false;
+}
+
+void SerialStoragePlugin::closeRead() {
+}
+
 size_t SerialStoragePlugin::receiveFile(uint8_t* data, size_t maxSize, uint32_t timeoutMs) {
     if (!isReady() || !data || maxSize == 0) {
         return 0;
@@ -255,6 +389,7 @@ size_t SerialStoragePlugin::receiveFile(uint8_t* data, size_t maxSize, uint32_t
                     const char* hexStart = lineBuffer;
                     if (startsWith(lineBuffer, linePos, "BEGIN:") ||
                         startsWith(lineBuffer, linePos, "END:") ||
+                        startsWith(lineBuffer, linePos, "CRC32:") ||
                         startsWith(lineBuffer, linePos, "SIZE:")) {
                         linePos = 0;
                         continue;
@@ -303,7 +438,8 @@ uint32_t SerialStoragePlugin::getFileSize(const char* filename) const {
     return 0;
 }
 
-size_t SerialStoragePlugin::listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles) const {
+size_t SerialStoragePlugin::listFiles(char filenames[][MAX_FILENAME_LENGTH], size_t maxFiles,
+                                      size_t first) const {
     // Serial storage doesn't maintain file listings
     return 0;
 }
@@ -328,7 +464,7 @@ bool SerialStoragePlugin::getStatus(char* statusBuffer, size_t bufferSize) const
     } else if (transferInProgress) {
         appendString(statusBuffer, bufferSize, "Transfer in progress");
     } else {
-        appendString(statusBuffer, bufferSize, "Ready");
+        appendString(statusBuffer, bufferSize, binaryMode ? "Ready (binary)" : "Ready");
     }
     
     return true;
@@ -396,8 +532,6 @@ void SerialStoragePlugin::sendProgressUpdate(const char* filename, uint32_t byte
     Serial.print(percentage);
     Serial.print(F("%)"));
     Serial.print(PROTOCOL_CRLF);
-    
-    flushSerial();
 }
 
 bool SerialStoragePlugin::testProtocol() {
@@ -424,6 +558,18 @@ bool SerialStoragePlugin::testProtocol() {
     return success;
 }
 
+bool SerialStoragePlugin::setBinaryMode(bool enabled) {
+    if (transferInProgress) {
+        return false;
+    }
+    binaryMode = enabled;
+    return true;
+}
+
+bool SerialStoragePlugin::isBinaryMode() const {
+    return binaryMode;
+}
+
 void SerialStoragePlugin::setHexBytesPerLine(size_t bytesPerLine) {
     // This would require modifying the HEX_BYTES_PER_LINE constant
     // For now, just log the request
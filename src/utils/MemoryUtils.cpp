@@ -1,4 +1,5 @@
 #include "MemoryUtils.h"
+#include "HardwareConfig.h"
 #include <string.h>
 #include <ctype.h>
 #include <limits.h>
@@ -283,17 +284,88 @@ void clearBuffer(void* buffer, size_t size) {
     }
 }
 
+#if defined(__AVR__)
 int getAvailableRAM() {
     extern int __heap_start, *__brkval;
     int v;
     return (int) &v - (__brkval == 0 ? (int) &__heap_start : (int) __brkval);
 }
 
+// Fill byte for RAM the stack has not reached yet
+static constexpr uint8_t STACK_CANARY = 0xC5;
+
+extern uint8_t __stack;     // Top of RAM
+
+/**
+ * Get the first byte above the heap
+ * @return __brkval, or the heap start while nothing was allocated
+ */
+static uint8_t* heapEnd() {
+    extern int __heap_start, *__brkval;
+    return (uint8_t*)(__brkval == 0 ? &__heap_start : __brkval);
+}
+
+/**
+ * Paint everything between .bss and the top of RAM with STACK_CANARY
+ * Runs from .init3: the stack pointer is set and nothing is on the stack
+ * yet, and nothing above .bss is live.
+ */
+void paintStack() __attribute__((naked, used, section(".init3")));
+void paintStack() {
+    extern int __heap_start;
+    for (uint8_t* p = (uint8_t*)&__heap_start; p <= &__stack; p++) {
+        *p = STACK_CANARY;
+    }
+}
+
+size_t getUnusedStack() {
+    const uint8_t* p = heapEnd();
+    size_t unused = 0;
+
+    while (p <= &__stack && *p == STACK_CANARY) {
+        p++;
+        unused++;
+    }
+    return unused;
+}
+
+size_t getStackHighWaterMark() {
+    return (size_t)(&__stack - heapEnd()) + 1 - getUnusedStack();
+}
+
+size_t getStaticRAM(size_t& dataBytes, size_t& bssBytes) {
+    extern uint8_t __data_start, __data_end, __bss_start, __bss_end;
+    dataBytes = (size_t)(&__data_end - &__data_start);
+    bssBytes = (size_t)(&__bss_end - &__bss_start);
+    return dataBytes + bssBytes;
+}
+#else
+// Host builds (bench/): no AVR linker symbols, report the design budget
+int getAvailableRAM() {
+    return AVAILABLE_RAM_SIZE;
+}
+
+size_t getUnusedStack() {
+    return 0;
+}
+
+size_t getStackHighWaterMark() {
+    return 0;
+}
+
+size_t getStaticRAM(size_t& dataBytes, size_t& bssBytes) {
+    dataBytes = 0;
+    bssBytes = 0;
+    return 0;
+}
+#endif
+
 bool validateMemory(const void* ptr, size_t size) {
     if (!ptr || size == 0) {
         return false;
     }
     
+#if defined(__AVR__)
     // Basic validation - check if pointer is in reasonable range
     uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
     
@@ -305,6 +377,7 @@ bool validateMemory(const void* ptr, size_t size) {
             return false;
         }
     }
+#endif
     
     return true;
 }
\ No newline at end of file
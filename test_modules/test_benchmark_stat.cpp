@@ -0,0 +1,113 @@
+#include <unity.h>
+#include <stdint.h>
+
+// Exercise the production benchmark statistics directly
+#include "BenchmarkStat.h"
+
+// Test setup/teardown
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// Summary Tests
+// ============================================================================
+
+void test_stat_initially_empty() {
+    BenchmarkStat stat;
+
+    TEST_ASSERT_EQUAL(0, stat.getCount());
+    TEST_ASSERT_EQUAL(0, stat.getMin());
+    TEST_ASSERT_EQUAL(0, stat.getMax());
+    TEST_ASSERT_EQUAL(0, stat.getAverage());
+    TEST_ASSERT_EQUAL(0, stat.getPercentileBound(90));
+}
+
+void test_stat_min_max_average() {
+    BenchmarkStat stat;
+
+    stat.record(40);
+    stat.record(10);
+    stat.record(100);
+
+    TEST_ASSERT_EQUAL(3, stat.getCount());
+    TEST_ASSERT_EQUAL(10, stat.getMin());
+    TEST_ASSERT_EQUAL(100, stat.getMax());
+    TEST_ASSERT_EQUAL(150, stat.getTotal());
+    TEST_ASSERT_EQUAL(50, stat.getAverage());
+}
+
+// ============================================================================
+// Histogram Tests
+// ============================================================================
+
+void test_stat_shift_scales_bins() {
+    BenchmarkStat stat(10);
+
+    // 60000 ticks (30ms) >> 10 = 58, bucket 5
+    stat.record(60000);
+
+    TEST_ASSERT_EQUAL(10, stat.getShift());
+    TEST_ASSERT_EQUAL(1, stat.getHistogram().getCount(5));
+    TEST_ASSERT_EQUAL(60000, stat.getMin());
+}
+
+void test_stat_long_samples_overflow() {
+    BenchmarkStat stat;
+
+    stat.record(0x10000);
+
+    TEST_ASSERT_EQUAL(1, stat.getHistogram().getCount(TIMING_HISTOGRAM_OVERFLOW));
+    TEST_ASSERT_EQUAL(0x10000, stat.getMax());
+    TEST_ASSERT_EQUAL(0x10000, stat.getPercentileBound(100));
+}
+
+void test_stat_percentile_bound() {
+    BenchmarkStat stat;
+
+    for (uint8_t i = 0; i < 9; i++) {
+        stat.record(5);       // bucket 2, ends at 8
+    }
+    stat.record(300);         // bucket 8, ends at 512
+
+    TEST_ASSERT_EQUAL(8, stat.getPercentileBound(90));
+    // The last bucket ends past the longest sample
+    TEST_ASSERT_EQUAL(300, stat.getPercentileBound(100));
+}
+
+void test_stat_percentile_bound_scaled() {
+    BenchmarkStat stat(4);
+
+    stat.record(100);         // 6, bucket 2
+    stat.record(1000);        // 62, bucket 5, ends at 64 << 4
+
+    TEST_ASSERT_EQUAL(8 << 4, stat.getPercentileBound(50));
+    TEST_ASSERT_EQUAL(1000, stat.getPercentileBound(100));
+}
+
+void test_stat_count_saturates() {
+    BenchmarkStat stat;
+
+    for (uint32_t i = 0; i < 70000; i++) {
+        stat.record(2);
+    }
+
+    TEST_ASSERT_EQUAL(0xFFFF, stat.getCount());
+    TEST_ASSERT_EQUAL(140000, stat.getTotal());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Summary
+    RUN_TEST(test_stat_initially_empty);
+    RUN_TEST(test_stat_min_max_average);
+
+    // Histogram
+    RUN_TEST(test_stat_shift_scales_bins);
+    RUN_TEST(test_stat_long_samples_overflow);
+    RUN_TEST(test_stat_percentile_bound);
+    RUN_TEST(test_stat_percentile_bound_scaled);
+    RUN_TEST(test_stat_count_saturates);
+
+    return UNITY_END();
+}
@@ -0,0 +1,79 @@
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+// Exercise the production checksum directly
+#include "Crc32.h"
+
+// Test setup/teardown
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// Checksum Tests
+// ============================================================================
+
+void test_crc32_check_value() {
+    // Standard CRC-32 check value
+    const char* digits = "123456789";
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, Crc32::compute((const uint8_t*)digits, 9));
+}
+
+void test_crc32_empty_input() {
+    Crc32 crc;
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, crc.get());
+
+    crc.update(nullptr, 0);
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, crc.get());
+}
+
+void test_crc32_incremental_matches_single_pass() {
+    uint8_t data[1000];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 31 + (i >> 4));
+    }
+    uint32_t expected = Crc32::compute(data, sizeof(data));
+
+    // Split the way storage appends arrive: uneven chunk sizes
+    static const size_t steps[] = {1, 7, 64, 255};
+    for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+        Crc32 crc;
+        for (size_t pos = 0; pos < sizeof(data); pos += steps[s]) {
+            size_t length = sizeof(data) - pos < steps[s] ? sizeof(data) - pos : steps[s];
+            crc.update(data + pos, length);
+        }
+        TEST_ASSERT_EQUAL_HEX32(expected, crc.get());
+    }
+}
+
+void test_crc32_reset_starts_over() {
+    const uint8_t first[] = {0xDE, 0xAD, 0xBE, 0xEF};
+    const uint8_t second[] = {'B', 'M'};
+
+    Crc32 crc;
+    crc.update(first, sizeof(first));
+    crc.reset();
+    crc.update(second, sizeof(second));
+    TEST_ASSERT_EQUAL_HEX32(Crc32::compute(second, sizeof(second)), crc.get());
+}
+
+void test_crc32_detects_single_bit_flip() {
+    uint8_t data[256];
+    memset(data, 0xFF, sizeof(data));
+    uint32_t clean = Crc32::compute(data, sizeof(data));
+
+    data[100] ^= 0x10;
+    TEST_ASSERT_NOT_EQUAL(clean, Crc32::compute(data, sizeof(data)));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_crc32_check_value);
+    RUN_TEST(test_crc32_empty_input);
+    RUN_TEST(test_crc32_incremental_matches_single_pass);
+    RUN_TEST(test_crc32_reset_starts_over);
+    RUN_TEST(test_crc32_detects_single_bit_flip);
+
+    return UNITY_END();
+}
@@ -0,0 +1,140 @@
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+// Exercise the production calendar arithmetic directly
+#include "DateTime.h"
+
+// Test setup/teardown
+void setUp(void) {}
+void tearDown(void) {}
+
+static DateTime makeTime(uint16_t year, uint8_t month, uint8_t day,
+                         uint8_t hour, uint8_t minute, uint8_t second) {
+    DateTime time;
+    time.year = year;
+    time.month = month;
+    time.day = day;
+    time.hour = hour;
+    time.minute = minute;
+    time.second = second;
+    return time;
+}
+
+// ============================================================================
+// Calendar Tests
+// ============================================================================
+
+void test_datetime_days_in_month() {
+    const uint8_t expected[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    for (uint8_t month = 1; month <= 12; month++) {
+        TEST_ASSERT_EQUAL(expected[month - 1], DateTime::daysInMonth(2023, month));
+    }
+    TEST_ASSERT_EQUAL(29, DateTime::daysInMonth(2024, 2));
+    TEST_ASSERT_EQUAL(29, DateTime::daysInMonth(2000, 2));
+}
+
+void test_datetime_validation() {
+    TEST_ASSERT_TRUE(makeTime(2024, 2, 29, 23, 59, 59).isValid());
+    TEST_ASSERT_FALSE(makeTime(2023, 2, 29, 0, 0, 0).isValid());
+    TEST_ASSERT_FALSE(makeTime(1999, 12, 31, 0, 0, 0).isValid());
+    TEST_ASSERT_FALSE(makeTime(2100, 1, 1, 0, 0, 0).isValid());
+    TEST_ASSERT_FALSE(makeTime(2024, 13, 1, 0, 0, 0).isValid());
+    TEST_ASSERT_FALSE(makeTime(2024, 4, 31, 0, 0, 0).isValid());
+    TEST_ASSERT_FALSE(makeTime(2024, 1, 1, 24, 0, 0).isValid());
+}
+
+// ============================================================================
+// Seconds Conversion Tests
+// ============================================================================
+
+void test_datetime_epoch_is_zero() {
+    TEST_ASSERT_EQUAL_UINT32(0, makeTime(2000, 1, 1, 0, 0, 0).toSeconds());
+}
+
+void test_datetime_known_values() {
+    // 2000 is a leap year: 366 days
+    TEST_ASSERT_EQUAL_UINT32(366UL * 86400, makeTime(2001, 1, 1, 0, 0, 0).toSeconds());
+    // 2024-03-01 12:34:56 (8826 days after the epoch)
+    TEST_ASSERT_EQUAL_UINT32(8826UL * 86400 + 45296,
+                             makeTime(2024, 3, 1, 12, 34, 56).toSeconds());
+}
+
+void test_datetime_round_trip() {
+    // Every day of 2000-2099 survives the round trip
+    uint32_t seconds = 0;
+    for (uint32_t day = 0; day < 36525; day++, seconds += 86400) {
+        DateTime time = DateTime::fromSeconds(seconds + 3723);
+        TEST_ASSERT_TRUE(time.isValid());
+        TEST_ASSERT_EQUAL_UINT32(seconds + 3723, time.toSeconds());
+    }
+
+    DateTime last = DateTime::fromSeconds(makeTime(2099, 12, 31, 23, 59, 59).toSeconds());
+    TEST_ASSERT_EQUAL(2099, last.year);
+    TEST_ASSERT_EQUAL(12, last.month);
+    TEST_ASSERT_EQUAL(31, last.day);
+}
+
+// ============================================================================
+// Formatting and Parsing Tests
+// ============================================================================
+
+void test_datetime_format() {
+    char text[DATETIME_TEXT_LENGTH + 1];
+    makeTime(2024, 3, 1, 9, 5, 7).format(text);
+    TEST_ASSERT_EQUAL_STRING("2024-03-01 09:05:07", text);
+}
+
+void test_datetime_format_stamp() {
+    char stamp[DATETIME_STAMP_LENGTH + 1];
+    makeTime(2024, 3, 1, 9, 5, 7).formatStamp(stamp);
+    TEST_ASSERT_EQUAL_STRING("01090507", stamp);
+    TEST_ASSERT_EQUAL(DATETIME_STAMP_LENGTH, strlen(stamp));
+}
+
+void test_datetime_parse() {
+    DateTime time;
+    TEST_ASSERT_TRUE(DateTime::parse("2024-02-29 23:59:58", time));
+    TEST_ASSERT_EQUAL(2024, time.year);
+    TEST_ASSERT_EQUAL(2, time.month);
+    TEST_ASSERT_EQUAL(29, time.day);
+    TEST_ASSERT_EQUAL(23, time.hour);
+    TEST_ASSERT_EQUAL(59, time.minute);
+    TEST_ASSERT_EQUAL(58, time.second);
+}
+
+void test_datetime_parse_rejects_bad_text() {
+    DateTime time;
+    TEST_ASSERT_FALSE(DateTime::parse(nullptr, time));
+    TEST_ASSERT_FALSE(DateTime::parse("", time));
+    TEST_ASSERT_FALSE(DateTime::parse("2024-02-29", time));
+    TEST_ASSERT_FALSE(DateTime::parse("2024/02/29 23:59:58", time));
+    TEST_ASSERT_FALSE(DateTime::parse("2024-02-29 23:59:58x", time));
+    TEST_ASSERT_FALSE(DateTime::parse("2023-02-29 23:59:58", time));
+    TEST_ASSERT_FALSE(DateTime::parse("2024-02-29 23:60:00", time));
+}
+
+void test_datetime_bcd() {
+    TEST_ASSERT_EQUAL_HEX8(0x59, DateTime::toBcd(59));
+    TEST_ASSERT_EQUAL(59, DateTime::fromBcd(0x59));
+    for (uint8_t value = 0; value < 100; value++) {
+        TEST_ASSERT_EQUAL(value, DateTime::fromBcd(DateTime::toBcd(value)));
+    }
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_datetime_days_in_month);
+    RUN_TEST(test_datetime_validation);
+    RUN_TEST(test_datetime_epoch_is_zero);
+    RUN_TEST(test_datetime_known_values);
+    RUN_TEST(test_datetime_round_trip);
+    RUN_TEST(test_datetime_format);
+    RUN_TEST(test_datetime_format_stamp);
+    RUN_TEST(test_datetime_parse);
+    RUN_TEST(test_datetime_parse_rejects_bad_text);
+    RUN_TEST(test_datetime_bcd);
+
+    return UNITY_END();
+}
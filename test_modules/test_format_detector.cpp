@@ -0,0 +1,167 @@
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+// Exercise the production detector directly
+#include "FormatDetector.h"
+
+// Test setup/teardown
+void setUp(void) {}
+void tearDown(void) {}
+
+// Build a 34-byte BMP header with the given file size and compression
+static void makeBmpHeader(uint8_t* header, uint32_t fileSize, uint32_t compression) {
+    memset(header, 0, FORMAT_DETECT_WINDOW);
+    header[0] = 'B';
+    header[1] = 'M';
+    for (uint8_t i = 0; i < 4; i++) {
+        header[2 + i] = (uint8_t)(fileSize >> (8 * i));
+        header[30 + i] = (uint8_t)(compression >> (8 * i));
+    }
+}
+
+// ============================================================================
+// Signature Tests
+// ============================================================================
+
+void test_detector_bmp_with_declared_size() {
+    FormatDetector detector;
+    uint8_t header[FORMAT_DETECT_WINDOW];
+    makeBmpHeader(header, 38462, 0);
+
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_BMP, detector.feed(header, sizeof(header)));
+    TEST_ASSERT_EQUAL(38462, detector.getDeclaredSize());
+    TEST_ASSERT_EQUAL_STRING(".BMP", detector.getExtension());
+    TEST_ASSERT_FALSE(detector.isCompressed());
+}
+
+void test_detector_rle_bitmap() {
+    FormatDetector detector;
+    uint8_t header[FORMAT_DETECT_WINDOW];
+    makeBmpHeader(header, 4000, 1);
+
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_RLE, detector.feed(header, sizeof(header)));
+    TEST_ASSERT_TRUE(detector.isCompressed());
+    TEST_ASSERT_EQUAL_STRING(".RLE", detector.getExtension());
+}
+
+void test_detector_pcx() {
+    FormatDetector detector;
+    const uint8_t header[] = {0x0A, 0x05, 0x01, 0x08};
+
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_PCX, detector.feed(header, sizeof(header)));
+    TEST_ASSERT_TRUE(detector.isCompressed());
+}
+
+void test_detector_tiff_both_byte_orders() {
+    FormatDetector little;
+    FormatDetector big;
+    const uint8_t ii[] = {'I', 'I', 0x2A, 0x00};
+    const uint8_t mm[] = {'M', 'M', 0x00, 0x2A};
+
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_TIFF, little.feed(ii, sizeof(ii)));
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_TIFF, big.feed(mm, sizeof(mm)));
+    TEST_ASSERT_EQUAL_STRING(".TIF", big.getExtension());
+}
+
+void test_detector_eps() {
+    FormatDetector text;
+    FormatDetector binary;
+    const uint8_t ps[] = "%!PS-Adobe-3.0 EPSF-3.0";
+    const uint8_t dos[] = {0xC5, 0xD0, 0xD3, 0xC6};
+
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_EPS, text.feed(ps, sizeof(ps) - 1));
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_EPS, binary.feed(dos, sizeof(dos)));
+}
+
+void test_detector_printer_escape_streams() {
+    FormatDetector epson;
+    FormatDetector hp;
+    const uint8_t escp[] = {0x1B, '@', 0x1B, '*'};
+    const uint8_t pcl[] = {0x1B, 'E', 0x1B, '&'};
+
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_ESCP, epson.feed(escp, sizeof(escp)));
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_PCL, hp.feed(pcl, sizeof(pcl)));
+    TEST_ASSERT_EQUAL_STRING(".PRN", epson.getExtension());
+    TEST_ASSERT_EQUAL_STRING(".PCL", hp.getExtension());
+}
+
+void test_detector_unknown_data() {
+    FormatDetector detector;
+    const uint8_t data[] = {0x00, 0x11, 0x22, 0x33};
+
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_UNKNOWN, detector.feed(data, sizeof(data)));
+    TEST_ASSERT_EQUAL_STRING(".BIN", detector.getExtension());
+}
+
+// ============================================================================
+// Streaming Tests
+// ============================================================================
+
+void test_detector_byte_at_a_time() {
+    FormatDetector detector;
+    uint8_t header[FORMAT_DETECT_WINDOW];
+    makeBmpHeader(header, 1234, 2);
+
+    // Stays pending until the compression field has been seen
+    for (uint8_t i = 0; i < FORMAT_DETECT_WINDOW - 1; i++) {
+        TEST_ASSERT_EQUAL(FormatDetector::FORMAT_PENDING, detector.feed(&header[i], 1));
+    }
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_RLE, detector.feed(&header[FORMAT_DETECT_WINDOW - 1], 1));
+    TEST_ASSERT_EQUAL(1234, detector.getDeclaredSize());
+}
+
+void test_detector_decision_is_sticky() {
+    FormatDetector detector;
+    const uint8_t pcl[] = {0x1B, 'E'};
+    const uint8_t bmp[] = {'B', 'M'};
+
+    detector.feed(pcl, sizeof(pcl));
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_PCL, detector.feed(bmp, sizeof(bmp)));
+}
+
+void test_detector_finish_short_session() {
+    FormatDetector tiny;
+    FormatDetector shortBmp;
+    const uint8_t one[] = {0x42};
+    const uint8_t bm[] = {'B', 'M', 0x10, 0x00, 0x00, 0x00};
+
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_PENDING, tiny.feed(one, sizeof(one)));
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_UNKNOWN, tiny.finish());
+
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_PENDING, shortBmp.feed(bm, sizeof(bm)));
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_BMP, shortBmp.finish());
+    TEST_ASSERT_EQUAL(16, shortBmp.getDeclaredSize());
+}
+
+void test_detector_reset() {
+    FormatDetector detector;
+    const uint8_t pcl[] = {0x1B, 'E'};
+    const uint8_t tiff[] = {'I', 'I', 0x2A, 0x00};
+
+    detector.feed(pcl, sizeof(pcl));
+    detector.reset();
+    TEST_ASSERT_FALSE(detector.isDecided());
+    TEST_ASSERT_EQUAL(FormatDetector::FORMAT_TIFF, detector.feed(tiff, sizeof(tiff)));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Signature tests
+    RUN_TEST(test_detector_bmp_with_declared_size);
+    RUN_TEST(test_detector_rle_bitmap);
+    RUN_TEST(test_detector_pcx);
+    RUN_TEST(test_detector_tiff_both_byte_orders);
+    RUN_TEST(test_detector_eps);
+    RUN_TEST(test_detector_printer_escape_streams);
+    RUN_TEST(test_detector_unknown_data);
+
+    // Streaming tests
+    RUN_TEST(test_detector_byte_at_a_time);
+    RUN_TEST(test_detector_decision_is_sticky);
+    RUN_TEST(test_detector_finish_short_session);
+    RUN_TEST(test_detector_reset);
+
+    return UNITY_END();
+}
@@ -0,0 +1,223 @@
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+// Exercise the production renderer directly
+#include "LcdFrameBuffer.h"
+
+typedef LcdFrameBuffer<16, 2> Frame;
+
+// Records what the frame sends, like a 16x2 HD44780
+class FakeLcd {
+public:
+    char screen[2][16];
+    uint8_t col;
+    uint8_t row;
+    uint16_t cursorMoves;
+    uint16_t writes;
+
+    FakeLcd() : col(0), row(0), cursorMoves(0), writes(0) {
+        memset(screen, ' ', sizeof(screen));
+    }
+
+    void setCursor(uint8_t c, uint8_t r) {
+        col = c;
+        row = r;
+        cursorMoves++;
+    }
+
+    size_t write(uint8_t value) {
+        if (col < 16) {
+            screen[row][col] = (char)value;
+        }
+        col++;
+        writes++;
+        return 1;
+    }
+
+    bool rowEquals(uint8_t r, const char* text) const {
+        return memcmp(screen[r], text, 16) == 0;
+    }
+};
+
+static void flushAll(Frame& frame, FakeLcd& lcd) {
+    while (frame.isDirty()) {
+        frame.flush(lcd, 0xFF);
+    }
+}
+
+// Test setup/teardown
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// Frame Content Tests
+// ============================================================================
+
+void test_frame_starts_blank_and_clean() {
+    Frame frame;
+    TEST_ASSERT_FALSE(frame.isDirty());
+    TEST_ASSERT_EQUAL(' ', frame.get(0, 0));
+    TEST_ASSERT_EQUAL(' ', frame.get(1, 15));
+}
+
+void test_frame_unchanged_cells_stay_clean() {
+    Frame frame;
+    frame.put(0, 3, ' ');
+    frame.putText(1, 0, nullptr);
+    TEST_ASSERT_FALSE(frame.isDirty());
+
+    frame.put(0, 3, 'x');
+    frame.put(0, 3, 'x');
+    TEST_ASSERT_EQUAL(1, frame.getDirtyCount());
+}
+
+void test_frame_put_text_pads_and_clips() {
+    Frame frame;
+    TEST_ASSERT_EQUAL(5, frame.putText(0, 0, "Ready"));
+    TEST_ASSERT_EQUAL(5, frame.getDirtyCount());
+
+    // Padding overwrites older text
+    frame.putText(0, 0, "ABCDEFGHIJKLMNOPQRS");
+    TEST_ASSERT_EQUAL('P', frame.get(0, 15));
+    frame.putText(0, 0, "Hi");
+    TEST_ASSERT_EQUAL('H', frame.get(0, 0));
+    TEST_ASSERT_EQUAL(' ', frame.get(0, 2));
+    TEST_ASSERT_EQUAL(' ', frame.get(0, 15));
+
+    // Field width and row end limit the write
+    frame.putText(1, 12, "123456", 10);
+    TEST_ASSERT_EQUAL('4', frame.get(1, 15));
+    TEST_ASSERT_EQUAL(' ', frame.get(1, 11));
+}
+
+void test_frame_ignores_off_screen_cells() {
+    Frame frame;
+    frame.put(2, 0, 'x');
+    frame.put(0, 16, 'x');
+    TEST_ASSERT_FALSE(frame.isDirty());
+}
+
+// ============================================================================
+// Flush Tests
+// ============================================================================
+
+void test_flush_sends_only_changed_cells() {
+    Frame frame;
+    FakeLcd lcd;
+    frame.putText(0, 0, "Saved: 01020304");
+    flushAll(frame, lcd);
+    TEST_ASSERT_TRUE(lcd.rowEquals(0, "Saved: 01020304 "));
+
+    // One character differs: one cursor move and one write
+    lcd.cursorMoves = 0;
+    lcd.writes = 0;
+    frame.putText(0, 0, "Saved: 01020305");
+    flushAll(frame, lcd);
+    TEST_ASSERT_EQUAL(1, lcd.cursorMoves);
+    TEST_ASSERT_EQUAL(1, lcd.writes);
+    TEST_ASSERT_TRUE(lcd.rowEquals(0, "Saved: 01020305 "));
+}
+
+void test_flush_respects_budget() {
+    Frame frame;
+    FakeLcd lcd;
+    frame.putText(0, 0, "MegaDeviceBridge");
+    frame.putText(1, 0, "Initializing....");
+
+    // Cursor move + 3 characters
+    TEST_ASSERT_EQUAL(4, frame.flush(lcd, 4));
+    TEST_ASSERT_EQUAL(3, lcd.writes);
+    TEST_ASSERT_EQUAL(29, frame.getDirtyCount());
+
+    // A budget too small for a cursor move and a character sends nothing
+    Frame other;
+    FakeLcd idle;
+    other.put(1, 5, 'x');
+    TEST_ASSERT_EQUAL(0, other.flush(idle, 1));
+    TEST_ASSERT_TRUE(other.isDirty());
+
+    uint16_t ticks = 1;
+    while (frame.isDirty()) {
+        TEST_ASSERT_TRUE(frame.flush(lcd, 4) <= 4);
+        ticks++;
+    }
+    TEST_ASSERT_TRUE(lcd.rowEquals(0, "MegaDeviceBridge"));
+    TEST_ASSERT_TRUE(lcd.rowEquals(1, "Initializing...."));
+
+    // Two rows, one cursor move each: 34 operations in 4-operation ticks
+    TEST_ASSERT_EQUAL(2, lcd.cursorMoves);
+    TEST_ASSERT_EQUAL(9, ticks);
+}
+
+void test_flush_moves_cursor_past_gaps_and_row_end() {
+    Frame frame;
+    FakeLcd lcd;
+    frame.put(0, 14, 'a');
+    frame.put(0, 15, 'b');
+    frame.put(1, 0, 'c');
+    frame.put(1, 5, 'd');
+    flushAll(frame, lcd);
+
+    // Row 0 run, then a move for row 1 (the LCD does not wrap) and the gap
+    TEST_ASSERT_EQUAL(3, lcd.cursorMoves);
+    TEST_ASSERT_EQUAL(4, lcd.writes);
+    TEST_ASSERT_EQUAL('d', lcd.screen[1][5]);
+}
+
+void test_flush_custom_characters() {
+    Frame frame;
+    FakeLcd lcd;
+    frame.put(1, 8, (char)0);
+    frame.put(1, 9, (char)5);
+    flushAll(frame, lcd);
+    TEST_ASSERT_EQUAL(0, lcd.screen[1][8]);
+    TEST_ASSERT_EQUAL(5, lcd.screen[1][9]);
+}
+
+void test_invalidate_resends_everything() {
+    Frame frame;
+    FakeLcd lcd;
+    frame.putText(0, 0, "Ready");
+    flushAll(frame, lcd);
+
+    frame.invalidate();
+    TEST_ASSERT_EQUAL(Frame::CELLS, frame.getDirtyCount());
+
+    lcd.cursorMoves = 0;
+    lcd.writes = 0;
+    flushAll(frame, lcd);
+    TEST_ASSERT_EQUAL(32, lcd.writes);
+    TEST_ASSERT_EQUAL(2, lcd.cursorMoves);
+}
+
+void test_invalidate_cursor_forces_move() {
+    Frame frame;
+    FakeLcd lcd;
+    frame.put(0, 0, 'a');
+    flushAll(frame, lcd);
+
+    // Next cell would follow on, but the cursor was moved elsewhere
+    frame.invalidateCursor();
+    frame.put(0, 1, 'b');
+    lcd.cursorMoves = 0;
+    flushAll(frame, lcd);
+    TEST_ASSERT_EQUAL(1, lcd.cursorMoves);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_frame_starts_blank_and_clean);
+    RUN_TEST(test_frame_unchanged_cells_stay_clean);
+    RUN_TEST(test_frame_put_text_pads_and_clips);
+    RUN_TEST(test_frame_ignores_off_screen_cells);
+    RUN_TEST(test_flush_sends_only_changed_cells);
+    RUN_TEST(test_flush_respects_budget);
+    RUN_TEST(test_flush_moves_cursor_past_gaps_and_row_end);
+    RUN_TEST(test_flush_custom_characters);
+    RUN_TEST(test_invalidate_resends_everything);
+    RUN_TEST(test_invalidate_cursor_forces_move);
+
+    return UNITY_END();
+}
@@ -0,0 +1,123 @@
+#include <unity.h>
+#include <stdint.h>
+
+// Exercise the production sequencer directly
+#include "LedPattern.h"
+
+static const uint8_t blinkPattern[] PROGMEM = {
+    LED_ON | 2, LED_OFF | 1,
+    0
+};
+
+static const uint8_t emptyPattern[] PROGMEM = {
+    0
+};
+
+static const uint32_t UNIT = LedPatternPlayer::UNIT_MS;
+
+// Test setup/teardown
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// Playback Tests
+// ============================================================================
+
+void test_player_starts_stopped() {
+    LedPatternPlayer player;
+    TEST_ASSERT_FALSE(player.isActive());
+    TEST_ASSERT_FALSE(player.isOn());
+    TEST_ASSERT_FALSE(player.update(1000));
+}
+
+void test_player_holds_each_step_for_its_duration() {
+    LedPatternPlayer player;
+    player.start(blinkPattern, true, 0);
+    TEST_ASSERT_TRUE(player.update(0));
+    TEST_ASSERT_TRUE(player.update(UNIT));
+    TEST_ASSERT_TRUE(player.update(2 * UNIT - 1));
+    TEST_ASSERT_FALSE(player.update(2 * UNIT));
+    TEST_ASSERT_FALSE(player.update(3 * UNIT - 1));
+}
+
+void test_player_loops_in_phase() {
+    LedPatternPlayer player;
+    player.start(blinkPattern, true, 0);
+
+    // Driven once per unit, the way the LED task runs it
+    uint8_t onCount = 0;
+    for (uint32_t tick = 0; tick < 30; tick++) {
+        if (player.update(tick * UNIT)) {
+            onCount++;
+        }
+    }
+    TEST_ASSERT_TRUE(player.isActive());
+    TEST_ASSERT_EQUAL(20, onCount);
+
+    // Tick 30 starts the 11th cycle on time
+    TEST_ASSERT_TRUE(player.update(30 * UNIT));
+}
+
+void test_player_one_shot_ends() {
+    LedPatternPlayer player;
+    player.start(blinkPattern, false, 0);
+    player.update(2 * UNIT);
+    TEST_ASSERT_TRUE(player.isActive());
+    TEST_ASSERT_FALSE(player.update(3 * UNIT));
+    TEST_ASSERT_FALSE(player.isActive());
+}
+
+void test_player_resyncs_after_a_stall() {
+    LedPatternPlayer player;
+    player.start(blinkPattern, true, 0);
+
+    // One step per update, and a late step restarts the clock
+    TEST_ASSERT_FALSE(player.update(10 * UNIT));
+    TEST_ASSERT_FALSE(player.update(11 * UNIT - 1));
+    TEST_ASSERT_TRUE(player.update(11 * UNIT));
+}
+
+void test_player_keeps_phase_when_slightly_late() {
+    LedPatternPlayer player;
+    player.start(blinkPattern, true, 0);
+
+    // Less than a unit late: the next step still ends on the grid
+    TEST_ASSERT_FALSE(player.update(2 * UNIT + UNIT / 2));
+    TEST_ASSERT_TRUE(player.update(3 * UNIT));
+}
+
+void test_player_rejects_empty_pattern() {
+    LedPatternPlayer player;
+    player.start(emptyPattern, true, 0);
+    TEST_ASSERT_FALSE(player.isActive());
+    player.start(nullptr, true, 0);
+    TEST_ASSERT_FALSE(player.isActive());
+}
+
+void test_player_stop_and_restart() {
+    LedPatternPlayer player;
+    player.start(blinkPattern, true, 0);
+    player.update(2 * UNIT);
+    player.stop();
+    TEST_ASSERT_FALSE(player.isActive());
+    TEST_ASSERT_FALSE(player.update(3 * UNIT));
+
+    // Restart begins at the first step
+    player.start(blinkPattern, true, 5 * UNIT);
+    TEST_ASSERT_TRUE(player.update(5 * UNIT));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_player_starts_stopped);
+    RUN_TEST(test_player_holds_each_step_for_its_duration);
+    RUN_TEST(test_player_loops_in_phase);
+    RUN_TEST(test_player_one_shot_ends);
+    RUN_TEST(test_player_resyncs_after_a_stall);
+    RUN_TEST(test_player_keeps_phase_when_slightly_late);
+    RUN_TEST(test_player_rejects_empty_pattern);
+    RUN_TEST(test_player_stop_and_restart);
+
+    return UNITY_END();
+}
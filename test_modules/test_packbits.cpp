@@ -0,0 +1,177 @@
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+// Exercise the production codec directly
+#include "PackBits.h"
+
+// Test setup/teardown
+void setUp(void) {}
+void tearDown(void) {}
+
+// Collects encoder output
+struct BufferSink {
+    uint8_t data[2048];
+    size_t length;
+    size_t maxEmit;             // Largest output of a single feed()
+    size_t mark;
+
+    BufferSink() : data(), length(0), maxEmit(0), mark(0) {}
+    void put(uint8_t value) { data[length++] = value; }
+    void begin() { mark = length; }
+    void end() {
+        if (length - mark > maxEmit) {
+            maxEmit = length - mark;
+        }
+    }
+};
+
+static size_t encode(const uint8_t* input, size_t size, BufferSink& sink) {
+    PackBitsEncoder encoder;
+    for (size_t i = 0; i < size; i++) {
+        sink.begin();
+        encoder.feed(input[i], sink);
+        sink.end();
+    }
+    sink.begin();
+    encoder.finish(sink);
+    sink.end();
+    return sink.length;
+}
+
+// Decode with input and output split into pieces of the given sizes
+static size_t decode(const uint8_t* packed, size_t size, uint8_t* out, size_t outSize,
+                     size_t inStep, size_t outStep) {
+    PackBitsDecoder decoder;
+    size_t pos = 0;
+    size_t produced = 0;
+
+    while (produced < outSize) {
+        size_t inLength = size - pos < inStep ? size - pos : inStep;
+        size_t outLength = outSize - produced < outStep ? outSize - produced : outStep;
+        size_t used;
+        size_t made = decoder.decode(packed + pos, inLength, used, out + produced, outLength);
+        pos += used;
+        produced += made;
+        if (made == 0 && used == 0) {
+            break;
+        }
+    }
+    return produced;
+}
+
+static void assertRoundTrip(const uint8_t* input, size_t size) {
+    BufferSink sink;
+    size_t packedSize = encode(input, size, sink);
+    TEST_ASSERT_TRUE(sink.maxEmit <= PACKBITS_MAX_EMIT);
+
+    static const size_t steps[][2] = {{2048, 2048}, {1, 1}, {1, 64}, {7, 3}};
+    for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+        uint8_t output[2048];
+        memset(output, 0xEE, sizeof(output));
+        size_t outSize = decode(sink.data, packedSize, output, sizeof(output),
+                                steps[s][0], steps[s][1]);
+        TEST_ASSERT_EQUAL(size, outSize);
+        TEST_ASSERT_EQUAL_MEMORY(input, output, size);
+    }
+}
+
+// ============================================================================
+// Encoding Tests
+// ============================================================================
+
+void test_packbits_flat_background_collapses() {
+    uint8_t input[1024];
+    memset(input, 0xFF, sizeof(input));
+
+    BufferSink sink;
+    // 1024 = 8 runs of 128, two bytes each
+    TEST_ASSERT_EQUAL(16, encode(input, sizeof(input), sink));
+    TEST_ASSERT_EQUAL_HEX8(0x81, sink.data[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, sink.data[1]);
+    assertRoundTrip(input, sizeof(input));
+}
+
+void test_packbits_literal_overhead_is_bounded() {
+    uint8_t input[1000];
+    for (size_t i = 0; i < sizeof(input); i++) {
+        input[i] = (uint8_t)(i * 7 + (i >> 3));
+    }
+
+    BufferSink sink;
+    size_t packedSize = encode(input, sizeof(input), sink);
+    TEST_ASSERT_TRUE(packedSize <= sizeof(input) + (sizeof(input) + 127) / 128);
+    assertRoundTrip(input, sizeof(input));
+}
+
+void test_packbits_short_repeats_stay_literal() {
+    const uint8_t input[] = {1, 2, 2, 3, 4, 4, 5};
+
+    BufferSink sink;
+    TEST_ASSERT_EQUAL(sizeof(input) + 1, encode(input, sizeof(input), sink));
+    TEST_ASSERT_EQUAL_HEX8(sizeof(input) - 1, sink.data[0]);
+    assertRoundTrip(input, sizeof(input));
+}
+
+void test_packbits_mixed_scanlines() {
+    // Scope-like rows: background, a trace, a grid dot
+    uint8_t input[1200];
+    for (size_t row = 0; row < 10; row++) {
+        uint8_t* line = &input[row * 120];
+        memset(line, 0x00, 120);
+        line[row * 3] = 0x5A;
+        line[row * 3 + 1] = 0xA5;
+        line[60] = 0x11;
+        line[61] = 0x11;
+        line[62] = 0x11;
+    }
+
+    BufferSink sink;
+    TEST_ASSERT_TRUE(encode(input, sizeof(input), sink) < sizeof(input) / 4);
+    assertRoundTrip(input, sizeof(input));
+}
+
+void test_packbits_empty_and_single_byte() {
+    BufferSink sink;
+    TEST_ASSERT_EQUAL(0, encode(nullptr, 0, sink));
+
+    const uint8_t one[] = {0x42};
+    assertRoundTrip(one, sizeof(one));
+}
+
+// ============================================================================
+// Decoding Tests
+// ============================================================================
+
+void test_packbits_decoder_skips_noop() {
+    const uint8_t packed[] = {0x80, 0x01, 'A', 'B', 0xFE, 'C'};
+    uint8_t output[8];
+
+    TEST_ASSERT_EQUAL(5, decode(packed, sizeof(packed), output, sizeof(output), 6, 8));
+    TEST_ASSERT_EQUAL_MEMORY("ABCCC", output, 5);
+}
+
+void test_packbits_header_signature() {
+    TEST_ASSERT_TRUE(PackBits::isPacked(PackBits::HEADER, PACKBITS_HEADER_SIZE));
+
+    const uint8_t bmp[] = {'B', 'M', 0x36, 0x96};
+    TEST_ASSERT_FALSE(PackBits::isPacked(bmp, sizeof(bmp)));
+    TEST_ASSERT_FALSE(PackBits::isPacked(PackBits::HEADER, PACKBITS_HEADER_SIZE - 1));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Encoding tests
+    RUN_TEST(test_packbits_flat_background_collapses);
+    RUN_TEST(test_packbits_literal_overhead_is_bounded);
+    RUN_TEST(test_packbits_short_repeats_stay_literal);
+    RUN_TEST(test_packbits_mixed_scanlines);
+    RUN_TEST(test_packbits_empty_and_single_byte);
+
+    // Decoding tests
+    RUN_TEST(test_packbits_decoder_skips_noop);
+    RUN_TEST(test_packbits_header_signature);
+
+    return UNITY_END();
+}
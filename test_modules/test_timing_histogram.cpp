@@ -0,0 +1,99 @@
+#include <unity.h>
+#include <stdint.h>
+
+// Exercise the production histogram directly
+#include "TimingHistogram.h"
+
+// Test setup/teardown
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// Bucket Selection Tests
+// ============================================================================
+
+void test_histogram_bucket_of_small_values() {
+    TEST_ASSERT_EQUAL(0, TimingHistogram::bucketOf(0));
+    TEST_ASSERT_EQUAL(0, TimingHistogram::bucketOf(1));
+    TEST_ASSERT_EQUAL(1, TimingHistogram::bucketOf(2));
+    TEST_ASSERT_EQUAL(1, TimingHistogram::bucketOf(3));
+    TEST_ASSERT_EQUAL(2, TimingHistogram::bucketOf(4));
+    TEST_ASSERT_EQUAL(7, TimingHistogram::bucketOf(255));
+}
+
+void test_histogram_bucket_of_matches_log2() {
+    // Every power of two and its predecessor land on the expected bucket
+    for (uint8_t bit = 1; bit < 16; bit++) {
+        uint16_t power = (uint16_t)(1u << bit);
+        TEST_ASSERT_EQUAL(bit, TimingHistogram::bucketOf(power));
+        TEST_ASSERT_EQUAL(bit - 1, TimingHistogram::bucketOf(power - 1));
+    }
+    TEST_ASSERT_EQUAL(15, TimingHistogram::bucketOf(0xFFFF));
+}
+
+void test_histogram_lower_bound() {
+    TEST_ASSERT_EQUAL(0, TimingHistogram::lowerBound(0));
+    TEST_ASSERT_EQUAL(2, TimingHistogram::lowerBound(1));
+    TEST_ASSERT_EQUAL(32768, TimingHistogram::lowerBound(15));
+
+    for (uint8_t i = 1; i < 16; i++) {
+        TEST_ASSERT_EQUAL(i, TimingHistogram::bucketOf(TimingHistogram::lowerBound(i)));
+    }
+}
+
+// ============================================================================
+// Recording Tests
+// ============================================================================
+
+void test_histogram_initially_empty() {
+    TimingHistogram histogram;
+
+    TEST_ASSERT_EQUAL(0, histogram.getTotal());
+    for (uint8_t i = 0; i < TIMING_HISTOGRAM_BUCKETS; i++) {
+        TEST_ASSERT_EQUAL(0, histogram.getCount(i));
+    }
+}
+
+void test_histogram_record_and_reset() {
+    TimingHistogram histogram;
+
+    histogram.record(3);      // bucket 1
+    histogram.record(3);
+    histogram.record(1000);   // bucket 9
+    histogram.recordOverflow();
+
+    TEST_ASSERT_EQUAL(2, histogram.getCount(1));
+    TEST_ASSERT_EQUAL(1, histogram.getCount(9));
+    TEST_ASSERT_EQUAL(1, histogram.getCount(TIMING_HISTOGRAM_OVERFLOW));
+    TEST_ASSERT_EQUAL(4, histogram.getTotal());
+
+    histogram.reset();
+    TEST_ASSERT_EQUAL(0, histogram.getTotal());
+}
+
+void test_histogram_counters_saturate() {
+    TimingHistogram histogram;
+
+    for (uint32_t i = 0; i < 70000; i++) {
+        histogram.record(8);
+    }
+
+    TEST_ASSERT_EQUAL(0xFFFF, histogram.getCount(3));
+    TEST_ASSERT_EQUAL(0, histogram.getCount(TIMING_HISTOGRAM_BUCKETS));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Bucket selection
+    RUN_TEST(test_histogram_bucket_of_small_values);
+    RUN_TEST(test_histogram_bucket_of_matches_log2);
+    RUN_TEST(test_histogram_lower_bound);
+
+    // Recording
+    RUN_TEST(test_histogram_initially_empty);
+    RUN_TEST(test_histogram_record_and_reset);
+    RUN_TEST(test_histogram_counters_saturate);
+
+    return UNITY_END();
+}
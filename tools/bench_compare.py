@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Compare two benchmark results and fail on a regression.
+
+Takes the JSON of a single bench run or of tools/bench_matrix.py; variants
+are matched by label. A variant regresses when, against the baseline:
+  - the sustained capture rate drops by more than --rate-tolerance percent
+  - the worst ring (drain) latency grows by more than --latency-tolerance
+    percent
+  - it drops, overflows or loses strobes where the baseline did not
+    (or more of them)
+  - the capture no longer completes or no longer matches the trace
+
+    bench_compare.py baseline.json bench.json
+
+Exit status 0 when nothing regressed, 1 otherwise.
+"""
+
+import argparse
+import json
+import sys
+
+# Counters that may never grow
+COUNTERS = ["bytes_dropped", "overflows", "lost_strobes", "host_ack_timeouts"]
+
+
+def load(path):
+    with open(path) as handle:
+        data = json.load(handle)
+    variants = data["variants"] if "variants" in data else [data]
+    return {v["label"]: v for v in variants}
+
+
+def percent(old, new):
+    if old == 0:
+        return 0.0 if new == 0 else float("inf")
+    return (new - old) * 100.0 / old
+
+
+def compare(label, old, new, args):
+    """Print the variant's changes; return the list of regressions."""
+    before, after = old["results"], new["results"]
+    problems = []
+
+    rate = percent(before["sustained_bytes_per_s"], after["sustained_bytes_per_s"])
+    latency = percent(before["drain_latency_max_us"], after["drain_latency_max_us"])
+    print("%-16s rate %9.1f -> %9.1f B/s (%+.1f%%)  drain max %8.1f -> %8.1f us (%+.1f%%)"
+          % (label, before["sustained_bytes_per_s"], after["sustained_bytes_per_s"], rate,
+             before["drain_latency_max_us"], after["drain_latency_max_us"], latency))
+
+    if -rate > args.rate_tolerance:
+        problems.append("capture rate down %.1f%%" % -rate)
+    if latency > args.latency_tolerance:
+        problems.append("drain latency up %.1f%%" % latency)
+    for counter in COUNTERS:
+        if after.get(counter, 0) > before.get(counter, 0):
+            problems.append("%s %d -> %d" % (counter, before.get(counter, 0), after[counter]))
+    if before["completed"] and not after["completed"]:
+        problems.append("capture did not complete")
+    if before["integrity"] == "match" and after["integrity"] != "match":
+        problems.append("integrity %s" % after["integrity"])
+    return problems
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--rate-tolerance", type=float, default=2.0,
+                        help="allowed capture rate drop, percent (default 2)")
+    parser.add_argument("--latency-tolerance", type=float, default=10.0,
+                        help="allowed drain latency growth, percent (default 10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressed = False
+    for label, new in current.items():
+        old = baseline.get(label)
+        if old is None:
+            print("%-16s not in the baseline" % label)
+            continue
+        for problem in compare(label, old, new, args):
+            print("  REGRESSION: %s" % problem)
+            regressed = True
+    for label in baseline:
+        if label not in current:
+            print("%-16s missing from the new results" % label)
+
+    return 1 if regressed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
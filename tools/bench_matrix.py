@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""Build and run the trace-replay benchmark over a set of configurations.
+
+Each variant is the firmware built for the native host with a few
+HardwareConfig.h macros overridden (-DNAME=VALUE), linked with bench/ and
+run on the same trace. The JSON reports are collected into one file:
+    {"variants": [ {report}, ... ]}
+which tools/bench_compare.py takes as a baseline or as the new result.
+
+The bench is built with PlatformIO (pio run -e bench, the flags passed in
+PLATFORMIO_BUILD_FLAGS), or with --cxx straight from the sources, which
+needs only a host g++:
+    bench_matrix.py --cxx g++ --output bench.json -- --host ack
+Arguments after "--" go to every bench run (trace, host mode, ...).
+"""
+
+import argparse
+import glob
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# name: macro overrides (the default build is always run first)
+VARIANTS = [
+    ("default", {}),
+    ("ring16", {"RING_BUFFER_SIZE": 16}),
+    ("ring64", {"RING_BUFFER_SIZE": 64}),
+    ("ring256", {"RING_BUFFER_SIZE": 256}),
+    ("display100ms", {"SCHEDULER_DISPLAY_MS": 100}),
+    ("lcd8ops", {"LCD_BUS_OPS_PER_UPDATE": 8}),
+    ("lcd32ops", {"LCD_BUS_OPS_PER_UPDATE": 32}),
+    ("no-sleep", {"IDLE_SLEEP": 0}),
+    ("no-flow-control", {"LPT_FLOW_CONTROL": 0}),
+]
+
+CXX_FLAGS = ["-std=gnu++17", "-O2", "-DSERIAL_TX_BUFFER_SIZE=256",
+             "-Ibench/mock", "-Ibench", "-Iinclude"]
+
+
+def defines(overrides):
+    return ["-D%s=%s" % (name, value) for name, value in sorted(overrides.items())]
+
+
+def build_cxx(cxx, overrides, work):
+    """Compile src/ and bench/ with the host compiler; return the binary path."""
+    sources = sorted(glob.glob(os.path.join("src", "**", "*.cpp"), recursive=True))
+    sources += sorted(glob.glob(os.path.join("bench", "*.cpp")))
+    objects = []
+    for source in sources:
+        obj = os.path.join(work, source.replace(os.sep, "_") + ".o")
+        subprocess.run([cxx] + CXX_FLAGS + defines(overrides) + ["-c", source, "-o", obj],
+                       cwd=ROOT, check=True)
+        objects.append(obj)
+    binary = os.path.join(work, "bench")
+    subprocess.run([cxx, "-o", binary] + objects + ["-lm"], cwd=ROOT, check=True)
+    return binary
+
+
+def build_pio(overrides, work):
+    """Build the [env:bench] environment; return a copy of the binary."""
+    env = dict(os.environ)
+    env["PLATFORMIO_BUILD_FLAGS"] = " ".join(defines(overrides))
+    subprocess.run(["pio", "run", "-e", "bench"], cwd=ROOT, env=env, check=True)
+    binary = os.path.join(work, "bench")
+    shutil.copy(os.path.join(ROOT, ".pio", "build", "bench", "program"), binary)
+    return binary
+
+
+def run_variant(name, overrides, args, bench_args):
+    with tempfile.TemporaryDirectory() as work:
+        if args.cxx:
+            binary = build_cxx(args.cxx, overrides, work)
+        else:
+            binary = build_pio(overrides, work)
+        report_path = os.path.join(work, "report.json")
+        run = subprocess.run([binary, "--label", name, "--json", report_path] + bench_args,
+                             cwd=ROOT, stdout=subprocess.DEVNULL)
+        if run.returncode == 2:
+            raise SystemExit("bench rejected its arguments: %s" % " ".join(bench_args))
+        with open(report_path) as handle:
+            report = json.load(handle)
+    report["overrides"] = overrides
+    return report
+
+
+def main():
+    argv = sys.argv[1:]
+    bench_args = []
+    if "--" in argv:
+        split = argv.index("--")
+        argv, bench_args = argv[:split], argv[split + 1:]
+
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--output", default="bench.json", help="collected JSON reports")
+    parser.add_argument("--cxx", help="build with this host compiler instead of PlatformIO")
+    parser.add_argument("--only", action="append", help="run only the named variant(s)")
+    args = parser.parse_args(argv)
+
+    variants = [v for v in VARIANTS if not args.only or v[0] in args.only]
+    reports = []
+    for name, overrides in variants:
+        report = run_variant(name, overrides, args, bench_args)
+        results = report["results"]
+        print("%-16s %9.1f B/s  drain max %8.1f us  dropped %lu  lost %lu  %s"
+              % (name, results["sustained_bytes_per_s"], results["drain_latency_max_us"],
+                 results["bytes_dropped"], results["lost_strobes"], results["integrity"]))
+        reports.append(report)
+
+    with open(args.output, "w") as handle:
+        json.dump({"variants": reports}, handle, indent=2)
+        handle.write("\n")
+    return 0 if all(r["results"]["completed"] for r in reports) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
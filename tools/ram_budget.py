@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""Fail the build when static RAM (.data + .bss + .noinit) exceeds a budget.
+
+The sizes come from the output sections of the GNU ld map file:
+    .data           0x00800200      0x1a4 load address 0x00007c5e
+    .bss            0x008003a4      0x5d2
+
+Used two ways:
+  - as a PlatformIO extra script (extra_scripts = post:tools/ram_budget.py):
+    the link writes firmware.map and the check runs after the .elf is
+    built, with the budget from custom_ram_budget in platformio.ini
+  - from the command line: ram_budget.py firmware.map --budget 7168
+
+The rest of the ATmega2560's 8 KB is stack; the boot-time stack painting
+("memory" command) shows how much of that the firmware really uses.
+"""
+
+import re
+import sys
+
+SECTION_RE = re.compile(r"^\.(data|bss|noinit)\s+0x[0-9a-fA-F]+\s+0x([0-9a-fA-F]+)")
+RAM_SIZE = 8192
+
+
+def section_sizes(map_path):
+    """Return {section: bytes} for the RAM output sections in a map file."""
+    sizes = {"data": 0, "bss": 0, "noinit": 0}
+    with open(map_path, "r", errors="replace") as handle:
+        for line in handle:
+            match = SECTION_RE.match(line)
+            if match:
+                sizes[match.group(1)] = int(match.group(2), 16)
+    return sizes
+
+
+def check(map_path, budget):
+    """Print the static RAM use; return True if it fits the budget."""
+    sizes = section_sizes(map_path)
+    used = sum(sizes.values())
+    print("RAM: .data %d + .bss %d + .noinit %d = %d bytes, budget %d, stack room %d"
+          % (sizes["data"], sizes["bss"], sizes["noinit"], used, budget, RAM_SIZE - used))
+    if used > budget:
+        print("RAM budget exceeded by %d bytes" % (used - budget), file=sys.stderr)
+        return False
+    return True
+
+
+def main():
+    import argparse
+
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("map", help="linker map file")
+    parser.add_argument("--budget", type=int, default=7168,
+                        help="static RAM budget in bytes (default 7168)")
+    args = parser.parse_args()
+    return 0 if check(args.map, args.budget) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
+else:
+    # PlatformIO (SCons) extra script
+    Import("env")  # noqa: F821
+
+    map_path = env.subst("$BUILD_DIR/firmware.map")  # noqa: F821
+    env.Append(LINKFLAGS=["-Wl,-Map," + map_path])  # noqa: F821
+
+    def ram_budget_action(target, source, env):
+        budget = int(env.GetProjectOption("custom_ram_budget", "7168"))
+        if not check(map_path, budget):
+            env.Exit(1)
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", ram_budget_action)  # noqa: F821
@@ -0,0 +1,349 @@
+#!/usr/bin/env python3
+"""Receive files sent by the bridge's binary serial transfer mode.
+
+Each packet is COBS-encoded and delimited by 0x00 bytes:
+    type(1) sequence(2, LE) payload crc32(4, LE)
+    'B'  size hint (u32 LE, 0 if unknown) + filename
+    'D'  file data
+    'E'  file size (u32 LE) + CRC-32 of the whole file (u32 LE)
+
+Anything between packets that does not decode (debug text from the
+firmware) is printed to stderr. Enable the mode on the bridge with the
+"serial binary" command.
+
+--link RATE raises the link speed first: the bridge acks "baud RATE" with
+"BAUD:RATE" at the old rate, both sides switch, and "baud ok" confirms the
+new rate (the bridge falls back on its own if the confirmation is lost).
+
+--pull downloads stored files instead of waiting for transfers. The file
+list comes from "files" (FILE:name,size lines, FILES:count per page), and
+each file is requested with "get NAME OFFSET". The reply uses the same
+packets with their own meaning:
+    'B'  (seq 0)     file size (u32 LE) + offset (u32 LE) + filename
+    'D'  (seq 1..n)  file data from the offset on
+    'E'  (seq n+1)   file size (u32 LE) + CRC-32 of the data sent (u32 LE)
+Several packets are in flight; "ack SEQ" confirms everything up to SEQ and
+"nak SEQ" asks for a resend from SEQ. Data is kept in NAME.part as it
+arrives, so an interrupted download resumes where it stopped.
+
+Packed captures (PackBits, header 89 'P' 'K' 01) are unpacked on save
+unless --raw is given.
+
+Usage:
+    serial_receive.py /dev/ttyACM0 [--baud 115200] [--link 1000000] [--out DIR]
+    serial_receive.py /dev/ttyACM0 --pull [NAME ...] [--out DIR]
+    serial_receive.py capture.bin --out DIR     (replay a raw capture)
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+
+PACKED_HEADER = b'\x89PK\x01'
+FILES_PER_PAGE = 8          # Bridge "files" page size
+ACK_EVERY = 4               # Packets per ack (the bridge keeps 16 in flight)
+NAK_HOLDOFF = 0.5           # Seconds before asking for the same resend again
+IDLE_TIMEOUT = 3.0          # Seconds of silence before a download is retried
+
+
+def cobs_decode(data):
+    """Decode one COBS block; returns None if it is malformed."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def parse_packet(block):
+    """Return (type, sequence, payload) for a valid packet, else None."""
+    packet = cobs_decode(block)
+    if packet is None or len(packet) < 7:
+        return None
+    body, crc = packet[:-4], struct.unpack('<I', packet[-4:])[0]
+    if zlib.crc32(body) & 0xFFFFFFFF != crc:
+        return None
+    return chr(body[0]), struct.unpack('<H', body[1:3])[0], body[3:]
+
+
+def unpack(data):
+    """Expand a PackBits capture (header already checked)."""
+    out = bytearray()
+    i = len(PACKED_HEADER)
+    while i < len(data):
+        n = data[i]
+        i += 1
+        if n < 0x80:
+            out += data[i:i + n + 1]
+            i += n + 1
+        elif n != 0x80 and i < len(data):
+            out += bytes([data[i]]) * (257 - n)
+            i += 1
+    return bytes(out)
+
+
+def write_file(path, data, raw):
+    if not raw and data.startswith(PACKED_HEADER):
+        data = unpack(data)
+    with open(path, 'wb') as f:
+        f.write(data)
+    return len(data)
+
+
+class Receiver:
+    def __init__(self, out_dir, raw=False):
+        self.out_dir = out_dir
+        self.raw = raw
+        self.name = None
+        self.data = bytearray()
+        self.sequence = 0
+        self.damaged = False
+        self.files = 0
+
+    def block(self, block):
+        if not block:
+            return
+        packet = parse_packet(block)
+        if packet is None:
+            # Debug text is passed on; a corrupted packet shows up as a gap
+            if all(32 <= value < 127 or value in (9, 10, 13) for value in block):
+                text = block.decode('ascii').strip()
+                if text:
+                    print(text, file=sys.stderr)
+            return
+
+        kind, sequence, payload = packet
+        if kind == 'B':
+            if self.name is not None:
+                print('%s: abandoned after %d bytes' % (self.name, len(self.data)),
+                      file=sys.stderr)
+            self.name = payload[4:].decode('ascii', 'replace')
+            self.data = bytearray()
+            self.sequence = 1
+            self.damaged = False
+            return
+
+        if self.name is None:
+            return
+        if sequence != self.sequence:
+            print('%s: lost %d packet(s) at offset %d' %
+                  (self.name, (sequence - self.sequence) & 0xFFFF, len(self.data)),
+                  file=sys.stderr)
+            self.damaged = True
+        self.sequence = (sequence + 1) & 0xFFFF
+
+        if kind == 'D':
+            self.data += payload
+        elif kind == 'E':
+            size, crc = struct.unpack('<II', payload[:8])
+            ok = (not self.damaged and size == len(self.data) and
+                  zlib.crc32(self.data) & 0xFFFFFFFF == crc)
+            self.save(ok)
+
+    def save(self, ok):
+        name = os.path.basename(self.name) or 'unnamed.bin'
+        if not ok:
+            name += '.bad'
+        path = os.path.join(self.out_dir, name)
+        size = write_file(path, bytes(self.data), self.raw or not ok)
+        print('%s %s (%d bytes)' % ('received' if ok else 'DAMAGED', path, size))
+        self.files += ok
+        self.name = None
+
+
+def wait_for(port, reply):
+    """Read lines until one equals reply; False on timeout or refusal."""
+    while True:
+        line = port.readline()
+        if not line:
+            return False
+        text = line.decode('ascii', 'replace').strip()
+        if text == reply:
+            return True
+        if text.startswith('BAUD:ERR'):
+            print(text, file=sys.stderr)
+            return False
+
+
+def negotiate(port, rate):
+    """Switch the bridge and the port to a new rate."""
+    port.timeout = 1.0
+    port.write(b'\nbaud %d\n' % rate)
+    if not wait_for(port, 'BAUD:%d' % rate):
+        return False
+    port.baudrate = rate
+    port.reset_input_buffer()
+    port.write(b'\nbaud ok\n')
+    ok = wait_for(port, 'BAUD:OK')
+    port.timeout = None
+    return ok
+
+
+def list_files(port):
+    """Return [(name, size)] for every file on the bridge's current storage."""
+    files = []
+    port.timeout = 1.0
+    while True:
+        port.write(b'\nfiles %d\n' % len(files))
+        count = None
+        while count is None:
+            line = port.readline()
+            if not line:
+                raise IOError('no reply to "files"')
+            text = line.decode('ascii', 'replace').strip()
+            if text.startswith('FILE:'):
+                name, size = text[5:].rsplit(',', 1)
+                files.append((name, int(size)))
+            elif text.startswith('FILES:'):
+                count = int(text[6:])
+        if count < FILES_PER_PAGE:
+            return files
+
+
+def download(port, name, out_dir, raw):
+    """Fetch one file, resuming from NAME.part; True once verified."""
+    part = os.path.join(out_dir, os.path.basename(name) + '.part')
+    have = os.path.getsize(part) if os.path.exists(part) else 0
+
+    port.timeout = 0.05
+    port.reset_input_buffer()
+    port.write(b'\nget %s %d\n' % (name.encode('ascii'), have))
+
+    expect = 0
+    size = None
+    crc = 0
+    nak_time = 0.0
+    last_packet = time.time()
+    pending = bytearray()
+
+    with open(part, 'ab') as f:
+        while time.time() - last_packet < IDLE_TIMEOUT:
+            for value in port.read(512):
+                if value != 0:
+                    pending.append(value)
+                    continue
+                packet = parse_packet(bytes(pending)) if pending else None
+                pending.clear()
+                if packet is None:
+                    continue
+
+                kind, sequence, payload = packet
+                last_packet = time.time()
+                if sequence != expect & 0xFFFF:
+                    # Lost or damaged packet: one resend request per hold-off
+                    if time.time() - nak_time > NAK_HOLDOFF:
+                        port.write(b'nak %d\n' % (expect & 0xFFFF))
+                        nak_time = time.time()
+                    continue
+                expect += 1
+                nak_time = 0.0
+
+                if kind == 'B':
+                    size, offset = struct.unpack('<II', payload[:8])
+                    if offset != have:
+                        print('%s: bridge sent offset %d, wanted %d' % (name, offset, have),
+                              file=sys.stderr)
+                        return False
+                elif kind == 'D':
+                    f.write(payload)
+                    crc = zlib.crc32(payload, crc)
+                elif kind == 'E':
+                    port.write(b'ack %d\n' % (sequence))
+                    f.close()
+                    end_size, end_crc = struct.unpack('<II', payload[:8])
+                    if end_size != size or os.path.getsize(part) != size or \
+                            crc & 0xFFFFFFFF != end_crc:
+                        print('%s: DAMAGED, starting over' % name, file=sys.stderr)
+                        os.remove(part)
+                        return False
+                    with open(part, 'rb') as done:
+                        data = done.read()
+                    path = os.path.join(out_dir, os.path.basename(name))
+                    written = write_file(path, data, raw)
+                    os.remove(part)
+                    print('received %s (%d bytes)' % (path, written))
+                    return True
+
+                if expect % ACK_EVERY == 0:
+                    port.write(b'ack %d\n' % (sequence))
+
+    print('%s: link idle after %d bytes, will resume' % (name, os.path.getsize(part)),
+          file=sys.stderr)
+    return False
+
+
+def pull(port, names, out_dir, raw, attempts=5):
+    stored = dict(list_files(port))
+    wanted = names or sorted(stored)
+    missing = 0
+    for name in wanted:
+        if name not in stored:
+            print('%s: not on the bridge' % name, file=sys.stderr)
+            missing += 1
+            continue
+        for _ in range(attempts):
+            if download(port, name, out_dir, raw):
+                break
+        else:
+            missing += 1
+    return 1 if missing else 0
+
+
+def blocks(stream):
+    """Split a byte stream at 0x00 delimiters."""
+    pending = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        for value in chunk:
+            if value == 0:
+                yield bytes(pending)
+                pending.clear()
+            else:
+                pending.append(value)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('source', help='serial port or raw capture file')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--link', type=int, help='negotiate this link rate first')
+    parser.add_argument('--out', default='.', help='directory for received files')
+    parser.add_argument('--pull', nargs='*', metavar='NAME',
+                        help='download stored files (all if no names are given)')
+    parser.add_argument('--raw', action='store_true', help='keep packed captures packed')
+    args = parser.parse_args()
+
+    if os.path.isfile(args.source):
+        stream = open(args.source, 'rb')
+    else:
+        import serial  # pyserial
+        stream = serial.Serial(args.source, args.baud, timeout=None)
+        if args.link and not negotiate(stream, args.link):
+            print('link rate %d not accepted' % args.link, file=sys.stderr)
+            return 1
+        if args.pull is not None:
+            return pull(stream, args.pull, args.out, args.raw)
+
+    receiver = Receiver(args.out, args.raw)
+    try:
+        for block in blocks(stream):
+            receiver.block(block)
+    except KeyboardInterrupt:
+        pass
+    return 0 if receiver.files else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())